@@ -0,0 +1,437 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxAsyncLoader.h
+// Desc : Asynchronous Resource Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <functional>
+#include <asdxRef.h>
+#include <asdxThreadPool.h>
+#include <asdxResTexture.h>
+#include <asdxResModel.h>
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+// Forward Declarations.
+//-----------------------------------------------------------------------------
+class AsyncRequest;
+class AsyncTexture;
+class AsyncModel;
+
+///////////////////////////////////////////////////////////////////////////////
+// ASYNC_LOAD_STATE enum
+///////////////////////////////////////////////////////////////////////////////
+enum ASYNC_LOAD_STATE
+{
+    ASYNC_LOAD_STATE_PENDING = 0,       //!< 読み込み待ち.
+    ASYNC_LOAD_STATE_LOADING,           //!< 読み込み中.
+    ASYNC_LOAD_STATE_COMPLETED,         //!< 読み込み完了.
+    ASYNC_LOAD_STATE_FAILED,            //!< 読み込み失敗.
+    ASYNC_LOAD_STATE_CANCELED,          //!< キャンセル済み.
+};
+
+//-----------------------------------------------------------------------------
+// Type Definition
+//-----------------------------------------------------------------------------
+using AsyncCallback = std::function<void(AsyncRequest* pRequest)>;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncRequest class
+///////////////////////////////////////////////////////////////////////////////
+class AsyncRequest : public IReference
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    friend class AsyncLoader;
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      参照カウントを1つ増やします.
+    //-------------------------------------------------------------------------
+    void AddRef() override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      参照カウントを1つ減らします.
+    //-------------------------------------------------------------------------
+    void Release() override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      参照カウントを取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      読み込み状態を取得します.
+    //-------------------------------------------------------------------------
+    ASYNC_LOAD_STATE GetState() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      処理が終了したかどうかチェックします.
+    //!
+    //! @retval true    完了・失敗・キャンセルのいずれかで，コールバックも呼び出し済みです.
+    //! @retval false   処理中です.
+    //-------------------------------------------------------------------------
+    bool IsDone() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      読み込みをキャンセルします.
+    //!             読み込み開始前の場合のみキャンセルでき，
+    //!             コールバックはこのメソッドを呼び出したスレッドで実行されます.
+    //!
+    //! @retval true    キャンセルに成功.
+    //! @retval false   既に読み込みが開始されています.
+    //-------------------------------------------------------------------------
+    bool Cancel();
+
+    //-------------------------------------------------------------------------
+    //! @brief      処理が終了するまで待機します.
+    //!             まだ開始されていない場合は呼び出しスレッドで読み込みを行います.
+    //!             その場合，完了コールバックも呼び出しスレッドで実行されます.
+    //!             他の読み込み要求のジョブは実行しないため，ジョブ内から呼び出しても
+    //!             無関係な読み込みが入れ子で実行されることはありません.
+    //-------------------------------------------------------------------------
+    void Wait();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルパスを取得します.
+    //-------------------------------------------------------------------------
+    const std::wstring& GetPath() const;
+
+protected:
+    //=========================================================================
+    // protected variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // protected methods.
+    //=========================================================================
+    AsyncRequest(const std::wstring& path, const AsyncCallback& callback);
+    virtual ~AsyncRequest();
+
+    //-------------------------------------------------------------------------
+    //! @brief      読み込み処理を行います. ワーカースレッドから呼び出されます.
+    //!
+    //! @param[in]      pPool       分割デコードに用いるスレッドプール(nullptr可).
+    //-------------------------------------------------------------------------
+    virtual bool OnLoad(ThreadPool* pPool) = 0;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::atomic<uint32_t>   m_Count;        //!< 参照カウント.
+    std::atomic<uint32_t>   m_State;        //!< 読み込み状態.
+    std::atomic<bool>       m_Done;         //!< 終了フラグ.
+    std::wstring            m_Path;         //!< ファイルパス.
+    AsyncCallback           m_Callback;     //!< 完了コールバック.
+    ThreadPool*             m_pPool;        //!< スレッドプール.
+    ThreadPool*             m_pDecodePool;  //!< 分割デコード用スレッドプール.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void Execute();
+    void Finish();
+
+    AsyncRequest                (const AsyncRequest&) = delete;
+    AsyncRequest& operator =    (const AsyncRequest&) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncTexture class
+///////////////////////////////////////////////////////////////////////////////
+class AsyncTexture final : public AsyncRequest
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    friend class AsyncLoader;
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャリソースを取得します.
+    //!             ASYNC_LOAD_STATE_COMPLETED の場合のみ有効です.
+    //-------------------------------------------------------------------------
+    ResTexture& GetResource();
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    ResTexture  m_Resource;     //!< テクスチャリソース.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    AsyncTexture(const std::wstring& path, const AsyncCallback& callback);
+    ~AsyncTexture();
+    bool OnLoad(ThreadPool* pPool) override;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncModel class
+///////////////////////////////////////////////////////////////////////////////
+class AsyncModel final : public AsyncRequest
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    friend class AsyncLoader;
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      モデルリソースを取得します.
+    //!             ASYNC_LOAD_STATE_COMPLETED の場合のみ有効です.
+    //-------------------------------------------------------------------------
+    ResModel& GetResource();
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    ResModel    m_Resource;     //!< モデルリソース.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    AsyncModel(const std::wstring& path, const AsyncCallback& callback);
+    ~AsyncModel();
+    bool OnLoad(ThreadPool* pPool) override;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncLoader class
+///////////////////////////////////////////////////////////////////////////////
+class AsyncLoader
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    // Desc structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Desc
+    {
+        uint32_t    ThreadCount;        //!< ワーカースレッド数(0の場合は論理コア数).
+        bool        SplitDecode;        //!< 大きな画像を行単位で分割してデコードする場合は true.
+    };
+
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    AsyncLoader();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~AsyncLoader();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      desc        設定です.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //-------------------------------------------------------------------------
+    bool Init(const Desc& desc);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います. 投入済みの読み込みは全て終了を待ちます.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャの読み込みを要求します.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    完了コールバック(ワーカースレッドで呼び出されます).
+    //! @return     読み込み要求を返却します.
+    //-------------------------------------------------------------------------
+    RefPtr<AsyncTexture> LoadTextureA(
+        const char*             path,
+        JOB_PRIORITY            priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&    callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャの読み込みを要求します.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    完了コールバック(ワーカースレッドで呼び出されます).
+    //! @return     読み込み要求を返却します.
+    //-------------------------------------------------------------------------
+    RefPtr<AsyncTexture> LoadTextureW(
+        const wchar_t*          path,
+        JOB_PRIORITY            priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&    callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャの一括読み込みを要求します.
+    //!
+    //! @param[in]      paths       ファイルパスの配列.
+    //! @param[in]      count       ファイル数.
+    //! @param[out]     results     ファイル毎の読み込み要求.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    ファイル毎の完了コールバック.
+    //-------------------------------------------------------------------------
+    void LoadTexturesA(
+        const char* const*                  paths,
+        uint32_t                            count,
+        std::vector<RefPtr<AsyncTexture>>&  results,
+        JOB_PRIORITY                        priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&                callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャの一括読み込みを要求します.
+    //!
+    //! @param[in]      paths       ファイルパスの配列.
+    //! @param[in]      count       ファイル数.
+    //! @param[out]     results     ファイル毎の読み込み要求.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    ファイル毎の完了コールバック.
+    //-------------------------------------------------------------------------
+    void LoadTexturesW(
+        const wchar_t* const*               paths,
+        uint32_t                            count,
+        std::vector<RefPtr<AsyncTexture>>&  results,
+        JOB_PRIORITY                        priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&                callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      モデル(ResModelBinary形式)の読み込みを要求します.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    完了コールバック(ワーカースレッドで呼び出されます).
+    //! @return     読み込み要求を返却します.
+    //-------------------------------------------------------------------------
+    RefPtr<AsyncModel> LoadModelA(
+        const char*             path,
+        JOB_PRIORITY            priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&    callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      モデル(ResModelBinary形式)の読み込みを要求します.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    完了コールバック(ワーカースレッドで呼び出されます).
+    //! @return     読み込み要求を返却します.
+    //-------------------------------------------------------------------------
+    RefPtr<AsyncModel> LoadModelW(
+        const wchar_t*          path,
+        JOB_PRIORITY            priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&    callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      モデル(ResModelBinary形式)の一括読み込みを要求します.
+    //!
+    //! @param[in]      paths       ファイルパスの配列.
+    //! @param[in]      count       ファイル数.
+    //! @param[out]     results     ファイル毎の読み込み要求.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    ファイル毎の完了コールバック.
+    //-------------------------------------------------------------------------
+    void LoadModelsA(
+        const char* const*                  paths,
+        uint32_t                            count,
+        std::vector<RefPtr<AsyncModel>>&    results,
+        JOB_PRIORITY                        priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&                callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      モデル(ResModelBinary形式)の一括読み込みを要求します.
+    //!
+    //! @param[in]      paths       ファイルパスの配列.
+    //! @param[in]      count       ファイル数.
+    //! @param[out]     results     ファイル毎の読み込み要求.
+    //! @param[in]      priority    優先度.
+    //! @param[in]      callback    ファイル毎の完了コールバック.
+    //-------------------------------------------------------------------------
+    void LoadModelsW(
+        const wchar_t* const*               paths,
+        uint32_t                            count,
+        std::vector<RefPtr<AsyncModel>>&    results,
+        JOB_PRIORITY                        priority = JOB_PRIORITY_NORMAL,
+        const AsyncCallback&                callback = nullptr);
+
+    //-------------------------------------------------------------------------
+    //! @brief      全ての読み込みが終了するまで待機します.
+    //-------------------------------------------------------------------------
+    void WaitAll();
+
+    //-------------------------------------------------------------------------
+    //! @brief      スレッドプールを取得します.
+    //-------------------------------------------------------------------------
+    ThreadPool& GetThreadPool();
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    ThreadPool  m_Pool;                     //!< スレッドプール.
+    bool        m_SplitDecode = false;      //!< 分割デコードを行うかどうか.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void Push(AsyncRequest* pRequest, JOB_PRIORITY priority);
+
+    AsyncLoader             (const AsyncLoader&) = delete;
+    AsyncLoader& operator = (const AsyncLoader&) = delete;
+};
+
+} // namespace asdx
@@ -0,0 +1,247 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAsyncLogger.h
+// Desc : Asynchronous Logger Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdarg>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <unordered_map>
+#include <asdxLogger.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LogOverflow enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum class LogOverflow : uint32_t
+{
+    Drop = 0,       //!< バッファが一杯の場合はログを破棄します.
+    Block,          //!< バッファが空くまで呼び出しスレッドを待機させます.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LOG_SINK enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum LOG_SINK
+{
+    LOG_SINK_CONSOLE        = 0x1 << 0,     //!< コンソールに出力します.
+    LOG_SINK_DEBUGGER       = 0x1 << 1,     //!< デバッガに出力します.
+    LOG_SINK_TEXT_FILE      = 0x1 << 2,     //!< テキストファイル(UTF-8)に出力します.
+    LOG_SINK_BINARY_FILE    = 0x1 << 3,     //!< バイナリファイルに出力します. DecodeBinaryLog() でテキストに変換できます.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncLogger class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class AsyncLogger : public ILogger
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    static constexpr size_t     DefaultBufferSize   = 1024 * 1024;  //!< デフォルトのリングバッファサイズ.
+    static constexpr size_t     MinBufferSize       = 64 * 1024;    //!< 最小のリングバッファサイズ.
+    static constexpr size_t     MaxRecordSize       = 4096;         //!< 1回のログで記録できる最大サイズ.
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Desc structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Desc
+    {
+        size_t          BufferSize;         //!< リングバッファサイズ(2のべき乗, 0の場合はデフォルト).
+        LogOverflow     Overflow;           //!< バッファが一杯になった場合の動作.
+        uint32_t        Sinks;              //!< LOG_SINK の組み合わせ.
+        const char*     TextFilePath;       //!< テキストファイルのパス(LOG_SINK_TEXT_FILE 指定時).
+        const char*     BinaryFilePath;     //!< バイナリファイルのパス(LOG_SINK_BINARY_FILE 指定時).
+        uint64_t        MaxFileSize;        //!< ファイルをローテーションするサイズ(0の場合はローテーションしない).
+        uint32_t        MaxFileCount;       //!< ローテーションで残す古いファイルの数.
+        uint32_t        FlushInterval;      //!< 書き出しスレッドが起床する間隔(ミリ秒, 0の場合は10ミリ秒).
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Stats structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Stats
+    {
+        uint64_t    WrittenCount;       //!< 書き出したログ数.
+        uint64_t    DroppedCount;       //!< バッファが一杯で破棄したログ数.
+        uint64_t    BlockedCount;       //!< バッファが一杯で待機したログ数.
+        size_t      HighWaterMark;      //!< リングバッファの最大使用量.
+    };
+
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    AsyncLogger();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~AsyncLogger();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      desc        構成設定.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init(const Desc& desc);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      残っているログを書き出してから終了処理を行います.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      呼び出し時点までに記録されたログが書き出されるまで待機します.
+    //---------------------------------------------------------------------------------------------
+    void Flush();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ログを出力します.
+    //!             引数を記録するだけで，書式化と出力は書き出しスレッドで行われます.
+    //!
+    //! @param[in]      level       ログレベルです.
+    //! @param[in]      format      フォーマットです.
+    //! @note       呼び出し元の文字列の寿命に依存しないように, フォーマット文字列は呼び出しごとに
+    //!             リングバッファへ複製されます(最大で MaxRecordSize の半分まで).
+    //!             LOG_SINK_BINARY_FILE でもファイルにはフォーマット番号だけが記録されますが,
+    //!             呼び出し側の複製コストとリングバッファの使用量はテキスト出力と変わりません.
+    //---------------------------------------------------------------------------------------------
+    void LogA( const LogLevel level, const char* format, ... ) override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ログを出力します.
+    //!             引数を記録するだけで，書式化と出力は書き出しスレッドで行われます.
+    //!
+    //! @param[in]      level       ログレベルです.
+    //! @param[in]      format      フォーマットです.
+    //! @note       フォーマット文字列の扱いは LogA() と同じです.
+    //---------------------------------------------------------------------------------------------
+    void LogW( const LogLevel level, const wchar_t* format, ... ) override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      可変長引数リストでログを出力します.
+    //!
+    //! @param[in]      level       ログレベルです.
+    //! @param[in]      format      フォーマットです.
+    //! @param[in]      args        引数リストです.
+    //---------------------------------------------------------------------------------------------
+    void LogVA( const LogLevel level, const char* format, va_list args );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      可変長引数リストでログを出力します.
+    //!
+    //! @param[in]      level       ログレベルです.
+    //! @param[in]      format      フォーマットです.
+    //! @param[in]      args        引数リストです.
+    //---------------------------------------------------------------------------------------------
+    void LogVW( const LogLevel level, const wchar_t* format, va_list args );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      フィルタを設定します.
+    //!
+    //! @param[in]      filter      設定するフィルタ.
+    //---------------------------------------------------------------------------------------------
+    void SetFilter( const LogLevel filter ) override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      設定されているフィルタを取得します.
+    //!
+    //! @return     設定されているフィルタを取得します.
+    //---------------------------------------------------------------------------------------------
+    LogLevel GetFilter() override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    Stats GetStats() const;
+
+private:
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    uint8_t*                    m_pBuffer;          //!< リングバッファです.
+    size_t                      m_BufferSize;       //!< リングバッファサイズです.
+    LogOverflow                 m_Overflow;         //!< バッファが一杯の場合の動作です.
+    uint32_t                    m_Sinks;            //!< 出力先です.
+    std::atomic<uint32_t>       m_Filter;           //!< フィルターです.
+    alignas(64) std::atomic<uint64_t>   m_WritePos; //!< 書き込み位置です.
+    alignas(64) std::atomic<uint64_t>   m_ReadPos;  //!< 読み込み位置です.
+    alignas(64) std::atomic<uint64_t>   m_DroppedCount; //!< 破棄したログ数です.
+    std::atomic<uint64_t>       m_BlockedCount;     //!< 待機したログ数です.
+    std::atomic<uint64_t>       m_WrittenCount;     //!< 書き出したログ数です.
+    std::atomic<size_t>         m_HighWaterMark;    //!< リングバッファの最大使用量です.
+    alignas(64) std::atomic<uint32_t>   m_ProducerCount;    //!< Push() 実行中のスレッド数です.
+    std::atomic<bool>           m_Accept;           //!< ログを受け付ける場合は true です.
+
+    std::thread                 m_Thread;           //!< 書き出しスレッドです.
+    std::mutex                  m_Mutex;            //!< 条件変数用のミューテックスです.
+    std::condition_variable     m_WakeCond;         //!< 書き出しスレッドを起こします.
+    std::condition_variable     m_FlushCond;        //!< 書き出しの完了を通知します.
+    bool                        m_Stop;             //!< 終了要求フラグです.
+    std::atomic<bool>           m_Wake;             //!< 起床要求フラグです.
+    uint32_t                    m_FlushInterval;    //!< 起床間隔(ミリ秒)です.
+
+    std::string                 m_TextPath;         //!< テキストファイルパスです.
+    std::string                 m_BinaryPath;       //!< バイナリファイルパスです.
+    FILE*                       m_pTextFile;        //!< テキストファイルです.
+    FILE*                       m_pBinaryFile;      //!< バイナリファイルです.
+    uint64_t                    m_TextFileSize;     //!< テキストファイルの書き込みサイズです.
+    uint64_t                    m_BinaryFileSize;   //!< バイナリファイルの書き込みサイズです.
+    uint64_t                    m_MaxFileSize;      //!< ローテーションするサイズです.
+    uint32_t                    m_MaxFileCount;     //!< ローテーションで残すファイル数です.
+
+    std::unordered_map<std::string, uint32_t>   m_FormatIds;    //!< バイナリ出力済みのフォーマットです.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    bool Push(LogLevel level, uint8_t type, const uint8_t* pPayload, size_t payloadSize);
+    void Wake();
+    void Consume();
+    void Write(const uint8_t* pRecord);
+    void WriteBinary(const uint8_t* pRecord);
+    bool OpenTextFile();
+    bool OpenBinaryFile();
+    void Run();
+
+    AsyncLogger             (const AsyncLogger&) = delete;
+    AsyncLogger& operator = (const AsyncLogger&) = delete;
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      バイナリログをテキスト(UTF-8)に変換します.
+//!
+//! @param[in]      binaryPath      LOG_SINK_BINARY_FILE で出力したファイルパス.
+//! @param[in]      textPath        出力するテキストファイルパス.
+//! @retval true    変換に成功.
+//! @retval false   変換に失敗.
+//-------------------------------------------------------------------------------------------------
+bool DecodeBinaryLog(const char* binaryPath, const char* textPath);
+
+} // namespace asdx
@@ -9,6 +9,11 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 
 namespace asdx {
@@ -24,6 +29,65 @@ class FrameHeap
     /* NOTHING */
 
 public:
+    static constexpr uint32_t   MaxFrameCount       = 4;            //!< őt[.
+    static constexpr uint32_t   MaxThreadCount      = 64;           //!< ɃA[iĂőXbh(Xbg̓XbhIɍėp).
+    static constexpr size_t     DefaultAlignment    = 16;           //!< ftHg̃ACg.
+    static constexpr size_t     DefaultArenaSize    = 64 * 1024;    //!< ftHg̃A[iTCY.
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Desc structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Desc
+    {
+        size_t      SizePerFrame;   //!< 1t[̃TCY.
+        uint32_t    FrameCount;     //!< t[(1 ` MaxFrameCount).
+        size_t      ArenaSize;      //!< Xbhɐ؂oA[iTCY(0̏ꍇ̓ftHg).
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Stats structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Stats
+    {
+        size_t      UsedBytes;      //!< ݂̃t[Ŏgp̃TCY.
+        size_t      LastFrameBytes; //!< Õt[ŎgpTCY.
+        size_t      HighWaterMark;  //!< 1t[ŎgpőTCY.
+        uint64_t    FailedCount;    //!< mۂɎs.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Marker structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Marker
+    {
+        uint64_t    Frame;          //!< t[ԍ.
+        uint32_t    Slot;           //!< Xbh̃Xbgԍ.
+        uint8_t*    pBegin;         //!< A[i̐擪.
+        uint8_t*    pCurrent;       //!< A[ǐ݈ʒu.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // ScopedMarker class
+    ///////////////////////////////////////////////////////////////////////////
+    class ScopedMarker
+    {
+    public:
+        explicit ScopedMarker(FrameHeap& heap)
+        : m_Heap    (heap)
+        , m_Marker  (heap.GetMarker())
+        { /* DO_NOTHING */ }
+
+        ~ScopedMarker()
+        { m_Heap.Rollback(m_Marker); }
+
+    private:
+        FrameHeap&  m_Heap;
+        Marker      m_Marker;
+
+        ScopedMarker                (const ScopedMarker&) = delete;
+        ScopedMarker& operator =    (const ScopedMarker&) = delete;
+    };
+
     //=========================================================================
     // public variables.
     //=========================================================================
@@ -52,51 +116,163 @@ public:
     //-------------------------------------------------------------------------
     bool Init(size_t size);
 
+    //-------------------------------------------------------------------------
+    //! @brief      s܂.
+    //!
+    //! @param[in]      desc        \ݒ.
+    //! @retval true    ɐ.
+    //! @retval false   Ɏs.
+    //-------------------------------------------------------------------------
+    bool Init(const Desc& desc);
+
     //-------------------------------------------------------------------------
     //! @brief      Is܂.
     //-------------------------------------------------------------------------
     void Term();
 
     //-------------------------------------------------------------------------
-    //! @brief      obt@擪ɃItZbgZbg܂.
+    //! @brief      ̃t[ɐ؂ւāC̃t[̗̈ėp܂.
+    //!             mۂƓɌĂяoĂ͂܂.
+    //!
+    //! @param[in]      completedFrame  gpt[ԍ.
+    //!                                 ̃t[ԍVt[̗͍̈ėp܂.
+    //! @retval true    t[؂ւ܂.
+    //! @retval false   ėp̈悪܂gpł.
     //-------------------------------------------------------------------------
-    void Reset();
+    bool Reset(uint64_t completedFrame = UINT64_MAX);
 
     //-------------------------------------------------------------------------
-    //! @brief      mۂ܂.
+    //! @brief      mۂ܂. XbhĂяo\ł.
     //!
     //! @param[in]      size        mۂ郁TCY.
+    //! @param[in]      alignment   ACg(2ׂ̂).
     //! @return     mۂւ̃|C^ԋp܂.
     //!             mۂɎsꍇ nullptr ԋp܂.
     //-------------------------------------------------------------------------
-    void* Alloc(size_t size);
+    void* Alloc(size_t size, size_t alignment = DefaultAlignment);
+
+    //-------------------------------------------------------------------------
+    //! @brief      IuWFNg𐶐܂. fXgN^͌Ăяo܂.
+    //!
+    //! @return     IuWFNgւ̃|C^ԋp܂.
+    //!             mۂɎsꍇ nullptr ԋp܂.
+    //-------------------------------------------------------------------------
+    template<typename T, typename... Args>
+    T* Alloc(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "T must be trivially destructible.");
+        auto ptr = Alloc(sizeof(T), Alignment<T>());
+        if (ptr == nullptr)
+        { return nullptr; }
+        return new(ptr) T(std::forward<Args>(args)...);
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      z𐶐܂. fXgN^͌Ăяo܂.
+    //!
+    //! @param[in]      count       vf.
+    //! @return     zւ̃|C^ԋp܂.
+    //!             mۂɎsꍇ nullptr ԋp܂.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    T* AllocArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "T must be trivially destructible.");
+        if (count > SIZE_MAX / sizeof(T))
+        { return nullptr; }
+
+        auto ptr = static_cast<T*>(Alloc(sizeof(T) * count, Alignment<T>()));
+        if (ptr == nullptr)
+        { return nullptr; }
+
+        for(size_t i=0; i<count; ++i)
+        { new(ptr + i) T(); }
+        return ptr;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ĂяoXbh̃A[ǐ݈ʒu擾܂.
+    //!             MaxThreadCount 𒴂XbhɊmۂĂԂ́C
+    //!             A[iĂȂXbh̃}[J[͊߂Ɏgp܂.
+    //-------------------------------------------------------------------------
+    Marker GetMarker();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ĂяoXbh̃A[i}[J[̈ʒu܂Ŋ߂܂.
+    //!             A[iɎ܂Ȃ傫Ȋmۂ͊߂܂.
+    //!
+    //! @param[in]      marker      XbhŎ擾}[J[.
+    //-------------------------------------------------------------------------
+    void Rollback(const Marker& marker);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ݂̃t[ԍ擾܂.
+    //-------------------------------------------------------------------------
+    uint64_t GetFrameIndex() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      v擾܂.
+    //-------------------------------------------------------------------------
+    Stats GetStats() const;
 
     //-------------------------------------------------------------------------
     //! @brief      TCY擾܂.
     //!
-    //! @return     TCYԋp܂.
+    //! @return     1t[̃TCYԋp܂.
     //-------------------------------------------------------------------------
     size_t GetSize() const;
 
     //-------------------------------------------------------------------------
     //! @brief      p\ȃTCY擾܂.
     //!
-    //! @return     p\ȃTCYԋp܂.
+    //! @return     ݂̃t[ŗp\ȃTCYԋp܂.
+    //!             ؂oς݂̃A[i̎c͊܂݂܂.
     //-------------------------------------------------------------------------
     size_t GetRestSize() const;
 
 private:
+    static constexpr size_t     CacheLineSize = 64;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Arena structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Arena
+    {
+        uint8_t*    pBegin;         //!< ؂ö̐擪.
+        uint8_t*    pCurrent;       //!< ݈ʒu.
+        uint8_t*    pEnd;           //!< ؂ö̏I[.
+        uint64_t    Frame;          //!< ؂ot[ԍ.
+        uint8_t     Padding[CacheLineSize - sizeof(uint8_t*) * 3 - sizeof(uint64_t)];
+    };
+
     //=========================================================================
     // private variables.
     //=========================================================================
-    size_t      m_Size;         //!< obt@TCYł.
-    uint8_t*    m_pBuffer;      //!< obt@ł.
-    size_t      m_Offset;       //!< obt@擪̃ItZbgł.
+    uint8_t*                m_pBuffer;                      //!< obt@ł.
+    Arena*                  m_pArenas;                      //!< Xbh̃A[ił.
+    uint8_t*                m_pFrames;                      //!< t[̈̐擪ł.
+    size_t                  m_Size;                         //!< 1t[̃obt@TCYł.
+    size_t                  m_ArenaSize;                    //!< A[iTCYł.
+    uint32_t                m_FrameCount;                   //!< t[ł.
+    uint32_t                m_Current;                      //!< ݂̃t[̈̔ԍł.
+    uint64_t                m_FrameIndex;                   //!< ݂̃t[ԍł.
+    uint64_t                m_UsedFrame[MaxFrameCount];     //!< t[̈gpt[ԍł.
+    std::atomic<size_t>     m_Offset;                       //!< t[̈擪̃ItZbgł.
+    std::atomic<uint64_t>   m_FailedCount;                  //!< mۂɎs񐔂ł.
+    size_t                  m_LastFrameBytes;               //!< Õt[̎gpTCYł.
+    size_t                  m_HighWaterMark;                //!< 1t[̍őgpTCYł.
 
     //=========================================================================
     // private methods.
     //=========================================================================
-    /* NOTHING */
+    uint8_t* AllocShared(size_t size, size_t alignment);
+
+    template<typename T>
+    static size_t Alignment()
+    { return (alignof(T) > DefaultAlignment) ? alignof(T) : DefaultAlignment; }
+
+    FrameHeap               (const FrameHeap&) = delete;
+    FrameHeap& operator =   (const FrameHeap&) = delete;
 };
 
-} // namespace asdx
\ No newline at end of file
+} // namespace asdx
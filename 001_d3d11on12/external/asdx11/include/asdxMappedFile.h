@@ -0,0 +1,109 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMappedFile.h
+// Desc : Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MappedFile();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MappedFile();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でメモリにマップします.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @retval true    マップに成功.
+    //! @retval false   マップに失敗.
+    //-------------------------------------------------------------------------
+    bool OpenA(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でメモリにマップします.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @retval true    マップに成功.
+    //! @retval false   マップに失敗.
+    //-------------------------------------------------------------------------
+    bool OpenW(const wchar_t* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      マップを解除し，ファイルを閉じます.
+    //-------------------------------------------------------------------------
+    void Close();
+
+    //-------------------------------------------------------------------------
+    //! @brief      マップされたデータの先頭を取得します.
+    //!
+    //! @return     データの先頭ポインタを返却します. ページ境界にアライメントされています.
+    //-------------------------------------------------------------------------
+    const uint8_t* GetData() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルサイズを取得します.
+    //!
+    //! @return     ファイルサイズを返却します.
+    //-------------------------------------------------------------------------
+    uint64_t GetSize() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      マップ済みかどうかチェックします.
+    //!
+    //! @retval true    マップ済みです.
+    //! @retval false   マップされていません.
+    //-------------------------------------------------------------------------
+    bool IsOpen() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    void*           m_hFile;        //!< ファイルハンドルです.
+    void*           m_hMapping;     //!< ファイルマッピングハンドルです.
+    const uint8_t*  m_pData;        //!< マップされたデータです.
+    uint64_t        m_Size;         //!< ファイルサイズです.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    bool Map();
+
+    MappedFile              (const MappedFile&) = delete;
+    MappedFile& operator =  (const MappedFile&) = delete;
+};
+
+} // namespace asdx
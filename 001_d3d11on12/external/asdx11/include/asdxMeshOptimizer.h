@@ -0,0 +1,150 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMeshOptimizer.h
+// Desc : Mesh Optimizer.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxMath.h>
+#include <asdxResModel.h>
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static constexpr uint32_t DEFAULT_VERTEX_CACHE_SIZE     = 16;   //!< キャッシュシミュレータのデフォルトのキャッシュサイズ.
+static constexpr uint32_t DEFAULT_MESHLET_VERTEX_COUNT  = 64;   //!< メッシュレットのデフォルトの最大頂点数.
+static constexpr uint32_t DEFAULT_MESHLET_PRIM_COUNT    = 126;  //!< メッシュレットのデフォルトの最大プリミティブ数.
+static constexpr uint32_t MAX_MESHLET_VERTEX_COUNT      = 256;  //!< メッシュレットの最大頂点数の上限.
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshStats
+{
+    uint32_t    VertexCount;        //!< 頂点数.
+    uint32_t    TriangleCount;      //!< 三角形数.
+    uint32_t    CacheMissCount;     //!< 頂点キャッシュのミス数.
+    float       ACMR;               //!< 三角形当たりのキャッシュミス数(Average Cache Miss Ratio).
+    float       ATVR;               //!< 頂点当たりのキャッシュミス数(Average Transformed Vertex Ratio).
+    uint64_t    VertexBytes;        //!< 頂点データのサイズ.
+    uint64_t    IndexBytes;         //!< インデックスデータのサイズ.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshOptimizeResult structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshOptimizeResult
+{
+    ResMeshStats    Before;         //!< 最適化前の統計情報.
+    ResMeshStats    After;          //!< 最適化後の統計情報.
+    uint32_t        WeldedCount;    //!< 結合した頂点数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshlet structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshlet
+{
+    uint32_t    VertexOffset;       //!< UniqueVertexIndices の先頭位置.
+    uint32_t    VertexCount;        //!< 頂点数.
+    uint32_t    PrimitiveOffset;    //!< PrimitiveIndices の先頭位置(三角形単位).
+    uint32_t    PrimitiveCount;     //!< プリミティブ数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshletBounds structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshletBounds
+{
+    Vector3     Center;             //!< バウンディングスフィアの中心.
+    float       Radius;             //!< バウンディングスフィアの半径.
+    Vector3     ConeApex;           //!< 法線コーンの頂点.
+    Vector3     ConeAxis;           //!< 法線コーンの軸.
+    float       ConeCutoff;         //!< dot(normalize(ConeApex - eye), ConeAxis) >= ConeCutoff ならば裏向き.
+                                    //!< 法線の向きが揃っていない場合は 1 になります.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshlets structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshlets
+{
+    std::vector<ResMeshlet>         Meshlets;               //!< メッシュレット.
+    std::vector<ResMeshletBounds>   Bounds;                 //!< メッシュレットのカリング情報.
+    std::vector<uint32_t>           UniqueVertexIndices;    //!< メッシュレットから参照する頂点番号.
+    std::vector<uint8_t>            PrimitiveIndices;       //!< メッシュレット内のローカル頂点番号(三角形当たり3つ).
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      FIFO 頂点キャッシュをシミュレートして統計情報を計算します.
+//!
+//! @param[in]      resource        メッシュ.
+//! @param[in]      cacheSize       キャッシュサイズ.
+//! @return     統計情報を返却します.
+//-----------------------------------------------------------------------------
+ResMeshStats CalcMeshStats(const ResMesh& resource, uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+//-----------------------------------------------------------------------------
+//! @brief      全ての頂点属性が一致する頂点を結合します.
+//!
+//! @param[in, out] resource        メッシュ.
+//! @return     結合した頂点数を返却します.
+//-----------------------------------------------------------------------------
+uint32_t WeldVertices(ResMesh& resource);
+
+//-----------------------------------------------------------------------------
+//! @brief      頂点キャッシュの効率が良くなるように三角形を並び替えます.
+//!
+//! @param[in, out] resource        メッシュ.
+//! @retval true    並び替えに成功.
+//! @retval false   並び替えに失敗.
+//-----------------------------------------------------------------------------
+bool OptimizeVertexCache(ResMesh& resource);
+
+//-----------------------------------------------------------------------------
+//! @brief      インデックスから参照される順に頂点を並び替えます.
+//!             参照されない頂点は削除されます.
+//!
+//! @param[in, out] resource        メッシュ.
+//! @retval true    並び替えに成功.
+//! @retval false   並び替えに失敗.
+//-----------------------------------------------------------------------------
+bool OptimizeVertexFetch(ResMesh& resource);
+
+//-----------------------------------------------------------------------------
+//! @brief      頂点の結合, 頂点キャッシュ最適化, 頂点フェッチ最適化を順に行います.
+//!
+//! @param[in, out] resource        メッシュ.
+//! @param[out]     pResult         最適化前後の統計情報の格納先(nullptr可).
+//! @retval true    最適化に成功.
+//! @retval false   最適化に失敗.
+//-----------------------------------------------------------------------------
+bool OptimizeMesh(ResMesh& resource, ResMeshOptimizeResult* pResult = nullptr);
+bool OptimizeMesh(ResModel& resource);
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレットを生成します.
+//!             OptimizeVertexCache() 後のメッシュを渡すと局所性の高いメッシュレットになります.
+//!
+//! @param[in]      resource        メッシュ.
+//! @param[in]      maxVertices     メッシュレットの最大頂点数(MAX_MESHLET_VERTEX_COUNT 以下).
+//! @param[in]      maxPrimitives   メッシュレットの最大プリミティブ数.
+//! @param[out]     result          生成したメッシュレット.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//-----------------------------------------------------------------------------
+bool BuildMeshlets(
+    const ResMesh&  resource,
+    uint32_t        maxVertices,
+    uint32_t        maxPrimitives,
+    ResMeshlets&    result);
+
+} // namespace asdx
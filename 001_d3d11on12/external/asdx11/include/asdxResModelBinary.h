@@ -0,0 +1,245 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxResModelBinary.h
+// Desc : Model Resource Binary Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxResModel.h>
+#include <asdxMappedFile.h>
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static constexpr uint32_t RES_MODEL_BINARY_MAGIC     = 0x4c444d41;   //!< 'AMDL'
+static constexpr uint32_t RES_MODEL_BINARY_VERSION   = 1;            //!< フォーマットバージョン.
+static constexpr uint32_t RES_MODEL_BINARY_ALIGNMENT = 16;           //!< ストリームのアライメント.
+
+///////////////////////////////////////////////////////////////////////////////
+// RES_MODEL_BINARY_FLAG enum
+///////////////////////////////////////////////////////////////////////////////
+enum RES_MODEL_BINARY_FLAG
+{
+    RES_MODEL_BINARY_FLAG_NONE      = 0,
+    RES_MODEL_BINARY_FLAG_QUANTIZED = 0x1 << 0,     //!< 頂点属性を圧縮形式で格納します.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// RES_MESH_STREAM enum
+///////////////////////////////////////////////////////////////////////////////
+enum RES_MESH_STREAM
+{
+    RES_MESH_STREAM_POSITION = 0,   //!< Vector3.
+    RES_MESH_STREAM_NORMAL,         //!< Vector3 (非圧縮時のみ).
+    RES_MESH_STREAM_TANGENT,        //!< Vector3 (非圧縮時, または圧縮時に法線が無い場合).
+    RES_MESH_STREAM_BITANGENT,      //!< Vector3 (非圧縮時, または圧縮時に法線が無い場合).
+    RES_MESH_STREAM_TBN,            //!< EncodeTBN() の結果 (圧縮時のみ).
+    RES_MESH_STREAM_COLOR,          //!< Vector4, 圧縮時は EncodeColor() の結果.
+    RES_MESH_STREAM_TEXCOORD0,      //!< Vector2, 圧縮時は Half2.
+    RES_MESH_STREAM_TEXCOORD1,      //!< Vector2, 圧縮時は Half2.
+    RES_MESH_STREAM_TEXCOORD2,      //!< Vector2, 圧縮時は Half2.
+    RES_MESH_STREAM_TEXCOORD3,      //!< Vector2, 圧縮時は Half2.
+    RES_MESH_STREAM_BONE_INDEX,     //!< ResBoneIndex.
+    RES_MESH_STREAM_BONE_WEIGHT,    //!< Vector4, 圧縮時は Half4.
+    RES_MESH_STREAM_INDEX,          //!< uint32_t.
+    RES_MESH_STREAM_COUNT,
+};
+static_assert(RES_MESH_STREAM_TEXCOORD3 - RES_MESH_STREAM_TEXCOORD0 + 1 == MAX_LAYER_COUNT, "Invalid TexCoord Stream Count");
+
+///////////////////////////////////////////////////////////////////////////////
+// ResModelBinaryHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResModelBinaryHeader
+{
+    uint32_t    Magic;          //!< マジック.
+    uint32_t    Version;        //!< バージョン.
+    uint32_t    Flags;          //!< RES_MODEL_BINARY_FLAG の組み合わせ.
+    uint32_t    MeshCount;      //!< メッシュ数.
+    uint64_t    FileSize;       //!< ファイルサイズ.
+    uint64_t    Hash;           //!< ヘッダ以降のデータの CalcHash64() の結果.
+};
+static_assert(sizeof(ResModelBinaryHeader) == 32, "ResModelBinaryHeader Invalid Data Size");
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshBinaryDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshBinaryDesc
+{
+    uint64_t    MeshName;                           //!< メッシュ名へのオフセット.
+    uint64_t    MaterialName;                       //!< マテリアル名へのオフセット.
+    uint32_t    VertexCount;                        //!< 頂点数.
+    uint32_t    IndexCount;                         //!< インデックス数.
+    uint64_t    Streams[RES_MESH_STREAM_COUNT];     //!< ストリームへのオフセット(存在しない場合は0).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ResMeshView structure
+///////////////////////////////////////////////////////////////////////////////
+struct ResMeshView
+{
+    const char*             MeshName;
+    const char*             MaterialName;
+    uint32_t                VertexCount;
+    uint32_t                IndexCount;
+    bool                    Quantized;
+
+    const Vector3*          Positions;
+    const ResBoneIndex*     BoneIndices;
+    const uint32_t*         Indices;
+
+    // 非圧縮時のみ有効. ただし Tangents, Bitangents は圧縮時でも法線が無ければ有効.
+    const Vector3*          Normals;
+    const Vector3*          Tangents;
+    const Vector3*          Bitangents;
+    const Vector4*          Colors;
+    const Vector2*          TexCoords[MAX_LAYER_COUNT];
+    const Vector4*          BoneWeights;
+
+    // 圧縮時のみ有効.
+    const uint32_t*         EncodedTBNs;
+    const uint32_t*         EncodedColors;
+    const Half2*            EncodedTexCoords[MAX_LAYER_COUNT];
+    const Half4*            EncodedBoneWeights;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ResModelBinary class
+///////////////////////////////////////////////////////////////////////////////
+class ResModelBinary
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    ResModelBinary();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~ResModelBinary();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルをメモリマップして読み込みます.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      verifyHash  ハッシュ値を検証する場合は true.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //-------------------------------------------------------------------------
+    bool LoadFromFileA(const char* path, bool verifyHash = true);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルをメモリマップして読み込みます.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @param[in]      verifyHash  ハッシュ値を検証する場合は true.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //-------------------------------------------------------------------------
+    bool LoadFromFileW(const wchar_t* path, bool verifyHash = true);
+
+    //-------------------------------------------------------------------------
+    //! @brief      メモリ上のデータを参照します.
+    //!             データはコピーされないため，破棄するまで有効である必要があります.
+    //!
+    //! @param[in]      pBuffer     バッファ(16バイトアライメント).
+    //! @param[in]      bufferSize  バッファサイズ.
+    //! @param[in]      verifyHash  ハッシュ値を検証する場合は true.
+    //! @retval true    読み込みに成功.
+    //! @retval false   読み込みに失敗.
+    //-------------------------------------------------------------------------
+    bool LoadFromMemory(const uint8_t* pBuffer, uint64_t bufferSize, bool verifyHash = true);
+
+    //-------------------------------------------------------------------------
+    //! @brief      解放処理を行います.
+    //-------------------------------------------------------------------------
+    void Release();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュ数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetMeshCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      圧縮形式かどうかチェックします.
+    //-------------------------------------------------------------------------
+    bool IsQuantized() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュのビューを取得します.
+    //!
+    //! @param[in]      index       メッシュ番号.
+    //! @return     データを直接参照するビューを返却します.
+    //-------------------------------------------------------------------------
+    ResMeshView GetMesh(uint32_t index) const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    MappedFile                  m_File;     //!< マップドファイル.
+    const uint8_t*              m_pData;    //!< データ先頭.
+    const ResModelBinaryHeader* m_pHeader;  //!< ヘッダ.
+    const ResMeshBinaryDesc*    m_pMeshes;  //!< メッシュテーブル.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    bool Validate(const uint8_t* pBuffer, uint64_t bufferSize, bool verifyHash);
+
+    ResModelBinary              (const ResModelBinary&) = delete;
+    ResModelBinary& operator =  (const ResModelBinary&) = delete;
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      モデルリソースをバイナリ形式に変換します.
+//!
+//! @param[in]      model       モデルリソース.
+//! @param[in]      flags       RES_MODEL_BINARY_FLAG の組み合わせ.
+//! @param[out]     result      変換結果.
+//! @retval true    変換に成功.
+//! @retval false   モデルリソースが不正.
+//-----------------------------------------------------------------------------
+bool WriteResModelBinary(const ResModel& model, uint32_t flags, std::vector<uint8_t>& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      モデルリソースをバイナリ形式でファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SaveResModelBinaryA(const char* path, const ResModel& model, uint32_t flags);
+
+//-----------------------------------------------------------------------------
+//! @brief      モデルリソースをバイナリ形式でファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SaveResModelBinaryW(const wchar_t* path, const ResModel& model, uint32_t flags);
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュのビューを展開してメッシュリソースを生成します.
+//!
+//! @param[in]      view        メッシュのビュー.
+//! @param[out]     result      展開結果.
+//-----------------------------------------------------------------------------
+void Expand(const ResMeshView& view, ResMesh& result);
+
+} // namespace asdx
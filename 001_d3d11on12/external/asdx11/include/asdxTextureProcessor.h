@@ -0,0 +1,94 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTextureProcessor.h
+// Desc : Texture Processor Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <asdxResTexture.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MIPMAP_FILTER enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum MIPMAP_FILTER
+{
+    MIPMAP_FILTER_BOX = 0,      //!< ボックスフィルタ(縮小範囲の面積平均)です.
+    MIPMAP_FILTER_KAISER,       //!< カイザー窓付き sinc フィルタです. ボックスよりもシャープになります.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MIPMAP_FLAG enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum MIPMAP_FLAG
+{
+    MIPMAP_FLAG_WRAP            = 0x1 << 0,     //!< 端をラップして参照します(指定しない場合はクランプ).
+    MIPMAP_FLAG_ALPHA_WEIGHTED  = 0x1 << 1,     //!< アルファで重み付けしてカラーを縮小します(透明部分の色が滲まなくなります).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// TextureProcessDesc structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct TextureProcessDesc
+{
+    bool            GenerateMipMaps;    //!< ミップマップを生成する場合は true.
+    MIPMAP_FILTER   Filter;             //!< ミップマップのフィルタ.
+    uint32_t        MipFlags;           //!< MIPMAP_FLAG の組み合わせ.
+    uint32_t        MipLevels;          //!< 生成するミップレベル数(0の場合は 1x1 まで).
+    uint32_t        Format;             //!< 圧縮フォーマット(DXGI_FORMAT_UNKNOWN の場合は圧縮しない).
+};
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ミップマップを生成します.
+//!             R8G8B8A8, B8G8R8A8 (UNORM/SRGB), R32G32B32A32_FLOAT に対応しています.
+//!             SRGB フォーマットはリニアに変換してからフィルタを掛けます.
+//!             色データを sRGB として扱う場合は事前に MakeSRGB() でフォーマットを変更してください.
+//!
+//! @param[in, out] resource        テクスチャリソース. 既存のミップマップは破棄されます.
+//! @param[in]      filter          フィルタ.
+//! @param[in]      flags           MIPMAP_FLAG の組み合わせ.
+//! @param[in]      mipLevels       生成するミップレベル数(0の場合は 1x1 まで).
+//! @param[in]      pPool           行単位で並列処理する場合のスレッドプール(nullptr可).
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//-------------------------------------------------------------------------------------------------
+bool GenerateMipMaps(
+    ResTexture&     resource,
+    MIPMAP_FILTER   filter,
+    uint32_t        flags     = 0,
+    uint32_t        mipLevels = 0,
+    ThreadPool*     pPool     = nullptr);
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ブロック圧縮します.
+//!             BC1, BC3, BC4, BC5, BC7 (UNORM/SRGB) と BC6H_UF16 に対応しています.
+//!             入力は GenerateMipMaps() と同じフォーマットです.
+//!             入力が SRGB の場合は出力も SRGB フォーマットになります.
+//!
+//! @param[in, out] resource        テクスチャリソース.
+//! @param[in]      format          圧縮フォーマット.
+//! @param[in]      pPool           タイル単位で並列処理する場合のスレッドプール(nullptr可).
+//! @retval true    圧縮に成功.
+//! @retval false   圧縮に失敗.
+//-------------------------------------------------------------------------------------------------
+bool CompressTexture(ResTexture& resource, uint32_t format, ThreadPool* pPool = nullptr);
+
+//-------------------------------------------------------------------------------------------------
+//! @brief      ミップマップ生成とブロック圧縮を順に行います.
+//!             読み込み直後のテクスチャに適用するか, 処理後に ResTexture::SaveToDDSFileA() で保存します.
+//!
+//! @param[in, out] resource        テクスチャリソース.
+//! @param[in]      desc            構成設定.
+//! @param[in]      pPool           スレッドプール(nullptr可).
+//! @retval true    処理に成功.
+//! @retval false   処理に失敗.
+//-------------------------------------------------------------------------------------------------
+bool ProcessTexture(ResTexture& resource, const TextureProcessDesc& desc, ThreadPool* pPool = nullptr);
+
+} // namespace asdx
@@ -0,0 +1,445 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxAsyncLoader.cpp
+// Desc : Asynchronous Resource Loader.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <asdxAsyncLoader.h>
+#include <asdxResModelBinary.h>
+#include <asdxMisc.h>
+#include <asdxLogger.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncRequest class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+AsyncRequest::AsyncRequest(const std::wstring& path, const AsyncCallback& callback)
+: m_Count       (0)
+, m_State       (ASYNC_LOAD_STATE_PENDING)
+, m_Done        (false)
+, m_Path        (path)
+, m_Callback    (callback)
+, m_pPool       (nullptr)
+, m_pDecodePool (nullptr)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+AsyncRequest::~AsyncRequest()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      参照カウントを1つ増やします.
+//-----------------------------------------------------------------------------
+void AsyncRequest::AddRef()
+{ m_Count++; }
+
+//-----------------------------------------------------------------------------
+//      参照カウントを1つ減らします.
+//-----------------------------------------------------------------------------
+void AsyncRequest::Release()
+{
+    if (--m_Count == 0)
+    { delete this; }
+}
+
+//-----------------------------------------------------------------------------
+//      参照カウントを取得します.
+//-----------------------------------------------------------------------------
+uint32_t AsyncRequest::GetCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      読み込み状態を取得します.
+//-----------------------------------------------------------------------------
+ASYNC_LOAD_STATE AsyncRequest::GetState() const
+{ return ASYNC_LOAD_STATE(m_State.load()); }
+
+//-----------------------------------------------------------------------------
+//      処理が終了したかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool AsyncRequest::IsDone() const
+{ return m_Done; }
+
+//-----------------------------------------------------------------------------
+//      読み込みをキャンセルします.
+//-----------------------------------------------------------------------------
+bool AsyncRequest::Cancel()
+{
+    uint32_t expected = ASYNC_LOAD_STATE_PENDING;
+    if (!m_State.compare_exchange_strong(expected, ASYNC_LOAD_STATE_CANCELED))
+    { return false; }
+
+    // キューに残っているジョブは実行時に何もせず終了する.
+    Finish();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      処理が終了するまで待機します.
+//-----------------------------------------------------------------------------
+void AsyncRequest::Wait()
+{
+    if (m_Done || m_pPool == nullptr)
+    { return; }
+
+    // まだ開始されていなければ呼び出しスレッドで読み込む.
+    Execute();
+
+    // 他のスレッドで読み込み中の場合は完了を待つ.
+    // 読み込み中のスレッドは必ず進行するので，無関係なジョブは実行しない.
+    m_pPool->Block([this]() { return m_Done.load(); });
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルパスを取得します.
+//-----------------------------------------------------------------------------
+const std::wstring& AsyncRequest::GetPath() const
+{ return m_Path; }
+
+//-----------------------------------------------------------------------------
+//      読み込み処理を実行します.
+//-----------------------------------------------------------------------------
+void AsyncRequest::Execute()
+{
+    uint32_t expected = ASYNC_LOAD_STATE_PENDING;
+    if (!m_State.compare_exchange_strong(expected, ASYNC_LOAD_STATE_LOADING))
+    { return; }
+
+    auto ret = OnLoad(m_pDecodePool);
+    if (!ret)
+    { ELOGW("Error : Async Load Failed. path = %ls", m_Path.c_str()); }
+
+    m_State = (ret) ? ASYNC_LOAD_STATE_COMPLETED : ASYNC_LOAD_STATE_FAILED;
+    Finish();
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void AsyncRequest::Finish()
+{
+    if (m_Callback)
+    {
+        m_Callback(this);
+        m_Callback = nullptr;
+    }
+
+    // 完了を通知すると待機側が要求を解放することがあるので，先にプールを取得しておく.
+    auto pPool = m_pPool;
+    m_Done = true;
+
+    // 呼び出しスレッドで実行した場合やキャンセルはジョブの完了を経由しないので，
+    // Wait() で待機中のスレッドを明示的に起こす.
+    if (pPool != nullptr)
+    { pPool->Notify(); }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncTexture class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+AsyncTexture::AsyncTexture(const std::wstring& path, const AsyncCallback& callback)
+: AsyncRequest(path, callback)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+AsyncTexture::~AsyncTexture()
+{ m_Resource.Release(); }
+
+//-----------------------------------------------------------------------------
+//      テクスチャリソースを取得します.
+//-----------------------------------------------------------------------------
+ResTexture& AsyncTexture::GetResource()
+{ return m_Resource; }
+
+//-----------------------------------------------------------------------------
+//      読み込み処理を行います.
+//-----------------------------------------------------------------------------
+bool AsyncTexture::OnLoad(ThreadPool* pPool)
+{ return m_Resource.LoadFromFileW(GetPath().c_str(), pPool); }
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncModel class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+AsyncModel::AsyncModel(const std::wstring& path, const AsyncCallback& callback)
+: AsyncRequest(path, callback)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+AsyncModel::~AsyncModel()
+{ Dispose(m_Resource); }
+
+//-----------------------------------------------------------------------------
+//      モデルリソースを取得します.
+//-----------------------------------------------------------------------------
+ResModel& AsyncModel::GetResource()
+{ return m_Resource; }
+
+//-----------------------------------------------------------------------------
+//      読み込み処理を行います.
+//-----------------------------------------------------------------------------
+bool AsyncModel::OnLoad(ThreadPool* pPool)
+{
+    ResModelBinary binary;
+    if (!binary.LoadFromFileW(GetPath().c_str()))
+    { return false; }
+
+    auto count = binary.GetMeshCount();
+    m_Resource.Meshes.resize(count);
+
+    auto expand = [&](uint32_t begin, uint32_t end)
+    {
+        for(auto i=begin; i<end; ++i)
+        { Expand(binary.GetMesh(i), m_Resource.Meshes[i]); }
+    };
+
+    // メッシュ単位で展開を分割する.
+    if (pPool != nullptr)
+    { pPool->ParallelFor(count, 1, expand); }
+    else
+    { expand(0, count); }
+
+    return true;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AsyncLoader class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+AsyncLoader::AsyncLoader()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+AsyncLoader::~AsyncLoader()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool AsyncLoader::Init(const Desc& desc)
+{
+    if (!m_Pool.Init(desc.ThreadCount))
+    {
+        ELOG("Error : ThreadPool::Init() Failed.");
+        return false;
+    }
+
+    m_SplitDecode = desc.SplitDecode;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void AsyncLoader::Term()
+{ m_Pool.Term(); }
+
+//-----------------------------------------------------------------------------
+//      テクスチャの読み込みを要求します.
+//-----------------------------------------------------------------------------
+RefPtr<AsyncTexture> AsyncLoader::LoadTextureA
+(
+    const char*             path,
+    JOB_PRIORITY            priority,
+    const AsyncCallback&    callback
+)
+{
+    auto pathW = ToStringW(path);
+    return LoadTextureW(pathW.c_str(), priority, callback);
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャの読み込みを要求します.
+//-----------------------------------------------------------------------------
+RefPtr<AsyncTexture> AsyncLoader::LoadTextureW
+(
+    const wchar_t*          path,
+    JOB_PRIORITY            priority,
+    const AsyncCallback&    callback
+)
+{
+    if (path == nullptr)
+    {
+        ELOG("Error : Invalid Argument.");
+        return RefPtr<AsyncTexture>();
+    }
+
+    auto pRequest = new (std::nothrow) AsyncTexture(path, callback);
+    if (pRequest == nullptr)
+    {
+        ELOG("Error : Out of Memory.");
+        return RefPtr<AsyncTexture>();
+    }
+
+    RefPtr<AsyncTexture> result(pRequest);
+    Push(pRequest, priority);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャの一括読み込みを要求します.
+//-----------------------------------------------------------------------------
+void AsyncLoader::LoadTexturesA
+(
+    const char* const*                  paths,
+    uint32_t                            count,
+    std::vector<RefPtr<AsyncTexture>>&  results,
+    JOB_PRIORITY                        priority,
+    const AsyncCallback&                callback
+)
+{
+    results.resize(count);
+    for(auto i=0u; i<count; ++i)
+    { results[i] = LoadTextureA(paths[i], priority, callback); }
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャの一括読み込みを要求します.
+//-----------------------------------------------------------------------------
+void AsyncLoader::LoadTexturesW
+(
+    const wchar_t* const*               paths,
+    uint32_t                            count,
+    std::vector<RefPtr<AsyncTexture>>&  results,
+    JOB_PRIORITY                        priority,
+    const AsyncCallback&                callback
+)
+{
+    results.resize(count);
+    for(auto i=0u; i<count; ++i)
+    { results[i] = LoadTextureW(paths[i], priority, callback); }
+}
+
+//-----------------------------------------------------------------------------
+//      モデルの読み込みを要求します.
+//-----------------------------------------------------------------------------
+RefPtr<AsyncModel> AsyncLoader::LoadModelA
+(
+    const char*             path,
+    JOB_PRIORITY            priority,
+    const AsyncCallback&    callback
+)
+{
+    auto pathW = ToStringW(path);
+    return LoadModelW(pathW.c_str(), priority, callback);
+}
+
+//-----------------------------------------------------------------------------
+//      モデルの読み込みを要求します.
+//-----------------------------------------------------------------------------
+RefPtr<AsyncModel> AsyncLoader::LoadModelW
+(
+    const wchar_t*          path,
+    JOB_PRIORITY            priority,
+    const AsyncCallback&    callback
+)
+{
+    if (path == nullptr)
+    {
+        ELOG("Error : Invalid Argument.");
+        return RefPtr<AsyncModel>();
+    }
+
+    auto pRequest = new (std::nothrow) AsyncModel(path, callback);
+    if (pRequest == nullptr)
+    {
+        ELOG("Error : Out of Memory.");
+        return RefPtr<AsyncModel>();
+    }
+
+    RefPtr<AsyncModel> result(pRequest);
+    Push(pRequest, priority);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルの一括読み込みを要求します.
+//-----------------------------------------------------------------------------
+void AsyncLoader::LoadModelsA
+(
+    const char* const*                  paths,
+    uint32_t                            count,
+    std::vector<RefPtr<AsyncModel>>&    results,
+    JOB_PRIORITY                        priority,
+    const AsyncCallback&                callback
+)
+{
+    results.resize(count);
+    for(auto i=0u; i<count; ++i)
+    { results[i] = LoadModelA(paths[i], priority, callback); }
+}
+
+//-----------------------------------------------------------------------------
+//      モデルの一括読み込みを要求します.
+//-----------------------------------------------------------------------------
+void AsyncLoader::LoadModelsW
+(
+    const wchar_t* const*               paths,
+    uint32_t                            count,
+    std::vector<RefPtr<AsyncModel>>&    results,
+    JOB_PRIORITY                        priority,
+    const AsyncCallback&                callback
+)
+{
+    results.resize(count);
+    for(auto i=0u; i<count; ++i)
+    { results[i] = LoadModelW(paths[i], priority, callback); }
+}
+
+//-----------------------------------------------------------------------------
+//      全ての読み込みが終了するまで待機します.
+//-----------------------------------------------------------------------------
+void AsyncLoader::WaitAll()
+{ m_Pool.WaitIdle(); }
+
+//-----------------------------------------------------------------------------
+//      スレッドプールを取得します.
+//-----------------------------------------------------------------------------
+ThreadPool& AsyncLoader::GetThreadPool()
+{ return m_Pool; }
+
+//-----------------------------------------------------------------------------
+//      読み込み要求をスレッドプールに投入します.
+//-----------------------------------------------------------------------------
+void AsyncLoader::Push(AsyncRequest* pRequest, JOB_PRIORITY priority)
+{
+    pRequest->m_pPool       = &m_Pool;
+    pRequest->m_pDecodePool = (m_SplitDecode) ? &m_Pool : nullptr;
+
+    // ジョブが完了するまで要求を保持する.
+    RefPtr<AsyncRequest> request(pRequest);
+
+    m_Pool.Push([request]() { request->Execute(); }, priority);
+}
+
+} // namespace asdx
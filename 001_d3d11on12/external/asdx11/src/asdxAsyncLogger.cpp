@@ -0,0 +1,1577 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxAsyncLogger.cpp
+// Desc : Asynchronous Logger Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstring>
+#include <cwchar>
+#include <ctime>
+#include <chrono>
+#include <vector>
+#include <new>
+#include <Windows.h>
+#include <asdxAsyncLogger.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const size_t     RECORD_ALIGNMENT        = 16;
+static const uint32_t   DEFAULT_FLUSH_INTERVAL  = 10;
+static const uint32_t   BINARY_LOG_MAGIC        = 0x474f4c41;   // 'ALOG'
+static const uint32_t   BINARY_LOG_VERSION      = 1;
+static const size_t     MAX_ARG_LENGTH          = 64 * 1024;    // 1つの変換指定で出力する最大文字数.
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RECORD_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum RECORD_TYPE
+{
+    RECORD_TYPE_PAD = 0,        // リングバッファ終端の詰め物.
+    RECORD_TYPE_TEXT_A,         // char のフォーマット.
+    RECORD_TYPE_TEXT_W,         // wchar_t のフォーマット.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ARG_TYPE enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum ARG_TYPE
+{
+    ARG_TYPE_NONE = 0,          // 引数を取らない("%%").
+    ARG_TYPE_INVALID,           // 解釈できない変換指定.
+    ARG_TYPE_INT32,
+    ARG_TYPE_INT64,
+    ARG_TYPE_DOUBLE,
+    ARG_TYPE_LONG_DOUBLE,
+    ARG_TYPE_POINTER,
+    ARG_TYPE_COUNT,             // "%n" は書き込まずに読み飛ばす.
+    ARG_TYPE_STRING_A,
+    ARG_TYPE_STRING_W,
+    ARG_TYPE_STRING_NULL,       // nullptr の文字列.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BINARY_CHUNK enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum BINARY_CHUNK
+{
+    BINARY_CHUNK_FORMAT = 1,    // フォーマット文字列の定義.
+    BINARY_CHUNK_RECORD,        // フォーマット番号と引数.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct RecordHeader
+{
+    std::atomic<uint64_t>   Commit;         // 書き込み完了時に (位置 + 1) が設定される.
+    uint32_t                Size;           // ヘッダを含むレコードサイズ.
+    uint8_t                 Type;           // RECORD_TYPE.
+    uint8_t                 Level;          // LogLevel.
+    uint16_t                Reserved;
+    uint64_t                Time;           // UNIX時間(ナノ秒).
+    uint32_t                ThreadId;       // スレッド番号.
+    uint32_t                PayloadSize;    // ペイロードサイズ.
+};
+static_assert(sizeof(RecordHeader) == 32, "RecordHeader Invalid Data Size");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "Atomic Invalid Data Size");
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BinaryHeader structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BinaryHeader
+{
+    uint32_t    Magic;
+    uint32_t    Version;
+    uint32_t    WideCharSize;   // 出力した環境の sizeof(wchar_t).
+    uint32_t    Reserved;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BinaryRecord structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma pack(push, 1)
+struct BinaryRecord
+{
+    uint8_t     Chunk;
+    uint32_t    FormatId;
+    uint8_t     Level;
+    uint32_t    ThreadId;
+    uint64_t    Time;
+    uint32_t    ArgSize;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BinaryFormat structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct BinaryFormat
+{
+    uint8_t     Chunk;
+    uint32_t    FormatId;
+    uint8_t     Type;
+    uint32_t    Size;
+};
+#pragma pack(pop)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FormatSpec structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FormatSpec
+{
+    size_t      End;            // 変換指定の終端位置.
+    uint32_t    StarCount;      // '*' で指定された幅と精度の数.
+    ARG_TYPE    Type;           // 引数の型.
+};
+
+//-------------------------------------------------------------------------------------------------
+// Global Variables
+//-------------------------------------------------------------------------------------------------
+std::atomic<uint32_t>   g_ThreadCounter(0);
+thread_local uint32_t   t_ThreadId = 0;
+
+//-------------------------------------------------------------------------------------------------
+//      ログ出力用のスレッド番号を取得します.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t GetLogThreadId()
+{
+    if (t_ThreadId == 0)
+    { t_ThreadId = g_ThreadCounter.fetch_add(1, std::memory_order_relaxed) + 1; }
+    return t_ThreadId;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      現在時刻を取得します.
+//-------------------------------------------------------------------------------------------------
+inline uint64_t GetLogTime()
+{
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+//-------------------------------------------------------------------------------------------------
+//      アライメントを揃えます.
+//-------------------------------------------------------------------------------------------------
+inline size_t AlignUp(size_t value, size_t alignment)
+{ return (value + alignment - 1) & ~(alignment - 1); }
+
+//-------------------------------------------------------------------------------------------------
+//      文字列引数がワイド文字列かどうか判定します.
+//-------------------------------------------------------------------------------------------------
+template<typename Char>
+bool IsWideStringArg(Char conversion, Char length)
+{
+    if (length == 'l' || length == 'w')
+    { return true; }
+    if (length == 'h')
+    { return false; }
+
+#if defined(_MSC_VER) && !defined(_CRT_STDIO_ISO_WIDE_SPECIFIERS)
+    // MSVC の既定では %s は呼び出し元と同じ文字型, %S は逆の文字型.
+    auto wide = (sizeof(Char) == sizeof(wchar_t));
+    return (conversion == 's') ? wide : !wide;
+#else
+    return (conversion != 's');
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      変換指定を解析します. format[pos] は '%' である必要があります.
+//-------------------------------------------------------------------------------------------------
+template<typename Char>
+FormatSpec ParseSpec(const Char* format, size_t pos)
+{
+    FormatSpec spec = {};
+    spec.Type = ARG_TYPE_INVALID;
+
+    auto i = pos + 1;
+    if (format[i] == '%')
+    {
+        spec.End  = i + 1;
+        spec.Type = ARG_TYPE_NONE;
+        return spec;
+    }
+
+    // フラグ.
+    while(format[i] == '-' || format[i] == '+' || format[i] == ' ' || format[i] == '#' || format[i] == '0' || format[i] == '\'')
+    { i++; }
+
+    // 幅.
+    if (format[i] == '*')
+    { spec.StarCount++; i++; }
+    else
+    {
+        while('0' <= format[i] && format[i] <= '9')
+        { i++; }
+    }
+
+    // 精度.
+    if (format[i] == '.')
+    {
+        i++;
+        if (format[i] == '*')
+        { spec.StarCount++; i++; }
+        else
+        {
+            while('0' <= format[i] && format[i] <= '9')
+            { i++; }
+        }
+    }
+
+    // 長さ修飾子.
+    auto intSize = sizeof(int);
+    Char length  = 0;
+    if (format[i] == 'h')
+    {
+        length = 'h'; i++;
+        if (format[i] == 'h')
+        { i++; }
+    }
+    else if (format[i] == 'l')
+    {
+        length = 'l'; intSize = sizeof(long); i++;
+        if (format[i] == 'l')
+        { intSize = sizeof(long long); i++; }
+    }
+    else if (format[i] == 'j' || format[i] == 'q')
+    { length = format[i]; intSize = sizeof(long long); i++; }
+    else if (format[i] == 'z' || format[i] == 't')
+    { length = format[i]; intSize = sizeof(size_t); i++; }
+    else if (format[i] == 'L' || format[i] == 'w')
+    { length = format[i]; i++; }
+    else if (format[i] == 'I')
+    {
+        length = 'I'; i++;
+        if (format[i] == '6' && format[i + 1] == '4')
+        { intSize = sizeof(int64_t); i += 2; }
+        else if (format[i] == '3' && format[i + 1] == '2')
+        { intSize = sizeof(int32_t); i += 2; }
+        else
+        { intSize = sizeof(size_t); }
+    }
+
+    auto conversion = format[i];
+    switch(conversion)
+    {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        spec.Type = (intSize == sizeof(int64_t)) ? ARG_TYPE_INT64 : ARG_TYPE_INT32;
+        break;
+
+    case 'c': case 'C':
+        spec.Type = ARG_TYPE_INT32;
+        break;
+
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        spec.Type = (length == 'L') ? ARG_TYPE_LONG_DOUBLE : ARG_TYPE_DOUBLE;
+        break;
+
+    case 'p':
+        spec.Type = ARG_TYPE_POINTER;
+        break;
+
+    case 'n':
+        spec.Type = ARG_TYPE_COUNT;
+        break;
+
+    case 's': case 'S':
+        spec.Type = IsWideStringArg(conversion, length) ? ARG_TYPE_STRING_W : ARG_TYPE_STRING_A;
+        break;
+
+    default:
+        // 終端や未知の変換指定はそのまま出力する.
+        spec.End = pos + 1;
+        return spec;
+    }
+
+    spec.End = i + 1;
+    return spec;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PayloadWriter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PayloadWriter
+{
+public:
+    PayloadWriter(uint8_t* pBuffer, size_t capacity)
+    : m_pBuffer (pBuffer)
+    , m_Capacity(capacity)
+    , m_Size    (0)
+    { /* DO_NOTHING */ }
+
+    bool Write(const void* pData, size_t size)
+    {
+        if (size > m_Capacity - m_Size)
+        { return false; }
+
+        memcpy(m_pBuffer + m_Size, pData, size);
+        m_Size += size;
+        return true;
+    }
+
+    template<typename T>
+    bool WriteArg(ARG_TYPE type, const T& value)
+    {
+        if (sizeof(uint8_t) + sizeof(T) > m_Capacity - m_Size)
+        { return false; }
+
+        auto tag = uint8_t(type);
+        Write(&tag, sizeof(tag));
+        Write(&value, sizeof(value));
+        return true;
+    }
+
+    template<typename Char>
+    bool WriteString(ARG_TYPE type, const Char* value)
+    {
+        auto overhead = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(Char);
+        if (overhead > m_Capacity - m_Size)
+        { return false; }
+
+        // 収まらない分は切り詰める.
+        auto maxLength = (m_Capacity - m_Size - overhead) / sizeof(Char);
+        size_t length = 0;
+        while(length < maxLength && value[length] != 0)
+        { length++; }
+
+        auto tag = uint8_t(type);
+        auto len = uint32_t(length);
+        Char terminator = 0;
+        Write(&tag, sizeof(tag));
+        Write(&len, sizeof(len));
+        Write(value, sizeof(Char) * length);
+        Write(&terminator, sizeof(terminator));
+        return true;
+    }
+
+    size_t GetSize() const
+    { return m_Size; }
+
+private:
+    uint8_t*    m_pBuffer;
+    size_t      m_Capacity;
+    size_t      m_Size;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PayloadReader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PayloadReader
+{
+public:
+    PayloadReader(const uint8_t* pBuffer, size_t size)
+    : m_pBuffer (pBuffer)
+    , m_Size    (size)
+    , m_Offset  (0)
+    { /* DO_NOTHING */ }
+
+    bool Read(void* pData, size_t size)
+    {
+        if (size > m_Size - m_Offset)
+        { return false; }
+
+        memcpy(pData, m_pBuffer + m_Offset, size);
+        m_Offset += size;
+        return true;
+    }
+
+    template<typename Char>
+    bool ReadString(std::basic_string<Char>& value)
+    {
+        uint32_t length = 0;
+        if (!Read(&length, sizeof(length)))
+        { return false; }
+
+        if (size_t(length + 1) * sizeof(Char) > m_Size - m_Offset)
+        { return false; }
+
+        // ワイド文字列はアライメントが揃っていないので複製する.
+        value.resize(length);
+        if (length > 0)
+        { memcpy(&value[0], m_pBuffer + m_Offset, sizeof(Char) * length); }
+        m_Offset += sizeof(Char) * (length + 1);
+        return true;
+    }
+
+    const uint8_t* GetCurrent() const
+    { return m_pBuffer + m_Offset; }
+
+    size_t GetRestSize() const
+    { return m_Size - m_Offset; }
+
+private:
+    const uint8_t*  m_pBuffer;
+    size_t          m_Size;
+    size_t          m_Offset;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ScopedCounter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ScopedCounter
+{
+public:
+    explicit ScopedCounter(std::atomic<uint32_t>& counter)
+    : m_Counter(counter)
+    { m_Counter.fetch_add(1); }
+
+    ~ScopedCounter()
+    { m_Counter.fetch_sub(1, std::memory_order_release); }
+
+private:
+    std::atomic<uint32_t>&  m_Counter;
+
+    ScopedCounter               (const ScopedCounter&) = delete;
+    ScopedCounter& operator =   (const ScopedCounter&) = delete;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      フォーマットと引数をペイロードに記録します.
+//-------------------------------------------------------------------------------------------------
+template<typename Char>
+size_t EncodePayload(const Char* format, va_list args, uint8_t* pBuffer, size_t capacity)
+{
+    PayloadWriter writer(pBuffer, capacity);
+
+    // フォーマット文字列自体も複製しておく(呼び出し元の寿命に依存しない).
+    auto length = std::char_traits<Char>::length(format);
+    auto maxLength = (capacity / 2) / sizeof(Char);
+    if (length > maxLength)
+    { length = maxLength; }
+
+    auto len = uint32_t(length);
+    Char terminator = 0;
+    writer.Write(&len, sizeof(len));
+    writer.Write(format, sizeof(Char) * length);
+    writer.Write(&terminator, sizeof(terminator));
+
+    for(size_t i=0; i<length; )
+    {
+        if (format[i] != '%')
+        { i++; continue; }
+
+        auto spec = ParseSpec(format, i);
+        i = spec.End;
+
+        if (spec.Type == ARG_TYPE_NONE || spec.Type == ARG_TYPE_INVALID)
+        { continue; }
+
+        // 書き込めなくなった時点で打ち切る. 書式化時に欠けた引数として扱われる.
+        auto result = true;
+        for(auto j=0u; j<spec.StarCount; ++j)
+        { result &= writer.WriteArg(ARG_TYPE_INT32, va_arg(args, int)); }
+
+        switch(spec.Type)
+        {
+        case ARG_TYPE_INT32:
+            result &= writer.WriteArg(spec.Type, va_arg(args, int));
+            break;
+
+        case ARG_TYPE_INT64:
+            result &= writer.WriteArg(spec.Type, va_arg(args, long long));
+            break;
+
+        case ARG_TYPE_DOUBLE:
+            result &= writer.WriteArg(spec.Type, va_arg(args, double));
+            break;
+
+        case ARG_TYPE_LONG_DOUBLE:
+            result &= writer.WriteArg(spec.Type, va_arg(args, long double));
+            break;
+
+        case ARG_TYPE_POINTER:
+        case ARG_TYPE_COUNT:
+            result &= writer.WriteArg(spec.Type, uint64_t(reinterpret_cast<uintptr_t>(va_arg(args, void*))));
+            break;
+
+        case ARG_TYPE_STRING_A:
+            {
+                auto value = va_arg(args, const char*);
+                result &= (value != nullptr)
+                    ? writer.WriteString(spec.Type, value)
+                    : writer.WriteArg(ARG_TYPE_STRING_NULL, uint8_t(0));
+            }
+            break;
+
+        case ARG_TYPE_STRING_W:
+            {
+                auto value = va_arg(args, const wchar_t*);
+                result &= (value != nullptr)
+                    ? writer.WriteString(spec.Type, value)
+                    : writer.WriteArg(ARG_TYPE_STRING_NULL, uint8_t(0));
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (!result)
+        { break; }
+    }
+
+    return writer.GetSize();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1つの変換指定を書式化します.
+//-------------------------------------------------------------------------------------------------
+inline int FormatArgs(char* pBuffer, size_t size, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    auto result = vsnprintf(pBuffer, size, format, args);
+    va_end(args);
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1つの変換指定を書式化します.
+//-------------------------------------------------------------------------------------------------
+inline int FormatArgs(wchar_t* pBuffer, size_t size, const wchar_t* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    auto result = vswprintf(pBuffer, size, format, args);
+    va_end(args);
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1つの変換指定を書式化して追加します.
+//-------------------------------------------------------------------------------------------------
+template<typename Char, typename T>
+void AppendArg(std::basic_string<Char>& result, const std::basic_string<Char>& spec, const int* stars, uint32_t starCount, T value)
+{
+    Char buffer[256];
+    std::vector<Char> temp;
+
+    auto pBuffer = buffer;
+    auto size    = sizeof(buffer) / sizeof(buffer[0]);
+    for(;;)
+    {
+        int count = -1;
+        switch(starCount)
+        {
+        case 0: count = FormatArgs(pBuffer, size, spec.c_str(), value); break;
+        case 1: count = FormatArgs(pBuffer, size, spec.c_str(), stars[0], value); break;
+        case 2: count = FormatArgs(pBuffer, size, spec.c_str(), stars[0], stars[1], value); break;
+        }
+
+        if (count >= 0 && size_t(count) < size)
+        {
+            result.append(pBuffer, size_t(count));
+            return;
+        }
+
+        // vswprintf は切り詰め時に長さを返さないので倍々で広げる.
+        auto required = (count >= 0) ? size_t(count) + 1 : size * 2;
+        if (required > MAX_ARG_LENGTH)
+        { return; }
+
+        temp.resize(required);
+        pBuffer = temp.data();
+        size    = temp.size();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ペイロードを書式化します.
+//-------------------------------------------------------------------------------------------------
+template<typename Char>
+void FormatPayload(const uint8_t* pPayload, size_t size, std::basic_string<Char>& result)
+{
+    static const Char kPercent = '%';
+    static const Char kNull[]  = { '(', 'n', 'u', 'l', 'l', ')', 0 };
+    static const Char kCut[]   = { '.', '.', '.', 0 };
+
+    result.clear();
+
+    PayloadReader reader(pPayload, size);
+
+    std::basic_string<Char> format;
+    if (!reader.ReadString(format))
+    { return; }
+
+    std::basic_string<Char> spec;
+    std::string             argA;
+    std::wstring            argWide;
+
+    for(size_t i=0; i<format.size(); )
+    {
+        auto next = format.find(kPercent, i);
+        if (next == std::basic_string<Char>::npos)
+        {
+            result.append(format, i, std::basic_string<Char>::npos);
+            break;
+        }
+
+        result.append(format, i, next - i);
+
+        auto parsed = ParseSpec(format.c_str(), next);
+        i = parsed.End;
+
+        // "%%" と解釈できない変換指定は '%' だけを出力する.
+        if (parsed.Type == ARG_TYPE_NONE || parsed.Type == ARG_TYPE_INVALID)
+        {
+            result.push_back(kPercent);
+            continue;
+        }
+
+        int stars[2] = {};
+        auto valid = true;
+        for(auto j=0u; j<parsed.StarCount && valid; ++j)
+        {
+            uint8_t tag = 0;
+            valid = reader.Read(&tag, sizeof(tag)) && tag == ARG_TYPE_INT32 && reader.Read(&stars[j], sizeof(int));
+        }
+
+        uint8_t tag = 0;
+        if (!valid || !reader.Read(&tag, sizeof(tag)))
+        {
+            // 記録しきれなかった引数以降は省略する.
+            result.append(kCut);
+            break;
+        }
+
+        spec.assign(format, next, parsed.End - next);
+
+        switch(tag)
+        {
+        case ARG_TYPE_INT32:
+            {
+                int32_t value = 0;
+                valid = reader.Read(&value, sizeof(value));
+                if (valid)
+                { AppendArg(result, spec, stars, parsed.StarCount, int(value)); }
+            }
+            break;
+
+        case ARG_TYPE_INT64:
+            {
+                int64_t value = 0;
+                valid = reader.Read(&value, sizeof(value));
+                if (valid)
+                { AppendArg(result, spec, stars, parsed.StarCount, (long long)(value)); }
+            }
+            break;
+
+        case ARG_TYPE_DOUBLE:
+            {
+                double value = 0.0;
+                valid = reader.Read(&value, sizeof(value));
+                if (valid)
+                { AppendArg(result, spec, stars, parsed.StarCount, value); }
+            }
+            break;
+
+        case ARG_TYPE_LONG_DOUBLE:
+            {
+                long double value = 0.0;
+                valid = reader.Read(&value, sizeof(value));
+                if (valid)
+                { AppendArg(result, spec, stars, parsed.StarCount, value); }
+            }
+            break;
+
+        case ARG_TYPE_POINTER:
+        case ARG_TYPE_COUNT:
+            {
+                uint64_t value = 0;
+                valid = reader.Read(&value, sizeof(value));
+                if (valid && tag == ARG_TYPE_POINTER)
+                { AppendArg(result, spec, stars, parsed.StarCount, reinterpret_cast<void*>(uintptr_t(value))); }
+            }
+            break;
+
+        case ARG_TYPE_STRING_A:
+            valid = reader.ReadString(argA);
+            if (valid)
+            { AppendArg(result, spec, stars, parsed.StarCount, argA.c_str()); }
+            break;
+
+        case ARG_TYPE_STRING_W:
+            valid = reader.ReadString(argWide);
+            if (valid)
+            { AppendArg(result, spec, stars, parsed.StarCount, argWide.c_str()); }
+            break;
+
+        case ARG_TYPE_STRING_NULL:
+            {
+                uint8_t dummy = 0;
+                valid = reader.Read(&dummy, sizeof(dummy));
+                if (valid)
+                { result.append(kNull); }
+            }
+            break;
+
+        default:
+            valid = false;
+            break;
+        }
+
+        if (!valid)
+        {
+            result.append(kCut);
+            break;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      UTF-8 に変換します.
+//-------------------------------------------------------------------------------------------------
+void ToUTF8(const std::wstring& value, std::string& result)
+{
+    result.clear();
+    if (value.empty())
+    { return; }
+
+    auto size = WideCharToMultiByte(CP_UTF8, 0, value.c_str(), int(value.size()), nullptr, 0, nullptr, nullptr);
+    if (size <= 0)
+    { return; }
+
+    result.resize(size_t(size));
+    WideCharToMultiByte(CP_UTF8, 0, value.c_str(), int(value.size()), &result[0], size, nullptr, nullptr);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル出力用の行頭を生成します.
+//-------------------------------------------------------------------------------------------------
+void MakePrefix(uint64_t time, uint8_t level, uint32_t threadId, std::string& result)
+{
+    static const char* kLevelName[] = {
+        "VERBOSE",
+        "INFO",
+        "DEBUG",
+        "WARNING",
+        "ERROR",
+    };
+
+    auto sec  = time_t(time / 1000000000ull);
+    auto msec = uint32_t((time / 1000000ull) % 1000ull);
+
+    tm local = {};
+    localtime_s(&local, &sec);
+
+    char buffer[128];
+    auto count = snprintf(buffer, sizeof(buffer), "[%04d/%02d/%02d %02d:%02d:%02d.%03u][%s][T%u] ",
+        local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+        local.tm_hour, local.tm_min, local.tm_sec, msec,
+        (level < 5) ? kLevelName[level] : "UNKNOWN",
+        threadId);
+
+    result.assign(buffer, (count > 0) ? size_t(count) : 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レコードを UTF-8 の1行に変換します.
+//-------------------------------------------------------------------------------------------------
+void FormatLine
+(
+    uint8_t         type,
+    uint64_t        time,
+    uint8_t         level,
+    uint32_t        threadId,
+    const uint8_t*  pPayload,
+    size_t          payloadSize,
+    std::string&    result
+)
+{
+    MakePrefix(time, level, threadId, result);
+
+    std::string msg;
+    if (type == RECORD_TYPE_TEXT_A)
+    { FormatPayload(pPayload, payloadSize, msg); }
+    else
+    {
+        std::wstring wide;
+        FormatPayload(pPayload, payloadSize, wide);
+        ToUTF8(wide, msg);
+    }
+
+    result += msg;
+    if (result.empty() || result.back() != '\n')
+    { result.push_back('\n'); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルをローテーションします.
+//-------------------------------------------------------------------------------------------------
+void RotateFile(const std::string& path, uint32_t maxCount)
+{
+    // path.N を削除し, path.(N-1) -> path.N, ..., path -> path.1 と名前を変更する.
+    if (maxCount == 0)
+    {
+        remove(path.c_str());
+        return;
+    }
+
+    remove((path + "." + std::to_string(maxCount)).c_str());
+    for(auto i=maxCount - 1; i>=1; --i)
+    {
+        auto src = path + "." + std::to_string(i);
+        auto dst = path + "." + std::to_string(i + 1);
+        rename(src.c_str(), dst.c_str());
+    }
+    rename(path.c_str(), (path + ".1").c_str());
+}
+
+//-------------------------------------------------------------------------------------------------
+//      コンソールカラーを取得します.
+//-------------------------------------------------------------------------------------------------
+WORD GetConsoleColor(WORD defaultAttribute, uint8_t level)
+{
+    switch(asdx::LogLevel(level))
+    {
+    case asdx::LogLevel::Verbose:
+        return FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED | FOREGROUND_INTENSITY;
+
+    case asdx::LogLevel::Info:
+        return FOREGROUND_GREEN | FOREGROUND_INTENSITY;
+
+    case asdx::LogLevel::Debug:
+        return FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+
+    case asdx::LogLevel::Warning:
+        return FOREGROUND_GREEN | FOREGROUND_RED | FOREGROUND_INTENSITY;
+
+    case asdx::LogLevel::Error:
+        return FOREGROUND_RED | FOREGROUND_INTENSITY;
+    }
+
+    return defaultAttribute;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncLogger class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncLogger::AsyncLogger()
+: m_pBuffer         (nullptr)
+, m_BufferSize      (0)
+, m_Overflow        (LogOverflow::Drop)
+, m_Sinks           (0)
+, m_Filter          (uint32_t(LogLevel::Verbose))
+, m_WritePos        (0)
+, m_ReadPos         (0)
+, m_DroppedCount    (0)
+, m_BlockedCount    (0)
+, m_WrittenCount    (0)
+, m_HighWaterMark   (0)
+, m_ProducerCount   (0)
+, m_Accept          (false)
+, m_Stop            (false)
+, m_Wake            (false)
+, m_FlushInterval   (DEFAULT_FLUSH_INTERVAL)
+, m_pTextFile       (nullptr)
+, m_pBinaryFile     (nullptr)
+, m_TextFileSize    (0)
+, m_BinaryFileSize  (0)
+, m_MaxFileSize     (0)
+, m_MaxFileCount    (0)
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+AsyncLogger::~AsyncLogger()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool AsyncLogger::Init(const Desc& desc)
+{
+    Term();
+
+    auto bufferSize = (desc.BufferSize != 0) ? desc.BufferSize : DefaultBufferSize;
+    if (bufferSize < MinBufferSize || (bufferSize & (bufferSize - 1)) != 0)
+    {
+        ELOGA("Error : Invalid Argument. BufferSize = %zu", bufferSize);
+        return false;
+    }
+
+    if ((desc.Sinks & LOG_SINK_TEXT_FILE) && desc.TextFilePath == nullptr)
+    {
+        ELOGA("Error : TextFilePath is null.");
+        return false;
+    }
+
+    if ((desc.Sinks & LOG_SINK_BINARY_FILE) && desc.BinaryFilePath == nullptr)
+    {
+        ELOGA("Error : BinaryFilePath is null.");
+        return false;
+    }
+
+    m_TextPath      = (desc.TextFilePath   != nullptr) ? desc.TextFilePath   : "";
+    m_BinaryPath    = (desc.BinaryFilePath != nullptr) ? desc.BinaryFilePath : "";
+    m_Sinks         = desc.Sinks;
+    m_MaxFileSize   = desc.MaxFileSize;
+    m_MaxFileCount  = desc.MaxFileCount;
+
+    if ((m_Sinks & LOG_SINK_TEXT_FILE) && !OpenTextFile())
+    {
+        ELOGA("Error : File Open Failed. path = %s", m_TextPath.c_str());
+        Term();
+        return false;
+    }
+
+    if ((m_Sinks & LOG_SINK_BINARY_FILE) && !OpenBinaryFile())
+    {
+        ELOGA("Error : File Open Failed. path = %s", m_BinaryPath.c_str());
+        Term();
+        return false;
+    }
+
+    m_pBuffer = new (std::nothrow) uint8_t[bufferSize];
+    if (m_pBuffer == nullptr)
+    {
+        ELOGA("Error : Out of memory.");
+        Term();
+        return false;
+    }
+
+    // 前周のコミット値を誤認しないようにゼロで埋めておく.
+    memset(m_pBuffer, 0, bufferSize);
+
+    m_BufferSize    = bufferSize;
+    m_Overflow      = desc.Overflow;
+    m_FlushInterval = (desc.FlushInterval != 0) ? desc.FlushInterval : DEFAULT_FLUSH_INTERVAL;
+    m_WritePos      = 0;
+    m_ReadPos       = 0;
+    m_DroppedCount  = 0;
+    m_BlockedCount  = 0;
+    m_WrittenCount  = 0;
+    m_HighWaterMark = 0;
+    m_Stop          = false;
+    m_Wake          = false;
+
+    m_Thread = std::thread(&AsyncLogger::Run, this);
+
+    // 全ての設定が終わってから受け付けを開始する.
+    m_Accept.store(true);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::Term()
+{
+    // SystemLogger から転送されている場合は先に切り離す.
+    if (SystemLogger::GetInstance().GetAsyncLogger() == this)
+    { SystemLogger::GetInstance().SetAsyncLogger(nullptr); }
+
+    // 新しいログを受け付けないようにして, Push() 中のスレッドが抜けるまで待つ.
+    // 待機モードのスレッドは書き出しで空きが出来るのを待っているので, 書き出しスレッドより先に止める.
+    m_Accept.store(false);
+    while(m_ProducerCount.load(std::memory_order_acquire) != 0)
+    { std::this_thread::yield(); }
+
+    if (m_Thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> locker(m_Mutex);
+            m_Stop = true;
+        }
+        m_WakeCond.notify_one();
+        m_Thread.join();
+    }
+
+    if (m_pBuffer != nullptr)
+    {
+        delete[] m_pBuffer;
+        m_pBuffer = nullptr;
+    }
+
+    if (m_pTextFile != nullptr)
+    {
+        fclose(m_pTextFile);
+        m_pTextFile = nullptr;
+    }
+
+    if (m_pBinaryFile != nullptr)
+    {
+        fclose(m_pBinaryFile);
+        m_pBinaryFile = nullptr;
+    }
+
+    m_FormatIds.clear();
+    m_BufferSize = 0;
+    m_Sinks      = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書き出しが完了するまで待機します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::Flush()
+{
+    if (!m_Thread.joinable())
+    { return; }
+
+    auto target = m_WritePos.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> locker(m_Mutex);
+    m_Wake = true;
+    m_WakeCond.notify_one();
+    m_FlushCond.wait(locker, [&]
+    { return m_ReadPos.load(std::memory_order_acquire) >= target || m_Stop; });
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ログを出力します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::LogA( const LogLevel level, const char* format, ... )
+{
+    va_list args;
+    va_start(args, format);
+    LogVA(level, format, args);
+    va_end(args);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ログを出力します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::LogW( const LogLevel level, const wchar_t* format, ... )
+{
+    va_list args;
+    va_start(args, format);
+    LogVW(level, format, args);
+    va_end(args);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      可変長引数リストでログを出力します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::LogVA( const LogLevel level, const char* format, va_list args )
+{
+    if (!m_Accept.load(std::memory_order_relaxed) || format == nullptr || uint32_t(level) < m_Filter.load(std::memory_order_relaxed))
+    { return; }
+
+    uint8_t payload[MaxRecordSize];
+    auto size = EncodePayload(format, args, payload, sizeof(payload));
+    Push(level, RECORD_TYPE_TEXT_A, payload, size);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      可変長引数リストでログを出力します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::LogVW( const LogLevel level, const wchar_t* format, va_list args )
+{
+    if (!m_Accept.load(std::memory_order_relaxed) || format == nullptr || uint32_t(level) < m_Filter.load(std::memory_order_relaxed))
+    { return; }
+
+    uint8_t payload[MaxRecordSize];
+    auto size = EncodePayload(format, args, payload, sizeof(payload));
+    Push(level, RECORD_TYPE_TEXT_W, payload, size);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      フィルタを設定します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::SetFilter( const LogLevel filter )
+{ m_Filter.store(uint32_t(filter), std::memory_order_relaxed); }
+
+//-------------------------------------------------------------------------------------------------
+//      設定されているフィルタを取得します.
+//-------------------------------------------------------------------------------------------------
+LogLevel AsyncLogger::GetFilter()
+{ return LogLevel(m_Filter.load(std::memory_order_relaxed)); }
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+AsyncLogger::Stats AsyncLogger::GetStats() const
+{
+    Stats stats = {};
+    stats.WrittenCount  = m_WrittenCount .load(std::memory_order_relaxed);
+    stats.DroppedCount  = m_DroppedCount .load(std::memory_order_relaxed);
+    stats.BlockedCount  = m_BlockedCount .load(std::memory_order_relaxed);
+    stats.HighWaterMark = m_HighWaterMark.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リングバッファにレコードを追加します.
+//-------------------------------------------------------------------------------------------------
+bool AsyncLogger::Push(LogLevel level, uint8_t type, const uint8_t* pPayload, size_t payloadSize)
+{
+    // Term() はカウンタが0になるまでバッファを解放しない.
+    // 受け付け状態の確認はカウンタを増やした後に行う.
+    ScopedCounter counter(m_ProducerCount);
+    if (!m_Accept.load())
+    { return false; }
+
+    auto recordSize = AlignUp(sizeof(RecordHeader) + payloadSize, RECORD_ALIGNMENT);
+    auto mask       = uint64_t(m_BufferSize - 1);
+    auto blocked    = false;
+
+    // 書き込み位置を予約する. 終端を跨ぐ場合は終端までを詰め物にする.
+    uint64_t total = 0;
+    uint64_t used  = 0;
+    auto pos = m_WritePos.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        auto contiguous = m_BufferSize - size_t(pos & mask);
+        total = (recordSize <= contiguous) ? recordSize : contiguous + recordSize;
+
+        auto read = m_ReadPos.load(std::memory_order_acquire);
+        used = pos + total - read;
+        if (used > m_BufferSize)
+        {
+            if (m_Overflow == LogOverflow::Drop)
+            {
+                m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (!blocked)
+            {
+                blocked = true;
+                m_BlockedCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            Wake();
+            std::this_thread::yield();
+            pos = m_WritePos.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (m_WritePos.compare_exchange_weak(pos, pos + total, std::memory_order_relaxed))
+        { break; }
+    }
+
+    if (total != recordSize)
+    {
+        auto pPad = reinterpret_cast<RecordHeader*>(m_pBuffer + (pos & mask));
+        pPad->Size = uint32_t(total - recordSize);
+        pPad->Type = RECORD_TYPE_PAD;
+        pPad->Commit.store(pos + 1, std::memory_order_release);
+        pos += total - recordSize;
+    }
+
+    auto pHeader = reinterpret_cast<RecordHeader*>(m_pBuffer + (pos & mask));
+    pHeader->Size        = uint32_t(recordSize);
+    pHeader->Type        = type;
+    pHeader->Level       = uint8_t(level);
+    pHeader->Reserved    = 0;
+    pHeader->Time        = GetLogTime();
+    pHeader->ThreadId    = GetLogThreadId();
+    pHeader->PayloadSize = uint32_t(payloadSize);
+    memcpy(reinterpret_cast<uint8_t*>(pHeader) + sizeof(RecordHeader), pPayload, payloadSize);
+    pHeader->Commit.store(pos + 1, std::memory_order_release);
+
+    auto mark = m_HighWaterMark.load(std::memory_order_relaxed);
+    while(mark < used && !m_HighWaterMark.compare_exchange_weak(mark, size_t(used), std::memory_order_relaxed))
+    { /* DO_NOTHING */ }
+
+    // 半分を超えたら書き出しスレッドを起こす.
+    if (used >= m_BufferSize / 2)
+    { Wake(); }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書き出しスレッドを起こします.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::Wake()
+{
+    // 既に起床要求が出ていれば書き出しスレッドが拾うので通知は省く.
+    if (m_Wake.exchange(true, std::memory_order_acq_rel))
+    { return; }
+
+    // 書き出しスレッドが条件を評価してから待機に入るまでの間に通知しないようにロックを経由する.
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+    }
+    m_WakeCond.notify_one();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リングバッファのレコードを書き出します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::Consume()
+{
+    auto mask  = uint64_t(m_BufferSize - 1);
+    auto read  = m_ReadPos.load(std::memory_order_relaxed);
+    auto count = 0u;
+
+    CONSOLE_SCREEN_BUFFER_INFO info = {};
+    auto console   = GetStdHandle(STD_OUTPUT_HANDLE);
+    auto hasColor  = (m_Sinks & LOG_SINK_CONSOLE) && GetConsoleScreenBufferInfo(console, &info);
+    auto lastLevel = uint8_t(0xff);
+
+    while(read != m_WritePos.load(std::memory_order_acquire))
+    {
+        auto pHeader = reinterpret_cast<RecordHeader*>(m_pBuffer + (read & mask));
+
+        // 予約済みで書き込み途中のレコードに追いついた.
+        if (pHeader->Commit.load(std::memory_order_acquire) != read + 1)
+        { break; }
+
+        if (pHeader->Type != RECORD_TYPE_PAD)
+        {
+            if (hasColor && pHeader->Level != lastLevel)
+            {
+                SetConsoleTextAttribute(console, GetConsoleColor(info.wAttributes, pHeader->Level));
+                lastLevel = pHeader->Level;
+            }
+
+            Write(reinterpret_cast<const uint8_t*>(pHeader));
+            count++;
+        }
+
+        read += pHeader->Size;
+        m_ReadPos.store(read, std::memory_order_release);
+    }
+
+    if (count == 0)
+    { return; }
+
+    if (hasColor)
+    { SetConsoleTextAttribute(console, info.wAttributes); }
+
+    if (m_pTextFile != nullptr)
+    { fflush(m_pTextFile); }
+
+    if (m_pBinaryFile != nullptr)
+    { fflush(m_pBinaryFile); }
+
+    m_WrittenCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レコードを出力します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::Write(const uint8_t* pRecord)
+{
+    auto pHeader  = reinterpret_cast<const RecordHeader*>(pRecord);
+    auto pPayload = pRecord + sizeof(RecordHeader);
+
+    if (m_Sinks & (LOG_SINK_CONSOLE | LOG_SINK_DEBUGGER))
+    {
+        if (pHeader->Type == RECORD_TYPE_TEXT_A)
+        {
+            std::string msg;
+            FormatPayload(pPayload, pHeader->PayloadSize, msg);
+
+            if (m_Sinks & LOG_SINK_CONSOLE)
+            { fputs(msg.c_str(), stdout); }
+
+            if (m_Sinks & LOG_SINK_DEBUGGER)
+            { OutputDebugStringA(msg.c_str()); }
+        }
+        else
+        {
+            std::wstring msg;
+            FormatPayload(pPayload, pHeader->PayloadSize, msg);
+
+            if (m_Sinks & LOG_SINK_CONSOLE)
+            { fputws(msg.c_str(), stdout); }
+
+            if (m_Sinks & LOG_SINK_DEBUGGER)
+            { OutputDebugStringW(msg.c_str()); }
+        }
+    }
+
+    if (m_pTextFile != nullptr)
+    {
+        std::string line;
+        FormatLine(pHeader->Type, pHeader->Time, pHeader->Level, pHeader->ThreadId, pPayload, pHeader->PayloadSize, line);
+
+        if (m_MaxFileSize != 0 && m_TextFileSize > 0 && m_TextFileSize + line.size() > m_MaxFileSize)
+        {
+            fclose(m_pTextFile);
+            m_pTextFile = nullptr;
+            RotateFile(m_TextPath, m_MaxFileCount);
+            OpenTextFile();
+        }
+
+        if (m_pTextFile != nullptr)
+        {
+            fwrite(line.data(), 1, line.size(), m_pTextFile);
+            m_TextFileSize += line.size();
+        }
+    }
+
+    if (m_pBinaryFile != nullptr)
+    { WriteBinary(pRecord); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      レコードをバイナリで出力します.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::WriteBinary(const uint8_t* pRecord)
+{
+    auto pHeader  = reinterpret_cast<const RecordHeader*>(pRecord);
+    auto pPayload = pRecord + sizeof(RecordHeader);
+
+    // ペイロード先頭のフォーマット文字列とそれ以降の引数に分ける.
+    uint32_t length = 0;
+    memcpy(&length, pPayload, sizeof(length));
+
+    auto charSize   = (pHeader->Type == RECORD_TYPE_TEXT_A) ? sizeof(char) : sizeof(wchar_t);
+    auto formatSize = sizeof(uint32_t) + charSize * (size_t(length) + 1);
+    if (formatSize > pHeader->PayloadSize)
+    { return; }
+
+    auto argSize = pHeader->PayloadSize - formatSize;
+
+    std::string key(reinterpret_cast<const char*>(pPayload), formatSize);
+    key.push_back(char(pHeader->Type));
+
+    // 初出のフォーマットは定義も書き出すので, その分も含めてサイズを判定する.
+    auto itr = m_FormatIds.find(key);
+    auto recordSize = sizeof(BinaryRecord) + argSize;
+    if (itr == m_FormatIds.end())
+    { recordSize += sizeof(BinaryFormat) + formatSize; }
+
+    if (m_MaxFileSize != 0 && m_BinaryFileSize > sizeof(BinaryHeader)
+     && m_BinaryFileSize + recordSize > m_MaxFileSize)
+    {
+        fclose(m_pBinaryFile);
+        m_pBinaryFile = nullptr;
+        RotateFile(m_BinaryPath, m_MaxFileCount);
+        if (!OpenBinaryFile())
+        { return; }
+
+        // 新しいファイルではフォーマットを定義し直す.
+        itr = m_FormatIds.end();
+    }
+
+    // 初出のフォーマットは番号を割り当てて定義を書き出す.
+    uint32_t id = 0;
+    if (itr == m_FormatIds.end())
+    {
+        id = uint32_t(m_FormatIds.size());
+        m_FormatIds[key] = id;
+
+        BinaryFormat chunk = {};
+        chunk.Chunk    = BINARY_CHUNK_FORMAT;
+        chunk.FormatId = id;
+        chunk.Type     = pHeader->Type;
+        chunk.Size     = uint32_t(formatSize);
+        fwrite(&chunk, sizeof(chunk), 1, m_pBinaryFile);
+        fwrite(pPayload, formatSize, 1, m_pBinaryFile);
+        m_BinaryFileSize += sizeof(chunk) + formatSize;
+    }
+    else
+    { id = itr->second; }
+
+    BinaryRecord record = {};
+    record.Chunk    = BINARY_CHUNK_RECORD;
+    record.FormatId = id;
+    record.Level    = pHeader->Level;
+    record.ThreadId = pHeader->ThreadId;
+    record.Time     = pHeader->Time;
+    record.ArgSize  = uint32_t(argSize);
+    fwrite(&record, sizeof(record), 1, m_pBinaryFile);
+    fwrite(pPayload + formatSize, argSize, 1, m_pBinaryFile);
+    m_BinaryFileSize += sizeof(record) + argSize;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      テキストファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+bool AsyncLogger::OpenTextFile()
+{
+    m_TextFileSize = 0;
+    if (fopen_s(&m_pTextFile, m_TextPath.c_str(), "wb") != 0)
+    {
+        m_pTextFile = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バイナリファイルを開きます.
+//-------------------------------------------------------------------------------------------------
+bool AsyncLogger::OpenBinaryFile()
+{
+    // 新しいファイルにはフォーマット定義を出力し直す.
+    m_FormatIds.clear();
+    m_BinaryFileSize = 0;
+
+    if (fopen_s(&m_pBinaryFile, m_BinaryPath.c_str(), "wb") != 0)
+    {
+        m_pBinaryFile = nullptr;
+        return false;
+    }
+
+    BinaryHeader header = {};
+    header.Magic        = BINARY_LOG_MAGIC;
+    header.Version      = BINARY_LOG_VERSION;
+    header.WideCharSize = sizeof(wchar_t);
+    fwrite(&header, sizeof(header), 1, m_pBinaryFile);
+    m_BinaryFileSize = sizeof(header);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      書き出しスレッドの処理です.
+//-------------------------------------------------------------------------------------------------
+void AsyncLogger::Run()
+{
+    for(;;)
+    {
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> locker(m_Mutex);
+            m_WakeCond.wait_for(locker, std::chrono::milliseconds(m_FlushInterval), [&]
+            { return m_Stop || m_Wake; });
+
+            // 起床要求を出したスレッドの書き込みが Consume() から見えるように RMW で取り下げる.
+            m_Wake.exchange(false, std::memory_order_acq_rel);
+            stop   = m_Stop;
+        }
+
+        Consume();
+
+        {
+            std::lock_guard<std::mutex> locker(m_Mutex);
+            m_FlushCond.notify_all();
+        }
+
+        // 予約済みのレコードが全て書き込まれるまで待ってから終了する.
+        if (stop && m_ReadPos.load(std::memory_order_relaxed) == m_WritePos.load(std::memory_order_acquire))
+        { break; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      バイナリログをテキストに変換します.
+//-------------------------------------------------------------------------------------------------
+bool DecodeBinaryLog(const char* binaryPath, const char* textPath)
+{
+    if (binaryPath == nullptr || textPath == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    FILE* pSrc = nullptr;
+    if (fopen_s(&pSrc, binaryPath, "rb") != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", binaryPath);
+        return false;
+    }
+
+    BinaryHeader header = {};
+    if (fread(&header, sizeof(header), 1, pSrc) != 1
+     || header.Magic        != BINARY_LOG_MAGIC
+     || header.Version      != BINARY_LOG_VERSION
+     || header.WideCharSize != sizeof(wchar_t))
+    {
+        ELOGA("Error : Invalid Binary Log. path = %s", binaryPath);
+        fclose(pSrc);
+        return false;
+    }
+
+    FILE* pDst = nullptr;
+    if (fopen_s(&pDst, textPath, "wb") != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", textPath);
+        fclose(pSrc);
+        return false;
+    }
+
+    struct Format
+    {
+        uint8_t                 Type;
+        std::vector<uint8_t>    Data;
+    };
+    std::vector<Format>     formats;
+    std::vector<uint8_t>    payload;
+    std::string             line;
+
+    auto result = true;
+    for(;;)
+    {
+        uint8_t chunk = 0;
+        if (fread(&chunk, sizeof(chunk), 1, pSrc) != 1)
+        { break; }
+
+        if (chunk == BINARY_CHUNK_FORMAT)
+        {
+            BinaryFormat format = {};
+            format.Chunk = chunk;
+            if (fread(reinterpret_cast<uint8_t*>(&format) + 1, sizeof(format) - 1, 1, pSrc) != 1
+             || format.FormatId != formats.size()
+             || format.Size > AsyncLogger::MaxRecordSize)
+            {
+                result = false;
+                break;
+            }
+
+            Format item;
+            item.Type = format.Type;
+            item.Data.resize(format.Size);
+            if (format.Size > 0 && fread(item.Data.data(), format.Size, 1, pSrc) != 1)
+            {
+                result = false;
+                break;
+            }
+
+            formats.push_back(std::move(item));
+        }
+        else if (chunk == BINARY_CHUNK_RECORD)
+        {
+            BinaryRecord record = {};
+            record.Chunk = chunk;
+            if (fread(reinterpret_cast<uint8_t*>(&record) + 1, sizeof(record) - 1, 1, pSrc) != 1
+             || record.FormatId >= formats.size()
+             || record.ArgSize > AsyncLogger::MaxRecordSize)
+            {
+                result = false;
+                break;
+            }
+
+            // フォーマットと引数を繋げてペイロードを復元する.
+            auto& format = formats[record.FormatId];
+            payload.assign(format.Data.begin(), format.Data.end());
+            payload.resize(format.Data.size() + record.ArgSize);
+            if (record.ArgSize > 0 && fread(payload.data() + format.Data.size(), record.ArgSize, 1, pSrc) != 1)
+            {
+                result = false;
+                break;
+            }
+
+            FormatLine(format.Type, record.Time, record.Level, record.ThreadId, payload.data(), payload.size(), line);
+            fwrite(line.data(), 1, line.size(), pDst);
+        }
+        else
+        {
+            result = false;
+            break;
+        }
+    }
+
+    if (!result)
+    { ELOGA("Error : Binary Log is corrupted. path = %s", binaryPath); }
+
+    fclose(pDst);
+    fclose(pSrc);
+
+    return result;
+}
+
+} // namespace asdx
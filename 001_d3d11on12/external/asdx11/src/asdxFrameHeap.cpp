@@ -12,6 +12,91 @@
 #include <asdxLogger.h>
 
 
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t INVALID_SLOT  = UINT32_MAX;
+static const uint64_t INVALID_FRAME = UINT64_MAX;
+
+//-----------------------------------------------------------------------------
+// Global Variables
+//-----------------------------------------------------------------------------
+std::atomic<uint64_t>   g_SlotMask(0);                  // 使用中のスロット(1ビットが1スロット).
+
+//-----------------------------------------------------------------------------
+//      アライメントを揃えます.
+//-----------------------------------------------------------------------------
+inline uintptr_t AlignUp(uintptr_t value, size_t alignment)
+{ return (value + alignment - 1) & ~uintptr_t(alignment - 1); }
+
+///////////////////////////////////////////////////////////////////////////////
+// ThreadSlot class
+///////////////////////////////////////////////////////////////////////////////
+class ThreadSlot
+{
+public:
+    ThreadSlot()
+    : m_Slot(INVALID_SLOT)
+    { /* DO_NOTHING */ }
+
+    ~ThreadSlot()
+    {
+        // スレッド終了時にスロットを返却して，後から生成されたスレッドで再利用する.
+        // アリーナの内容は次の所有スレッドから見えるように release で公開する.
+        if (m_Slot < asdx::FrameHeap::MaxThreadCount)
+        { g_SlotMask.fetch_and(~(uint64_t(1) << m_Slot), std::memory_order_release); }
+    }
+
+    uint32_t Get()
+    {
+        // 空きが無くて共有領域を使っているスレッドは，空きが出来た時点で取り直す.
+        if (m_Slot >= asdx::FrameHeap::MaxThreadCount)
+        { m_Slot = Acquire(); }
+
+        return m_Slot;
+    }
+
+private:
+    uint32_t m_Slot;
+
+    static uint32_t Acquire()
+    {
+        const auto full = ~uint64_t(0) >> (64 - asdx::FrameHeap::MaxThreadCount);
+
+        auto mask = g_SlotMask.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            if ((mask & full) == full)
+            { return asdx::FrameHeap::MaxThreadCount; }
+
+            auto slot = 0u;
+            while(slot < asdx::FrameHeap::MaxThreadCount && (mask & (uint64_t(1) << slot)) != 0)
+            { slot++; }
+
+            if (g_SlotMask.compare_exchange_weak(mask, mask | (uint64_t(1) << slot), std::memory_order_acquire, std::memory_order_relaxed))
+            { return slot; }
+        }
+    }
+};
+
+static_assert(asdx::FrameHeap::MaxThreadCount <= 64, "Slot mask supports up to 64 threads.");
+
+//-----------------------------------------------------------------------------
+// Thread Local Variables
+//-----------------------------------------------------------------------------
+thread_local ThreadSlot t_Slot;                         // スレッドのスロット.
+
+//-----------------------------------------------------------------------------
+//      呼び出しスレッドのスロット番号を取得します.
+//-----------------------------------------------------------------------------
+inline uint32_t GetThreadSlot()
+{ return t_Slot.Get(); }
+
+} // namespace
+
+
 namespace asdx {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -22,10 +107,22 @@ namespace asdx {
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
 FrameHeap::FrameHeap()
-: m_Size    (0)
-, m_pBuffer (nullptr)
-, m_Offset  (0)
-{ /* DO_NOTHING */ }
+: m_pBuffer         (nullptr)
+, m_pArenas         (nullptr)
+, m_pFrames         (nullptr)
+, m_Size            (0)
+, m_ArenaSize       (0)
+, m_FrameCount      (0)
+, m_Current         (0)
+, m_FrameIndex      (0)
+, m_Offset          (0)
+, m_FailedCount     (0)
+, m_LastFrameBytes  (0)
+, m_HighWaterMark   (0)
+{
+    for(auto i=0u; i<MaxFrameCount; ++i)
+    { m_UsedFrame[i] = INVALID_FRAME; }
+}
 
 //-----------------------------------------------------------------------------
 //      デストラクタです.
@@ -37,18 +134,66 @@ FrameHeap::~FrameHeap()
 //      初期化処理を行います.
 //-----------------------------------------------------------------------------
 bool FrameHeap::Init(size_t size)
+{
+    Desc desc = {};
+    desc.SizePerFrame = size;
+    desc.FrameCount   = 1;
+    desc.ArenaSize    = DefaultArenaSize;
+    return Init(desc);
+}
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool FrameHeap::Init(const Desc& desc)
 {
     Term();
 
-    m_pBuffer = new(std::nothrow) uint8_t[size];
+    if (desc.SizePerFrame == 0 || desc.FrameCount == 0 || desc.FrameCount > MaxFrameCount)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    // フレーム領域同士やアリーナがキャッシュラインを共有しないように揃える.
+    auto frameSize  = size_t(AlignUp(desc.SizePerFrame, CacheLineSize));
+    auto arenaBytes = sizeof(Arena) * MaxThreadCount;
+    auto totalSize  = arenaBytes + frameSize * desc.FrameCount + CacheLineSize;
+
+    m_pBuffer = new(std::nothrow) uint8_t[totalSize];
     if (m_pBuffer == nullptr)
     {
         ELOG("Error : Out of memory.");
         return false;
     }
 
-    m_Size   = size;
-    m_Offset = 0;
+    auto base = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(m_pBuffer), CacheLineSize));
+    m_pArenas = reinterpret_cast<Arena*>(base);
+    m_pFrames = base + arenaBytes;
+
+    for(auto i=0u; i<MaxThreadCount; ++i)
+    {
+        m_pArenas[i].pBegin   = nullptr;
+        m_pArenas[i].pCurrent = nullptr;
+        m_pArenas[i].pEnd     = nullptr;
+        m_pArenas[i].Frame    = INVALID_FRAME;
+    }
+
+    m_Size       = frameSize;
+    m_ArenaSize  = (desc.ArenaSize != 0) ? desc.ArenaSize : DefaultArenaSize;
+    m_ArenaSize  = size_t(AlignUp(m_ArenaSize, CacheLineSize));
+    m_FrameCount = desc.FrameCount;
+    m_Current    = 0;
+    m_FrameIndex = 0;
+    m_Offset     = 0;
+
+    for(auto i=0u; i<MaxFrameCount; ++i)
+    { m_UsedFrame[i] = INVALID_FRAME; }
+    m_UsedFrame[0] = m_FrameIndex;
+
+    m_FailedCount    = 0;
+    m_LastFrameBytes = 0;
+    m_HighWaterMark  = 0;
 
     return true;
 }
@@ -64,29 +209,153 @@ void FrameHeap::Term()
         m_pBuffer = nullptr;
     }
 
-    m_Size   = 0;
-    m_Offset = 0;
+    m_pArenas    = nullptr;
+    m_pFrames    = nullptr;
+    m_Size       = 0;
+    m_ArenaSize  = 0;
+    m_FrameCount = 0;
+    m_Current    = 0;
+    m_Offset     = 0;
 }
 
 //-----------------------------------------------------------------------------
-//      バッファ先頭にオフセットをリセットします.
+//      次のフレームに切り替えます.
 //-----------------------------------------------------------------------------
-void FrameHeap::Reset()
-{ m_Offset = 0; }
+bool FrameHeap::Reset(uint64_t completedFrame)
+{
+    if (m_pBuffer == nullptr)
+    { return false; }
+
+    // 次の領域を使っていたフレームが完了していなければ再利用しない.
+    auto next = (m_Current + 1) % m_FrameCount;
+    if (m_UsedFrame[next] != INVALID_FRAME && m_UsedFrame[next] > completedFrame)
+    { return false; }
+
+    auto used = m_Offset.load(std::memory_order_relaxed);
+    m_LastFrameBytes = used;
+    if (m_HighWaterMark < used)
+    { m_HighWaterMark = used; }
+
+    // フレーム番号が変わるとアリーナは次回の確保時に破棄される.
+    m_FrameIndex++;
+    m_Current = next;
+    m_UsedFrame[next] = m_FrameIndex;
+    m_Offset.store(0, std::memory_order_relaxed);
+
+    return true;
+}
 
 //-----------------------------------------------------------------------------
 //      メモリ確保を行います.
 //-----------------------------------------------------------------------------
-void* FrameHeap::Alloc(size_t size)
+void* FrameHeap::Alloc(size_t size, size_t alignment)
 {
-    if (GetRestSize() < size)
+    if (m_pBuffer == nullptr || (alignment & (alignment - 1)) != 0)
     { return nullptr; }
 
-    auto ptr = m_pBuffer + m_Offset;
-    m_Offset += size;
+    if (alignment == 0)
+    { alignment = DefaultAlignment; }
+
+    auto slot = GetThreadSlot();
+
+    // 大きな確保やアリーナを持たないスレッドは共有領域から直接確保.
+    if (slot >= MaxThreadCount || size >= m_ArenaSize / 4 || alignment >= m_ArenaSize / 4)
+    {
+        auto ptr = AllocShared(size, alignment);
+        if (ptr == nullptr)
+        { m_FailedCount.fetch_add(1, std::memory_order_relaxed); }
+        return ptr;
+    }
+
+    // アリーナは所有スレッドからしか触らないのでロック不要.
+    auto& arena = m_pArenas[slot];
+    if (arena.Frame == m_FrameIndex)
+    {
+        auto ptr = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(arena.pCurrent), alignment));
+        if (ptr <= arena.pEnd && size <= size_t(arena.pEnd - ptr))
+        {
+            arena.pCurrent = ptr + size;
+            return ptr;
+        }
+    }
+
+    // 共有領域から新しいアリーナを切り出す.
+    auto pChunk = AllocShared(m_ArenaSize, CacheLineSize);
+    if (pChunk == nullptr)
+    {
+        // 残りがアリーナ未満でも収まる分は確保する.
+        auto ptr = AllocShared(size, alignment);
+        if (ptr == nullptr)
+        { m_FailedCount.fetch_add(1, std::memory_order_relaxed); }
+        return ptr;
+    }
+
+    auto ptr = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(pChunk), alignment));
+    arena.pBegin   = pChunk;
+    arena.pCurrent = ptr + size;
+    arena.pEnd     = pChunk + m_ArenaSize;
+    arena.Frame    = m_FrameIndex;
+
     return ptr;
 }
 
+//-----------------------------------------------------------------------------
+//      呼び出しスレッドのアリーナの現在位置を取得します.
+//-----------------------------------------------------------------------------
+FrameHeap::Marker FrameHeap::GetMarker()
+{
+    Marker marker = {};
+    marker.Frame = m_FrameIndex;
+    marker.Slot  = GetThreadSlot();
+
+    if (m_pArenas != nullptr && marker.Slot < MaxThreadCount)
+    {
+        auto& arena = m_pArenas[marker.Slot];
+        if (arena.Frame == m_FrameIndex)
+        {
+            marker.pBegin   = arena.pBegin;
+            marker.pCurrent = arena.pCurrent;
+        }
+    }
+
+    return marker;
+}
+
+//-----------------------------------------------------------------------------
+//      呼び出しスレッドのアリーナを巻き戻します.
+//-----------------------------------------------------------------------------
+void FrameHeap::Rollback(const Marker& marker)
+{
+    if (m_pArenas == nullptr || marker.Slot >= MaxThreadCount || marker.Slot != GetThreadSlot())
+    { return; }
+
+    auto& arena = m_pArenas[marker.Slot];
+    if (arena.Frame != marker.Frame || arena.Frame != m_FrameIndex)
+    { return; }
+
+    // マーカー取得後に切り出したアリーナは丸ごと一時確保なので先頭まで戻す.
+    arena.pCurrent = (arena.pBegin == marker.pBegin) ? marker.pCurrent : arena.pBegin;
+}
+
+//-----------------------------------------------------------------------------
+//      現在のフレーム番号を取得します.
+//-----------------------------------------------------------------------------
+uint64_t FrameHeap::GetFrameIndex() const
+{ return m_FrameIndex; }
+
+//-----------------------------------------------------------------------------
+//      統計情報を取得します.
+//-----------------------------------------------------------------------------
+FrameHeap::Stats FrameHeap::GetStats() const
+{
+    Stats stats = {};
+    stats.UsedBytes      = m_Offset.load(std::memory_order_relaxed);
+    stats.LastFrameBytes = m_LastFrameBytes;
+    stats.HighWaterMark  = (m_HighWaterMark > stats.UsedBytes) ? m_HighWaterMark : stats.UsedBytes;
+    stats.FailedCount    = m_FailedCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
 //-----------------------------------------------------------------------------
 //      メモリサイズを取得します.
 //-----------------------------------------------------------------------------
@@ -97,6 +366,26 @@ size_t FrameHeap::GetSize() const
 //      利用可能なメモリサイズを取得します.
 //-----------------------------------------------------------------------------
 size_t FrameHeap::GetRestSize() const
-{ return m_Size - m_Offset; }
+{ return m_Size - m_Offset.load(std::memory_order_relaxed); }
+
+//-----------------------------------------------------------------------------
+//      共有領域からメモリを確保します.
+//-----------------------------------------------------------------------------
+uint8_t* FrameHeap::AllocShared(size_t size, size_t alignment)
+{
+    auto pFrame = m_pFrames + m_Size * m_Current;
+    auto base   = reinterpret_cast<uintptr_t>(pFrame);
+    auto offset = m_Offset.load(std::memory_order_relaxed);
+
+    for(;;)
+    {
+        auto begin = size_t(AlignUp(base + offset, alignment) - base);
+        if (begin > m_Size || size > m_Size - begin)
+        { return nullptr; }
+
+        if (m_Offset.compare_exchange_weak(offset, begin + size, std::memory_order_relaxed))
+        { return pFrame + begin; }
+    }
+}
 
-} // namespace asdx
\ No newline at end of file
+} // namespace asdx
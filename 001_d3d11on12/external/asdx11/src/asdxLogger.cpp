@@ -11,6 +11,7 @@
 #include <cstdarg>
 #include <Windows.h>
 #include <asdxLogger.h>
+#include <asdxAsyncLogger.h>
 
 
 namespace /* anonymous */ {
@@ -107,7 +108,8 @@ SystemLogger SystemLogger::s_Instance;
 //      コンストラクタです
 //-------------------------------------------------------------------------------------------------
 SystemLogger::SystemLogger()
-: m_Filter( LogLevel::Verbose )
+: m_Filter      ( LogLevel::Verbose )
+, m_pAsyncLogger( nullptr )
 { /* DO_NOTHING */ }
 
 //-------------------------------------------------------------------------------------------------
@@ -123,6 +125,18 @@ void SystemLogger::LogA( const LogLevel level, const char* format, ... )
 {
     if ( level >= m_Filter )
     {
+        // 非同期ロガーが設定されている場合は転送する.
+        auto pAsyncLogger = m_pAsyncLogger.load( std::memory_order_acquire );
+        if ( pAsyncLogger != nullptr )
+        {
+            va_list arg;
+
+            va_start( arg, format );
+            pAsyncLogger->LogVA( level, format, arg );
+            va_end( arg );
+            return;
+        }
+
         ConsoleColor color;
 
         // カラーを設定.
@@ -155,6 +169,18 @@ void SystemLogger::LogW( const LogLevel level, const wchar_t* format, ... )
 {
     if ( level >= m_Filter )
     {
+        // 非同期ロガーが設定されている場合は転送する.
+        auto pAsyncLogger = m_pAsyncLogger.load( std::memory_order_acquire );
+        if ( pAsyncLogger != nullptr )
+        {
+            va_list arg;
+
+            va_start( arg, format );
+            pAsyncLogger->LogVW( level, format, arg );
+            va_end( arg );
+            return;
+        }
+
         ConsoleColor color;
 
         // カラーを設定.
@@ -191,4 +217,16 @@ void SystemLogger::SetFilter( const LogLevel filter )
 LogLevel SystemLogger::GetFilter()
 { return m_Filter; }
 
+//-------------------------------------------------------------------------------------------------
+//      転送先の非同期ロガーを設定します.
+//-------------------------------------------------------------------------------------------------
+void SystemLogger::SetAsyncLogger( AsyncLogger* pLogger )
+{ m_pAsyncLogger.store( pLogger, std::memory_order_release ); }
+
+//-------------------------------------------------------------------------------------------------
+//      転送先の非同期ロガーを取得します.
+//-------------------------------------------------------------------------------------------------
+AsyncLogger* SystemLogger::GetAsyncLogger() const
+{ return m_pAsyncLogger.load( std::memory_order_acquire ); }
+
 } // namespace asdx
@@ -9,10 +9,16 @@
 // Includes
 //-------------------------------------------------------------------------------------------------
 #include <cstdint>
+#include <atomic>
 
 
 namespace asdx {
 
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+class AsyncLogger;
+
 #ifndef __ASDX_WIDE
 #define __ASDX_WIDE( _string )      L ## _string
 #endif//__ASDX_WIDE
@@ -130,6 +136,21 @@ public:
     //---------------------------------------------------------------------------------------------
     LogLevel  GetFilter() override;
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      転送先の非同期ロガーを設定します.
+    //!             設定中のログは書式化と出力を行わずに非同期ロガーへ転送されます.
+    //!
+    //! @param[in]      pLogger     非同期ロガー(nullptrの場合は同期出力に戻します).
+    //---------------------------------------------------------------------------------------------
+    void SetAsyncLogger( AsyncLogger* pLogger );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      転送先の非同期ロガーを取得します.
+    //!
+    //! @return     転送先の非同期ロガーを返却します.
+    //---------------------------------------------------------------------------------------------
+    AsyncLogger* GetAsyncLogger() const;
+
 protected:
     //=============================================================================================
     // protected variables.
@@ -147,6 +168,7 @@ private:
     //=============================================================================================
     static SystemLogger     s_Instance;     //!< シングルトンインスタンスです.
     LogLevel                m_Filter;       //!< フィルターです.
+    std::atomic<AsyncLogger*>   m_pAsyncLogger; //!< 転送先の非同期ロガーです.
 
     //=============================================================================================
     // private methods.
@@ -0,0 +1,162 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMappedFile.cpp
+// Desc : Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <Windows.h>
+#include <asdxMappedFile.h>
+#include <asdxLogger.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::MappedFile()
+: m_hFile   (INVALID_HANDLE_VALUE)
+, m_hMapping(nullptr)
+, m_pData   (nullptr)
+, m_Size    (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{ Close(); }
+
+//-----------------------------------------------------------------------------
+//      ファイルをメモリにマップします.
+//-----------------------------------------------------------------------------
+bool MappedFile::OpenA(const char* path)
+{
+    Close();
+
+    m_hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    return Map();
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルをメモリにマップします.
+//-----------------------------------------------------------------------------
+bool MappedFile::OpenW(const wchar_t* path)
+{
+    Close();
+
+    m_hFile = CreateFileW(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+    {
+        ELOGA("Error : File Open Failed. path = %ls", path);
+        return false;
+    }
+
+    return Map();
+}
+
+//-----------------------------------------------------------------------------
+//      マップを解除し，ファイルを閉じます.
+//-----------------------------------------------------------------------------
+void MappedFile::Close()
+{
+    if (m_pData != nullptr)
+    {
+        UnmapViewOfFile(m_pData);
+        m_pData = nullptr;
+    }
+
+    if (m_hMapping != nullptr)
+    {
+        CloseHandle(m_hMapping);
+        m_hMapping = nullptr;
+    }
+
+    if (m_hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+
+    m_Size = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      マップされたデータの先頭を取得します.
+//-----------------------------------------------------------------------------
+const uint8_t* MappedFile::GetData() const
+{ return m_pData; }
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-----------------------------------------------------------------------------
+uint64_t MappedFile::GetSize() const
+{ return m_Size; }
+
+//-----------------------------------------------------------------------------
+//      マップ済みかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool MappedFile::IsOpen() const
+{ return m_pData != nullptr; }
+
+//-----------------------------------------------------------------------------
+//      開いたファイルをマップします.
+//-----------------------------------------------------------------------------
+bool MappedFile::Map()
+{
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0)
+    {
+        ELOGA("Error : Invalid File Size.");
+        Close();
+        return false;
+    }
+
+    m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_hMapping == nullptr)
+    {
+        ELOGA("Error : CreateFileMapping() Failed. errcode = 0x%x", GetLastError());
+        Close();
+        return false;
+    }
+
+    m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_pData == nullptr)
+    {
+        ELOGA("Error : MapViewOfFile() Failed. errcode = 0x%x", GetLastError());
+        Close();
+        return false;
+    }
+
+    m_Size = uint64_t(size.QuadPart);
+    return true;
+}
+
+} // namespace asdx
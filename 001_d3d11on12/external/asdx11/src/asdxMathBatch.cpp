@@ -0,0 +1,938 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMathBatch.cpp
+// Desc : Batched SIMD Math.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <asdxMathBatch.h>
+#include <atomic>
+#include <cstring>
+#include <intrin.h>
+#include <immintrin.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t FRUSTUM_PLANE_COUNT = 6;
+
+static_assert(sizeof(asdx::Vector3) == sizeof(float) * 3, "Vector3 Invalid Data Size");
+static_assert(sizeof(asdx::Vector4) == sizeof(float) * 4, "Vector4 Invalid Data Size");
+static_assert(sizeof(asdx::Matrix)  == sizeof(float) * 16, "Matrix Invalid Data Size");
+
+///////////////////////////////////////////////////////////////////////////////
+// TRANSFORM_MODE enum
+///////////////////////////////////////////////////////////////////////////////
+enum TRANSFORM_MODE
+{
+    TRANSFORM_MODE_POSITION = 0,    // Vector3::Transform() 相当.
+    TRANSFORM_MODE_COORD,           // Vector3::TransformCoord() 相当.
+    TRANSFORM_MODE_NORMAL,          // Vector3::TransformNormal() 相当.
+};
+
+//-----------------------------------------------------------------------------
+//      実行環境のSIMDレベルを調べます.
+//-----------------------------------------------------------------------------
+asdx::SIMD_LEVEL DetectSimdLevel()
+{
+    int info[4] = {};
+    __cpuid(info, 0);
+    auto maxId = info[0];
+
+    __cpuid(info, 1);
+    auto sse2    = (info[3] & (1 << 26)) != 0;
+    auto osxsave = (info[2] & (1 << 27)) != 0;
+    auto avx     = (info[2] & (1 << 28)) != 0;
+
+    // OS が YMM レジスタを保存する場合のみ AVX2 を使う.
+    if (maxId >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 5)) != 0)
+        { return asdx::SIMD_LEVEL_AVX2; }
+    }
+
+    return (sse2) ? asdx::SIMD_LEVEL_SSE2 : asdx::SIMD_LEVEL_SCALAR;
+}
+
+//-----------------------------------------------------------------------------
+//      使用するSIMDレベルを保持する変数を取得します.
+//-----------------------------------------------------------------------------
+std::atomic<int>& GetSimdLevelRef()
+{
+    static std::atomic<int> s_Level(int(asdx::GetSupportedSimdLevel()));
+    return s_Level;
+}
+
+//-----------------------------------------------------------------------------
+//      可視判定のビットを立てます.
+//-----------------------------------------------------------------------------
+inline void SetVisibility(uint32_t* pVisibility, size_t index, uint32_t bits)
+{ pVisibility[index / 32] |= bits << (index % 32); }
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Scalar
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      位置座標を変換します.
+//-----------------------------------------------------------------------------
+template<int Mode>
+void TransformScalar(const asdx::Vector3* pSrc, size_t count, const asdx::Matrix& m, asdx::Vector3* pDst)
+{
+    for(size_t i=0; i<count; ++i)
+    {
+        auto& v = pSrc[i];
+        if (Mode == TRANSFORM_MODE_POSITION)
+        { pDst[i] = asdx::Vector3::Transform(v, m); }
+        else if (Mode == TRANSFORM_MODE_COORD)
+        { pDst[i] = asdx::Vector3::TransformCoord(v, m); }
+        else
+        { pDst[i] = asdx::Vector3::TransformNormal(v, m); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      4次元ベクトルを変換します.
+//-----------------------------------------------------------------------------
+void TransformScalar(const asdx::Vector4* pSrc, size_t count, const asdx::Matrix& m, asdx::Vector4* pDst)
+{
+    for(size_t i=0; i<count; ++i)
+    { pDst[i] = asdx::Vector4::Transform(pSrc[i], m); }
+}
+
+//-----------------------------------------------------------------------------
+//      ベクトルを正規化します.
+//-----------------------------------------------------------------------------
+void NormalizeScalar(const asdx::Vector3* pSrc, size_t count, asdx::Vector3* pDst)
+{
+    for(size_t i=0; i<count; ++i)
+    {
+        auto& v  = pSrc[i];
+        auto mag = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        if (mag > 0.0f)
+        { pDst[i] = asdx::Vector3(v.x / mag, v.y / mag, v.z / mag); }
+        else
+        { pDst[i] = asdx::Vector3(0.0f, 0.0f, 0.0f); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      球と視錐台の交差判定を行います.
+//-----------------------------------------------------------------------------
+void CullSpheresScalar(const asdx::Vector4* planes, const asdx::Vector4* pSpheres, size_t offset, size_t count, uint32_t* pVisibility)
+{
+    for(auto i=offset; i<count; ++i)
+    {
+        auto& s = pSpheres[i];
+        auto visible = true;
+        for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+        {
+            auto& p = planes[j];
+            auto d = ((s.x * p.x + s.y * p.y) + s.z * p.z) + p.w;
+            visible &= (d >= -s.w);
+        }
+
+        if (visible)
+        { SetVisibility(pVisibility, i, 1); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      AABBと視錐台の交差判定を行います.
+//-----------------------------------------------------------------------------
+void CullBoxesScalar(const asdx::Vector4* planes, const asdx::Vector3* pMins, const asdx::Vector3* pMaxs, size_t offset, size_t count, uint32_t* pVisibility)
+{
+    for(auto i=offset; i<count; ++i)
+    {
+        auto visible = true;
+        for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+        {
+            // 法線方向に最も遠い頂点で判定する.
+            auto& p = planes[j];
+            auto x = (p.x >= 0.0f) ? pMaxs[i].x : pMins[i].x;
+            auto y = (p.y >= 0.0f) ? pMaxs[i].y : pMins[i].y;
+            auto z = (p.z >= 0.0f) ? pMaxs[i].z : pMins[i].z;
+            auto d = ((x * p.x + y * p.y) + z * p.z) + p.w;
+            visible &= (d >= 0.0f);
+        }
+
+        if (visible)
+        { SetVisibility(pVisibility, i, 1); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      スキニングを行います.
+//-----------------------------------------------------------------------------
+void SkinningScalar
+(
+    const asdx::Vector3*        pPositions,
+    const asdx::Vector3*        pNormals,
+    const asdx::ResBoneIndex*   pBoneIndices,
+    const asdx::Vector4*        pBoneWeights,
+    size_t                      offset,
+    size_t                      count,
+    const asdx::Matrix*         pBones,
+    asdx::Vector3*              pOutPositions,
+    asdx::Vector3*              pOutNormals
+)
+{
+    for(auto i=offset; i<count; ++i)
+    {
+        auto& idx = pBoneIndices[i];
+        auto& w   = pBoneWeights[i];
+        auto& b0  = pBones[idx.x];
+        auto& b1  = pBones[idx.y];
+        auto& b2  = pBones[idx.z];
+        auto& b3  = pBones[idx.w];
+
+        // 平行移動を含む4行3列のみブレンドする.
+        asdx::Matrix m;
+        for(auto r=0; r<4; ++r)
+        {
+            for(auto c=0; c<3; ++c)
+            { m.m[r][c] = ((b0.m[r][c] * w.x + b1.m[r][c] * w.y) + b2.m[r][c] * w.z) + b3.m[r][c] * w.w; }
+        }
+
+        auto pos = pPositions[i];
+        pOutPositions[i].x = ((pos.x * m._11 + pos.y * m._21) + pos.z * m._31) + m._41;
+        pOutPositions[i].y = ((pos.x * m._12 + pos.y * m._22) + pos.z * m._32) + m._42;
+        pOutPositions[i].z = ((pos.x * m._13 + pos.y * m._23) + pos.z * m._33) + m._43;
+
+        if (pNormals != nullptr)
+        {
+            auto nrm = pNormals[i];
+            pOutNormals[i].x = (nrm.x * m._11 + nrm.y * m._21) + nrm.z * m._31;
+            pOutNormals[i].y = (nrm.x * m._12 + nrm.y * m._22) + nrm.z * m._32;
+            pOutNormals[i].z = (nrm.x * m._13 + nrm.y * m._23) + nrm.z * m._33;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      4つの3次元ベクトルをSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+inline void LoadSoA(const asdx::Vector3* pSrc, __m128& x, __m128& y, __m128& z)
+{
+    auto ptr = reinterpret_cast<const float*>(pSrc);
+    auto a   = _mm_loadu_ps(ptr + 0);   // x0 y0 z0 x1
+    auto b   = _mm_loadu_ps(ptr + 4);   // y1 z1 x2 y2
+    auto c   = _mm_loadu_ps(ptr + 8);   // z2 x3 y3 z3
+
+    auto xy = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));   // x2 y2 x3 y3
+    auto yz = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));   // y0 z0 y1 z1
+    x = _mm_shuffle_ps(a,  xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(yz, c,  _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+//-----------------------------------------------------------------------------
+//      SoA形式の4つの3次元ベクトルを書き込みます.
+//-----------------------------------------------------------------------------
+inline void StoreSoA(asdx::Vector3* pDst, __m128 x, __m128 y, __m128 z)
+{
+    auto xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));   // x0 x2 y0 y2
+    auto yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));   // y1 y3 z1 z3
+    auto zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));   // z0 z2 x1 x3
+
+    auto ptr = reinterpret_cast<float*>(pDst);
+    _mm_storeu_ps(ptr + 0, _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(ptr + 4, _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_ps(ptr + 8, _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+//-----------------------------------------------------------------------------
+//      4つの4次元ベクトルをSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+inline void LoadSoA(const asdx::Vector4* pSrc, __m128& x, __m128& y, __m128& z, __m128& w)
+{
+    x = _mm_loadu_ps(&pSrc[0].x);
+    y = _mm_loadu_ps(&pSrc[1].x);
+    z = _mm_loadu_ps(&pSrc[2].x);
+    w = _mm_loadu_ps(&pSrc[3].x);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+}
+
+//-----------------------------------------------------------------------------
+//      3要素を書き込みます.
+//-----------------------------------------------------------------------------
+inline void StoreFloat3(asdx::Vector3* pDst, __m128 value)
+{
+    auto ptr = reinterpret_cast<float*>(pDst);
+    _mm_storel_pi(reinterpret_cast<__m64*>(ptr), value);
+    _mm_store_ss(ptr + 2, _mm_movehl_ps(value, value));
+}
+
+//-----------------------------------------------------------------------------
+//      位置座標を変換します.
+//-----------------------------------------------------------------------------
+template<int Mode>
+void TransformSSE2(const asdx::Vector3* pSrc, size_t count, const asdx::Matrix& m, asdx::Vector3* pDst)
+{
+    auto m11 = _mm_set1_ps(m._11); auto m12 = _mm_set1_ps(m._12); auto m13 = _mm_set1_ps(m._13); auto m14 = _mm_set1_ps(m._14);
+    auto m21 = _mm_set1_ps(m._21); auto m22 = _mm_set1_ps(m._22); auto m23 = _mm_set1_ps(m._23); auto m24 = _mm_set1_ps(m._24);
+    auto m31 = _mm_set1_ps(m._31); auto m32 = _mm_set1_ps(m._32); auto m33 = _mm_set1_ps(m._33); auto m34 = _mm_set1_ps(m._34);
+    auto m41 = _mm_set1_ps(m._41); auto m42 = _mm_set1_ps(m._42); auto m43 = _mm_set1_ps(m._43); auto m44 = _mm_set1_ps(m._44);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        LoadSoA(pSrc + i, x, y, z);
+
+        // スカラー版と同じ順序で演算して結果を一致させる.
+        auto X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m11), _mm_mul_ps(y, m21)), _mm_mul_ps(z, m31));
+        auto Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m12), _mm_mul_ps(y, m22)), _mm_mul_ps(z, m32));
+        auto Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m13), _mm_mul_ps(y, m23)), _mm_mul_ps(z, m33));
+
+        if (Mode != TRANSFORM_MODE_NORMAL)
+        {
+            X = _mm_add_ps(X, m41);
+            Y = _mm_add_ps(Y, m42);
+            Z = _mm_add_ps(Z, m43);
+        }
+
+        if (Mode == TRANSFORM_MODE_COORD)
+        {
+            auto W = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m14), _mm_mul_ps(y, m24)), _mm_mul_ps(z, m34)), m44);
+            X = _mm_div_ps(X, W);
+            Y = _mm_div_ps(Y, W);
+            Z = _mm_div_ps(Z, W);
+        }
+
+        StoreSoA(pDst + i, X, Y, Z);
+    }
+
+    TransformScalar<Mode>(pSrc + i, count - i, m, pDst + i);
+}
+
+//-----------------------------------------------------------------------------
+//      4次元ベクトルを変換します.
+//-----------------------------------------------------------------------------
+void TransformSSE2(const asdx::Vector4* pSrc, size_t count, const asdx::Matrix& m, asdx::Vector4* pDst)
+{
+    auto r0 = _mm_loadu_ps(&m._11);
+    auto r1 = _mm_loadu_ps(&m._21);
+    auto r2 = _mm_loadu_ps(&m._31);
+    auto r3 = _mm_loadu_ps(&m._41);
+
+    for(size_t i=0; i<count; ++i)
+    {
+        auto v = _mm_loadu_ps(&pSrc[i].x);
+        auto x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+        auto y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        auto z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+        auto w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+        auto r = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, r0), _mm_mul_ps(y, r1)), _mm_mul_ps(z, r2)), _mm_mul_ps(w, r3));
+        _mm_storeu_ps(&pDst[i].x, r);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ベクトルを正規化します.
+//-----------------------------------------------------------------------------
+void NormalizeSSE2(const asdx::Vector3* pSrc, size_t count, asdx::Vector3* pDst)
+{
+    auto zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        LoadSoA(pSrc + i, x, y, z);
+
+        auto mag  = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        auto mask = _mm_cmpgt_ps(mag, zero);
+
+        x = _mm_and_ps(_mm_div_ps(x, mag), mask);
+        y = _mm_and_ps(_mm_div_ps(y, mag), mask);
+        z = _mm_and_ps(_mm_div_ps(z, mag), mask);
+
+        StoreSoA(pDst + i, x, y, z);
+    }
+
+    NormalizeScalar(pSrc + i, count - i, pDst + i);
+}
+
+//-----------------------------------------------------------------------------
+//      球と視錐台の交差判定を行います.
+//-----------------------------------------------------------------------------
+void CullSpheresSSE2(const asdx::Vector4* planes, const asdx::Vector4* pSpheres, size_t count, uint32_t* pVisibility)
+{
+    __m128 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+    for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+    {
+        px[j] = _mm_set1_ps(planes[j].x);
+        py[j] = _mm_set1_ps(planes[j].y);
+        pz[j] = _mm_set1_ps(planes[j].z);
+        pw[j] = _mm_set1_ps(planes[j].w);
+    }
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z, r;
+        LoadSoA(pSpheres + i, x, y, z, r);
+
+        auto nr      = _mm_sub_ps(_mm_setzero_ps(), r);
+        auto visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+        {
+            auto d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, px[j]), _mm_mul_ps(y, py[j])), _mm_mul_ps(z, pz[j])), pw[j]);
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(d, nr));
+        }
+
+        SetVisibility(pVisibility, i, uint32_t(_mm_movemask_ps(visible)));
+    }
+
+    CullSpheresScalar(planes, pSpheres, i, count, pVisibility);
+}
+
+//-----------------------------------------------------------------------------
+//      AABBと視錐台の交差判定を行います.
+//-----------------------------------------------------------------------------
+void CullBoxesSSE2(const asdx::Vector4* planes, const asdx::Vector3* pMins, const asdx::Vector3* pMaxs, size_t count, uint32_t* pVisibility)
+{
+    __m128 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+    for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+    {
+        px[j] = _mm_set1_ps(planes[j].x);
+        py[j] = _mm_set1_ps(planes[j].y);
+        pz[j] = _mm_set1_ps(planes[j].z);
+        pw[j] = _mm_set1_ps(planes[j].w);
+    }
+
+    auto zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 minX, minY, minZ, maxX, maxY, maxZ;
+        LoadSoA(pMins + i, minX, minY, minZ);
+        LoadSoA(pMaxs + i, maxX, maxY, maxZ);
+
+        auto visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+        {
+            // 平面毎に法線方向に最も遠い頂点を選ぶ.
+            auto x = (planes[j].x >= 0.0f) ? maxX : minX;
+            auto y = (planes[j].y >= 0.0f) ? maxY : minY;
+            auto z = (planes[j].z >= 0.0f) ? maxZ : minZ;
+            auto d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, px[j]), _mm_mul_ps(y, py[j])), _mm_mul_ps(z, pz[j])), pw[j]);
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(d, zero));
+        }
+
+        SetVisibility(pVisibility, i, uint32_t(_mm_movemask_ps(visible)));
+    }
+
+    CullBoxesScalar(planes, pMins, pMaxs, i, count, pVisibility);
+}
+
+//-----------------------------------------------------------------------------
+//      スキニングを行います.
+//-----------------------------------------------------------------------------
+void SkinningSSE2
+(
+    const asdx::Vector3*        pPositions,
+    const asdx::Vector3*        pNormals,
+    const asdx::ResBoneIndex*   pBoneIndices,
+    const asdx::Vector4*        pBoneWeights,
+    size_t                      count,
+    const asdx::Matrix*         pBones,
+    asdx::Vector3*              pOutPositions,
+    asdx::Vector3*              pOutNormals
+)
+{
+    for(size_t i=0; i<count; ++i)
+    {
+        auto& idx = pBoneIndices[i];
+        auto  wv  = _mm_loadu_ps(&pBoneWeights[i].x);
+        auto  w0  = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(0, 0, 0, 0));
+        auto  w1  = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(1, 1, 1, 1));
+        auto  w2  = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(2, 2, 2, 2));
+        auto  w3  = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // ボーン行列を行単位でブレンド.
+        __m128 r[4];
+        for(auto k=0; k<4; ++k)
+        {
+            auto b0 = _mm_loadu_ps(pBones[idx.x].m[k]);
+            auto b1 = _mm_loadu_ps(pBones[idx.y].m[k]);
+            auto b2 = _mm_loadu_ps(pBones[idx.z].m[k]);
+            auto b3 = _mm_loadu_ps(pBones[idx.w].m[k]);
+            r[k] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, w0), _mm_mul_ps(b1, w1)), _mm_mul_ps(b2, w2)), _mm_mul_ps(b3, w3));
+        }
+
+        auto& pos = pPositions[i];
+        auto p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pos.x), r[0]), _mm_mul_ps(_mm_set1_ps(pos.y), r[1])), _mm_mul_ps(_mm_set1_ps(pos.z), r[2]));
+        StoreFloat3(pOutPositions + i, _mm_add_ps(p, r[3]));
+
+        if (pNormals != nullptr)
+        {
+            auto& nrm = pNormals[i];
+            auto n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(nrm.x), r[0]), _mm_mul_ps(_mm_set1_ps(nrm.y), r[1])), _mm_mul_ps(_mm_set1_ps(nrm.z), r[2]));
+            StoreFloat3(pOutNormals + i, n);
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      8つの3次元ベクトルをSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+inline void LoadSoA(const asdx::Vector3* pSrc, __m256& x, __m256& y, __m256& z)
+{
+    // 128bit レーン毎に SSE2 版と同じ並び替えを行う.
+    auto ptr = reinterpret_cast<const float*>(pSrc);
+    auto a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(ptr + 0)), _mm_loadu_ps(ptr + 12), 1);
+    auto b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(ptr + 4)), _mm_loadu_ps(ptr + 16), 1);
+    auto c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(ptr + 8)), _mm_loadu_ps(ptr + 20), 1);
+
+    auto xy = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    auto yz = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm256_shuffle_ps(a,  xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm256_shuffle_ps(yz, c,  _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+//-----------------------------------------------------------------------------
+//      SoA形式の8つの3次元ベクトルを書き込みます.
+//-----------------------------------------------------------------------------
+inline void StoreSoA(asdx::Vector3* pDst, __m256 x, __m256 y, __m256 z)
+{
+    auto xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    auto yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    auto zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+    auto a = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+    auto b = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    auto c = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+
+    auto ptr = reinterpret_cast<float*>(pDst);
+    _mm_storeu_ps(ptr +  0, _mm256_castps256_ps128(a));
+    _mm_storeu_ps(ptr +  4, _mm256_castps256_ps128(b));
+    _mm_storeu_ps(ptr +  8, _mm256_castps256_ps128(c));
+    _mm_storeu_ps(ptr + 12, _mm256_extractf128_ps(a, 1));
+    _mm_storeu_ps(ptr + 16, _mm256_extractf128_ps(b, 1));
+    _mm_storeu_ps(ptr + 20, _mm256_extractf128_ps(c, 1));
+}
+
+//-----------------------------------------------------------------------------
+//      8つの4次元ベクトルをSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+inline void LoadSoA(const asdx::Vector4* pSrc, __m256& x, __m256& y, __m256& z, __m256& w)
+{
+    auto r0 = _mm256_loadu2_m128(&pSrc[4].x, &pSrc[0].x);
+    auto r1 = _mm256_loadu2_m128(&pSrc[5].x, &pSrc[1].x);
+    auto r2 = _mm256_loadu2_m128(&pSrc[6].x, &pSrc[2].x);
+    auto r3 = _mm256_loadu2_m128(&pSrc[7].x, &pSrc[3].x);
+
+    auto t0 = _mm256_unpacklo_ps(r0, r1);
+    auto t1 = _mm256_unpacklo_ps(r2, r3);
+    auto t2 = _mm256_unpackhi_ps(r0, r1);
+    auto t3 = _mm256_unpackhi_ps(r2, r3);
+
+    x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    w = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+//-----------------------------------------------------------------------------
+//      位置座標を変換します.
+//-----------------------------------------------------------------------------
+template<int Mode>
+void TransformAVX2(const asdx::Vector3* pSrc, size_t count, const asdx::Matrix& m, asdx::Vector3* pDst)
+{
+    auto m11 = _mm256_set1_ps(m._11); auto m12 = _mm256_set1_ps(m._12); auto m13 = _mm256_set1_ps(m._13); auto m14 = _mm256_set1_ps(m._14);
+    auto m21 = _mm256_set1_ps(m._21); auto m22 = _mm256_set1_ps(m._22); auto m23 = _mm256_set1_ps(m._23); auto m24 = _mm256_set1_ps(m._24);
+    auto m31 = _mm256_set1_ps(m._31); auto m32 = _mm256_set1_ps(m._32); auto m33 = _mm256_set1_ps(m._33); auto m34 = _mm256_set1_ps(m._34);
+    auto m41 = _mm256_set1_ps(m._41); auto m42 = _mm256_set1_ps(m._42); auto m43 = _mm256_set1_ps(m._43); auto m44 = _mm256_set1_ps(m._44);
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z;
+        LoadSoA(pSrc + i, x, y, z);
+
+        // FMA は使わずスカラー版と同じ順序で演算する.
+        auto X = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m11), _mm256_mul_ps(y, m21)), _mm256_mul_ps(z, m31));
+        auto Y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m12), _mm256_mul_ps(y, m22)), _mm256_mul_ps(z, m32));
+        auto Z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m13), _mm256_mul_ps(y, m23)), _mm256_mul_ps(z, m33));
+
+        if (Mode != TRANSFORM_MODE_NORMAL)
+        {
+            X = _mm256_add_ps(X, m41);
+            Y = _mm256_add_ps(Y, m42);
+            Z = _mm256_add_ps(Z, m43);
+        }
+
+        if (Mode == TRANSFORM_MODE_COORD)
+        {
+            auto W = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m14), _mm256_mul_ps(y, m24)), _mm256_mul_ps(z, m34)), m44);
+            X = _mm256_div_ps(X, W);
+            Y = _mm256_div_ps(Y, W);
+            Z = _mm256_div_ps(Z, W);
+        }
+
+        StoreSoA(pDst + i, X, Y, Z);
+    }
+
+    _mm256_zeroupper();
+    TransformSSE2<Mode>(pSrc + i, count - i, m, pDst + i);
+}
+
+//-----------------------------------------------------------------------------
+//      4次元ベクトルを変換します.
+//-----------------------------------------------------------------------------
+void TransformAVX2(const asdx::Vector4* pSrc, size_t count, const asdx::Matrix& m, asdx::Vector4* pDst)
+{
+    auto r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m._11));
+    auto r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m._21));
+    auto r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m._31));
+    auto r3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m._41));
+
+    size_t i = 0;
+    for(; i + 2 <= count; i += 2)
+    {
+        auto v = _mm256_loadu_ps(&pSrc[i].x);
+        auto x = _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0));
+        auto y = _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1));
+        auto z = _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2));
+        auto w = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+        auto r = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, r0), _mm256_mul_ps(y, r1)), _mm256_mul_ps(z, r2)), _mm256_mul_ps(w, r3));
+        _mm256_storeu_ps(&pDst[i].x, r);
+    }
+
+    _mm256_zeroupper();
+    TransformSSE2(pSrc + i, count - i, m, pDst + i);
+}
+
+//-----------------------------------------------------------------------------
+//      ベクトルを正規化します.
+//-----------------------------------------------------------------------------
+void NormalizeAVX2(const asdx::Vector3* pSrc, size_t count, asdx::Vector3* pDst)
+{
+    auto zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z;
+        LoadSoA(pSrc + i, x, y, z);
+
+        auto mag  = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+        auto mask = _mm256_cmp_ps(mag, zero, _CMP_GT_OQ);
+
+        x = _mm256_and_ps(_mm256_div_ps(x, mag), mask);
+        y = _mm256_and_ps(_mm256_div_ps(y, mag), mask);
+        z = _mm256_and_ps(_mm256_div_ps(z, mag), mask);
+
+        StoreSoA(pDst + i, x, y, z);
+    }
+
+    _mm256_zeroupper();
+    NormalizeSSE2(pSrc + i, count - i, pDst + i);
+}
+
+//-----------------------------------------------------------------------------
+//      球と視錐台の交差判定を行います.
+//-----------------------------------------------------------------------------
+void CullSpheresAVX2(const asdx::Vector4* planes, const asdx::Vector4* pSpheres, size_t count, uint32_t* pVisibility)
+{
+    __m256 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+    for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+    {
+        px[j] = _mm256_set1_ps(planes[j].x);
+        py[j] = _mm256_set1_ps(planes[j].y);
+        pz[j] = _mm256_set1_ps(planes[j].z);
+        pw[j] = _mm256_set1_ps(planes[j].w);
+    }
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z, r;
+        LoadSoA(pSpheres + i, x, y, z, r);
+
+        auto nr      = _mm256_sub_ps(_mm256_setzero_ps(), r);
+        auto visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+        {
+            auto d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, px[j]), _mm256_mul_ps(y, py[j])), _mm256_mul_ps(z, pz[j])), pw[j]);
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, nr, _CMP_GE_OQ));
+        }
+
+        SetVisibility(pVisibility, i, uint32_t(_mm256_movemask_ps(visible)));
+    }
+
+    _mm256_zeroupper();
+    CullSpheresScalar(planes, pSpheres, i, count, pVisibility);
+}
+
+//-----------------------------------------------------------------------------
+//      AABBと視錐台の交差判定を行います.
+//-----------------------------------------------------------------------------
+void CullBoxesAVX2(const asdx::Vector4* planes, const asdx::Vector3* pMins, const asdx::Vector3* pMaxs, size_t count, uint32_t* pVisibility)
+{
+    __m256 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT], pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+    for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+    {
+        px[j] = _mm256_set1_ps(planes[j].x);
+        py[j] = _mm256_set1_ps(planes[j].y);
+        pz[j] = _mm256_set1_ps(planes[j].z);
+        pw[j] = _mm256_set1_ps(planes[j].w);
+    }
+
+    auto zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m256 minX, minY, minZ, maxX, maxY, maxZ;
+        LoadSoA(pMins + i, minX, minY, minZ);
+        LoadSoA(pMaxs + i, maxX, maxY, maxZ);
+
+        auto visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for(auto j=0u; j<FRUSTUM_PLANE_COUNT; ++j)
+        {
+            auto x = (planes[j].x >= 0.0f) ? maxX : minX;
+            auto y = (planes[j].y >= 0.0f) ? maxY : minY;
+            auto z = (planes[j].z >= 0.0f) ? maxZ : minZ;
+            auto d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, px[j]), _mm256_mul_ps(y, py[j])), _mm256_mul_ps(z, pz[j])), pw[j]);
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+        }
+
+        SetVisibility(pVisibility, i, uint32_t(_mm256_movemask_ps(visible)));
+    }
+
+    _mm256_zeroupper();
+    CullBoxesScalar(planes, pMins, pMaxs, i, count, pVisibility);
+}
+
+//-----------------------------------------------------------------------------
+//      スキニングを行います.
+//-----------------------------------------------------------------------------
+void SkinningAVX2
+(
+    const asdx::Vector3*        pPositions,
+    const asdx::Vector3*        pNormals,
+    const asdx::ResBoneIndex*   pBoneIndices,
+    const asdx::Vector4*        pBoneWeights,
+    size_t                      count,
+    const asdx::Matrix*         pBones,
+    asdx::Vector3*              pOutPositions,
+    asdx::Vector3*              pOutNormals
+)
+{
+    for(size_t i=0; i<count; ++i)
+    {
+        auto& idx = pBoneIndices[i];
+        auto& wv  = pBoneWeights[i];
+        auto  w0  = _mm256_broadcast_ss(&wv.x);
+        auto  w1  = _mm256_broadcast_ss(&wv.y);
+        auto  w2  = _mm256_broadcast_ss(&wv.z);
+        auto  w3  = _mm256_broadcast_ss(&wv.w);
+
+        // ボーン行列を2行ずつブレンド.
+        __m256 r[2];
+        for(auto k=0; k<2; ++k)
+        {
+            auto b0 = _mm256_loadu_ps(pBones[idx.x].m[k * 2]);
+            auto b1 = _mm256_loadu_ps(pBones[idx.y].m[k * 2]);
+            auto b2 = _mm256_loadu_ps(pBones[idx.z].m[k * 2]);
+            auto b3 = _mm256_loadu_ps(pBones[idx.w].m[k * 2]);
+            r[k] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, w0), _mm256_mul_ps(b1, w1)), _mm256_mul_ps(b2, w2)), _mm256_mul_ps(b3, w3));
+        }
+
+        // 上位レーンと下位レーンを足し合わせてスカラー版と同じ順序で変換する.
+        auto& pos = pPositions[i];
+        auto p01 = _mm256_mul_ps(_mm256_setr_ps(pos.x, pos.x, pos.x, pos.x, pos.y, pos.y, pos.y, pos.y), r[0]);
+        auto p2  = _mm_mul_ps(_mm_set1_ps(pos.z), _mm256_castps256_ps128(r[1]));
+        auto p   = _mm_add_ps(_mm_add_ps(_mm256_castps256_ps128(p01), _mm256_extractf128_ps(p01, 1)), p2);
+        StoreFloat3(pOutPositions + i, _mm_add_ps(p, _mm256_extractf128_ps(r[1], 1)));
+
+        if (pNormals != nullptr)
+        {
+            auto& nrm = pNormals[i];
+            auto n01 = _mm256_mul_ps(_mm256_setr_ps(nrm.x, nrm.x, nrm.x, nrm.x, nrm.y, nrm.y, nrm.y, nrm.y), r[0]);
+            auto n2  = _mm_mul_ps(_mm_set1_ps(nrm.z), _mm256_castps256_ps128(r[1]));
+            StoreFloat3(pOutNormals + i, _mm_add_ps(_mm_add_ps(_mm256_castps256_ps128(n01), _mm256_extractf128_ps(n01, 1)), n2));
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+} // namespace
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+//      実行環境でサポートされる最大のSIMDレベルを取得します.
+//-----------------------------------------------------------------------------
+SIMD_LEVEL GetSupportedSimdLevel()
+{
+    static const SIMD_LEVEL s_Level = DetectSimdLevel();
+    return s_Level;
+}
+
+//-----------------------------------------------------------------------------
+//      バッチ処理に使用するSIMDレベルを取得します.
+//-----------------------------------------------------------------------------
+SIMD_LEVEL GetSimdLevel()
+{ return SIMD_LEVEL(GetSimdLevelRef().load(std::memory_order_relaxed)); }
+
+//-----------------------------------------------------------------------------
+//      バッチ処理に使用するSIMDレベルを設定します.
+//-----------------------------------------------------------------------------
+void SetSimdLevel(SIMD_LEVEL level)
+{
+    auto supported = GetSupportedSimdLevel();
+    if (level > supported)
+    { level = supported; }
+
+    GetSimdLevelRef().store(int(level), std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//      位置座標をまとめて変換します.
+//-----------------------------------------------------------------------------
+void TransformBatch(const Vector3* pSrc, size_t count, const Matrix& matrix, Vector3* pDst)
+{
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { TransformAVX2<TRANSFORM_MODE_POSITION>(pSrc, count, matrix, pDst); } break;
+    case SIMD_LEVEL_SSE2: { TransformSSE2<TRANSFORM_MODE_POSITION>(pSrc, count, matrix, pDst); } break;
+    default:              { TransformScalar<TRANSFORM_MODE_POSITION>(pSrc, count, matrix, pDst); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      位置座標をまとめて変換し，w=1に射影します.
+//-----------------------------------------------------------------------------
+void TransformCoordBatch(const Vector3* pSrc, size_t count, const Matrix& matrix, Vector3* pDst)
+{
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { TransformAVX2<TRANSFORM_MODE_COORD>(pSrc, count, matrix, pDst); } break;
+    case SIMD_LEVEL_SSE2: { TransformSSE2<TRANSFORM_MODE_COORD>(pSrc, count, matrix, pDst); } break;
+    default:              { TransformScalar<TRANSFORM_MODE_COORD>(pSrc, count, matrix, pDst); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      法線ベクトルをまとめて変換します.
+//-----------------------------------------------------------------------------
+void TransformNormalBatch(const Vector3* pSrc, size_t count, const Matrix& matrix, Vector3* pDst)
+{
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { TransformAVX2<TRANSFORM_MODE_NORMAL>(pSrc, count, matrix, pDst); } break;
+    case SIMD_LEVEL_SSE2: { TransformSSE2<TRANSFORM_MODE_NORMAL>(pSrc, count, matrix, pDst); } break;
+    default:              { TransformScalar<TRANSFORM_MODE_NORMAL>(pSrc, count, matrix, pDst); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      4次元ベクトルをまとめて変換します.
+//-----------------------------------------------------------------------------
+void TransformBatch(const Vector4* pSrc, size_t count, const Matrix& matrix, Vector4* pDst)
+{
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { TransformAVX2(pSrc, count, matrix, pDst); } break;
+    case SIMD_LEVEL_SSE2: { TransformSSE2(pSrc, count, matrix, pDst); } break;
+    default:              { TransformScalar(pSrc, count, matrix, pDst); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ベクトルをまとめて正規化します.
+//-----------------------------------------------------------------------------
+void NormalizeBatch(const Vector3* pSrc, size_t count, Vector3* pDst)
+{
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { NormalizeAVX2(pSrc, count, pDst); } break;
+    case SIMD_LEVEL_SSE2: { NormalizeSSE2(pSrc, count, pDst); } break;
+    default:              { NormalizeScalar(pSrc, count, pDst); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      球と視錐台の交差判定をまとめて行います.
+//-----------------------------------------------------------------------------
+void CullSpheres(const Vector4* planes, const Vector4* pSpheres, size_t count, uint32_t* pVisibility)
+{
+    memset(pVisibility, 0, sizeof(uint32_t) * ((count + 31) / 32));
+
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { CullSpheresAVX2(planes, pSpheres, count, pVisibility); } break;
+    case SIMD_LEVEL_SSE2: { CullSpheresSSE2(planes, pSpheres, count, pVisibility); } break;
+    default:              { CullSpheresScalar(planes, pSpheres, 0, count, pVisibility); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      AABBと視錐台の交差判定をまとめて行います.
+//-----------------------------------------------------------------------------
+void CullBoxes(const Vector4* planes, const Vector3* pMins, const Vector3* pMaxs, size_t count, uint32_t* pVisibility)
+{
+    memset(pVisibility, 0, sizeof(uint32_t) * ((count + 31) / 32));
+
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { CullBoxesAVX2(planes, pMins, pMaxs, count, pVisibility); } break;
+    case SIMD_LEVEL_SSE2: { CullBoxesSSE2(planes, pMins, pMaxs, count, pVisibility); } break;
+    default:              { CullBoxesScalar(planes, pMins, pMaxs, 0, count, pVisibility); } break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      4ボーンの線形ブレンドスキニングをまとめて行います.
+//-----------------------------------------------------------------------------
+void SkinningBatch
+(
+    const Vector3*      pPositions,
+    const Vector3*      pNormals,
+    const ResBoneIndex* pBoneIndices,
+    const Vector4*      pBoneWeights,
+    size_t              count,
+    const Matrix*       pBones,
+    Vector3*            pOutPositions,
+    Vector3*            pOutNormals
+)
+{
+    if (pOutNormals == nullptr)
+    { pNormals = nullptr; }
+
+    switch(GetSimdLevel())
+    {
+    case SIMD_LEVEL_AVX2: { SkinningAVX2(pPositions, pNormals, pBoneIndices, pBoneWeights, count, pBones, pOutPositions, pOutNormals); } break;
+    case SIMD_LEVEL_SSE2: { SkinningSSE2(pPositions, pNormals, pBoneIndices, pBoneWeights, count, pBones, pOutPositions, pOutNormals); } break;
+    default:              { SkinningScalar(pPositions, pNormals, pBoneIndices, pBoneWeights, 0, count, pBones, pOutPositions, pOutNormals); } break;
+    }
+}
+
+} // namespace asdx
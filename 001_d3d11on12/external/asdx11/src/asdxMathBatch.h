@@ -0,0 +1,146 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMathBatch.h
+// Desc : Batched SIMD Math.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+#include <asdxMath.h>
+#include <asdxResModel.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// SIMD_LEVEL enum
+///////////////////////////////////////////////////////////////////////////////
+enum SIMD_LEVEL
+{
+    SIMD_LEVEL_SCALAR = 0,      //!< スカラー実装.
+    SIMD_LEVEL_SSE2,            //!< SSE2実装.
+    SIMD_LEVEL_AVX2,            //!< AVX2実装.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      実行環境でサポートされる最大のSIMDレベルを取得します.
+//-----------------------------------------------------------------------------
+SIMD_LEVEL GetSupportedSimdLevel();
+
+//-----------------------------------------------------------------------------
+//! @brief      バッチ処理に使用するSIMDレベルを取得します.
+//-----------------------------------------------------------------------------
+SIMD_LEVEL GetSimdLevel();
+
+//-----------------------------------------------------------------------------
+//! @brief      バッチ処理に使用するSIMDレベルを設定します.
+//!             サポートされていないレベルが指定された場合は最大レベルに丸められます.
+//!
+//! @param[in]      level       SIMDレベル.
+//-----------------------------------------------------------------------------
+void SetSimdLevel(SIMD_LEVEL level);
+
+//-----------------------------------------------------------------------------
+//! @brief      位置座標をまとめて変換します. Vector3::Transform() と同じ結果になります.
+//!
+//! @param[in]      pSrc        入力ベクトル配列.
+//! @param[in]      count       要素数.
+//! @param[in]      matrix      変換行列.
+//! @param[out]     pDst        出力ベクトル配列(pSrc と同じでも可).
+//-----------------------------------------------------------------------------
+void TransformBatch(const Vector3* pSrc, size_t count, const Matrix& matrix, Vector3* pDst);
+
+//-----------------------------------------------------------------------------
+//! @brief      位置座標をまとめて変換し，w=1に射影します.
+//!             Vector3::TransformCoord() と同じ結果になります.
+//!
+//! @param[in]      pSrc        入力ベクトル配列.
+//! @param[in]      count       要素数.
+//! @param[in]      matrix      変換行列.
+//! @param[out]     pDst        出力ベクトル配列(pSrc と同じでも可).
+//-----------------------------------------------------------------------------
+void TransformCoordBatch(const Vector3* pSrc, size_t count, const Matrix& matrix, Vector3* pDst);
+
+//-----------------------------------------------------------------------------
+//! @brief      法線ベクトルをまとめて変換します.
+//!             Vector3::TransformNormal() と同じ結果になります.
+//!
+//! @param[in]      pSrc        入力ベクトル配列.
+//! @param[in]      count       要素数.
+//! @param[in]      matrix      変換行列.
+//! @param[out]     pDst        出力ベクトル配列(pSrc と同じでも可).
+//-----------------------------------------------------------------------------
+void TransformNormalBatch(const Vector3* pSrc, size_t count, const Matrix& matrix, Vector3* pDst);
+
+//-----------------------------------------------------------------------------
+//! @brief      4次元ベクトルをまとめて変換します.
+//!             Vector4::Transform() と同じ結果になります.
+//!
+//! @param[in]      pSrc        入力ベクトル配列.
+//! @param[in]      count       要素数.
+//! @param[in]      matrix      変換行列.
+//! @param[out]     pDst        出力ベクトル配列(pSrc と同じでも可).
+//-----------------------------------------------------------------------------
+void TransformBatch(const Vector4* pSrc, size_t count, const Matrix& matrix, Vector4* pDst);
+
+//-----------------------------------------------------------------------------
+//! @brief      ベクトルをまとめて正規化します.
+//!             長さが0のベクトルは零ベクトルを出力します.
+//!
+//! @param[in]      pSrc        入力ベクトル配列.
+//! @param[in]      count       要素数.
+//! @param[out]     pDst        出力ベクトル配列(pSrc と同じでも可).
+//-----------------------------------------------------------------------------
+void NormalizeBatch(const Vector3* pSrc, size_t count, Vector3* pDst);
+
+//-----------------------------------------------------------------------------
+//! @brief      球と視錐台の交差判定をまとめて行います.
+//!
+//! @param[in]      planes      CalcFrustumPlanes() で求めた6平面.
+//! @param[in]      pSpheres    球の配列(xyzが中心, wが半径).
+//! @param[in]      count       要素数.
+//! @param[out]     pVisibility 可視判定の格納先((count + 31) / 32 個).
+//!                             i番目の要素が可視なら i / 32 番目の要素の i % 32 ビット目が立ちます.
+//-----------------------------------------------------------------------------
+void CullSpheres(const Vector4* planes, const Vector4* pSpheres, size_t count, uint32_t* pVisibility);
+
+//-----------------------------------------------------------------------------
+//! @brief      AABBと視錐台の交差判定をまとめて行います.
+//!
+//! @param[in]      planes      CalcFrustumPlanes() で求めた6平面.
+//! @param[in]      pMins       AABBの最小値の配列.
+//! @param[in]      pMaxs       AABBの最大値の配列.
+//! @param[in]      count       要素数.
+//! @param[out]     pVisibility 可視判定の格納先((count + 31) / 32 個).
+//!                             i番目の要素が可視なら i / 32 番目の要素の i % 32 ビット目が立ちます.
+//-----------------------------------------------------------------------------
+void CullBoxes(const Vector4* planes, const Vector3* pMins, const Vector3* pMaxs, size_t count, uint32_t* pVisibility);
+
+//-----------------------------------------------------------------------------
+//! @brief      4ボーンの線形ブレンドスキニングをまとめて行います.
+//!             ボーン行列を重みでブレンドしてから変換します.
+//!
+//! @param[in]      pPositions      入力位置座標.
+//! @param[in]      pNormals        入力法線ベクトル(nullptr可).
+//! @param[in]      pBoneIndices    ボーン番号.
+//! @param[in]      pBoneWeights    ボーンの重み.
+//! @param[in]      count           頂点数.
+//! @param[in]      pBones          ボーン行列の配列.
+//! @param[out]     pOutPositions   出力位置座標.
+//! @param[out]     pOutNormals     出力法線ベクトル(pNormals が nullptr の場合は無視されます).
+//-----------------------------------------------------------------------------
+void SkinningBatch(
+    const Vector3*      pPositions,
+    const Vector3*      pNormals,
+    const ResBoneIndex* pBoneIndices,
+    const Vector4*      pBoneWeights,
+    size_t              count,
+    const Matrix*       pBones,
+    Vector3*            pOutPositions,
+    Vector3*            pOutNormals);
+
+} // namespace asdx
@@ -0,0 +1,715 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMeshOptimizer.cpp
+// Desc : Mesh Optimizer.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+#include <asdxMeshOptimizer.h>
+#include <asdxHash.h>
+#include <asdxLogger.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t   INVALID_INDEX           = UINT32_MAX;
+static const uint32_t   FORSYTH_CACHE_SIZE      = 32;       // スコア計算に用いる LRU キャッシュサイズ.
+static const uint32_t   FORSYTH_VALENCE_SIZE    = 64;       // 事前計算する残り三角形数の上限.
+static const float      FORSYTH_DECAY_POWER     = 1.5f;
+static const float      FORSYTH_LAST_TRI_SCORE  = 0.75f;
+static const float      FORSYTH_VALENCE_SCALE   = 2.0f;
+static const float      FORSYTH_VALENCE_POWER   = 0.5f;
+
+//-----------------------------------------------------------------------------
+//      全ての頂点ストリームに対して処理を行います.
+//-----------------------------------------------------------------------------
+template<typename Mesh, typename Func>
+void ForEachStream(Mesh& mesh, Func func)
+{
+    func(mesh.Positions);
+    func(mesh.Normals);
+    func(mesh.Tangents);
+    func(mesh.Bitangents);
+    func(mesh.Colors);
+    for(auto i=0; i<MAX_LAYER_COUNT; ++i)
+    { func(mesh.TexCoords[i]); }
+    func(mesh.BoneIndices);
+    func(mesh.BoneWeights);
+}
+
+//-----------------------------------------------------------------------------
+//      1頂点当たりのデータサイズを求めます.
+//-----------------------------------------------------------------------------
+uint32_t GetVertexStride(const asdx::ResMesh& mesh)
+{
+    uint32_t stride = 0;
+    ForEachStream(mesh, [&](const auto& stream)
+    {
+        if (!stream.empty())
+        { stride += uint32_t(sizeof(stream[0])); }
+    });
+    return stride;
+}
+
+//-----------------------------------------------------------------------------
+//      最適化可能なメッシュかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool ValidateMesh(const asdx::ResMesh& mesh)
+{
+    auto vertexCount = mesh.Positions.size();
+    if (vertexCount >= INVALID_INDEX)
+    {
+        ELOG("Error : Too many vertices. MeshName = %s", mesh.MeshName.c_str());
+        return false;
+    }
+
+    auto valid = true;
+    ForEachStream(mesh, [&](const auto& stream)
+    {
+        if (!stream.empty() && stream.size() != vertexCount)
+        { valid = false; }
+    });
+
+    if (!valid)
+    {
+        ELOG("Error : Vertex stream size mismatch. MeshName = %s", mesh.MeshName.c_str());
+        return false;
+    }
+
+    if (mesh.Indices.size() % 3 != 0)
+    {
+        ELOG("Error : Index count is not a multiple of 3. MeshName = %s", mesh.MeshName.c_str());
+        return false;
+    }
+
+    for(auto& index : mesh.Indices)
+    {
+        if (index >= vertexCount)
+        {
+            ELOG("Error : Index out of range. MeshName = %s, Index = %u", mesh.MeshName.c_str(), index);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      指定された頂点番号の順にストリームを詰め直します.
+//-----------------------------------------------------------------------------
+void GatherVertices(asdx::ResMesh& mesh, const std::vector<uint32_t>& order)
+{
+    ForEachStream(mesh, [&](auto& stream)
+    {
+        if (stream.empty())
+        { return; }
+
+        typename std::remove_reference<decltype(stream)>::type temp(order.size());
+        for(size_t i=0; i<order.size(); ++i)
+        { temp[i] = stream[order[i]]; }
+
+        stream.swap(temp);
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      2のべき乗に切り上げます.
+//-----------------------------------------------------------------------------
+inline size_t NextPow2(size_t value)
+{
+    size_t result = 1;
+    while(result < value)
+    { result <<= 1; }
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ForsythScore class
+///////////////////////////////////////////////////////////////////////////////
+class ForsythScore
+{
+public:
+    ForsythScore()
+    {
+        for(auto i=0u; i<FORSYTH_CACHE_SIZE; ++i)
+        {
+            // 直前の三角形で使った頂点は, 次の三角形で再利用しにくいので固定値にする.
+            if (i < 3)
+            { m_CacheScore[i] = FORSYTH_LAST_TRI_SCORE; }
+            else
+            {
+                auto scale = 1.0f / float(FORSYTH_CACHE_SIZE - 3);
+                m_CacheScore[i] = powf(1.0f - float(i - 3) * scale, FORSYTH_DECAY_POWER);
+            }
+        }
+
+        m_ValenceScore[0] = 0.0f;
+        for(auto i=1u; i<FORSYTH_VALENCE_SIZE; ++i)
+        { m_ValenceScore[i] = FORSYTH_VALENCE_SCALE * powf(float(i), -FORSYTH_VALENCE_POWER); }
+    }
+
+    float Calc(uint32_t cachePos, uint32_t remaining) const
+    {
+        // 残り三角形が無い頂点は選ばない.
+        if (remaining == 0)
+        { return -1.0f; }
+
+        auto score = (cachePos < FORSYTH_CACHE_SIZE) ? m_CacheScore[cachePos] : 0.0f;
+        score += (remaining < FORSYTH_VALENCE_SIZE)
+            ? m_ValenceScore[remaining]
+            : FORSYTH_VALENCE_SCALE * powf(float(remaining), -FORSYTH_VALENCE_POWER);
+        return score;
+    }
+
+private:
+    float m_CacheScore  [FORSYTH_CACHE_SIZE];
+    float m_ValenceScore[FORSYTH_VALENCE_SIZE];
+};
+
+//-----------------------------------------------------------------------------
+//      三角形の順番を並び替えます(Tom Forsyth, "Linear-Speed Vertex Cache Optimisation").
+//-----------------------------------------------------------------------------
+void SortTriangles(const std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& result)
+{
+    static const ForsythScore s_Score;
+
+    auto triCount = uint32_t(indices.size() / 3);
+
+    // 頂点から三角形を引ける隣接リストを作る.
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for(auto& index : indices)
+    { remaining[index]++; }
+
+    std::vector<uint32_t> adjOffset(size_t(vertexCount) + 1, 0);
+    for(auto i=0u; i<vertexCount; ++i)
+    { adjOffset[i + 1] = adjOffset[i] + remaining[i]; }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> cursor(adjOffset.begin(), adjOffset.end() - 1);
+        for(auto i=0u; i<triCount; ++i)
+        {
+            for(auto j=0; j<3; ++j)
+            { adjacency[cursor[indices[i * 3 + j]]++] = i; }
+        }
+    }
+
+    std::vector<float> vertexScore(vertexCount);
+    for(auto i=0u; i<vertexCount; ++i)
+    { vertexScore[i] = s_Score.Calc(INVALID_INDEX, remaining[i]); }
+
+    std::vector<uint8_t> triAdded(triCount, 0);
+
+    auto bestTri   = INVALID_INDEX;
+    auto bestScore = -1.0f;
+    for(auto i=0u; i<triCount; ++i)
+    {
+        auto i0 = indices[i * 3 + 0];
+        auto i1 = indices[i * 3 + 1];
+        auto i2 = indices[i * 3 + 2];
+        auto score = vertexScore[i0] + vertexScore[i1] + vertexScore[i2];
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestTri   = i;
+        }
+    }
+
+    // 先頭に追加した3頂点の分だけ溢れる領域を持っておく.
+    uint32_t cache   [FORSYTH_CACHE_SIZE + 3];
+    uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t cacheCount = 0;
+
+    uint32_t scanPos = 0;
+
+    result.resize(indices.size());
+    for(auto t=0u; t<triCount; ++t)
+    {
+        // キャッシュ内の頂点から候補が見つからなければ未出力の三角形から選ぶ.
+        if (bestTri == INVALID_INDEX)
+        {
+            while(triAdded[scanPos])
+            { scanPos++; }
+            bestTri = scanPos;
+        }
+
+        triAdded[bestTri] = 1;
+
+        uint32_t newCount = 0;
+        for(auto j=0; j<3; ++j)
+        {
+            auto v = indices[bestTri * 3 + j];
+            result[t * 3 + j] = v;
+
+            // 隣接リストから出力した三角形を取り除く.
+            auto begin = adjOffset[v];
+            auto end   = begin + remaining[v];
+            for(auto k=begin; k<end; ++k)
+            {
+                if (adjacency[k] == bestTri)
+                {
+                    adjacency[k] = adjacency[end - 1];
+                    break;
+                }
+            }
+            remaining[v]--;
+
+            // 縮退三角形では書き込み済みの数が j より少ないので, 書き込んだ分とだけ比較する.
+            auto dup = false;
+            for(auto k=0u; k<newCount; ++k)
+            { dup |= (v == newCache[k]); }
+
+            if (!dup)
+            { newCache[newCount++] = v; }
+        }
+
+        for(auto i=0u; i<cacheCount; ++i)
+        {
+            auto v = cache[i];
+            auto hit = false;
+            for(auto j=0u; j<3 && j<newCount; ++j)
+            { hit |= (v == newCache[j]); }
+
+            if (!hit)
+            { newCache[newCount++] = v; }
+        }
+
+        // キャッシュ位置を更新し，影響のある頂点と三角形のスコアを計算し直す.
+        for(auto i=0u; i<newCount; ++i)
+        {
+            auto v = newCache[i];
+            vertexScore[v] = s_Score.Calc((i < FORSYTH_CACHE_SIZE) ? i : INVALID_INDEX, remaining[v]);
+        }
+
+        bestTri   = INVALID_INDEX;
+        bestScore = -1.0f;
+        for(auto i=0u; i<newCount; ++i)
+        {
+            auto v     = newCache[i];
+            auto begin = adjOffset[v];
+            auto end   = begin + remaining[v];
+            for(auto k=begin; k<end; ++k)
+            {
+                auto tri = adjacency[k];
+                auto score = vertexScore[indices[tri * 3 + 0]]
+                           + vertexScore[indices[tri * 3 + 1]]
+                           + vertexScore[indices[tri * 3 + 2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTri   = tri;
+                }
+            }
+        }
+
+        cacheCount = (newCount < FORSYTH_CACHE_SIZE) ? newCount : FORSYTH_CACHE_SIZE;
+        memcpy(cache, newCache, sizeof(uint32_t) * cacheCount);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットのカリング情報を計算します.
+//-----------------------------------------------------------------------------
+asdx::ResMeshletBounds CalcMeshletBounds
+(
+    const asdx::ResMesh&        mesh,
+    const asdx::ResMeshlets&    meshlets,
+    const asdx::ResMeshlet&     meshlet
+)
+{
+    asdx::ResMeshletBounds bounds = {};
+
+    auto pVertices = meshlets.UniqueVertexIndices.data() + meshlet.VertexOffset;
+    auto pPrims    = meshlets.PrimitiveIndices.data() + size_t(meshlet.PrimitiveOffset) * 3;
+
+    // AABB の中心を球の中心とする.
+    auto mini = mesh.Positions[pVertices[0]];
+    auto maxi = mini;
+    for(auto i=1u; i<meshlet.VertexCount; ++i)
+    {
+        auto& p = mesh.Positions[pVertices[i]];
+        mini = asdx::Vector3::Min(mini, p);
+        maxi = asdx::Vector3::Max(maxi, p);
+    }
+
+    bounds.Center = (mini + maxi) * 0.5f;
+    for(auto i=0u; i<meshlet.VertexCount; ++i)
+    {
+        auto dist = asdx::Vector3::Distance(bounds.Center, mesh.Positions[pVertices[i]]);
+        bounds.Radius = asdx::Max(bounds.Radius, dist);
+    }
+
+    // 法線コーン.
+    std::vector<asdx::Vector3> normals;
+    normals.reserve(meshlet.PrimitiveCount);
+
+    asdx::Vector3 axis(0.0f, 0.0f, 0.0f);
+    for(auto i=0u; i<meshlet.PrimitiveCount; ++i)
+    {
+        auto& p0 = mesh.Positions[pVertices[pPrims[i * 3 + 0]]];
+        auto& p1 = mesh.Positions[pVertices[pPrims[i * 3 + 1]]];
+        auto& p2 = mesh.Positions[pVertices[pPrims[i * 3 + 2]]];
+
+        auto n   = asdx::Vector3::Cross(p1 - p0, p2 - p0);
+        auto len = n.Length();
+        if (len <= 0.0f)
+        {
+            normals.push_back(asdx::Vector3(0.0f, 0.0f, 0.0f));
+            continue;
+        }
+
+        n *= 1.0f / len;
+        normals.push_back(n);
+        axis += n;
+    }
+
+    bounds.ConeApex   = bounds.Center;
+    bounds.ConeAxis   = asdx::Vector3(0.0f, 0.0f, 1.0f);
+    bounds.ConeCutoff = 1.0f;
+
+    auto axisLen = axis.Length();
+    if (axisLen <= 0.0f)
+    { return bounds; }
+    axis *= 1.0f / axisLen;
+
+    auto minDot = 1.0f;
+    for(auto& n : normals)
+    {
+        if (n.x == 0.0f && n.y == 0.0f && n.z == 0.0f)
+        { continue; }
+        minDot = asdx::Min(minDot, asdx::Vector3::Dot(axis, n));
+    }
+
+    // 半球以上に広がる場合はカリングできない.
+    bounds.ConeAxis = axis;
+    if (minDot <= 0.0f)
+    { return bounds; }
+
+    // 全ての三角形の平面より背後に頂点を置く.
+    auto maxT = 0.0f;
+    for(auto i=0u; i<meshlet.PrimitiveCount; ++i)
+    {
+        auto& n = normals[i];
+        if (n.x == 0.0f && n.y == 0.0f && n.z == 0.0f)
+        { continue; }
+
+        auto& p0 = mesh.Positions[pVertices[pPrims[i * 3 + 0]]];
+        auto t = asdx::Vector3::Dot(bounds.Center - p0, n) / asdx::Vector3::Dot(axis, n);
+        maxT = asdx::Max(maxT, t);
+    }
+
+    bounds.ConeApex   = bounds.Center - axis * maxT;
+    bounds.ConeCutoff = sqrtf(1.0f - minDot * minDot);
+
+    return bounds;
+}
+
+} // namespace
+
+
+namespace asdx {
+
+//-----------------------------------------------------------------------------
+//      FIFO 頂点キャッシュをシミュレートして統計情報を計算します.
+//-----------------------------------------------------------------------------
+ResMeshStats CalcMeshStats(const ResMesh& resource, uint32_t cacheSize)
+{
+    ResMeshStats stats = {};
+
+    auto vertexCount = uint32_t(resource.Positions.size());
+    stats.VertexCount   = vertexCount;
+    stats.TriangleCount = uint32_t(resource.Indices.size() / 3);
+    stats.VertexBytes   = uint64_t(vertexCount) * GetVertexStride(resource);
+    stats.IndexBytes    = uint64_t(resource.Indices.size()) * sizeof(uint32_t);
+
+    if (cacheSize == 0)
+    { cacheSize = DEFAULT_VERTEX_CACHE_SIZE; }
+
+    // キャッシュに入った時点のミス数を覚えておけば, FIFO の場合は cacheSize 回ミスした後に追い出される.
+    std::vector<uint32_t> timestamp(vertexCount, 0);
+    uint32_t misses     = 0;
+    uint32_t referenced = 0;
+    for(auto& index : resource.Indices)
+    {
+        if (index >= vertexCount)
+        { continue; }
+
+        auto& time = timestamp[index];
+        if (time == 0)
+        { referenced++; }
+
+        if (time == 0 || misses + 1 - time > cacheSize)
+        {
+            misses++;
+            time = misses;
+        }
+    }
+
+    stats.CacheMissCount = misses;
+    stats.ACMR = (stats.TriangleCount > 0) ? float(misses) / float(stats.TriangleCount) : 0.0f;
+    stats.ATVR = (referenced > 0)          ? float(misses) / float(referenced)          : 0.0f;
+
+    return stats;
+}
+
+//-----------------------------------------------------------------------------
+//      全ての頂点属性が一致する頂点を結合します.
+//-----------------------------------------------------------------------------
+uint32_t WeldVertices(ResMesh& resource)
+{
+    if (!ValidateMesh(resource))
+    { return 0; }
+
+    auto vertexCount = uint32_t(resource.Positions.size());
+    auto stride      = GetVertexStride(resource);
+    if (vertexCount == 0)
+    { return 0; }
+
+    // 頂点属性を1頂点ずつ連続したバイト列に並べる.
+    std::vector<uint8_t> keys(size_t(vertexCount) * stride);
+    {
+        size_t offset = 0;
+        ForEachStream(resource, [&](const auto& stream)
+        {
+            if (stream.empty())
+            { return; }
+
+            auto size = sizeof(stream[0]);
+            for(size_t i=0; i<stream.size(); ++i)
+            { memcpy(&keys[i * stride + offset], &stream[i], size); }
+            offset += size;
+        });
+    }
+
+    // オープンアドレス法のハッシュテーブルで同一の頂点を探す.
+    auto capacity = NextPow2(size_t(vertexCount) * 2);
+    auto mask     = capacity - 1;
+    std::vector<uint32_t> table (capacity, INVALID_INDEX);
+    std::vector<uint64_t> hashes(vertexCount);
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint32_t> order;
+    order.reserve(vertexCount);
+
+    for(auto i=0u; i<vertexCount; ++i)
+    {
+        auto pKey = &keys[size_t(i) * stride];
+        auto hash = CalcHash64(pKey, stride);
+        hashes[i] = hash;
+
+        auto slot = size_t(hash) & mask;
+        for(;;)
+        {
+            auto found = table[slot];
+            if (found == INVALID_INDEX)
+            {
+                table[slot] = i;
+                remap[i] = uint32_t(order.size());
+                order.push_back(i);
+                break;
+            }
+
+            if (hashes[found] == hash && memcmp(&keys[size_t(found) * stride], pKey, stride) == 0)
+            {
+                remap[i] = remap[found];
+                break;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    auto weldedCount = vertexCount - uint32_t(order.size());
+    if (weldedCount == 0)
+    { return 0; }
+
+    for(auto& index : resource.Indices)
+    { index = remap[index]; }
+
+    GatherVertices(resource, order);
+
+    return weldedCount;
+}
+
+//-----------------------------------------------------------------------------
+//      頂点キャッシュの効率が良くなるように三角形を並び替えます.
+//-----------------------------------------------------------------------------
+bool OptimizeVertexCache(ResMesh& resource)
+{
+    if (!ValidateMesh(resource))
+    { return false; }
+
+    if (resource.Indices.empty())
+    { return true; }
+
+    std::vector<uint32_t> indices;
+    SortTriangles(resource.Indices, uint32_t(resource.Positions.size()), indices);
+    resource.Indices.swap(indices);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      インデックスから参照される順に頂点を並び替えます.
+//-----------------------------------------------------------------------------
+bool OptimizeVertexFetch(ResMesh& resource)
+{
+    if (!ValidateMesh(resource))
+    { return false; }
+
+    auto vertexCount = uint32_t(resource.Positions.size());
+
+    std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+    std::vector<uint32_t> order;
+    order.reserve(vertexCount);
+
+    for(auto& index : resource.Indices)
+    {
+        if (remap[index] == INVALID_INDEX)
+        {
+            remap[index] = uint32_t(order.size());
+            order.push_back(index);
+        }
+        index = remap[index];
+    }
+
+    GatherVertices(resource, order);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      頂点の結合, 頂点キャッシュ最適化, 頂点フェッチ最適化を順に行います.
+//-----------------------------------------------------------------------------
+bool OptimizeMesh(ResMesh& resource, ResMeshOptimizeResult* pResult)
+{
+    if (!ValidateMesh(resource))
+    { return false; }
+
+    ResMeshOptimizeResult result = {};
+    result.Before = CalcMeshStats(resource);
+
+    result.WeldedCount = WeldVertices(resource);
+
+    if (!OptimizeVertexCache(resource))
+    { return false; }
+
+    if (!OptimizeVertexFetch(resource))
+    { return false; }
+
+    result.After = CalcMeshStats(resource);
+
+    if (pResult != nullptr)
+    { *pResult = result; }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      モデル内の全メッシュを最適化します.
+//-----------------------------------------------------------------------------
+bool OptimizeMesh(ResModel& resource)
+{
+    auto result = true;
+    for(auto& mesh : resource.Meshes)
+    { result &= OptimizeMesh(mesh); }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットを生成します.
+//-----------------------------------------------------------------------------
+bool BuildMeshlets
+(
+    const ResMesh&  resource,
+    uint32_t        maxVertices,
+    uint32_t        maxPrimitives,
+    ResMeshlets&    result
+)
+{
+    result.Meshlets            .clear();
+    result.Bounds              .clear();
+    result.UniqueVertexIndices .clear();
+    result.PrimitiveIndices    .clear();
+
+    if (maxVertices < 3 || maxVertices > MAX_MESHLET_VERTEX_COUNT || maxPrimitives == 0)
+    {
+        ELOG("Error : Invalid Argument. maxVertices = %u, maxPrimitives = %u", maxVertices, maxPrimitives);
+        return false;
+    }
+
+    if (!ValidateMesh(resource))
+    { return false; }
+
+    auto vertexCount = uint32_t(resource.Positions.size());
+    auto triCount    = uint32_t(resource.Indices.size() / 3);
+
+    result.UniqueVertexIndices.reserve(resource.Indices.size() / 2);
+    result.PrimitiveIndices   .reserve(resource.Indices.size());
+
+    // 頂点番号からメッシュレット内のローカル番号を引く.
+    std::vector<uint32_t> localIndex(vertexCount, INVALID_INDEX);
+
+    ResMeshlet meshlet = {};
+
+    auto flush = [&]()
+    {
+        if (meshlet.PrimitiveCount == 0)
+        { return; }
+
+        result.Meshlets.push_back(meshlet);
+        result.Bounds  .push_back(CalcMeshletBounds(resource, result, meshlet));
+
+        for(auto i=0u; i<meshlet.VertexCount; ++i)
+        { localIndex[result.UniqueVertexIndices[meshlet.VertexOffset + i]] = INVALID_INDEX; }
+
+        meshlet.VertexOffset    = uint32_t(result.UniqueVertexIndices.size());
+        meshlet.VertexCount     = 0;
+        meshlet.PrimitiveOffset = uint32_t(result.PrimitiveIndices.size() / 3);
+        meshlet.PrimitiveCount  = 0;
+    };
+
+    for(auto i=0u; i<triCount; ++i)
+    {
+        auto i0 = resource.Indices[i * 3 + 0];
+        auto i1 = resource.Indices[i * 3 + 1];
+        auto i2 = resource.Indices[i * 3 + 2];
+
+        // 縮退三角形で同じ頂点を重複して数えないようにする.
+        uint32_t newCount = 0;
+        newCount += (localIndex[i0] == INVALID_INDEX) ? 1 : 0;
+        newCount += (localIndex[i1] == INVALID_INDEX && i1 != i0) ? 1 : 0;
+        newCount += (localIndex[i2] == INVALID_INDEX && i2 != i0 && i2 != i1) ? 1 : 0;
+
+        if (meshlet.VertexCount + newCount > maxVertices || meshlet.PrimitiveCount + 1 > maxPrimitives)
+        { flush(); }
+
+        uint32_t tri[3] = { i0, i1, i2 };
+        for(auto j=0; j<3; ++j)
+        {
+            auto v = tri[j];
+            if (localIndex[v] == INVALID_INDEX)
+            {
+                localIndex[v] = meshlet.VertexCount++;
+                result.UniqueVertexIndices.push_back(v);
+            }
+            result.PrimitiveIndices.push_back(uint8_t(localIndex[v]));
+        }
+
+        meshlet.PrimitiveCount++;
+    }
+
+    flush();
+
+    return true;
+}
+
+} // namespace asdx
@@ -7,7 +7,12 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <thread>
+#include <algorithm>
+#include <immintrin.h>
 #include <asdxResModel.h>
+#include <asdxMathBatch.h>
+#include <asdxThreadPool.h>
 #include <asdxLogger.h>
 
 
@@ -64,6 +69,530 @@ union Unorm8888
 inline float Max3(const asdx::Vector3& value)
 { return asdx::Max(value.x, asdx::Max(value.y, value.z)); }
 
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const size_t PARALLEL_GRAIN_SIZE      = 16384;   //!< 1タスクで処理する要素数.
+static const size_t PARALLEL_MESH_THRESHOLD  = 65536;   //!< メッシュ内で並列化する最小三角形数.
+
+///////////////////////////////////////////////////////////////////////////////
+// SharedThreadPool structure
+///////////////////////////////////////////////////////////////////////////////
+struct SharedThreadPool
+{
+    asdx::ThreadPool    Pool;
+
+    SharedThreadPool()
+    {
+        // 呼び出し元スレッドも処理に参加するので，1スレッド分少なく起動する.
+        auto count = std::thread::hardware_concurrency();
+        Pool.Init((count > 1) ? count - 1 : 1);
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      法線・接線計算で共有するスレッドプールを取得します.
+//      呼び出しごとにスレッドを生成しないよう，初回呼び出し時に起動して使い回します.
+//-----------------------------------------------------------------------------
+asdx::ThreadPool& GetThreadPool()
+{
+    static SharedThreadPool s_Instance;
+    return s_Instance.Pool;
+}
+
+//-----------------------------------------------------------------------------
+//      [0, count) を分割して並列に処理します.
+//      各要素の結果は担当スレッドに依存しないため，出力は決定的です.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void ParallelFor(size_t count, bool parallel, Func func)
+{
+    auto chunkCount = (count + PARALLEL_GRAIN_SIZE - 1) / PARALLEL_GRAIN_SIZE;
+    if (!parallel || chunkCount <= 1)
+    {
+        func(size_t(0), count);
+        return;
+    }
+
+    GetThreadPool().ParallelFor(uint32_t(count), uint32_t(PARALLEL_GRAIN_SIZE), [&](uint32_t begin, uint32_t end)
+    { func(size_t(begin), size_t(end)); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VertexAdjacency structure
+///////////////////////////////////////////////////////////////////////////////
+struct VertexAdjacency
+{
+    std::vector<uint32_t>   Offsets;    //!< 頂点ごとの Faces の開始位置 (頂点数 + 1).
+    std::vector<uint32_t>   Faces;      //!< 頂点を参照する三角形番号 (昇順).
+};
+
+//-----------------------------------------------------------------------------
+//      頂点から三角形への隣接情報を構築します.
+//      三角形番号は昇順に並ぶため，集計順序は逐次処理と一致します.
+//-----------------------------------------------------------------------------
+void BuildVertexAdjacency(const asdx::ResMesh& mesh, size_t triangleCount, VertexAdjacency& result)
+{
+    auto vertexCount = mesh.Positions.size();
+    auto indexCount  = triangleCount * 3;
+
+    result.Offsets.assign(vertexCount + 1, 0);
+    result.Faces  .resize(indexCount);
+
+    for(size_t i=0; i<indexCount; ++i)
+    { result.Offsets[mesh.Indices[i] + 1]++; }
+
+    for(size_t i=0; i<vertexCount; ++i)
+    { result.Offsets[i + 1] += result.Offsets[i]; }
+
+    std::vector<uint32_t> cursor(result.Offsets.begin(), result.Offsets.end() - 1);
+    for(size_t i=0; i<indexCount; ++i)
+    { result.Faces[cursor[mesh.Indices[i]]++] = uint32_t(i / 3); }
+}
+
+//-----------------------------------------------------------------------------
+//      4三角形分の頂点成分をSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+template<typename T>
+inline void Gather4(const T* pValues, const uint32_t* pIndices, uint32_t corner, __m128& x, __m128& y)
+{
+    const auto& a = pValues[pIndices[0 * 3 + corner]];
+    const auto& b = pValues[pIndices[1 * 3 + corner]];
+    const auto& c = pValues[pIndices[2 * 3 + corner]];
+    const auto& d = pValues[pIndices[3 * 3 + corner]];
+    x = _mm_setr_ps(a.x, b.x, c.x, d.x);
+    y = _mm_setr_ps(a.y, b.y, c.y, d.y);
+}
+
+//-----------------------------------------------------------------------------
+//      4三角形分の位置座標をSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+inline void Gather4(const asdx::Vector3* pValues, const uint32_t* pIndices, uint32_t corner, __m128& x, __m128& y, __m128& z)
+{
+    Gather4(pValues, pIndices, corner, x, y);
+    z = _mm_setr_ps(
+        pValues[pIndices[0 * 3 + corner]].z,
+        pValues[pIndices[1 * 3 + corner]].z,
+        pValues[pIndices[2 * 3 + corner]].z,
+        pValues[pIndices[3 * 3 + corner]].z);
+}
+
+//-----------------------------------------------------------------------------
+//      SoA形式のベクトルを書き出します.
+//-----------------------------------------------------------------------------
+inline void Scatter4(__m128 x, __m128 y, __m128 z, asdx::Vector3* pResult)
+{
+    alignas(16) float vx[4], vy[4], vz[4];
+    _mm_store_ps(vx, x);
+    _mm_store_ps(vy, y);
+    _mm_store_ps(vz, z);
+    for(auto i=0; i<4; ++i)
+    { pResult[i] = asdx::Vector3(vx[i], vy[i], vz[i]); }
+}
+
+//-----------------------------------------------------------------------------
+//      8三角形分の頂点成分をSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+template<typename T>
+inline void Gather8(const T* pValues, const uint32_t* pIndices, uint32_t corner, __m256& x, __m256& y)
+{
+    __m128 x0, y0, x1, y1;
+    Gather4(pValues, pIndices + 0 * 3, corner, x0, y0);
+    Gather4(pValues, pIndices + 4 * 3, corner, x1, y1);
+    x = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+    y = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+}
+
+//-----------------------------------------------------------------------------
+//      8三角形分の位置座標をSoA形式で読み込みます.
+//-----------------------------------------------------------------------------
+inline void Gather8(const asdx::Vector3* pValues, const uint32_t* pIndices, uint32_t corner, __m256& x, __m256& y, __m256& z)
+{
+    __m128 x0, y0, z0, x1, y1, z1;
+    Gather4(pValues, pIndices + 0 * 3, corner, x0, y0, z0);
+    Gather4(pValues, pIndices + 4 * 3, corner, x1, y1, z1);
+    x = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+    y = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+    z = _mm256_insertf128_ps(_mm256_castps128_ps256(z0), z1, 1);
+}
+
+//-----------------------------------------------------------------------------
+//      SoA形式のベクトルを書き出します (8要素).
+//-----------------------------------------------------------------------------
+inline void Scatter8(__m256 x, __m256 y, __m256 z, asdx::Vector3* pResult)
+{
+    Scatter4(_mm256_castps256_ps128(x),   _mm256_castps256_ps128(y),   _mm256_castps256_ps128(z),   pResult + 0);
+    Scatter4(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), pResult + 4);
+}
+
+//-----------------------------------------------------------------------------
+//      面法線を計算します.
+//-----------------------------------------------------------------------------
+inline asdx::Vector3 CalcFaceNormal(const asdx::ResMesh& mesh, size_t face)
+{
+    auto i0 = mesh.Indices[face * 3 + 0];
+    auto i1 = mesh.Indices[face * 3 + 1];
+    auto i2 = mesh.Indices[face * 3 + 2];
+
+    const auto& p0 = mesh.Positions[i0];
+    const auto& p1 = mesh.Positions[i1];
+    const auto& p2 = mesh.Positions[i2];
+
+    auto e0 = p1 - p0;
+    auto e1 = p2 - p0;
+
+    auto fn = asdx::Vector3::Cross(e0, e1);
+    return asdx::Vector3::SafeNormalize(fn, fn);
+}
+
+//-----------------------------------------------------------------------------
+//      面接線を計算します.
+//-----------------------------------------------------------------------------
+inline asdx::Vector3 CalcFaceTangent(const asdx::ResMesh& mesh, size_t face)
+{
+    auto i0 = mesh.Indices[face * 3 + 0];
+    auto i1 = mesh.Indices[face * 3 + 1];
+    auto i2 = mesh.Indices[face * 3 + 2];
+
+    const auto& p0 = mesh.Positions[i0];
+    const auto& p1 = mesh.Positions[i1];
+    const auto& p2 = mesh.Positions[i2];
+
+    const auto& t0 = mesh.TexCoords[0][i0];
+    const auto& t1 = mesh.TexCoords[0][i1];
+    const auto& t2 = mesh.TexCoords[0][i2];
+
+    auto e1 = p1 - p0;
+    auto e2 = p2 - p0;
+
+    float x1 = t1.x - t0.x;
+    float x2 = t2.x - t0.x;
+
+    float y1 = t1.y - t0.y;
+    float y2 = t2.y - t0.y;
+
+    float r = 1.0f / (x1 * y2 - x2 * y1);
+
+    return (e1 * y2 - e2 * y1) * r;
+}
+
+//-----------------------------------------------------------------------------
+//      面法線を8三角形同時に計算します.
+//      AVX 対応の CPU でのみ呼び出し, 処理していない最初の面番号を返します.
+//-----------------------------------------------------------------------------
+size_t CalcFaceNormalsAVX(const asdx::Vector3* pPositions, const uint32_t* pIndices, size_t face, size_t end, asdx::Vector3* pResult)
+{
+    auto zero = _mm256_setzero_ps();
+    for(; face + 8 <= end; face += 8)
+    {
+        __m256 x0, y0, z0, x1, y1, z1, x2, y2, z2;
+        Gather8(pPositions, pIndices + face * 3, 0, x0, y0, z0);
+        Gather8(pPositions, pIndices + face * 3, 1, x1, y1, z1);
+        Gather8(pPositions, pIndices + face * 3, 2, x2, y2, z2);
+
+        auto ax = _mm256_sub_ps(x1, x0);
+        auto ay = _mm256_sub_ps(y1, y0);
+        auto az = _mm256_sub_ps(z1, z0);
+
+        auto bx = _mm256_sub_ps(x2, x0);
+        auto by = _mm256_sub_ps(y2, y0);
+        auto bz = _mm256_sub_ps(z2, z0);
+
+        auto nx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+        auto ny = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+        auto nz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+
+        auto len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz)));
+
+        auto mask = _mm256_cmp_ps(len, zero, _CMP_GT_OQ);
+        nx = _mm256_blendv_ps(nx, _mm256_div_ps(nx, len), mask);
+        ny = _mm256_blendv_ps(ny, _mm256_div_ps(ny, len), mask);
+        nz = _mm256_blendv_ps(nz, _mm256_div_ps(nz, len), mask);
+
+        Scatter8(nx, ny, nz, pResult + face);
+    }
+
+    // 後続の SSE 命令で遷移ペナルティが発生しないようにする.
+    _mm256_zeroupper();
+    return face;
+}
+
+//-----------------------------------------------------------------------------
+//      面接線を8三角形同時に計算します.
+//      AVX 対応の CPU でのみ呼び出し, 処理していない最初の面番号を返します.
+//-----------------------------------------------------------------------------
+size_t CalcFaceTangentsAVX(const asdx::Vector3* pPositions, const asdx::Vector2* pTexCoords, const uint32_t* pIndices, size_t face, size_t end, asdx::Vector3* pResult)
+{
+    auto one = _mm256_set1_ps(1.0f);
+    for(; face + 8 <= end; face += 8)
+    {
+        __m256 px0, py0, pz0, px1, py1, pz1, px2, py2, pz2;
+        Gather8(pPositions, pIndices + face * 3, 0, px0, py0, pz0);
+        Gather8(pPositions, pIndices + face * 3, 1, px1, py1, pz1);
+        Gather8(pPositions, pIndices + face * 3, 2, px2, py2, pz2);
+
+        __m256 u0, v0, u1, v1, u2, v2;
+        Gather8(pTexCoords, pIndices + face * 3, 0, u0, v0);
+        Gather8(pTexCoords, pIndices + face * 3, 1, u1, v1);
+        Gather8(pTexCoords, pIndices + face * 3, 2, u2, v2);
+
+        auto e1x = _mm256_sub_ps(px1, px0);
+        auto e1y = _mm256_sub_ps(py1, py0);
+        auto e1z = _mm256_sub_ps(pz1, pz0);
+
+        auto e2x = _mm256_sub_ps(px2, px0);
+        auto e2y = _mm256_sub_ps(py2, py0);
+        auto e2z = _mm256_sub_ps(pz2, pz0);
+
+        auto x1 = _mm256_sub_ps(u1, u0);
+        auto x2 = _mm256_sub_ps(u2, u0);
+        auto y1 = _mm256_sub_ps(v1, v0);
+        auto y2 = _mm256_sub_ps(v2, v0);
+
+        auto r = _mm256_div_ps(one, _mm256_sub_ps(_mm256_mul_ps(x1, y2), _mm256_mul_ps(x2, y1)));
+
+        auto tx = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(e1x, y2), _mm256_mul_ps(e2x, y1)), r);
+        auto ty = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(e1y, y2), _mm256_mul_ps(e2y, y1)), r);
+        auto tz = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(e1z, y2), _mm256_mul_ps(e2z, y1)), r);
+
+        Scatter8(tx, ty, tz, pResult + face);
+    }
+
+    _mm256_zeroupper();
+    return face;
+}
+
+//-----------------------------------------------------------------------------
+//      面法線を計算します (4三角形同時, AVX2 対応の CPU では8三角形同時).
+//      演算順序は CalcFaceNormal() と同一なので結果はビット単位で一致します.
+//-----------------------------------------------------------------------------
+void CalcFaceNormals(const asdx::ResMesh& mesh, size_t begin, size_t end, asdx::Vector3* pResult)
+{
+    auto pPositions = mesh.Positions.data();
+    auto pIndices   = mesh.Indices.data();
+    auto zero       = _mm_setzero_ps();
+
+    auto face = begin;
+
+    // AVX2 対応の CPU では8三角形ずつ処理する.
+    if (asdx::GetSimdLevel() == asdx::SIMD_LEVEL_AVX2)
+    { face = CalcFaceNormalsAVX(pPositions, pIndices, face, end, pResult); }
+
+    for(; face + 4 <= end; face += 4)
+    {
+        __m128 x0, y0, z0, x1, y1, z1, x2, y2, z2;
+        Gather4(pPositions, pIndices + face * 3, 0, x0, y0, z0);
+        Gather4(pPositions, pIndices + face * 3, 1, x1, y1, z1);
+        Gather4(pPositions, pIndices + face * 3, 2, x2, y2, z2);
+
+        auto ax = _mm_sub_ps(x1, x0);
+        auto ay = _mm_sub_ps(y1, y0);
+        auto az = _mm_sub_ps(z1, z0);
+
+        auto bx = _mm_sub_ps(x2, x0);
+        auto by = _mm_sub_ps(y2, y0);
+        auto bz = _mm_sub_ps(z2, z0);
+
+        auto nx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+        auto ny = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+        auto nz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+
+        auto len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)));
+
+        // SafeNormalize() と同様に，長さが0の場合は元の値を返す.
+        auto mask = _mm_cmpgt_ps(len, zero);
+        nx = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(nx, len)), _mm_andnot_ps(mask, nx));
+        ny = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(ny, len)), _mm_andnot_ps(mask, ny));
+        nz = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(nz, len)), _mm_andnot_ps(mask, nz));
+
+        Scatter4(nx, ny, nz, pResult + face);
+    }
+
+    for(; face < end; ++face)
+    { pResult[face] = CalcFaceNormal(mesh, face); }
+}
+
+//-----------------------------------------------------------------------------
+//      面接線を計算します (4三角形同時, AVX2 対応の CPU では8三角形同時).
+//      演算順序は CalcFaceTangent() と同一なので結果はビット単位で一致します.
+//-----------------------------------------------------------------------------
+void CalcFaceTangents(const asdx::ResMesh& mesh, size_t begin, size_t end, asdx::Vector3* pResult)
+{
+    auto pPositions = mesh.Positions.data();
+    auto pTexCoords = mesh.TexCoords[0].data();
+    auto pIndices   = mesh.Indices.data();
+    auto one        = _mm_set1_ps(1.0f);
+
+    auto face = begin;
+
+    // AVX2 対応の CPU では8三角形ずつ処理する.
+    if (asdx::GetSimdLevel() == asdx::SIMD_LEVEL_AVX2)
+    { face = CalcFaceTangentsAVX(pPositions, pTexCoords, pIndices, face, end, pResult); }
+
+    for(; face + 4 <= end; face += 4)
+    {
+        __m128 px0, py0, pz0, px1, py1, pz1, px2, py2, pz2;
+        Gather4(pPositions, pIndices + face * 3, 0, px0, py0, pz0);
+        Gather4(pPositions, pIndices + face * 3, 1, px1, py1, pz1);
+        Gather4(pPositions, pIndices + face * 3, 2, px2, py2, pz2);
+
+        __m128 u0, v0, u1, v1, u2, v2;
+        Gather4(pTexCoords, pIndices + face * 3, 0, u0, v0);
+        Gather4(pTexCoords, pIndices + face * 3, 1, u1, v1);
+        Gather4(pTexCoords, pIndices + face * 3, 2, u2, v2);
+
+        auto e1x = _mm_sub_ps(px1, px0);
+        auto e1y = _mm_sub_ps(py1, py0);
+        auto e1z = _mm_sub_ps(pz1, pz0);
+
+        auto e2x = _mm_sub_ps(px2, px0);
+        auto e2y = _mm_sub_ps(py2, py0);
+        auto e2z = _mm_sub_ps(pz2, pz0);
+
+        auto x1 = _mm_sub_ps(u1, u0);
+        auto x2 = _mm_sub_ps(u2, u0);
+        auto y1 = _mm_sub_ps(v1, v0);
+        auto y2 = _mm_sub_ps(v2, v0);
+
+        auto r = _mm_div_ps(one, _mm_sub_ps(_mm_mul_ps(x1, y2), _mm_mul_ps(x2, y1)));
+
+        auto tx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1x, y2), _mm_mul_ps(e2x, y1)), r);
+        auto ty = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1y, y2), _mm_mul_ps(e2y, y1)), r);
+        auto tz = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1z, y2), _mm_mul_ps(e2z, y1)), r);
+
+        Scatter4(tx, ty, tz, pResult + face);
+    }
+
+    for(; face < end; ++face)
+    { pResult[face] = CalcFaceTangent(mesh, face); }
+}
+
+//-----------------------------------------------------------------------------
+//      法線ベクトルを計算します.
+//-----------------------------------------------------------------------------
+void CalcNormalsImpl(asdx::ResMesh& resource, bool parallel)
+{
+    auto vertexCount   = resource.Positions.size();
+    auto triangleCount = resource.Indices.size() / 3;
+
+    // 面法線を算出.
+    std::vector<asdx::Vector3> faceNormals(triangleCount);
+    ParallelFor(triangleCount, parallel, [&](size_t begin, size_t end)
+    { CalcFaceNormals(resource, begin, end, faceNormals.data()); });
+
+    // 頂点ごとに参照する三角形を集計するため，スレッド間で書き込みが競合しない.
+    VertexAdjacency adjacency;
+    BuildVertexAdjacency(resource, triangleCount, adjacency);
+
+    const auto SMOOTHING_ANGLE = 59.7f;
+    auto cosSmooth = cosf(asdx::ToDegree(SMOOTHING_ANGLE));
+
+    // メモリ確保.
+    auto prevCount = resource.Normals.size();
+    resource.Normals.resize(vertexCount);
+
+    ParallelFor(vertexCount, parallel, [&](size_t begin, size_t end)
+    {
+        for(auto i=begin; i<end; ++i)
+        {
+            auto first = adjacency.Offsets[i + 0];
+            auto last  = adjacency.Offsets[i + 1];
+
+            // どの三角形からも参照されない頂点は，逐次版と同様に既存の法線を残す.
+            // 新たに確保した要素は未初期化のままにせずゼロとする.
+            if (first == last)
+            {
+                if (i >= prevCount)
+                { resource.Normals[i] = asdx::Vector3(0.0f, 0.0f, 0.0f); }
+                continue;
+            }
+
+            // 面法線を加算し，正規化して頂点法線を求める.
+            auto n = asdx::Vector3(0.0f, 0.0f, 0.0f);
+            for(auto j=first; j<last; ++j)
+            { n += faceNormals[adjacency.Faces[j]]; }
+            n = asdx::Vector3::SafeNormalize(n, n);
+
+            // スムージング処理 (最後に参照した三角形で判定).
+            const auto& fn = faceNormals[adjacency.Faces[last - 1]];
+            auto c = asdx::Vector3::Dot(n, fn);
+            resource.Normals[i] = (c >= cosSmooth) ? n : fn;
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      接線ベクトルを計算します.
+//-----------------------------------------------------------------------------
+void CalcTangentsImpl(asdx::ResMesh& resource, bool parallel)
+{
+    auto vertexCount = resource.Positions.size();
+    resource.Tangents.resize(vertexCount);
+
+    // テクスチャ座標が無い場合は接線ベクトルをきちんと計算できないので，
+    // 雑に計算する.
+    if (resource.TexCoords[0].empty())
+    {
+        ParallelFor(vertexCount, parallel, [&](size_t begin, size_t end)
+        {
+            for(auto i=begin; i<end; ++i)
+            {
+                asdx::Vector3 T, B;
+                asdx::CalcONB(resource.Normals[i], T, B);
+                resource.Tangents[i] = T;
+            }
+        });
+        return;
+    }
+
+    auto triangleCount = resource.Indices.size() / 3;
+
+    // 面接線を算出.
+    std::vector<asdx::Vector3> faceTangents(triangleCount);
+    ParallelFor(triangleCount, parallel, [&](size_t begin, size_t end)
+    { CalcFaceTangents(resource, begin, end, faceTangents.data()); });
+
+    VertexAdjacency adjacency;
+    BuildVertexAdjacency(resource, triangleCount, adjacency);
+
+    ParallelFor(vertexCount, parallel, [&](size_t begin, size_t end)
+    {
+        for(auto i=begin; i<end; ++i)
+        {
+            auto a = asdx::Vector3(0.0f, 0.0f, 0.0f);
+            for(auto j=adjacency.Offsets[i]; j<adjacency.Offsets[i + 1]; ++j)
+            { a += faceTangents[adjacency.Faces[j]]; }
+
+            // Reject = a - b * Dot(a, b);
+            auto b = resource.Normals[i];
+            auto T = a - b * asdx::Vector3::Dot(a, b);
+            resource.Tangents[i] = asdx::Vector3::SafeNormalize(T, T);
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      モデル内の全メッシュを処理します.
+//      大きいメッシュはメッシュ内で，小さいメッシュはメッシュ単位で並列化します.
+//-----------------------------------------------------------------------------
+void ForEachMesh(asdx::ResModel& model, void (*func)(asdx::ResMesh&, bool))
+{
+    std::vector<asdx::ResMesh*> smallMeshes;
+    for(auto& mesh : model.Meshes)
+    {
+        if (mesh.Indices.size() / 3 >= PARALLEL_MESH_THRESHOLD)
+        { func(mesh, true); }
+        else
+        { smallMeshes.push_back(&mesh); }
+    }
+
+    GetThreadPool().ParallelFor(uint32_t(smallMeshes.size()), 1, [&](uint32_t begin, uint32_t end)
+    {
+        for(auto i=begin; i<end; ++i)
+        { func(*smallMeshes[i], false); }
+    });
+}
+
 } // namespace
 
 
@@ -236,183 +765,25 @@ void DecodeTBN(uint32_t encoded, Vector3& tangent, Vector3& bitangent, Vector3&
 //      法線ベクトルを計算します.
 //-----------------------------------------------------------------------------
 void CalcNormals(ResMesh& resource)
-{
-    auto vertexCount = resource.Positions.size();
-    std::vector<asdx::Vector3> normals;
-    normals.resize(vertexCount);
-
-    // 法線データ初期化.
-    for(size_t i=0; i<vertexCount; ++i)
-    {
-        normals[i] = asdx::Vector3(0.0f, 0.0f, 0.0f);
-    }
-
-    auto indexCount = resource.Indices.size();
-    for(size_t i=0; i<indexCount - 3; i+=3)
-    {
-        auto i0 = resource.Indices[i + 0];
-        auto i1 = resource.Indices[i + 1];
-        auto i2 = resource.Indices[i + 2];
-
-        const auto& p0 = resource.Positions[i0];
-        const auto& p1 = resource.Positions[i1];
-        const auto& p2 = resource.Positions[i2];
-
-        // エッジ.
-        auto e0 = p1 - p0;
-        auto e1 = p2 - p0;
-
-        // 面法線を算出.
-        auto fn = asdx::Vector3::Cross(e0, e1);
-        fn = asdx::Vector3::SafeNormalize(fn, fn);
-
-        // 面法線を加算.
-        normals[i0] += fn;
-        normals[i1] += fn;
-        normals[i2] += fn;
-    }
-
-    // 加算した法線を正規化し，頂点法線を求める.
-    for(size_t i=0; i<vertexCount; ++i)
-    {
-        normals[i] = asdx::Vector3::SafeNormalize(normals[i], normals[i]);
-    }
-
-    const auto SMOOTHING_ANGLE = 59.7f;
-    auto cosSmooth = cosf(asdx::ToDegree(SMOOTHING_ANGLE));
-
-    // メモリ確保.
-    resource.Normals.resize(vertexCount);
-
-    // スムージング処理.
-    for(size_t i=0; i<indexCount - 3; i+=3)
-    {
-        auto i0 = resource.Indices[i + 0];
-        auto i1 = resource.Indices[i + 1];
-        auto i2 = resource.Indices[i + 2];
-
-        const auto& p0 = resource.Positions[i0];
-        const auto& p1 = resource.Positions[i1];
-        const auto& p2 = resource.Positions[i2];
-
-        // エッジ.
-        auto e0 = p1 - p0;
-        auto e1 = p2 - p0;
-
-        // 面法線を算出.
-        auto fn = asdx::Vector3::Cross(e0, e1);
-        fn = asdx::Vector3::SafeNormalize(fn, fn);
-
-        // 頂点法線と面法線のなす角度を算出.
-        auto c0 = asdx::Vector3::Dot(normals[i0], fn);
-        auto c1 = asdx::Vector3::Dot(normals[i1], fn);
-        auto c2 = asdx::Vector3::Dot(normals[i2], fn);
-
-        // スムージング処理.
-        resource.Normals[i0] = (c0 >= cosSmooth) ? normals[i0] : fn;
-        resource.Normals[i1] = (c1 >= cosSmooth) ? normals[i1] : fn;
-        resource.Normals[i2] = (c2 >= cosSmooth) ? normals[i2] : fn;
-    }
-
-    normals.clear();
-}
+{ CalcNormalsImpl(resource, true); }
 
 //-----------------------------------------------------------------------------
 //      法線ベクトルを計算します.
 //-----------------------------------------------------------------------------
 void CalcNormals(ResModel& resource)
-{
-    for(auto& mesh : resource.Meshes)
-    { CalcNormals(mesh); }
-}
+{ ForEachMesh(resource, CalcNormalsImpl); }
 
-//-----------------------------------------------------------------------------
-//      接線ベクトルを計算します.
-//-----------------------------------------------------------------------------
-void CalcTangentsRoughly(ResMesh& mesh)
-{
-    auto vertexCount = mesh.Positions.size();
-    mesh.Tangents.resize(vertexCount);
-    for(size_t i=0; i<vertexCount; ++i)
-    {
-        asdx::Vector3 T, B;
-        asdx::CalcONB(mesh.Normals[i], T, B);
-        mesh.Tangents[i] = T;
-    }
-}
 //-----------------------------------------------------------------------------
 //      接線ベクトルを計算します.
 //-----------------------------------------------------------------------------
 void CalcTangents(ResMesh& resource)
-{
-    // テクスチャ座標が無い場合は接線ベクトルをきちんと計算できないので，
-    // 雑に計算する.
-    if (resource.TexCoords[0].empty())
-    {
-        CalcTangentsRoughly(resource);
-        return;
-    }
-
-    auto vertexCount = resource.Positions.size();
-    resource.Tangents.resize(vertexCount);
-
-    // 接線ベクトルを初期化.
-    for(size_t i=0; i<vertexCount; ++i)
-    {
-        resource.Tangents[i] = asdx::Vector3(0.0f, 0.0f, 0.0f);
-    }
-
-    auto indexCount = resource.Indices.size();
-    for(size_t i=0; i<indexCount - 3; i+=3)
-    {
-        auto i0 = resource.Indices[i + 0];
-        auto i1 = resource.Indices[i + 1];
-        auto i2 = resource.Indices[i + 2];
-
-        auto p0 = resource.Positions[i0];
-        auto p1 = resource.Positions[i1];
-        auto p2 = resource.Positions[i2];
-
-        auto t0 = resource.TexCoords[0][i0];
-        auto t1 = resource.TexCoords[0][i1];
-        auto t2 = resource.TexCoords[0][i2];
-
-        auto e1 = p1 - p0;
-        auto e2 = p2 - p0;
-
-        float x1 = t1.x - t0.x;
-        float x2 = t2.x - t0.x;
-
-        float y1 = t1.y - t0.y;
-        float y2 = t2.y - t0.y;
-
-        float r = 1.0f / (x1 * y2 - x2 * y1);
-
-        asdx::Vector3 T = (e1 * y2 - e2 * y1) * r;
-
-        resource.Tangents[i0] += T;
-        resource.Tangents[i1] += T;
-        resource.Tangents[i2] += T;
-    }
-
-    for(size_t i=0; i<vertexCount; ++i)
-    {
-        // Reject = a - b * Dot(a, b);
-        auto a = resource.Tangents[i];
-        auto b = resource.Normals[i];
-        auto T = a - b * asdx::Vector3::Dot(a, b);
-        resource.Tangents[i] = asdx::Vector3::SafeNormalize(T, T);
-    }
-}
+{ CalcTangentsImpl(resource, true); }
 
 //-----------------------------------------------------------------------------
 //      接線ベクトルを計算します.
 //-----------------------------------------------------------------------------
 void CalcTangents(ResModel& resource)
-{
-    for(auto& mesh : resource.Meshes)
-    { CalcTangents(mesh); }
-}
+{ ForEachMesh(resource, CalcTangentsImpl); }
 
 //-----------------------------------------------------------------------------
 //      カラーを圧縮します.
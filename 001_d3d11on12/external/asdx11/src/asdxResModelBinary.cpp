@@ -0,0 +1,721 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxResModelBinary.cpp
+// Desc : Model Resource Binary Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <asdxResModelBinary.h>
+#include <asdxHash.h>
+#include <asdxLogger.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      オフセットをアライメントに切り上げます.
+//-----------------------------------------------------------------------------
+inline uint64_t AlignOffset(uint64_t offset)
+{
+    const uint64_t mask = asdx::RES_MODEL_BINARY_ALIGNMENT - 1;
+    return (offset + mask) & ~mask;
+}
+
+//-----------------------------------------------------------------------------
+//      ストリームの要素サイズを取得します.
+//-----------------------------------------------------------------------------
+uint64_t GetStreamStride(uint32_t stream, bool quantized)
+{
+    switch(stream)
+    {
+    case asdx::RES_MESH_STREAM_POSITION:
+    case asdx::RES_MESH_STREAM_NORMAL:
+    case asdx::RES_MESH_STREAM_TANGENT:
+    case asdx::RES_MESH_STREAM_BITANGENT:
+        return sizeof(asdx::Vector3);
+
+    case asdx::RES_MESH_STREAM_TBN:
+        return sizeof(uint32_t);
+
+    case asdx::RES_MESH_STREAM_COLOR:
+        return (quantized) ? sizeof(uint32_t) : sizeof(asdx::Vector4);
+
+    case asdx::RES_MESH_STREAM_TEXCOORD0:
+    case asdx::RES_MESH_STREAM_TEXCOORD1:
+    case asdx::RES_MESH_STREAM_TEXCOORD2:
+    case asdx::RES_MESH_STREAM_TEXCOORD3:
+        return (quantized) ? sizeof(asdx::Half2) : sizeof(asdx::Vector2);
+
+    case asdx::RES_MESH_STREAM_BONE_INDEX:
+        return sizeof(asdx::ResBoneIndex);
+
+    case asdx::RES_MESH_STREAM_BONE_WEIGHT:
+        return (quantized) ? sizeof(asdx::Half4) : sizeof(asdx::Vector4);
+
+    case asdx::RES_MESH_STREAM_INDEX:
+        return sizeof(uint32_t);
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      格納するストリームの要素数を取得します.
+//-----------------------------------------------------------------------------
+uint64_t GetStreamCount(const asdx::ResMesh& mesh, uint32_t stream, bool quantized)
+{
+    switch(stream)
+    {
+    case asdx::RES_MESH_STREAM_POSITION:    return mesh.Positions.size();
+    case asdx::RES_MESH_STREAM_NORMAL:      return (quantized) ? 0 : mesh.Normals.size();
+    // 圧縮時は法線と合わせて TBN に格納する. 法線が無い場合は TBN を作れないので非圧縮で格納する.
+    case asdx::RES_MESH_STREAM_TANGENT:     return (quantized && !mesh.Normals.empty()) ? 0 : mesh.Tangents.size();
+    case asdx::RES_MESH_STREAM_BITANGENT:   return (quantized && !mesh.Normals.empty()) ? 0 : mesh.Bitangents.size();
+    case asdx::RES_MESH_STREAM_TBN:         return (quantized) ? mesh.Normals.size() : 0;
+    case asdx::RES_MESH_STREAM_COLOR:       return mesh.Colors.size();
+    case asdx::RES_MESH_STREAM_TEXCOORD0:   return mesh.TexCoords[0].size();
+    case asdx::RES_MESH_STREAM_TEXCOORD1:   return mesh.TexCoords[1].size();
+    case asdx::RES_MESH_STREAM_TEXCOORD2:   return mesh.TexCoords[2].size();
+    case asdx::RES_MESH_STREAM_TEXCOORD3:   return mesh.TexCoords[3].size();
+    case asdx::RES_MESH_STREAM_BONE_INDEX:  return mesh.BoneIndices.size();
+    case asdx::RES_MESH_STREAM_BONE_WEIGHT: return mesh.BoneWeights.size();
+    case asdx::RES_MESH_STREAM_INDEX:       return mesh.Indices.size();
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュを検証します.
+//-----------------------------------------------------------------------------
+bool ValidateMesh(const asdx::ResMesh& mesh)
+{
+    auto vertexCount = mesh.Positions.size();
+    if (vertexCount == 0 || vertexCount > UINT32_MAX || mesh.Indices.size() > UINT32_MAX)
+    {
+        ELOGA("Error : Invalid Vertex Count. mesh = %s, count = %zu", mesh.MeshName.c_str(), vertexCount);
+        return false;
+    }
+
+    if ((mesh.Indices.size() % 3) != 0)
+    {
+        ELOGA("Error : Invalid Index Count. mesh = %s, count = %zu", mesh.MeshName.c_str(), mesh.Indices.size());
+        return false;
+    }
+
+    for(uint32_t i=asdx::RES_MESH_STREAM_POSITION; i<asdx::RES_MESH_STREAM_INDEX; ++i)
+    {
+        auto count = GetStreamCount(mesh, i, false);
+        if (count != 0 && count != vertexCount)
+        {
+            ELOGA("Error : Stream Size Mismatch. mesh = %s, stream = %u, count = %llu, expected = %zu",
+                mesh.MeshName.c_str(), i, count, vertexCount);
+            return false;
+        }
+    }
+
+    for(size_t i=0; i<mesh.Indices.size(); ++i)
+    {
+        if (mesh.Indices[i] >= vertexCount)
+        {
+            ELOGA("Error : Index Out Of Range. mesh = %s, index[%zu] = %u", mesh.MeshName.c_str(), i, mesh.Indices[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ストリームを書き込みます.
+//-----------------------------------------------------------------------------
+void WriteStream(const asdx::ResMesh& mesh, uint32_t stream, bool quantized, uint8_t* pDst)
+{
+    switch(stream)
+    {
+    case asdx::RES_MESH_STREAM_POSITION:
+        memcpy(pDst, mesh.Positions.data(), mesh.Positions.size() * sizeof(asdx::Vector3));
+        break;
+
+    case asdx::RES_MESH_STREAM_NORMAL:
+        memcpy(pDst, mesh.Normals.data(), mesh.Normals.size() * sizeof(asdx::Vector3));
+        break;
+
+    case asdx::RES_MESH_STREAM_TANGENT:
+        memcpy(pDst, mesh.Tangents.data(), mesh.Tangents.size() * sizeof(asdx::Vector3));
+        break;
+
+    case asdx::RES_MESH_STREAM_BITANGENT:
+        memcpy(pDst, mesh.Bitangents.data(), mesh.Bitangents.size() * sizeof(asdx::Vector3));
+        break;
+
+    case asdx::RES_MESH_STREAM_TBN:
+        {
+            auto pTBN = reinterpret_cast<uint32_t*>(pDst);
+            for(size_t i=0; i<mesh.Normals.size(); ++i)
+            {
+                auto N = asdx::Vector3::SafeNormalize(mesh.Normals[i], asdx::Vector3(0.0f, 0.0f, 1.0f));
+                asdx::Vector3 T, B;
+                asdx::CalcONB(N, T, B);
+                if (!mesh.Tangents.empty())
+                {
+                    // 法線に直交化しておかないと EncodeTBN() で零ベクトルの正規化が起こる.
+                    auto a = mesh.Tangents[i];
+                    auto t = a - N * asdx::Vector3::Dot(a, N);
+                    if (asdx::Vector3::Dot(t, t) > asdx::F_EPSILON)
+                    {
+                        T = asdx::Vector3::Normalize(t);
+                        B = (mesh.Bitangents.empty()) ? asdx::Vector3::Cross(N, T) : mesh.Bitangents[i];
+                    }
+                }
+
+                // DecodeTBN() は Cross(N, T) を従接線とするため，向きが逆なら反転フラグを立てる.
+                uint8_t handedness = (asdx::Vector3::Dot(asdx::Vector3::Cross(N, T), B) < 0.0f) ? 1 : 0;
+                pTBN[i] = asdx::EncodeTBN(N, T, handedness);
+            }
+        }
+        break;
+
+    case asdx::RES_MESH_STREAM_COLOR:
+        if (quantized)
+        {
+            auto pColor = reinterpret_cast<uint32_t*>(pDst);
+            for(size_t i=0; i<mesh.Colors.size(); ++i)
+            { pColor[i] = asdx::EncodeColor(asdx::Vector4::Saturate(mesh.Colors[i])); }
+        }
+        else
+        { memcpy(pDst, mesh.Colors.data(), mesh.Colors.size() * sizeof(asdx::Vector4)); }
+        break;
+
+    case asdx::RES_MESH_STREAM_TEXCOORD0:
+    case asdx::RES_MESH_STREAM_TEXCOORD1:
+    case asdx::RES_MESH_STREAM_TEXCOORD2:
+    case asdx::RES_MESH_STREAM_TEXCOORD3:
+        {
+            const auto& texcoords = mesh.TexCoords[stream - asdx::RES_MESH_STREAM_TEXCOORD0];
+            if (quantized)
+            {
+                auto pTexCoord = reinterpret_cast<asdx::Half2*>(pDst);
+                for(size_t i=0; i<texcoords.size(); ++i)
+                { pTexCoord[i] = asdx::EncodeHalf2(texcoords[i]); }
+            }
+            else
+            { memcpy(pDst, texcoords.data(), texcoords.size() * sizeof(asdx::Vector2)); }
+        }
+        break;
+
+    case asdx::RES_MESH_STREAM_BONE_INDEX:
+        memcpy(pDst, mesh.BoneIndices.data(), mesh.BoneIndices.size() * sizeof(asdx::ResBoneIndex));
+        break;
+
+    case asdx::RES_MESH_STREAM_BONE_WEIGHT:
+        if (quantized)
+        {
+            auto pWeight = reinterpret_cast<asdx::Half4*>(pDst);
+            for(size_t i=0; i<mesh.BoneWeights.size(); ++i)
+            { pWeight[i] = asdx::EncodeHalf4(mesh.BoneWeights[i]); }
+        }
+        else
+        { memcpy(pDst, mesh.BoneWeights.data(), mesh.BoneWeights.size() * sizeof(asdx::Vector4)); }
+        break;
+
+    case asdx::RES_MESH_STREAM_INDEX:
+        memcpy(pDst, mesh.Indices.data(), mesh.Indices.size() * sizeof(uint32_t));
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ストリームへのポインタを取得します.
+//-----------------------------------------------------------------------------
+template<typename T>
+inline const T* GetStream(const uint8_t* pData, const asdx::ResMeshBinaryDesc& desc, uint32_t stream)
+{
+    return (desc.Streams[stream] != 0)
+        ? reinterpret_cast<const T*>(pData + desc.Streams[stream])
+        : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルに書き込みます.
+//-----------------------------------------------------------------------------
+bool WriteFile(FILE* pFile, const std::vector<uint8_t>& binary)
+{
+    auto size = fwrite(binary.data(), 1, binary.size(), pFile);
+    fclose(pFile);
+
+    if (size != binary.size())
+    {
+        ELOGA("Error : File Write Failed.");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// ResModelBinary class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ResModelBinary::ResModelBinary()
+: m_pData   (nullptr)
+, m_pHeader (nullptr)
+, m_pMeshes (nullptr)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+ResModelBinary::~ResModelBinary()
+{ Release(); }
+
+//-----------------------------------------------------------------------------
+//      ファイルをメモリマップして読み込みます.
+//-----------------------------------------------------------------------------
+bool ResModelBinary::LoadFromFileA(const char* path, bool verifyHash)
+{
+    Release();
+
+    if (!m_File.OpenA(path))
+    { return false; }
+
+    if (!Validate(m_File.GetData(), m_File.GetSize(), verifyHash))
+    {
+        ELOGA("Error : Invalid Model Binary. path = %s", path);
+        Release();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルをメモリマップして読み込みます.
+//-----------------------------------------------------------------------------
+bool ResModelBinary::LoadFromFileW(const wchar_t* path, bool verifyHash)
+{
+    Release();
+
+    if (!m_File.OpenW(path))
+    { return false; }
+
+    if (!Validate(m_File.GetData(), m_File.GetSize(), verifyHash))
+    {
+        ELOGA("Error : Invalid Model Binary. path = %ls", path);
+        Release();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリ上のデータを参照します.
+//-----------------------------------------------------------------------------
+bool ResModelBinary::LoadFromMemory(const uint8_t* pBuffer, uint64_t bufferSize, bool verifyHash)
+{
+    Release();
+
+    if (pBuffer == nullptr || (uintptr_t(pBuffer) % RES_MODEL_BINARY_ALIGNMENT) != 0)
+    {
+        ELOGA("Error : Invalid Argument. buffer must be %u bytes aligned.", RES_MODEL_BINARY_ALIGNMENT);
+        return false;
+    }
+
+    if (!Validate(pBuffer, bufferSize, verifyHash))
+    {
+        ELOGA("Error : Invalid Model Binary.");
+        Release();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      解放処理を行います.
+//-----------------------------------------------------------------------------
+void ResModelBinary::Release()
+{
+    m_pData   = nullptr;
+    m_pHeader = nullptr;
+    m_pMeshes = nullptr;
+    m_File.Close();
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュ数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t ResModelBinary::GetMeshCount() const
+{ return (m_pHeader != nullptr) ? m_pHeader->MeshCount : 0; }
+
+//-----------------------------------------------------------------------------
+//      圧縮形式かどうかチェックします.
+//-----------------------------------------------------------------------------
+bool ResModelBinary::IsQuantized() const
+{ return (m_pHeader != nullptr) && (m_pHeader->Flags & RES_MODEL_BINARY_FLAG_QUANTIZED) != 0; }
+
+//-----------------------------------------------------------------------------
+//      メッシュのビューを取得します.
+//-----------------------------------------------------------------------------
+ResMeshView ResModelBinary::GetMesh(uint32_t index) const
+{
+    ResMeshView view = {};
+    if (index >= GetMeshCount())
+    { return view; }
+
+    const auto& desc = m_pMeshes[index];
+    auto quantized = IsQuantized();
+
+    view.MeshName       = reinterpret_cast<const char*>(m_pData + desc.MeshName);
+    view.MaterialName   = reinterpret_cast<const char*>(m_pData + desc.MaterialName);
+    view.VertexCount    = desc.VertexCount;
+    view.IndexCount     = desc.IndexCount;
+    view.Quantized      = quantized;
+    view.Positions      = GetStream<Vector3>     (m_pData, desc, RES_MESH_STREAM_POSITION);
+    view.BoneIndices    = GetStream<ResBoneIndex>(m_pData, desc, RES_MESH_STREAM_BONE_INDEX);
+    view.Indices        = GetStream<uint32_t>    (m_pData, desc, RES_MESH_STREAM_INDEX);
+
+    if (quantized)
+    {
+        view.EncodedTBNs        = GetStream<uint32_t>(m_pData, desc, RES_MESH_STREAM_TBN);
+        view.EncodedColors      = GetStream<uint32_t>(m_pData, desc, RES_MESH_STREAM_COLOR);
+        view.EncodedBoneWeights = GetStream<Half4>   (m_pData, desc, RES_MESH_STREAM_BONE_WEIGHT);
+        view.Tangents           = GetStream<Vector3> (m_pData, desc, RES_MESH_STREAM_TANGENT);
+        view.Bitangents         = GetStream<Vector3> (m_pData, desc, RES_MESH_STREAM_BITANGENT);
+        for(auto i=0; i<MAX_LAYER_COUNT; ++i)
+        { view.EncodedTexCoords[i] = GetStream<Half2>(m_pData, desc, RES_MESH_STREAM_TEXCOORD0 + i); }
+    }
+    else
+    {
+        view.Normals     = GetStream<Vector3>(m_pData, desc, RES_MESH_STREAM_NORMAL);
+        view.Tangents    = GetStream<Vector3>(m_pData, desc, RES_MESH_STREAM_TANGENT);
+        view.Bitangents  = GetStream<Vector3>(m_pData, desc, RES_MESH_STREAM_BITANGENT);
+        view.Colors      = GetStream<Vector4>(m_pData, desc, RES_MESH_STREAM_COLOR);
+        view.BoneWeights = GetStream<Vector4>(m_pData, desc, RES_MESH_STREAM_BONE_WEIGHT);
+        for(auto i=0; i<MAX_LAYER_COUNT; ++i)
+        { view.TexCoords[i] = GetStream<Vector2>(m_pData, desc, RES_MESH_STREAM_TEXCOORD0 + i); }
+    }
+
+    return view;
+}
+
+//-----------------------------------------------------------------------------
+//      データを検証します.
+//-----------------------------------------------------------------------------
+bool ResModelBinary::Validate(const uint8_t* pBuffer, uint64_t bufferSize, bool verifyHash)
+{
+    if (bufferSize < sizeof(ResModelBinaryHeader))
+    { return false; }
+
+    auto pHeader = reinterpret_cast<const ResModelBinaryHeader*>(pBuffer);
+    if (pHeader->Magic != RES_MODEL_BINARY_MAGIC)
+    {
+        ELOGA("Error : Invalid Magic.");
+        return false;
+    }
+
+    if (pHeader->Version != RES_MODEL_BINARY_VERSION)
+    {
+        ELOGA("Error : Version Mismatch. version = %u, expected = %u", pHeader->Version, RES_MODEL_BINARY_VERSION);
+        return false;
+    }
+
+    if (pHeader->FileSize != bufferSize)
+    {
+        ELOGA("Error : Size Mismatch. size = %llu, expected = %llu", bufferSize, pHeader->FileSize);
+        return false;
+    }
+
+    auto tableSize = uint64_t(pHeader->MeshCount) * sizeof(ResMeshBinaryDesc);
+    if (tableSize > bufferSize - sizeof(ResModelBinaryHeader))
+    {
+        ELOGA("Error : Invalid Mesh Count. count = %u", pHeader->MeshCount);
+        return false;
+    }
+
+    if (verifyHash)
+    {
+        auto hash = CalcHash64(pBuffer + sizeof(ResModelBinaryHeader), bufferSize - sizeof(ResModelBinaryHeader));
+        if (hash != pHeader->Hash)
+        {
+            ELOGA("Error : Hash Mismatch.");
+            return false;
+        }
+    }
+
+    auto quantized = (pHeader->Flags & RES_MODEL_BINARY_FLAG_QUANTIZED) != 0;
+    auto pMeshes   = reinterpret_cast<const ResMeshBinaryDesc*>(pBuffer + sizeof(ResModelBinaryHeader));
+
+    // 名前とストリームはヘッダとメッシュテーブルより後ろに置かれている必要がある.
+    auto dataStart = sizeof(ResModelBinaryHeader) + tableSize;
+
+    for(uint32_t i=0; i<pHeader->MeshCount; ++i)
+    {
+        const auto& desc = pMeshes[i];
+
+        // 文字列は終端を含めて範囲内にある必要がある.
+        if (desc.MeshName     < dataStart || desc.MeshName     >= bufferSize
+        ||  desc.MaterialName < dataStart || desc.MaterialName >= bufferSize
+        || memchr(pBuffer + desc.MeshName,     '\0', size_t(bufferSize - desc.MeshName))     == nullptr
+        || memchr(pBuffer + desc.MaterialName, '\0', size_t(bufferSize - desc.MaterialName)) == nullptr)
+        {
+            ELOGA("Error : Invalid Name Offset. mesh = %u", i);
+            return false;
+        }
+
+        for(uint32_t j=0; j<RES_MESH_STREAM_COUNT; ++j)
+        {
+            auto offset = desc.Streams[j];
+            if (offset == 0)
+            { continue; }
+
+            auto count = (j == RES_MESH_STREAM_INDEX) ? desc.IndexCount : desc.VertexCount;
+            auto size  = count * GetStreamStride(j, quantized);
+            if ((offset % RES_MODEL_BINARY_ALIGNMENT) != 0 || offset < dataStart || offset > bufferSize || size > bufferSize - offset)
+            {
+                ELOGA("Error : Invalid Stream Offset. mesh = %u, stream = %u", i, j);
+                return false;
+            }
+        }
+
+        if (desc.Streams[RES_MESH_STREAM_POSITION] == 0)
+        {
+            ELOGA("Error : Position Stream Not Found. mesh = %u", i);
+            return false;
+        }
+
+        // 範囲外の頂点を参照するインデックスがあると, 利用側で範囲外アクセスになる.
+        if (desc.Streams[RES_MESH_STREAM_INDEX] != 0)
+        {
+            auto pIndices = reinterpret_cast<const uint32_t*>(pBuffer + desc.Streams[RES_MESH_STREAM_INDEX]);
+            for(uint32_t j=0; j<desc.IndexCount; ++j)
+            {
+                if (pIndices[j] >= desc.VertexCount)
+                {
+                    ELOGA("Error : Index Out Of Range. mesh = %u, index[%u] = %u, vertexCount = %u", i, j, pIndices[j], desc.VertexCount);
+                    return false;
+                }
+            }
+        }
+    }
+
+    m_pData   = pBuffer;
+    m_pHeader = pHeader;
+    m_pMeshes = pMeshes;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルリソースをバイナリ形式に変換します.
+//-----------------------------------------------------------------------------
+bool WriteResModelBinary(const ResModel& model, uint32_t flags, std::vector<uint8_t>& result)
+{
+    auto quantized = (flags & RES_MODEL_BINARY_FLAG_QUANTIZED) != 0;
+    auto meshCount = model.Meshes.size();
+    if (meshCount > UINT32_MAX)
+    {
+        ELOGA("Error : Too Many Meshes. count = %zu", meshCount);
+        return false;
+    }
+
+    for(const auto& mesh : model.Meshes)
+    {
+        if (!ValidateMesh(mesh))
+        { return false; }
+    }
+
+    std::vector<ResMeshBinaryDesc> descs(meshCount);
+
+    // レイアウトを決定.
+    uint64_t offset = sizeof(ResModelBinaryHeader) + meshCount * sizeof(ResMeshBinaryDesc);
+    for(size_t i=0; i<meshCount; ++i)
+    {
+        const auto& mesh = model.Meshes[i];
+        auto& desc = descs[i];
+
+        desc.MeshName = offset;
+        offset += mesh.MeshName.size() + 1;
+
+        desc.MaterialName = offset;
+        offset += mesh.MaterialName.size() + 1;
+
+        desc.VertexCount = uint32_t(mesh.Positions.size());
+        desc.IndexCount  = uint32_t(mesh.Indices.size());
+    }
+
+    for(size_t i=0; i<meshCount; ++i)
+    {
+        auto& desc = descs[i];
+        for(uint32_t j=0; j<RES_MESH_STREAM_COUNT; ++j)
+        {
+            auto count = GetStreamCount(model.Meshes[i], j, quantized);
+            if (count == 0)
+            {
+                desc.Streams[j] = 0;
+                continue;
+            }
+
+            offset = AlignOffset(offset);
+            desc.Streams[j] = offset;
+            offset += count * GetStreamStride(j, quantized);
+        }
+    }
+
+    result.clear();
+    result.resize(size_t(AlignOffset(offset)), 0);
+
+    // データを書き込み.
+    auto pData = result.data();
+    memcpy(pData + sizeof(ResModelBinaryHeader), descs.data(), meshCount * sizeof(ResMeshBinaryDesc));
+
+    for(size_t i=0; i<meshCount; ++i)
+    {
+        const auto& mesh = model.Meshes[i];
+        const auto& desc = descs[i];
+
+        memcpy(pData + desc.MeshName,     mesh.MeshName.c_str(),     mesh.MeshName.size() + 1);
+        memcpy(pData + desc.MaterialName, mesh.MaterialName.c_str(), mesh.MaterialName.size() + 1);
+
+        for(uint32_t j=0; j<RES_MESH_STREAM_COUNT; ++j)
+        {
+            if (desc.Streams[j] != 0)
+            { WriteStream(mesh, j, quantized, pData + desc.Streams[j]); }
+        }
+    }
+
+    ResModelBinaryHeader header = {};
+    header.Magic     = RES_MODEL_BINARY_MAGIC;
+    header.Version   = RES_MODEL_BINARY_VERSION;
+    header.Flags     = flags;
+    header.MeshCount = uint32_t(meshCount);
+    header.FileSize  = result.size();
+    header.Hash      = CalcHash64(pData + sizeof(ResModelBinaryHeader), result.size() - sizeof(ResModelBinaryHeader));
+    memcpy(pData, &header, sizeof(header));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルリソースをバイナリ形式でファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SaveResModelBinaryA(const char* path, const ResModel& model, uint32_t flags)
+{
+    std::vector<uint8_t> binary;
+    if (!WriteResModelBinary(model, flags, binary))
+    { return false; }
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s(&pFile, path, "wb");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    return WriteFile(pFile, binary);
+}
+
+//-----------------------------------------------------------------------------
+//      モデルリソースをバイナリ形式でファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SaveResModelBinaryW(const wchar_t* path, const ResModel& model, uint32_t flags)
+{
+    std::vector<uint8_t> binary;
+    if (!WriteResModelBinary(model, flags, binary))
+    { return false; }
+
+    FILE* pFile = nullptr;
+    auto err = _wfopen_s(&pFile, path, L"wb");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %ls", path);
+        return false;
+    }
+
+    return WriteFile(pFile, binary);
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュのビューを展開してメッシュリソースを生成します.
+//-----------------------------------------------------------------------------
+void Expand(const ResMeshView& view, ResMesh& result)
+{
+    Dispose(result);
+
+    auto count = view.VertexCount;
+    result.MeshName     = (view.MeshName     != nullptr) ? view.MeshName     : "";
+    result.MaterialName = (view.MaterialName != nullptr) ? view.MaterialName : "";
+
+    if (view.Positions   != nullptr) { result.Positions  .assign(view.Positions,   view.Positions   + count); }
+    if (view.BoneIndices != nullptr) { result.BoneIndices.assign(view.BoneIndices, view.BoneIndices + count); }
+    if (view.Indices     != nullptr) { result.Indices    .assign(view.Indices,     view.Indices     + view.IndexCount); }
+
+    if (!view.Quantized)
+    {
+        if (view.Normals     != nullptr) { result.Normals    .assign(view.Normals,     view.Normals     + count); }
+        if (view.Tangents    != nullptr) { result.Tangents   .assign(view.Tangents,    view.Tangents    + count); }
+        if (view.Bitangents  != nullptr) { result.Bitangents .assign(view.Bitangents,  view.Bitangents  + count); }
+        if (view.Colors      != nullptr) { result.Colors     .assign(view.Colors,      view.Colors      + count); }
+        if (view.BoneWeights != nullptr) { result.BoneWeights.assign(view.BoneWeights, view.BoneWeights + count); }
+        for(auto i=0; i<MAX_LAYER_COUNT; ++i)
+        {
+            if (view.TexCoords[i] != nullptr)
+            { result.TexCoords[i].assign(view.TexCoords[i], view.TexCoords[i] + count); }
+        }
+        return;
+    }
+
+    if (view.EncodedTBNs != nullptr)
+    {
+        result.Normals   .resize(count);
+        result.Tangents  .resize(count);
+        result.Bitangents.resize(count);
+        for(uint32_t i=0; i<count; ++i)
+        { DecodeTBN(view.EncodedTBNs[i], result.Tangents[i], result.Bitangents[i], result.Normals[i]); }
+    }
+    else
+    {
+        // 法線の無いメッシュの接線は非圧縮で格納されている.
+        if (view.Tangents   != nullptr) { result.Tangents  .assign(view.Tangents,   view.Tangents   + count); }
+        if (view.Bitangents != nullptr) { result.Bitangents.assign(view.Bitangents, view.Bitangents + count); }
+    }
+
+    if (view.EncodedColors != nullptr)
+    {
+        result.Colors.resize(count);
+        for(uint32_t i=0; i<count; ++i)
+        { result.Colors[i] = DecodeColor(view.EncodedColors[i]); }
+    }
+
+    if (view.EncodedBoneWeights != nullptr)
+    {
+        result.BoneWeights.resize(count);
+        for(uint32_t i=0; i<count; ++i)
+        { result.BoneWeights[i] = DecodeHalf4(view.EncodedBoneWeights[i]); }
+    }
+
+    for(auto i=0; i<MAX_LAYER_COUNT; ++i)
+    {
+        if (view.EncodedTexCoords[i] == nullptr)
+        { continue; }
+
+        result.TexCoords[i].resize(count);
+        for(uint32_t j=0; j<count; ++j)
+        { result.TexCoords[i][j] = DecodeHalf2(view.EncodedTexCoords[i][j]); }
+    }
+}
+
+} // namespace asdx
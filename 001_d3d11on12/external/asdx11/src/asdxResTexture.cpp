@@ -10,6 +10,8 @@
 #include <asdxTexture.h>
 #include <asdxLogger.h>
 #include <asdxMath.h>
+#include <asdxMappedFile.h>
+#include <asdxThreadPool.h>
 #include <dxgiformat.h>
 #include <wincodec.h>
 #include <wrl/client.h>
@@ -17,6 +19,9 @@
 #include <memory>
 #include <string>
 #include <algorithm>
+#include <mutex>
+#include <intrin.h>
+#include <tmmintrin.h>
 
 
 //-------------------------------------------------------------------------------------------------
@@ -42,6 +47,10 @@ using Microsoft::WRL::ComPtr;
 //static const uint32_t MAX_TEXTURE_SIZE = 8192;   // D3D_FEATURE_LEVEL_10_0, D3D_FEATURE_LEVEL_10_1
 static const uint32_t MAX_TEXTURE_SIZE = 16384;  // D3D_FEATURE_LEVEL_11_0
 
+// 行単位で分割デコードを行うピクセル数の閾値と1ジョブ当たりのピクセル数.
+static const size_t SPLIT_DECODE_THRESHOLD  = 1024 * 1024;
+static const size_t SPLIT_DECODE_GRAIN_SIZE = 256 * 1024;
+
 // dwFlags Value
 static const unsigned int DDSD_CAPS         = 0x00000001;   // dwCaps/dwCaps2が有効.
 static const unsigned int DDSD_HEIGHT       = 0x00000002;   // dwHeightが有効.
@@ -128,6 +137,8 @@ enum NATIVE_TEXTURE_FORMAT
     NATIVE_TEXTURE_FORMAT_R32_FLOAT,
     NATIVE_TEXTURE_FORMAT_G32R32_FLOAT,
     NATIVE_TEXTURE_FORMAT_A32B32G32R32_FLOAT,
+    NATIVE_TEXTURE_FORMAT_BC6H,
+    NATIVE_TEXTURE_FORMAT_BC7,
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -201,6 +212,19 @@ typedef struct __DDSurfaceDesc
 } DDSurfaceDesc;
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// DDSHeaderDXT10 structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+typedef struct __DDSHeaderDXT10
+{
+    unsigned int    dxgiFormat;
+    unsigned int    resourceDimension;
+    unsigned int    miscFlag;
+    unsigned int    arraySize;
+    unsigned int    miscFlags2;
+} DDSHeaderDXT10;
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // WIC Pixel Format Translation Data
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -473,6 +497,10 @@ static WICConvert g_WICCustomConvert[] = {
 static IWICImagingFactory* GetWIC()
 {
     static IWICImagingFactory* s_Factory = nullptr;
+    static std::mutex          s_Mutex;
+
+    // ワーカースレッドから同時に呼ばれても生成は1回だけにする.
+    std::lock_guard<std::mutex> locker( s_Mutex );
 
     if ( s_Factory )
         return s_Factory;
@@ -652,8 +680,11 @@ size_t GetBitPerPixel( unsigned int format )
     case NATIVE_TEXTURE_FORMAT_BC3:
     case NATIVE_TEXTURE_FORMAT_BC5U:
     case NATIVE_TEXTURE_FORMAT_BC5S:
+    case NATIVE_TEXTURE_FORMAT_BC6H:
+    case NATIVE_TEXTURE_FORMAT_BC7:
         { return 8; }
 
+    case NATIVE_TEXTURE_FORMAT_L8A8:
     case NATIVE_TEXTURE_FORMAT_R16_FLOAT:
         { return 16; }
 
@@ -677,6 +708,208 @@ size_t GetBitPerPixel( unsigned int format )
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+//      DXGIフォーマットからネイティブフォーマットを取得します.
+//      DX10拡張ヘッダのデータはDXGIフォーマットの並びのまま格納されているため，
+//      ネイティブフォーマットはサブリソースのサイズ計算にのみ使用します.
+//-------------------------------------------------------------------------------------------------
+bool GetNativeFormat( unsigned int dxgiFormat, uint32_t& nativeFormat )
+{
+    switch( dxgiFormat )
+    {
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_ARGB_8888; }
+        break;
+
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_XBGR_8888; }
+        break;
+
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_R8; }
+        break;
+
+    case DXGI_FORMAT_A8_UNORM:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_A8; }
+        break;
+
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_L8A8; }
+        break;
+
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC1; }
+        break;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC2; }
+        break;
+
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC3; }
+        break;
+
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC4U; }
+        break;
+
+    case DXGI_FORMAT_BC4_SNORM:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC4S; }
+        break;
+
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC5U; }
+        break;
+
+    case DXGI_FORMAT_BC5_SNORM:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC5S; }
+        break;
+
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC6H; }
+        break;
+
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_BC7; }
+        break;
+
+    case DXGI_FORMAT_R16_FLOAT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_R16_FLOAT; }
+        break;
+
+    case DXGI_FORMAT_R16G16_FLOAT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_G16R16_FLOAT; }
+        break;
+
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_A16B16G16R16_FLOAT; }
+        break;
+
+    case DXGI_FORMAT_R32_FLOAT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_R32_FLOAT; }
+        break;
+
+    case DXGI_FORMAT_R32G32_FLOAT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_G32R32_FLOAT; }
+        break;
+
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        { nativeFormat = NATIVE_TEXTURE_FORMAT_A32B32G32R32_FLOAT; }
+        break;
+
+    default:
+        { return false; }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      DX10拡張ヘッダを解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseHeaderDXT10
+(
+    const DDSHeaderDXT10&   ext,
+    uint32_t                depth,
+    asdx::ResTexture&       resTexture,
+    uint32_t&               nativeFormat
+)
+{
+    if ( !GetNativeFormat( ext.dxgiFormat, nativeFormat ) )
+    {
+        ELOG( "Error : Unsupported DXGI Format. format = %u", ext.dxgiFormat );
+        return false;
+    }
+
+    if ( ext.arraySize == 0 )
+    {
+        ELOG( "Error : Invalid Array Size." );
+        return false;
+    }
+
+    switch( ext.resourceDimension )
+    {
+    case 2: // D3D10_RESOURCE_DIMENSION_TEXTURE1D
+        {
+            resTexture.SurfaceCount = ext.arraySize;
+        }
+        break;
+
+    case 3: // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        {
+            // D3D10_RESOURCE_MISC_TEXTURECUBE の場合は6面を1要素として数える.
+            if ( ext.miscFlag & 0x4 )
+            {
+                resTexture.SurfaceCount = ext.arraySize * 6;
+                resTexture.Option |= asdx::SUBRESOURCE_OPTION_CUBEMAP;
+            }
+            else
+            {
+                resTexture.SurfaceCount = ext.arraySize;
+                resTexture.Option &= ~asdx::SUBRESOURCE_OPTION_CUBEMAP;
+            }
+        }
+        break;
+
+    case 4: // D3D10_RESOURCE_DIMENSION_TEXTURE3D
+        {
+            if ( ext.arraySize != 1 )
+            {
+                ELOG( "Error : Invalid Array Size." );
+                return false;
+            }
+
+            resTexture.SurfaceCount = 1;
+            resTexture.Depth        = depth;
+            resTexture.Option |= asdx::SUBRESOURCE_OPTION_VOLUME;
+        }
+        break;
+
+    default:
+        {
+            ELOG( "Error : Invalid Resource Dimension. dimension = %u", ext.resourceDimension );
+            return false;
+        }
+    }
+
+    resTexture.Format = ext.dxgiFormat;
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 //      最大値を取得します.
 //-------------------------------------------------------------------------------------------------
@@ -741,343 +974,504 @@ std::string GetExtA( const char* filePath )
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      8Bitインデックスカラー形式を解析します.
-//!
-//! @param[in]      pColorMap       カラーマップです.
+//! @brief      SSSE3命令がサポートされているかチェックします.
 //-------------------------------------------------------------------------------------------------
-void Parse8Bits( FILE* pFile, uint32_t size, uint8_t* pColorMap, uint8_t* pPixels )
+bool IsSupportSSSE3()
 {
-    uint8_t color = 0;
-    for( uint32_t i=0; i<size; ++i )
+    static const bool s_Support = []()
     {
-        color = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 2 ] = pColorMap[ color * 3 + 0 ];
-        pPixels[ i * 4 + 1 ] = pColorMap[ color * 3 + 1 ];
-        pPixels[ i * 4 + 0 ] = pColorMap[ color * 3 + 2 ];
-        pPixels[ i * 4 + 3 ] = 255;
-    }
+        int info[4] = {};
+        __cpuid( info, 1 );
+        return ( info[2] & ( 0x1 << 9 ) ) != 0;
+    }();
+    return s_Support;
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      16Bitフルカラー形式を解析します.
+//! @brief      行単位で処理します. 大きな画像はスレッドプールで分割して処理します.
 //-------------------------------------------------------------------------------------------------
-void Parse16Bits( FILE* pFile, uint32_t size, uint8_t* pPixels )
+template<typename Func>
+void ForEachRows( asdx::ThreadPool* pPool, uint32_t width, uint32_t height, Func func )
 {
-    for( uint32_t i=0; i<size; ++i )
+    auto count = size_t( width ) * height;
+    if ( pPool == nullptr || count < SPLIT_DECODE_THRESHOLD )
     {
-        uint16_t color = fgetc( pFile ) + ( fgetc( pFile ) << 8 );
-        pPixels[ i * 4 + 0 ] = (uint8_t)(( ( color & 0x7C00 ) >> 10 ) << 3);
-        pPixels[ i * 4 + 1 ] = (uint8_t)(( ( color & 0x03E0 ) >>  5 ) << 3);
-        pPixels[ i * 4 + 2 ] = (uint8_t)(( ( color & 0x001F ) >>  0 ) << 3);
-        pPixels[ i * 4 + 3 ] = 255;
+        func( 0, height );
+        return;
     }
+
+    auto grainSize = uint32_t( SPLIT_DECODE_GRAIN_SIZE / width );
+    pPool->ParallelFor( height, ( grainSize > 0 ) ? grainSize : 1, func );
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      24Bitフルカラー形式を解析します.
+// TGA ピクセル変換関数の型です.
 //-------------------------------------------------------------------------------------------------
-void Parse24Bits( FILE* pFile, uint32_t size, uint8_t* pPixels )
-{
-    for( uint32_t i=0; i<size; ++i )
-    {
-        pPixels[ i * 4 + 2 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 1 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 0 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 3 ] = 255;
-    }
-}
+typedef void (*TgaConvertFunc)( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* pPalette );
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      32Bitフルカラー形式を解析します.
+//! @brief      8Bitインデックスカラーをパレットを用いてRGBAに変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse32Bits( FILE* pFile, uint32_t size, uint8_t* pPixels )
+void ConvertIndex8( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* pPalette )
 {
-    for( uint32_t i=0; i<size; ++i )
-    {
-        pPixels[ i * 4 + 2 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 1 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 0 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 4 + 3 ] = (uint8_t)fgetc( pFile );
-    }
+    auto pOut = reinterpret_cast<uint32_t*>( pDst );
+    for( size_t i=0; i<count; ++i )
+    { memcpy( &pOut[i], &pPalette[ pSrc[i] ], sizeof(uint32_t) ); }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief     8Bitグレースケール形式を解析します.
+//! @brief      16Bit(X1R5G5B5)カラーをRGBAに変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse8BitsGrayScale( FILE* pFile, uint32_t size, uint8_t* pPixels )
+void ConvertBGR16( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* )
 {
-    for( uint32_t i=0; i<size; ++i )
+    size_t i = 0;
+
+    // 8ピクセルずつ処理.
+    const auto mask  = _mm_set1_epi16( 0xF8 );
+    const auto alpha = _mm_set1_epi8( -1 );
+    for( ; i + 8 <= count; i += 8 )
     {
-        pPixels[ i ] = (uint8_t)fgetc( pFile );
+        auto c  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 2 ) );
+        auto r  = _mm_and_si128( _mm_srli_epi16( c, 7 ), mask );
+        auto g  = _mm_and_si128( _mm_srli_epi16( c, 2 ), mask );
+        auto b  = _mm_and_si128( _mm_slli_epi16( c, 3 ), mask );
+        auto rg = _mm_unpacklo_epi8( _mm_packus_epi16( r, r ), _mm_packus_epi16( g, g ) );
+        auto ba = _mm_unpacklo_epi8( _mm_packus_epi16( b, b ), alpha );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 + 0  ), _mm_unpacklo_epi16( rg, ba ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 + 16 ), _mm_unpackhi_epi16( rg, ba ) );
     }
-}
 
-//-------------------------------------------------------------------------------------------------
-//! @brief      16Bitグレースケール形式を解析します.
-//-------------------------------------------------------------------------------------------------
-void Parse16BitsGrayScale( FILE* pFile, uint32_t size, uint8_t* pPixels )
-{
-    for( uint32_t i=0; i<size; ++i )
+    for( ; i<count; ++i )
     {
-        pPixels[ i * 2 + 0 ] = (uint8_t)fgetc( pFile );
-        pPixels[ i * 2 + 1 ] = (uint8_t)fgetc( pFile );
+        uint16_t color = uint16_t( pSrc[ i * 2 + 0 ] | ( pSrc[ i * 2 + 1 ] << 8 ) );
+        pDst[ i * 4 + 0 ] = (uint8_t)(( ( color & 0x7C00 ) >> 10 ) << 3);
+        pDst[ i * 4 + 1 ] = (uint8_t)(( ( color & 0x03E0 ) >>  5 ) << 3);
+        pDst[ i * 4 + 2 ] = (uint8_t)(( ( color & 0x001F ) >>  0 ) << 3);
+        pDst[ i * 4 + 3 ] = 255;
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      8BitRLE圧縮インデックスカラー形式を解析します.
-//!
-//! @param[in]  pColorMap       カラーマップです.
+//! @brief      24Bit(BGR)カラーをRGBAに変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse8BitsRLE( FILE* pFile, uint8_t* pColorMap, uint32_t size, uint8_t* pPixels )
+void ConvertBGR24( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* )
 {
-    uint32_t count  = 0;
-    uint8_t  color  = 0;
-    uint8_t  header = 0;
-    uint8_t* ptr    = pPixels;
+    size_t i = 0;
 
-    while( ptr < pPixels + size )   // size = width * height * 3.
+    // 4ピクセルずつ処理. 16byte読み込むため末尾の 6 ピクセル未満はスカラーで処理.
+    if ( IsSupportSSSE3() )
     {
-        header = (uint8_t)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
-
-        if ( header & 0x80 )
+        const auto shuffle = _mm_setr_epi8( 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1 );
+        const auto alpha   = _mm_set1_epi32( int( 0xFF000000 ) );
+        for( ; i + 6 <= count; i += 4 )
         {
-            color = (uint8_t)fgetc( pFile );
-
-            //for( uint32_t i=0; i<count; ++i, ptr+=3 )
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = pColorMap[ color * 3 + 2 ];
-                ptr[ 1 ] = pColorMap[ color * 3 + 1 ];
-                ptr[ 2 ] = pColorMap[ color * 3 + 0 ];
-                ptr[ 3 ] = 255;
-            }
+            auto c = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 3 ) );
+            c = _mm_or_si128( _mm_shuffle_epi8( c, shuffle ), alpha );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 ), c );
         }
-        else
-        {
-            //for( uint32_t i=0; i<count; ++i, ptr+=3 )
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                color = (uint8_t)fgetc( pFile );
+    }
 
-                ptr[ 0 ] = pColorMap[ color * 3 + 2 ];
-                ptr[ 1 ] = pColorMap[ color * 3 + 1 ];
-                ptr[ 2 ] = pColorMap[ color * 3 + 0 ];
-                ptr[ 3 ] = 255;
-            }
-        }
+    for( ; i<count; ++i )
+    {
+        pDst[ i * 4 + 0 ] = pSrc[ i * 3 + 2 ];
+        pDst[ i * 4 + 1 ] = pSrc[ i * 3 + 1 ];
+        pDst[ i * 4 + 2 ] = pSrc[ i * 3 + 0 ];
+        pDst[ i * 4 + 3 ] = 255;
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      16BitRLE圧縮フルカラー形式を解析します.
+//! @brief      32Bit(BGRA)カラーをRGBAに変換します.
 //-------------------------------------------------------------------------------------------------
-void Parse16BitsRLE( FILE* pFile, uint32_t size, uint8_t* pPixels )
+void ConvertBGR32( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* )
 {
-    uint32_t count  = 0;
-    uint16_t color  = 0;
-    uint8_t  header = 0;
-    uint8_t* ptr    = pPixels;
+    size_t i = 0;
 
-    while( ptr < pPixels + size )   // size = width * height * 3.
+    // 4ピクセルずつ処理. R と B を入れ替える.
+    const auto maskGA = _mm_set1_epi32( int( 0xFF00FF00 ) );
+    const auto maskB  = _mm_set1_epi32( 0x000000FF );
+    for( ; i + 4 <= count; i += 4 )
     {
-        header = (uint8_t)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
-
-        if ( header & 0x80 )
-        {
-            color = fgetc( pFile ) + ( fgetc( pFile ) << 8 ); 
-
-            //for( uint32_t i=0; i<count; ++i, ptr+=3 )
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = (uint8_t)(( ( color & 0x7C00 ) >> 10 ) << 3);
-                ptr[ 1 ] = (uint8_t)(( ( color & 0x03E0 ) >>  5 ) << 3);
-                ptr[ 2 ] = (uint8_t)(( ( color & 0x001F ) >>  0 ) << 3);
-                ptr[ 3 ] = 255;
-            }
-        }
-        else
-        {
-            //for( uint32_t i=0; i<count; ++i, ptr+=3 )
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                color = fgetc( pFile ) + ( fgetc( pFile ) << 8 );
+        auto c  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i * 4 ) );
+        auto ga = _mm_and_si128( c, maskGA );
+        auto r  = _mm_and_si128( _mm_srli_epi32( c, 16 ), maskB );
+        auto b  = _mm_slli_epi32( _mm_and_si128( c, maskB ), 16 );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( pDst + i * 4 ), _mm_or_si128( ga, _mm_or_si128( r, b ) ) );
+    }
 
-                ptr[ 0 ] = (uint8_t)(( ( color & 0x7C00 ) >> 10 ) << 3);
-                ptr[ 1 ] = (uint8_t)(( ( color & 0x03E0 ) >>  5 ) << 3);
-                ptr[ 2 ] = (uint8_t)(( ( color & 0x001F ) >>  0 ) << 3);
-                ptr[ 3 ] = 255;
-            }
-        }
+    for( ; i<count; ++i )
+    {
+        pDst[ i * 4 + 0 ] = pSrc[ i * 4 + 2 ];
+        pDst[ i * 4 + 1 ] = pSrc[ i * 4 + 1 ];
+        pDst[ i * 4 + 2 ] = pSrc[ i * 4 + 0 ];
+        pDst[ i * 4 + 3 ] = pSrc[ i * 4 + 3 ];
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      24BitRLE圧縮フルカラー形式を解析します.
+//! @brief      8Bitグレースケールをコピーします.
 //-------------------------------------------------------------------------------------------------
-void Parse24BitsRLE( FILE* pFile, uint32_t size, uint8_t* pPixels )
-{
-    uint32_t count    = 0;
-    uint8_t  color[3] = { 0, 0, 0 };
-    uint8_t  header   = 0;
-    uint8_t* ptr      = pPixels;
+void ConvertGray8( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* )
+{ memcpy( pDst, pSrc, count ); }
 
-    while( ptr < pPixels + size )   // size = width * height * 3.
-    {
-        header = (uint8_t)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
+//-------------------------------------------------------------------------------------------------
+//! @brief      16Bitグレースケール(輝度+アルファ)をコピーします.
+//-------------------------------------------------------------------------------------------------
+void ConvertGray16( const uint8_t* pSrc, uint8_t* pDst, size_t count, const uint32_t* )
+{ memcpy( pDst, pSrc, count * 2 ); }
 
-        if ( header & 0x80 )
-        {
-            fread( color, sizeof(uint8_t), 3, pFile );
+//-------------------------------------------------------------------------------------------------
+//! @brief      非圧縮のピクセルデータを解析します.
+//-------------------------------------------------------------------------------------------------
+bool ParseTgaPixels
+(
+    const uint8_t*      pSrc,
+    const uint8_t*      pEnd,
+    uint32_t            width,
+    uint32_t            height,
+    uint32_t            srcBytes,
+    uint32_t            dstBytes,
+    TgaConvertFunc      convert,
+    const uint32_t*     pPalette,
+    uint8_t*            pPixels,
+    asdx::ThreadPool*   pPool
+)
+{
+    if ( size_t( pEnd - pSrc ) / srcBytes < size_t( width ) * height )
+    { return false; }
 
-            //for( uint32_t i=0; i<count; ++i, ptr+=3 )
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = color[ 2 ];
-                ptr[ 1 ] = color[ 1 ];
-                ptr[ 2 ] = color[ 0 ];
-                ptr[ 3 ] = 255;
-            }
-        }
-        else
-        {
-            //for( uint32_t i=0; i<count; ++i, ptr+=3 )
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 2 ] = (uint8_t)fgetc( pFile );
-                ptr[ 1 ] = (uint8_t)fgetc( pFile );
-                ptr[ 0 ] = (uint8_t)fgetc( pFile );
-                ptr[ 3 ] = 255;
-            }
-        }
-    }
+    ForEachRows( pPool, width, height, [&]( uint32_t begin, uint32_t end )
+    {
+        auto offset = size_t( begin ) * width;
+        convert( pSrc + offset * srcBytes, pPixels + offset * dstBytes, size_t( end - begin ) * width, pPalette );
+    });
+    return true;
 }
 
 //-------------------------------------------------------------------------------------------------
-//! @brief      32BitRLE圧縮フルカラー形式を解析します.
+//! @brief      RLE圧縮されたピクセルデータを解析します.
 //-------------------------------------------------------------------------------------------------
-void Parse32BitsRLE( FILE* pFile, uint32_t size, uint8_t* pPixels )
+bool ParseTgaPixelsRLE
+(
+    const uint8_t*  pSrc,
+    const uint8_t*  pEnd,
+    size_t          count,
+    uint32_t        srcBytes,
+    uint32_t        dstBytes,
+    TgaConvertFunc  convert,
+    const uint32_t* pPalette,
+    uint8_t*        pPixels
+)
 {
-    uint32_t count    = 0;
-    uint8_t  color[4] = { 0, 0, 0, 0 };
-    uint8_t  header   = 0;
-    uint8_t* ptr      = pPixels;
-
-    while( ptr < pPixels + size )   // size = width * height * 4.
+    size_t i = 0;
+    while( i < count )
     {
-        header = (uint8_t)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
+        if ( pSrc >= pEnd )
+        { return false; }
+
+        auto header = *pSrc++;
+        auto run    = size_t( 1 + ( header & 0x7F ) );
+        if ( count - i < run )
+        { return false; }
 
+        auto ptr = pPixels + i * dstBytes;
         if ( header & 0x80 )
         {
-            fread( color, sizeof(uint8_t), 4, pFile );
+            if ( size_t( pEnd - pSrc ) < srcBytes )
+            { return false; }
 
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 0 ] = color[ 2 ];
-                ptr[ 1 ] = color[ 1 ];
-                ptr[ 2 ] = color[ 0 ];
-                ptr[ 3 ] = color[ 3 ];
-            }
+            // 先頭ピクセルだけ変換して，残りは複製.
+            convert( pSrc, ptr, 1, pPalette );
+            for( size_t j=1; j<run; ++j )
+            { memcpy( ptr + j * dstBytes, ptr, dstBytes ); }
+
+            pSrc += srcBytes;
         }
         else
         {
-            for( uint32_t i=0; i<count; ++i, ptr+=4 )
-            {
-                ptr[ 2 ] = (uint8_t)fgetc( pFile );
-                ptr[ 1 ] = (uint8_t)fgetc( pFile );
-                ptr[ 0 ] = (uint8_t)fgetc( pFile );
-                ptr[ 3 ] = (uint8_t)fgetc( pFile );
-            }
+            if ( size_t( pEnd - pSrc ) / srcBytes < run )
+            { return false; }
+
+            convert( pSrc, ptr, run, pPalette );
+            pSrc += run * srcBytes;
         }
+
+        i += run;
     }
+
+    return true;
 }
 
-//-------------------------------------------------------------------------------------------------
-//! @brief      8BitRLE圧縮グレースケール形式を解析します.
-//-------------------------------------------------------------------------------------------------
-void Parse8BitsGrayScaleRLE( FILE* pFile, uint32_t size, uint8_t* pPixles )
+//------------------------------------------------------------------------------------------
+//      HDRファイルのヘッダから1行読み取ります(fgets()と同じく改行を含みます).
+//------------------------------------------------------------------------------------------
+bool ReadHdrLine( const uint8_t*& pCur, const uint8_t* pEnd, char* buf, size_t bufSize )
 {
-    uint32_t count  = 0;
-    uint8_t  color  = 0;
-    uint8_t  header = 0;
-    uint8_t* ptr    = pPixles;
+    if ( pCur >= pEnd )
+    { return false; }
 
-    while( ptr < pPixles + size ) // size = width * height
+    size_t i = 0;
+    while( pCur < pEnd && i + 1 < bufSize )
     {
-        header = (uint8_t)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
-
-        if ( header & 0x80 )
-        {
-            color = (uint8_t)fgetc( pFile );
-
-            for( uint32_t i=0; i<count; ++i, ptr++ )
-            { (*ptr) = color; }
-        }
-        else
-        {
-            for( uint32_t i=0; i<count; ++i, ptr++ )
-            { (*ptr) = (uint8_t)fgetc( pFile ); }
-        }
+        auto c = char( *pCur++ );
+        buf[i++] = c;
+        if ( c == '\n' )
+        { break; }
     }
+    buf[i] = '\0';
+    return true;
 }
 
-//-------------------------------------------------------------------------------------------------
-//! @brief      16BitRLE圧縮グレースケール形式を解析します.
-//-------------------------------------------------------------------------------------------------
-void Parse16BitsGrayScaleRLE( FILE* pFile, uint32_t size, uint8_t* pPixles )
+//------------------------------------------------------------------------------------------
+//      HDRファイルのヘッダを読み込みします.
+//------------------------------------------------------------------------------------------
+bool ReadHdrHeader
+(
+    const uint8_t*& pCur,
+    const uint8_t*  pEnd,
+    int32_t&        width,
+    int32_t&        height,
+    float&          gamma,
+    float&          exposure
+)
 {
-    uint32_t count  = 0;
-    uint8_t  color  = 0;
-    uint8_t  alpha  = 0;
-    uint8_t  header = 0;
-    uint8_t* ptr    = pPixles;
+    if ( pEnd - pCur < 2 || pCur[0] != '#' || pCur[1] != '?' )
+    { return false; }
+    pCur += 2;
 
-    while( ptr < pPixles + size ) // size = width * height * 2
+    char buf[ 256 ];
+    auto valid = false;
+    for( ;; )
     {
-        header = (uint8_t)fgetc( pFile );
-        count = 1 + ( header & 0x7F );
-
-        if ( header & 0x80 )
-        {
-            color = (uint8_t)fgetc( pFile );
-            alpha = (uint8_t)fgetc( pFile );
+        if ( !ReadHdrLine( pCur, pEnd, buf, sizeof(buf) ) )
+        { break; }
 
-            for( uint32_t i=0; i<count; ++i, ptr+=2 )
-            {
-                ptr[ 0 ] = color;
-                ptr[ 1 ] = alpha;
-            }
-        }
+        if ( buf[0] == '\n' )
+        { break; }
+        else if ( buf[0] == '#' )
+        { continue; }
         else
         {
-            for( uint32_t i=0; i<count; ++i, ptr+=2 )
-            {
-                ptr[ 0 ] = (uint8_t)fgetc( pFile );
-                ptr[ 1 ] = (uint8_t)fgetc( pFile );
-            }
+            auto g = 1.0f;
+            auto e = 1.0f;
+            if ( sscanf_s( buf, "GAMMA=%f\n", &g ) != 0 )
+            { gamma = g; }
+            else if ( sscanf_s( buf, "EXPOSURE=%f\n", &e ) != 0 )
+            { exposure = e; }
+            else if ( strcmp( buf, "FORMAT=32-bit_rle_rgbe\n" ) == 0 )
+            { valid = true; }
         }
     }
-}
 
-//-----------------------------------------------------------------------------
-//      nullptrかどうかを考慮してdelete[]します.
-//-----------------------------------------------------------------------------
-template<typename T>
-void SafeDeleteArray(T*& ptr)
-{
-    if (ptr != nullptr)
+    if ( !valid )
+    { return false; }
+
+    if ( !ReadHdrLine( pCur, pEnd, buf, sizeof(buf) ) )
+    { return false; }
+
+    auto w = 0;
+    auto h = 0;
+    if ( sscanf_s( buf, "-Y %d +X %d\n", &h, &w ) == 2 )
     {
-        delete[] ptr;
-        ptr = nullptr;
+        width  = w;
+        height = h;
     }
-}
-
-} // namespace /* anonymous */
+    else if ( sscanf_s( buf, "+X %d -Y %d\n", &w, &h ) == 2 )
+    {
+        width  = w;
+        height = h;
+    }
+    else
+    { return false; }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+//      旧形式のカラーを読み取ります.
+//------------------------------------------------------------------------------------------
+bool ReadOldColors
+(
+    const uint8_t*& pCur,
+    const uint8_t*  pEnd,
+    const RGBE*     pImage,
+    RGBE*           pLine,
+    int32_t         count
+)
+{
+    auto shift = 0;
+    while( 0 < count )
+    {
+        if ( pEnd - pCur < 4 )
+        { return false; }
+
+        RGBE color;
+        memcpy( color.v, pCur, sizeof(color.v) );
+        pCur += 4;
+
+        if ( color.r == 1
+          && color.g == 1
+          && color.b == 1 )
+        {
+            // 繰り返し対象の直前ピクセルが無い, または範囲外.
+            if ( pLine == pImage || 24 < shift )
+            { return false; }
+
+            auto run = uint64_t( color.e ) << shift;
+            if ( uint64_t( count ) < run )
+            { return false; }
+
+            auto prev = pLine[-1];
+            for( uint64_t i=0; i<run; ++i )
+            { pLine[i] = prev; }
+
+            pLine += run;
+            count -= int32_t( run );
+            shift += 8;
+        }
+        else
+        {
+            (*pLine) = color;
+            pLine++;
+            count--;
+            shift = 0;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+//      カラーを読み取ります.
+//------------------------------------------------------------------------------------------
+bool ReadColor
+(
+    const uint8_t*& pCur,
+    const uint8_t*  pEnd,
+    const RGBE*     pImage,
+    RGBE*           pLine,
+    int32_t         count
+)
+{
+    if ( count < 8 || 0x7fff < count )
+    { return ReadOldColors( pCur, pEnd, pImage, pLine, count ); }
+
+    if ( pEnd - pCur < 4 )
+    { return false; }
+
+    // 新形式のRLEでなければ旧形式として読み取り.
+    if ( pCur[0] != 2 || pCur[1] != 2 || ( pCur[2] & 128 ) )
+    { return ReadOldColors( pCur, pEnd, pImage, pLine, count ); }
+
+    if ( ( pCur[2] << 8 | pCur[3] ) != count )
+    { return false; }
+
+    pCur += 4;
+
+    for( auto i=0; i<4; ++i )
+    {
+        for( auto j=0; j<count; )
+        {
+            if ( pCur >= pEnd )
+            { return false; }
+
+            auto code = int32_t( *pCur++ );
+            if ( 128 < code )
+            {
+                code &= 127;
+                if ( pCur >= pEnd || count - j < code )
+                { return false; }
+
+                auto val = *pCur++;
+                while( code-- )
+                { pLine[j++].v[i] = val; }
+            }
+            else
+            {
+                if ( code == 0 || count - j < code || pEnd - pCur < code )
+                { return false; }
+
+                while( code-- )
+                { pLine[j++].v[i] = *pCur++; }
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+//      RGBE形式から浮動小数形式(RGBA)に変換します.
+//------------------------------------------------------------------------------------------
+void ConvertRGBEToFloat( const RGBE* pSrc, float* pDst, size_t count )
+{
+    size_t i = 0;
+
+    // ldexp(1, e - 136) を指数ビットから直接生成する.
+    // e < 10 では非正規化数になるため 2^32 倍した値を経由して丸めを1回に抑える.
+    const auto zero     = _mm_setzero_si128();
+    const auto bias     = _mm_set1_epi32( 9 );
+    const auto biasLow  = _mm_set1_epi32( 23 );
+    const auto scaleLow = _mm_set1_ps( 1.0f / 4294967296.0f );
+    const auto maskRGB  = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+    const auto alpha    = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+
+    for( ; i + 4 <= count; i += 4 )
+    {
+        auto c  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( pSrc + i ) );
+        auto lo = _mm_unpacklo_epi8( c, zero );
+        auto hi = _mm_unpackhi_epi8( c, zero );
+
+        __m128i pixels[4] = {
+            _mm_unpacklo_epi16( lo, zero ),
+            _mm_unpackhi_epi16( lo, zero ),
+            _mm_unpacklo_epi16( hi, zero ),
+            _mm_unpackhi_epi16( hi, zero ),
+        };
+
+        for( auto j=0; j<4; ++j )
+        {
+            auto e  = _mm_shuffle_epi32( pixels[j], _MM_SHUFFLE( 3, 3, 3, 3 ) );
+            auto v  = _mm_cvtepi32_ps( pixels[j] );
+            auto sH = _mm_castsi128_ps( _mm_slli_epi32( _mm_sub_epi32( e, bias ), 23 ) );
+            auto sL = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( e, biasLow ), 23 ) );
+            auto vH = _mm_mul_ps( v, sH );
+            auto vL = _mm_mul_ps( _mm_mul_ps( v, sL ), scaleLow );
+
+            auto isHigh = _mm_castsi128_ps( _mm_cmpgt_epi32( e, bias ) );
+            auto isZero = _mm_castsi128_ps( _mm_cmpeq_epi32( e, zero ) );
+            auto result = _mm_or_ps( _mm_and_ps( isHigh, vH ), _mm_andnot_ps( isHigh, vL ) );
+            result = _mm_andnot_ps( isZero, result );
+            result = _mm_or_ps( _mm_and_ps( result, maskRGB ), alpha );
+
+            _mm_storeu_ps( pDst + ( i + j ) * 4, result );
+        }
+    }
+
+    for( ; i<count; ++i )
+    {
+        auto pix = RGBEToVec3( pSrc[i] );
+        pDst[ i * 4 + 0 ] = pix.x;
+        pDst[ i * 4 + 1 ] = pix.y;
+        pDst[ i * 4 + 2 ] = pix.z;
+        pDst[ i * 4 + 3 ] = 1.0f;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      nullptrかどうかを考慮してdelete[]します.
+//-----------------------------------------------------------------------------
+template<typename T>
+void SafeDeleteArray(T*& ptr)
+{
+    if (ptr != nullptr)
+    {
+        delete[] ptr;
+        ptr = nullptr;
+    }
+}
+
+} // namespace /* anonymous */
 
 
 namespace asdx {
@@ -1914,7 +2308,7 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
 
             case FOURCC_BC4S:
                 {
-                    resTexture.Format = DXGI_FORMAT_BC5_SNORM;
+                    resTexture.Format = DXGI_FORMAT_BC4_SNORM;
                     nativeFormat      = NATIVE_TEXTURE_FORMAT_BC4S;
                     isSupportFormat   = true;
                 }
@@ -1939,6 +2333,10 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
 
             case FOURCC_DX10:
                 {
+                    // 拡張ヘッダを読み込み.
+                    DDSHeaderDXT10 ext = {};
+                    if ( fread( &ext, sizeof( DDSHeaderDXT10 ), 1, pFile ) == 1 )
+                    { isSupportFormat = ParseHeaderDXT10( ext, depth, resTexture, nativeFormat ); }
                 }
                 break;
 
@@ -2202,7 +2600,7 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
     switch( nativeFormat )
     {
         // 一括読み込みでくるっているので修正.
-        case NATIVE_TEXTURE_FORMAT_ARGB_8888:
+        case NATIVE_TEXTURE_FORMAT_ABGR_8888:
         case NATIVE_TEXTURE_FORMAT_XRGB_8888:
         {
             for( size_t i=0; i<pixelSize; i+=4 )
@@ -2224,14 +2622,14 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
     // リソースデータのメモリを確保.
     resTexture.pResources = new SubResource[ resTexture.MipMapCount * resTexture.SurfaceCount ];
 
-    // 各ミップレベルごとに処理.
-    for ( size_t j=0; j<resTexture.MipMapCount; ++j )
+    // サーフェイスごとに全てのミップレベルが並んでいる.
+    for( size_t i=0; i<resTexture.SurfaceCount; ++i )
     {
         size_t w = width;
         size_t h = height;
         size_t d = depth;
 
-        for( size_t i=0; i<resTexture.SurfaceCount; ++i )
+        for ( size_t j=0; j<resTexture.MipMapCount; ++j )
         {
             size_t rowBytes = 0;
             size_t numRows  = 0;
@@ -2244,7 +2642,9 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
               || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC4U )
               || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC4S )
               || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC5U )
-              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC5S ) )
+              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC5S )
+              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC6H )
+              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC7 ) )
             {
                 size_t bcPerBlock = 0;
                 size_t blockWide  = 0;
@@ -2259,13 +2659,8 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
                 else
                 { bcPerBlock = 16; }
 
-                // 横幅が1以上の場合.
-                if ( w > 0 )
-                { blockWide = Max< size_t >( 1, ( w + 3 ) / 4 ); }
-
-                // 縦幅が異常の場合.
-                if ( h > 0 )
-                { blockHigh = Max< size_t >( 1, ( h + 3 ) / 4 ); }
+                blockWide = Max< size_t >( 1, ( w + 3 ) / 4 );
+                blockHigh = Max< size_t >( 1, ( h + 3 ) / 4 );
 
                 // 一行のバイト数.
                 rowBytes = blockWide * bcPerBlock;
@@ -2289,6 +2684,19 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
             // データ数 = (1行当たりのバイト数) * 行数.
             numBytes = rowBytes * numRows;
 
+            // データ範囲をチェック.
+            if ( offset + numBytes > pixelSize )
+            {
+                // 不要になったメモリを解放.
+                delete [] pPixelData;
+
+                // エラーログ出力.
+                ELOG( "Error : Out of Range." );
+
+                // 異常終了.
+                return false;
+            }
+
             // リソースデータを設定.
             resTexture.pResources[ idx ].Width      = uint32_t( w );
             resTexture.pResources[ idx ].Height     = uint32_t( h );
@@ -2297,8 +2705,11 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
             resTexture.pResources[ idx ].pPixels    = new uint8_t [ numBytes ];
 
             // NULLチェック.
-            if ( resTexture.pResources[ i ].pPixels == nullptr )
+            if ( resTexture.pResources[ idx ].pPixels == nullptr )
             {
+                // 不要になったメモリを解放.
+                delete [] pPixelData;
+
                 // エラーログ出力.
                 ELOG( "Error : Memory Allocate Failed." );
 
@@ -2314,17 +2725,17 @@ bool CreateResTextureFromDDSFile(FILE* pFile, asdx::ResTexture& resTexture)
 
             // インデックスをカウントアップ.
             idx++;
-        }
 
-        // 横幅，縦幅を更新.
-        w = w >> 1;
-        h = h >> 1;
-        d = d >> 1;
+            // 横幅，縦幅を更新.
+            w = w >> 1;
+            h = h >> 1;
+            d = d >> 1;
 
-        // クランプ処理.
-        if ( w == 0 ) { w = 1; }
-        if ( h == 0 ) { h = 1; }
-        if ( d == 0 ) { d = 1; }
+            // クランプ処理.
+            if ( w == 0 ) { w = 1; }
+            if ( h == 0 ) { h = 1; }
+            if ( d == 0 ) { d = 1; }
+        }
     }
 
     // 不要になったメモリを解放.
@@ -2367,6 +2778,137 @@ bool CreateResTextureFromDDSFileW(const wchar_t* filename, asdx::ResTexture& res
     return CreateResTextureFromDDSFile(pFile, resTexture);
 }
 
+//-------------------------------------------------------------------------------------------------
+//      リソーステクスチャをDDSファイルに保存します.
+//-------------------------------------------------------------------------------------------------
+bool SaveResTextureToDDSFile(FILE* pFile, const asdx::ResTexture& resTexture)
+{
+    if ( resTexture.pResources == nullptr || ( resTexture.Option & SUBRESOURCE_OPTION_VOLUME ) )
+    {
+        ELOG( "Error : Invalid Argument." );
+        fclose( pFile );
+        return false;
+    }
+
+    auto mipCount     = ( resTexture.MipMapCount  > 0 ) ? resTexture.MipMapCount  : 1;
+    auto surfaceCount = ( resTexture.SurfaceCount > 0 ) ? resTexture.SurfaceCount : 1;
+    auto isCube       = ( resTexture.Option & SUBRESOURCE_OPTION_CUBEMAP ) != 0;
+    auto isCompressed = ( resTexture.Format >= DXGI_FORMAT_BC1_TYPELESS && resTexture.Format <= DXGI_FORMAT_BC5_SNORM )
+                     || ( resTexture.Format >= DXGI_FORMAT_BC6H_TYPELESS && resTexture.Format <= DXGI_FORMAT_BC7_UNORM_SRGB );
+
+    DDSurfaceDesc ddsd = {};
+    ddsd.size         = sizeof( DDSurfaceDesc );
+    ddsd.flags        = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
+    ddsd.width        = resTexture.Width;
+    ddsd.height       = resTexture.Height;
+    ddsd.mipMapLevels = mipCount;
+    ddsd.caps         = DDSCAPS_TEXTURE;
+    ddsd.pixelFormat.size = sizeof( DDPixelFormat );
+
+    if ( isCompressed )
+    {
+        ddsd.flags |= DDSD_LINEARSIZE;
+        ddsd.pitch  = resTexture.pResources[0].SlicePitch;
+    }
+    else
+    {
+        ddsd.flags |= DDSD_PITCH;
+        ddsd.pitch  = resTexture.pResources[0].Pitch;
+    }
+
+    if ( mipCount > 1 )
+    {
+        ddsd.flags |= DDSD_MIPMAPCOUNT;
+        ddsd.caps  |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+
+    if ( isCube )
+    {
+        ddsd.caps  |= DDSCAPS_COMPLEX;
+        ddsd.caps2 |= DDSCAPS2_CUBEMAP
+                    | DDSCAPS2_CUBEMAP_POSITIVE_X | DDSCAPS2_CUBEMAP_NEGATIVE_X
+                    | DDSCAPS2_CUBEMAP_POSITIVE_Y | DDSCAPS2_CUBEMAP_NEGATIVE_Y
+                    | DDSCAPS2_CUBEMAP_POSITIVE_Z | DDSCAPS2_CUBEMAP_NEGATIVE_Z;
+    }
+
+    // 従来のヘッダで読み込み時と同じフォーマットに戻るものはそのまま, それ以外は DX10 拡張ヘッダを付ける.
+    auto isArray = ( surfaceCount > 1 && !isCube ) || ( isCube && surfaceCount != 6 );
+    auto isDX10  = isArray;
+    if ( !isArray )
+    {
+        switch( resTexture.Format )
+        {
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            ddsd.pixelFormat.flags  = DDPF_FOURCC;
+            ddsd.pixelFormat.fourCC = FOURCC_DXT1;
+            break;
+
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            ddsd.pixelFormat.flags  = DDPF_FOURCC;
+            ddsd.pixelFormat.fourCC = FOURCC_DXT5;
+            break;
+
+        case DXGI_FORMAT_BC4_UNORM:
+            ddsd.pixelFormat.flags  = DDPF_FOURCC;
+            ddsd.pixelFormat.fourCC = FOURCC_BC4U;
+            break;
+
+        case DXGI_FORMAT_BC5_UNORM:
+            ddsd.pixelFormat.flags  = DDPF_FOURCC;
+            ddsd.pixelFormat.fourCC = FOURCC_BC5U;
+            break;
+
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            ddsd.pixelFormat.flags  = DDPF_FOURCC;
+            ddsd.pixelFormat.fourCC = FOURCC_A32B32G32R32F;
+            break;
+
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            ddsd.pixelFormat.flags  = DDPF_RGB | DDPF_ALPHAPIXELS;
+            ddsd.pixelFormat.bpp    = 32;
+            ddsd.pixelFormat.maskR  = 0x000000ff;
+            ddsd.pixelFormat.maskG  = 0x0000ff00;
+            ddsd.pixelFormat.maskB  = 0x00ff0000;
+            ddsd.pixelFormat.maskA  = 0xff000000;
+            break;
+
+        default:
+            isDX10 = true;
+            break;
+        }
+    }
+
+    fwrite( "DDS ", sizeof(char), 4, pFile );
+
+    if ( isDX10 )
+    {
+        ddsd.pixelFormat.flags  = DDPF_FOURCC;
+        ddsd.pixelFormat.fourCC = FOURCC_DX10;
+        fwrite( &ddsd, sizeof( DDSurfaceDesc ), 1, pFile );
+
+        DDSHeaderDXT10 ext = {};
+        ext.dxgiFormat        = resTexture.Format;
+        ext.resourceDimension = 3;  // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        ext.miscFlag          = isCube ? 0x4 : 0;   // D3D10_RESOURCE_MISC_TEXTURECUBE
+        ext.arraySize         = isCube ? surfaceCount / 6 : surfaceCount;
+        fwrite( &ext, sizeof( DDSHeaderDXT10 ), 1, pFile );
+    }
+    else
+    {
+        fwrite( &ddsd, sizeof( DDSurfaceDesc ), 1, pFile );
+    }
+
+    // サーフェイスごとに全てのミップレベルを書き出す.
+    for( uint32_t i=0; i<surfaceCount * mipCount; ++i )
+    {
+        auto& res = resTexture.pResources[ i ];
+        fwrite( res.pPixels, 1, res.SlicePitch, pFile );
+    }
+
+    fclose( pFile );
+    return true;
+}
+
 //-------------------------------------------------------------------------------------------------
 //      DDSからリソーステクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
@@ -2528,7 +3070,7 @@ bool CreateResTextureFromDDSMemory(const uint8_t* pBinary, uint32_t bufferSize,
 
             case FOURCC_BC4S:
                 {
-                    resTexture.Format = DXGI_FORMAT_BC5_SNORM;
+                    resTexture.Format = DXGI_FORMAT_BC4_SNORM;
                     nativeFormat      = NATIVE_TEXTURE_FORMAT_BC4S;
                     isSupportFormat   = true;
                 }
@@ -2553,6 +3095,19 @@ bool CreateResTextureFromDDSMemory(const uint8_t* pBinary, uint32_t bufferSize,
 
             case FOURCC_DX10:
                 {
+                    // 拡張ヘッダを読み込み.
+                    offset += sizeof( DDSHeaderDXT10 );
+                    if ( offset > bufferSize )
+                    {
+                        ELOG( "Error : Out of Range." );
+                        return false;
+                    }
+
+                    DDSHeaderDXT10 ext;
+                    memcpy( &ext, pCur, sizeof( DDSHeaderDXT10 ) );
+                    pCur += sizeof( DDSHeaderDXT10 );
+
+                    isSupportFormat = ParseHeaderDXT10( ext, depth, resTexture, nativeFormat );
                 }
                 break;
 
@@ -2794,7 +3349,7 @@ bool CreateResTextureFromDDSMemory(const uint8_t* pBinary, uint32_t bufferSize,
     switch( nativeFormat )
     {
         // 一括読み込みでくるっているので修正.
-        case NATIVE_TEXTURE_FORMAT_ARGB_8888:
+        case NATIVE_TEXTURE_FORMAT_ABGR_8888:
         case NATIVE_TEXTURE_FORMAT_XRGB_8888:
         {
             for( size_t i=0; i<pixelSize; i+=4 )
@@ -2816,14 +3371,14 @@ bool CreateResTextureFromDDSMemory(const uint8_t* pBinary, uint32_t bufferSize,
     // リソースデータのメモリを確保.
     resTexture.pResources = new SubResource[ resTexture.MipMapCount * resTexture.SurfaceCount ];
 
-    size_t w = width;
-    size_t h = height;
-    size_t d = depth;
-
-    // 各ミップレベルごとに処理.
-    for ( size_t j=0; j<resTexture.MipMapCount; ++j )
+    // サーフェイスごとに全てのミップレベルが並んでいる.
+    for( size_t i=0; i<resTexture.SurfaceCount; ++i )
     {
-        for( size_t i=0; i<resTexture.SurfaceCount; ++i )
+        size_t w = width;
+        size_t h = height;
+        size_t d = depth;
+
+        for ( size_t j=0; j<resTexture.MipMapCount; ++j )
         {
             size_t rowBytes = 0;
             size_t numRows  = 0;
@@ -2836,7 +3391,9 @@ bool CreateResTextureFromDDSMemory(const uint8_t* pBinary, uint32_t bufferSize,
               || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC4U )
               || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC4S )
               || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC5U )
-              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC5S ) )
+              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC5S )
+              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC6H )
+              || ( nativeFormat == NATIVE_TEXTURE_FORMAT_BC7 ) )
             {
                 size_t bcPerBlock = 0;
                 size_t blockWide  = 0;
@@ -2876,86 +3433,116 @@ bool CreateResTextureFromDDSMemory(const uint8_t* pBinary, uint32_t bufferSize,
             // データ数 = (1行当たりのバイト数) * 行数.
             numBytes = rowBytes * numRows;
 
+            // データ範囲をチェック.
+            if ( byteOffset + numBytes > pixelSize )
+            {
+                // 不要になったメモリを解放.
+                delete [] pPixelData;
+
+                // エラーログ出力.
+                ELOG( "Error : Out of Range." );
+
+                // 異常終了.
+                return false;
+            }
+
             // リソースデータを設定.
             resTexture.pResources[ idx ].Width      = uint32_t( w );
             resTexture.pResources[ idx ].Height     = uint32_t( h );
             resTexture.pResources[ idx ].Pitch      = uint32_t( rowBytes );
             resTexture.pResources[ idx ].SlicePitch = uint32_t( numBytes );
-            resTexture.pResources[ idx ].pPixels    = pPixelData + byteOffset;
+            resTexture.pResources[ idx ].pPixels    = new uint8_t [ numBytes ];
+
+            // NULLチェック.
+            if ( resTexture.pResources[ idx ].pPixels == nullptr )
+            {
+                // 不要になったメモリを解放.
+                delete [] pPixelData;
+
+                // エラーログ出力.
+                ELOG( "Error : Memory Allocate Failed." );
+
+                // 異常終了.
+                return false;
+            }
+
+            // ピクセルデータをコピー.
+            std::memcpy( resTexture.pResources[ idx ].pPixels, pPixelData + byteOffset, numBytes );
 
             // オフセットをカウントアップ.
             byteOffset += numBytes;
 
             // インデックスをカウントアップ.
             idx++;
-        }
 
+            // 横幅，縦幅を更新.
+            w = w >> 1;
+            h = h >> 1;
+            d = d >> 1;
 
-        // 横幅，縦幅を更新.
-        w = w >> 1;
-        h = h >> 1;
-        d = d >> 1;
-
-        // クランプ処理.
-        if ( w == 0 ) { w = 1; }
-        if ( h == 0 ) { h = 1; }
-        if ( d == 0 ) { d = 1; }
+            // クランプ処理.
+            if ( w == 0 ) { w = 1; }
+            if ( h == 0 ) { h = 1; }
+            if ( d == 0 ) { d = 1; }
+        }
     }
 
+    // 不要になったメモリを解放.
+    delete [] pPixelData;
+    pPixelData = nullptr;
+
     // 正常終了.
     return true;
 }
 
 //-------------------------------------------------------------------------------------------------
-//      Targaファイルからリソーステクスチャを生成します.
+//      メモリ上のTargaデータからリソーステクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
-bool CreateResTextureFromTGAFile(FILE* pFile, asdx::ResTexture& resTexture)
+bool CreateResTextureFromTGAMemory(const uint8_t* pBinary, uint64_t bufferSize, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
+    if ( pBinary == nullptr || bufferSize < sizeof(TGA_HEADER) + sizeof(TGA_FOOTER) )
+    {
+        ELOG( "Error : Invalid Argument." );
+        return false;
+    }
+
     // フッターを読み込み.
     TGA_FOOTER footer;
-    long offset = sizeof(footer);
-    fseek( pFile, -offset, SEEK_END );
-    fread( &footer, sizeof(footer), 1, pFile );
+    memcpy( &footer, pBinary + bufferSize - sizeof(footer), sizeof(footer) );
 
     // ファイルマジックをチェック.
-    if ( strcmp( footer.Tag, "TRUEVISION-XFILE." ) != 0 )
+    if ( memcmp( footer.Tag, "TRUEVISION-XFILE.", sizeof(footer.Tag) ) != 0 )
     {
         ELOG( "Error : Invalid File Format." );
-        fclose( pFile );
         return false;
     }
 
-    // 拡張データがある場合は読み込み.
-    if ( footer.OffsetExt != 0 )
-    {
-        TGA_EXTENSION extension;
+    // ピクセルデータはフッターより前にある.
+    auto pEnd = pBinary + bufferSize - sizeof(footer);
 
-        fseek( pFile, footer.OffsetExt, SEEK_SET );
-        fread( &extension, sizeof(extension), 1, pFile );
-    }
+    // ヘッダデータを読み込む.
+    TGA_HEADER header;
+    memcpy( &header, pBinary, sizeof(header) );
 
-    // ディベロッパーエリアがある場合.
-    if ( footer.OffsetDev != 0 )
+    if ( header.Width == 0 || header.Height == 0 )
     {
-        /* NOT IMPLEMENT */
+        ELOG( "Error : Invalid Image Size." );
+        return false;
     }
 
-    // ファイル先頭に戻す.
-    fseek( pFile, 0, SEEK_SET );
-
-    // ヘッダデータを読み込む.
-    TGA_HEADER header;
-    fread( &header, sizeof(header), 1, pFile );
-
     // フォーマット判定.
-    uint32_t bytePerPixel = 0;
+    uint32_t        srcBytes = 0;
+    uint32_t        dstBytes = 0;
+    TgaConvertFunc  convert  = nullptr;
+    DXGI_FORMAT     format   = DXGI_FORMAT_UNKNOWN;
+    bool            rle      = false;
+
     switch( header.Format )
     {
     // 該当なし.
     case TGA_FORMAT_NONE:
         {
             ELOG( "Error : Invalid Format." );
-            fclose( pFile );
             return false;
         }
         break;
@@ -2963,233 +3550,165 @@ bool CreateResTextureFromTGAFile(FILE* pFile, asdx::ResTexture& resTexture)
     // グレースケール
     case TGA_FORMAT_GRAYSCALE:
     case TGA_FORMAT_RLE_GRAYSCALE:
-        { 
+        {
             if ( header.BitPerPixel == 8 )
-            { bytePerPixel = 1; }
-            else
-            { bytePerPixel = 2; }
+            {
+                srcBytes = 1;
+                convert  = ConvertGray8;
+                format   = DXGI_FORMAT_R8_UNORM;
+            }
+            else if ( header.BitPerPixel == 16 )
+            {
+                srcBytes = 2;
+                convert  = ConvertGray16;
+                format   = DXGI_FORMAT_R8G8_UNORM;
+            }
+            dstBytes = srcBytes;
+            rle      = ( header.Format == TGA_FORMAT_RLE_GRAYSCALE );
         }
         break;
 
-    // カラー.
-    case TGA_FORMAT_INDEXCOLOR:
+    // フルカラー.
     case TGA_FORMAT_FULLCOLOR:
-    case TGA_FORMAT_RLE_INDEXCOLOR:
     case TGA_FORMAT_RLE_FULLCOLOR:
         {
-            if ( header.BitPerPixel <= 24 )
-            { bytePerPixel = 3; }
-            else
-            { bytePerPixel = 4; }
+            switch( header.BitPerPixel )
+            {
+            case 15:
+            case 16:
+                { srcBytes = 2; convert = ConvertBGR16; }
+                break;
+
+            case 24:
+                { srcBytes = 3; convert = ConvertBGR24; }
+                break;
+
+            case 32:
+                { srcBytes = 4; convert = ConvertBGR32; }
+                break;
+            }
+            dstBytes = 4;
+            format   = DXGI_FORMAT_R8G8B8A8_UNORM;
+            rle      = ( header.Format == TGA_FORMAT_RLE_FULLCOLOR );
         }
         break;
 
-    // 上記以外.
-    default:
+    // パレット.
+    case TGA_FORMAT_INDEXCOLOR:
+    case TGA_FORMAT_RLE_INDEXCOLOR:
         {
-            ELOG( "Error : Unsupported Format." );
-            fclose( pFile );
-            return false;
+            if ( header.HasColorMap && header.BitPerPixel == 8 )
+            {
+                srcBytes = 1;
+                convert  = ConvertIndex8;
+            }
+            dstBytes = 4;
+            format   = DXGI_FORMAT_R8G8B8A8_UNORM;
+            rle      = ( header.Format == TGA_FORMAT_RLE_INDEXCOLOR );
         }
         break;
     }
 
-    // IDフィールドサイズ分だけオフセットを移動させる.
-    if (header.IdFieldLength != 0)
+    if ( convert == nullptr )
     {
-        fseek(pFile, header.IdFieldLength, SEEK_CUR);
+        ELOG( "Error : Unsupported Format. format = %u, bitPerPixel = %u", header.Format, header.BitPerPixel );
+        return false;
     }
 
-    // RGBのみはテクスチャがサポートされないので，強制的にRGBAにする.
-    auto bpp = (bytePerPixel == 3) ? 4 : bytePerPixel;
-
-    // ピクセルサイズを決定してメモリを確保.
-    auto size = header.Width * header.Height * bpp;
-    auto pPixels = new (std::nothrow) uint8_t [ size ];
-    if ( pPixels == nullptr )
+    // IDフィールドサイズ分だけオフセットを移動させる.
+    auto pCur = pBinary + sizeof(header) + header.IdFieldLength;
+    if ( pCur > pEnd )
     {
-        ELOG( "Error : Out Of Memory." );
-        fclose( pFile );
+        ELOG( "Error : Invalid Data Size." );
         return false;
     }
 
     // カラーマップを持つかチェック.
-    uint8_t* pColorMap = nullptr;
+    uint32_t palette[ 256 ];
     if ( header.HasColorMap )
     {
-        // カラーマップサイズを算出.
-        uint32_t colorMapSize = header.ColorMapEntry * ( header.ColorMapEntrySize >> 3 );
-
-        // メモリを確保.
-        pColorMap = new (std::nothrow) uint8_t [ colorMapSize ];
-        if ( pColorMap == nullptr )
+        auto entryBytes   = uint32_t( header.ColorMapEntrySize + 7 ) / 8;
+        auto colorMapSize = size_t( header.ColorMapLength ) * entryBytes;
+        if ( size_t( pEnd - pCur ) < colorMapSize )
         {
-            ELOG( "Error : Out Of Memory." );
-            delete[] pPixels;
-            pPixels = nullptr;
-            fclose( pFile );
+            ELOG( "Error : Invalid Color Map Size." );
             return false;
         }
 
-        // がばっと読み込む.
-        fread( pColorMap, sizeof(uint8_t), colorMapSize, pFile );
-    }
+        // パレットをRGBAに展開しておく.
+        if ( convert == ConvertIndex8 )
+        {
+            TgaConvertFunc convertEntry = nullptr;
+            switch( entryBytes )
+            {
+            case 2: { convertEntry = ConvertBGR16; } break;
+            case 3: { convertEntry = ConvertBGR24; } break;
+            case 4: { convertEntry = ConvertBGR32; } break;
+            }
 
-    // 幅・高さ・ビットの深さ・ハッシュキーを設定.
-    auto width       = header.Width;
-    auto height      = header.Height;
-    auto format      = static_cast<TGA_FORMAT_TYPE>( header.Format );
-   
-    // フォーマットに合わせてピクセルデータを解析する.
-    switch( header.Format )
-    {
-    // パレット.
-    case TGA_FORMAT_INDEXCOLOR:
-        { Parse8Bits( pFile, width * height, pColorMap, pPixels ); }
-        break;
-
-    // フルカラー.
-    case TGA_FORMAT_FULLCOLOR:
-        {
-            switch( header.BitPerPixel )
+            if ( convertEntry == nullptr )
             {
-            case 16:
-                { Parse16Bits( pFile, width * height, pPixels ); }
-                break;
-
-            case 24:
-                { Parse24Bits( pFile, width * height, pPixels ); }
-                break;
-
-            case 32:
-                { Parse32Bits( pFile, width * height, pPixels ); }
-                break;
+                ELOG( "Error : Unsupported Color Map. entrySize = %u", header.ColorMapEntrySize );
+                return false;
             }
-        }
-        break;
-
-    // グレースケール.
-    case TGA_FORMAT_GRAYSCALE:
-        {
-            if ( header.BitPerPixel == 8 )
-            { Parse8BitsGrayScale( pFile, width * height, pPixels ); }
-            else
-            { Parse16BitsGrayScale( pFile, width * height, pPixels ); }
-        }
-        break;
 
-    // パレットRLE圧縮.
-    case TGA_FORMAT_RLE_INDEXCOLOR:
-        { Parse8BitsRLE( pFile, pColorMap, width * height * 3, pPixels ); }
-        break;
+            for( auto i=0; i<256; ++i )
+            { palette[i] = 0xFF000000; }
 
-    // フルカラーRLE圧縮.
-    case TGA_FORMAT_RLE_FULLCOLOR:
-        {
-            switch( header.BitPerPixel )
+            if ( header.ColorMapEntry < 256 )
             {
-            case 16:
-                { Parse16BitsRLE( pFile, width * height * 4, pPixels ); }
-                break;
-
-            case 24:
-                { Parse24BitsRLE( pFile, width * height * 4, pPixels ); }
-                break;
-
-            case 32:
-                { Parse32BitsRLE( pFile, width * height * 4, pPixels ); }
-                break;
+                auto count = std::min<size_t>( header.ColorMapLength, 256 - header.ColorMapEntry );
+                convertEntry( pCur, reinterpret_cast<uint8_t*>( palette + header.ColorMapEntry ), count, nullptr );
             }
         }
-        break;
 
-    // グレースケールRLE圧縮.
-    case TGA_FORMAT_RLE_GRAYSCALE:
-        {
-            if ( header.BitPerPixel == 8 )
-            { Parse8BitsGrayScaleRLE( pFile, width * height, pPixels ); }
-            else
-            { Parse16BitsGrayScaleRLE( pFile, width * height * 2, pPixels ); }
-        }
-        break;
+        pCur += colorMapSize;
     }
 
-    // 不要なメモリを解放.
-    if (pColorMap != nullptr)
+    // ピクセルサイズを決定してメモリを確保.
+    auto width  = uint32_t( header.Width );
+    auto height = uint32_t( header.Height );
+    auto count  = size_t( width ) * height;
+    auto pPixels = new (std::nothrow) uint8_t [ count * dstBytes ];
+    if ( pPixels == nullptr )
     {
-        delete[] pColorMap;
-        pColorMap = nullptr;
+        ELOG( "Error : Out Of Memory." );
+        return false;
     }
 
-    // ファイルを閉じる.
-    fclose( pFile );
+    // フォーマットに合わせてピクセルデータを解析する.
+    auto ret = ( rle )
+        ? ParseTgaPixelsRLE( pCur, pEnd, count, srcBytes, dstBytes, convert, palette, pPixels )
+        : ParseTgaPixels   ( pCur, pEnd, width, height, srcBytes, dstBytes, convert, palette, pPixels, pPool );
+    if ( !ret )
+    {
+        ELOG( "Error : Invalid Pixel Data." );
+        SafeDeleteArray( pPixels );
+        return false;
+    }
 
-    auto surface = new SubResource();
-    if (surface == nullptr)
+    auto surface = new (std::nothrow) SubResource[1];
+    if ( surface == nullptr )
     {
-        ELOG("Error : Out of Memory.");
+        ELOG( "Error : Out of Memory." );
+        SafeDeleteArray( pPixels );
         return false;
     }
 
     surface->Width      = width;
     surface->Height     = height;
-    surface->Pitch      = width * bpp;
-    surface->SlicePitch = width * height * bpp;
+    surface->Pitch      = width * dstBytes;
+    surface->SlicePitch = width * height * dstBytes;
     surface->pPixels    = pPixels;
 
     resTexture.Width        = width;
     resTexture.Height       = height;
     resTexture.Depth        = 1;
+    resTexture.Format       = format;
     resTexture.SurfaceCount = 1;
     resTexture.MipMapCount  = 1;
     resTexture.pResources   = surface;
 
-    switch(format)
-    {
-    case TGA_FORMAT_NONE:
-        resTexture.Format = DXGI_FORMAT_UNKNOWN;
-        break;
-
-    case TGA_FORMAT_FULLCOLOR:
-        resTexture.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        break;
-
-    case TGA_FORMAT_GRAYSCALE:
-        resTexture.Format = DXGI_FORMAT_R8_UNORM;
-        break;
-
-    case TGA_FORMAT_RLE_FULLCOLOR:
-        resTexture.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        break;
-
-    case TGA_FORMAT_RLE_GRAYSCALE:
-        resTexture.Format = DXGI_FORMAT_R8_UNORM;
-        break;
-
-    case TGA_FORMAT_INDEXCOLOR:
-    case TGA_FORMAT_RLE_INDEXCOLOR:
-        {
-            switch (bytePerPixel)
-            {
-            case 1:
-                { resTexture.Format = DXGI_FORMAT_R8_UNORM; }
-                break;
-
-            case 2:
-                { resTexture.Format = DXGI_FORMAT_B5G5R5A1_UNORM; }
-                break;
-
-            default:
-                {
-                    ELOG("Error : Unknown Format. bytePerPixel = %u", bytePerPixel );
-                    assert(false);
-                    return false;
-                }
-            }
-        }
-        break;
-    }
-
     // 正常終了.
     return true;
 }
@@ -3197,258 +3716,109 @@ bool CreateResTextureFromTGAFile(FILE* pFile, asdx::ResTexture& resTexture)
 //-------------------------------------------------------------------------------------------------
 //      Targaファイルからリソーステクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
-bool CreateResTextureFromTGAFileA(const char* filename, asdx::ResTexture& resTexture)
+bool CreateResTextureFromTGAFileA(const char* filename, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
-    FILE* pFile = nullptr;
-    auto err = fopen_s(&pFile, filename, "rb");
-    if (err != 0)
+    MappedFile file;
+    if ( !file.OpenA( filename ) )
     {
-        ELOGA("Error : File Open Failed. path = %s", filename);
+        ELOGA( "Error : File Open Failed. path = %s", filename );
         return false;
     }
 
-    return CreateResTextureFromTGAFile(pFile, resTexture);
+    return CreateResTextureFromTGAMemory( file.GetData(), file.GetSize(), resTexture, pPool );
 }
 
 //-------------------------------------------------------------------------------------------------
 //      Targaファイルからリソーステクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
-bool CreateResTextureFromTGAFileW(const wchar_t* filename, asdx::ResTexture& resTexture)
+bool CreateResTextureFromTGAFileW(const wchar_t* filename, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
-    FILE* pFile = nullptr;
-    auto err = _wfopen_s(&pFile, filename, L"rb");
-    if (err != 0)
+    MappedFile file;
+    if ( !file.OpenW( filename ) )
     {
-        ELOGW("Error : File Open Failed. path = %ls", filename);
+        ELOGW( "Error : File Open Failed. path = %ls", filename );
         return false;
     }
 
-    return CreateResTextureFromTGAFile(pFile, resTexture);
+    return CreateResTextureFromTGAMemory( file.GetData(), file.GetSize(), resTexture, pPool );
 }
 
 //------------------------------------------------------------------------------------------
-//      HDRファイルのヘッダを読み込みします.
+//      メモリ上のHDRデータからリソーステクスチャを生成します.
 //------------------------------------------------------------------------------------------
-bool ReadHdrHeader( FILE* pFile, int32_t& width, int32_t& height, float& gamma, float& exposure )
+bool CreateResTextureFromHDRMemory(const uint8_t* pBinary, uint64_t bufferSize, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
-    char buf[ 256 ];
-    fread( buf, sizeof(char), 2, pFile );
-
-    if ( buf[0] != '#' || buf[1] != '?' )
-    { return false; }
-
-    auto valid = false;
-    for( ;; )
+    if ( pBinary == nullptr || bufferSize < 2 )
     {
-        if ( fgets( buf, 256, pFile ) == nullptr )
-        { break; }
-
-        if ( buf[0] == '\n' )
-        { break; }
-        else if ( buf[0] == '#' )
-        { continue; }
-        else
-        {
-            auto g = 1.0f;
-            auto e = 1.0f;
-            if ( sscanf_s( buf, "GAMMA=%f\n", &g ) != 0 ) 
-            { gamma = g; }
-            else if ( sscanf_s( buf, "EXPOSURE=%f\n", &e ) != 0 )
-            { exposure = e; }
-            else if ( strcmp( buf, "FORMAT=32-bit_rle_rgbe\n" ) == 0 )
-            { valid = true; }
-        }
+        ELOG( "Error : Invalid Argument." );
+        return false;
     }
 
-    if ( !valid )
-    { return false; }
+    auto pCur = pBinary;
+    auto pEnd = pBinary + bufferSize;
 
-    if ( fgets( buf, 256, pFile ) != nullptr )
+    int32_t width    = 0;
+    int32_t height   = 0;
+    float   gamma    = 1.0f;
+    float   exposure = 1.0f;
+    if ( !ReadHdrHeader( pCur, pEnd, width, height, gamma, exposure ) || width <= 0 || height <= 0 )
     {
-        auto w = 0;
-        auto h = 0;
-        if ( sscanf_s( buf, "-Y %d +X %d\n", &h, &w ) != 0 )
-        {
-            width = w;
-            height = h;
-        }
-        else if ( sscanf_s( buf, "+X %d -Y %d\n", &w, &h ) != 0 )
-        {
-            width = w;
-            height = h;
-        }
-        else
-        { return false; }
+        ELOG( "Error : LoadFromHDR() Failed. Header Read Failed." );
+        return false;
     }
 
-    return true;
-}
-
-//------------------------------------------------------------------------------------------
-//      旧形式のカラーを読み取ります.
-//------------------------------------------------------------------------------------------
-bool ReadOldColors( FILE* pFile, RGBE* pLine, int32_t count )
-{
-    auto shift = 0;
-    while( 0 < count )
+    // 確保する前に画像サイズを検証する.
+    if ( uint32_t( width ) > MAX_TEXTURE_SIZE || uint32_t( height ) > MAX_TEXTURE_SIZE )
     {
-        pLine[0].r = getc( pFile );
-        pLine[0].g = getc( pFile );
-        pLine[0].b = getc( pFile );
-        pLine[0].e = getc( pFile );
-
-        if ( feof( pFile ) || ferror( pFile ) )
-            return false;
-
-        if ( pLine[0].r == 1
-          && pLine[0].g == 1
-          && pLine[0].b == 1 )
-        {
-            for( auto i=pLine[0].e << shift; i > 0; i-- )
-            {
-                pLine[0].r = pLine[-1].r;
-                pLine[0].g = pLine[-1].g;
-                pLine[0].b = pLine[-1].b;
-                pLine[0].e = pLine[-1].e;
-                pLine++;
-                count--;
-            }
-            shift += 8;
-        }
-        else
-        {
-            pLine++;
-            count--;
-            shift = 0;
-        }
-    }
-
-    return true;
-}
-
-//------------------------------------------------------------------------------------------
-//      カラーを読み取ります.
-//------------------------------------------------------------------------------------------
-bool ReadColor( FILE* pFile, RGBE* pLine, int32_t count )
-{
-    if ( count < 8 || 0x7fff < count )
-    { return ReadOldColors( pFile, pLine, count ); }
-
-    auto i = getc( pFile );
-    if ( i == EOF )
+        ELOG( "Error : LoadFromHDR() Failed. Invalid Image Size. width = %d, height = %d", width, height );
         return false;
-
-    if ( i != 2 )
-    {
-        ungetc( i, pFile );
-        return ReadOldColors( pFile, pLine, count );
     }
 
-    pLine[0].g = getc( pFile );
-    pLine[0].b = getc( pFile );
-
-    if ( ( i = getc( pFile ) ) == EOF )
-        return false;
-
-    if ( pLine[0].g != 2 || pLine[0].b & 128 )
+    // 旧形式の繰り返しでも各スキャンラインは最低1ピクセル分(4バイト)を必要とする.
+    if ( size_t( pEnd - pCur ) < size_t( height ) * sizeof(RGBE) )
     {
-        pLine[0].r = 2;
-        pLine[0].e = i;
-        return ReadOldColors( pFile, pLine + 1, count -1 );
-    }
-
-    if ( ( pLine[0].b << 8 | i ) != count )
+        ELOG( "Error : LoadFromHDR() Failed. Data Too Short. width = %d, height = %d", width, height );
         return false;
+    }
 
-    for( i=0; i<4; ++i )
+    auto count   = size_t( width ) * size_t( height );
+    auto pImage  = new (std::nothrow) RGBE [ count ];
+    auto pPixels = new (std::nothrow) float [ count * 4 ];
+    auto surface = new (std::nothrow) SubResource[1];
+    if ( pImage == nullptr || pPixels == nullptr || surface == nullptr )
     {
-        for( auto j=0; j<count; )
-        {
-            auto code = getc( pFile );
-            if ( code == EOF )
-                return false;
-
-            if ( 128 < code )
-            {
-                code &= 127;
-                auto val = getc( pFile );
-                while( code-- )
-                { pLine[j++].v[i] = val; }
-            }
-            else
-            {
-                while( code-- )
-                { pLine[j++].v[i] = getc( pFile ); }
-            }
-        }
+        ELOG( "Error : Out of Memory." );
+        SafeDeleteArray( pImage );
+        SafeDeleteArray( pPixels );
+        SafeDeleteArray( surface );
+        return false;
     }
 
-    return ( feof( pFile ) ? false : true );
-}
-
-//------------------------------------------------------------------------------------------
-//      HDRデータを読み取ります.
-//------------------------------------------------------------------------------------------
-bool ReadHdrData( FILE* pFile, const int32_t width, const int32_t height, float** ppPixels )
-{
-    auto pLines = new(std::nothrow) RGBE [ width * height ];
-    if ( pLines == nullptr )
-    { return false; }
-
-    auto pixels = new (std::nothrow) float [ width * height * 4 ];
-    if ( pixels == nullptr )
-    { return false; }
-
+    // スキャンラインを全て展開してから一括で変換する.
     for( auto y=0; y<height; ++y )
     {
-        if ( !ReadColor( pFile, pLines, width ) )
+        if ( !ReadColor( pCur, pEnd, pImage, pImage + size_t( y ) * width, width ) )
         {
-            SafeDeleteArray( pLines );
-            SafeDeleteArray( pixels );
+            ELOG( "Error : LoadFromHDR() Failed. Data Read Failed." );
+            SafeDeleteArray( pImage );
+            SafeDeleteArray( pPixels );
+            SafeDeleteArray( surface );
             return false;
         }
-
-        for( auto x =0; x < width; x++ )
-        {
-            auto pix = RGBEToVec3( pLines[x] );
-            auto idx = ( x * 4 ) + ( y * width *  4 );
-            pixels[idx + 0] = pix.x;
-            pixels[idx + 1] = pix.y;
-            pixels[idx + 2] = pix.z;
-            pixels[idx + 3] = 1.0f;
-        }
     }
 
-    SafeDeleteArray( pLines );
-    (*ppPixels) = pixels;
-
-    return true;
-}
-
-//------------------------------------------------------------------------------------------
-//      HDRファイルからデータをロードします.
-//------------------------------------------------------------------------------------------
-bool CreateResTextureFromHDRFileA( const char* filename, asdx::ResTexture& resTexture)
-{
-    FILE* pFile = nullptr;
-
-    auto err = fopen_s( &pFile, filename, "rb" );
-    if ( err != 0 )
+    ForEachRows( pPool, uint32_t(width), uint32_t(height), [&]( uint32_t begin, uint32_t end )
     {
-        ELOGA( "Error : LoadFromHDR() Failed. File Open Failed. filename = %s", filename );
-        return false;
-    }
+        auto offset = size_t( begin ) * width;
+        ConvertRGBEToFloat( pImage + offset, pPixels + offset * 4, size_t( end - begin ) * width );
+    });
+    SafeDeleteArray( pImage );
 
-    int32_t width    = 0;
-    int32_t height   = 0;
-    float   gamma    = 1.0f;
-    float   exposure = 1.0f;
-    if ( !ReadHdrHeader(pFile, width, height, gamma, exposure) )
-    {
-        ELOGA( "Error : LoadFromHDR() Failed. Header Read Failed. filename = %s", filename );
-        fclose(pFile);
-        return false;
-    }
+    surface->Width      = uint32_t(width);
+    surface->Height     = uint32_t(height);
+    surface->Pitch      = width * sizeof(float) * 4;
+    surface->SlicePitch = surface->Pitch * height;
+    surface->pPixels    = reinterpret_cast<uint8_t*>(pPixels);
 
     resTexture.Width        = uint32_t(width);
     resTexture.Height       = uint32_t(height);
@@ -3456,78 +3826,46 @@ bool CreateResTextureFromHDRFileA( const char* filename, asdx::ResTexture& resTe
     resTexture.Format       = DXGI_FORMAT_R32G32B32A32_FLOAT;
     resTexture.MipMapCount  = 1;
     resTexture.SurfaceCount = 1;
-    resTexture.pResources   = new SubResource[1];
-
-    resTexture.pResources[0].Width      = uint32_t(width);
-    resTexture.pResources[0].Height     = uint32_t(height);
-    resTexture.pResources[0].Pitch      = width * sizeof(float) * 4;
-    resTexture.pResources[0].SlicePitch = resTexture.pResources[0].Pitch * height;
-
-    if ( !ReadHdrData(pFile, width, height, reinterpret_cast<float**>(&resTexture.pResources[0].pPixels)) )
-    {
-        ELOGA( "Error : LoadFromHDR() Failed. Data Read Failed. filename = %s", filename );
-        fclose(pFile);
-        return false;
-    }
+    resTexture.pResources   = surface;
 
-    fclose(pFile);
     return true;
 }
 
 //------------------------------------------------------------------------------------------
 //      HDRファイルからデータをロードします.
 //------------------------------------------------------------------------------------------
-bool CreateResTextureFromHDRFileW(const wchar_t* filename, asdx::ResTexture& resTexture)
+bool CreateResTextureFromHDRFileA( const char* filename, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
-    FILE* pFile = nullptr;
-
-    auto err = _wfopen_s(&pFile, filename, L"rb" );
-    if ( err != 0 )
-    {
-        ELOGW( "Error : LoadFromHDR() Failed. File Open Failed. filename = %s", filename );
-        return false;
-    }
-
-    int32_t width    = 0;
-    int32_t height   = 0;
-    float   gamma    = 1.0f;
-    float   exposure = 1.0f;
-    if ( !ReadHdrHeader(pFile, width, height, gamma, exposure) )
+    MappedFile file;
+    if ( !file.OpenA( filename ) )
     {
-        ELOGW( "Error : LoadFromHDR() Failed. Header Read Failed. filename = %s", filename );
-        fclose(pFile);
+        ELOGA( "Error : LoadFromHDR() Failed. File Open Failed. filename = %s", filename );
         return false;
     }
 
-    resTexture.Width        = uint32_t(width);
-    resTexture.Height       = uint32_t(height);
-    resTexture.Depth        = 0;
-    resTexture.Format       = DXGI_FORMAT_R32G32B32A32_FLOAT;
-    resTexture.MipMapCount  = 1;
-    resTexture.SurfaceCount = 1;
-    resTexture.pResources   = new SubResource[1];
-
-    resTexture.pResources[0].Width      = uint32_t(width);
-    resTexture.pResources[0].Height     = uint32_t(height);
-    resTexture.pResources[0].Pitch      = width * sizeof(float) * 4;
-    resTexture.pResources[0].SlicePitch = resTexture.pResources[0].Pitch * height;
+    return CreateResTextureFromHDRMemory( file.GetData(), file.GetSize(), resTexture, pPool );
+}
 
-    if ( !ReadHdrData(pFile, width, height, reinterpret_cast<float**>(&resTexture.pResources[0].pPixels)) )
+//------------------------------------------------------------------------------------------
+//      HDRファイルからデータをロードします.
+//------------------------------------------------------------------------------------------
+bool CreateResTextureFromHDRFileW(const wchar_t* filename, asdx::ResTexture& resTexture, ThreadPool* pPool)
+{
+    MappedFile file;
+    if ( !file.OpenW( filename ) )
     {
-        ELOGW( "Error : LoadFromHDR() Failed. Data Read Failed. filename = %s", filename );
-        fclose(pFile);
+        ELOGW( "Error : LoadFromHDR() Failed. File Open Failed. filename = %ls", filename );
         return false;
     }
 
-    fclose(pFile);
-    return true;
+    return CreateResTextureFromHDRMemory( file.GetData(), file.GetSize(), resTexture, pPool );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //      ファイルからテクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
-bool CreateResTextureFromFileW(const wchar_t* filename, asdx::ResTexture& resTexture)
+bool CreateResTextureFromFileW(const wchar_t* filename, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
     if ( filename == nullptr )
     {
@@ -3540,9 +3878,9 @@ bool CreateResTextureFromFileW(const wchar_t* filename, asdx::ResTexture& resTex
     if (ext == L"dds")
     { return CreateResTextureFromDDSFileW( filename, resTexture ); }
     else if (ext == L"tga")
-    { return CreateResTextureFromTGAFileW( filename, resTexture ); }
+    { return CreateResTextureFromTGAFileW( filename, resTexture, pPool ); }
     else if (ext == L"hdr")
-    { return CreateResTextureFromHDRFileW( filename, resTexture ); }
+    { return CreateResTextureFromHDRFileW( filename, resTexture, pPool ); }
 
     return CreateResTextureFromWICFileW( filename, resTexture );
 }
@@ -3551,7 +3889,7 @@ bool CreateResTextureFromFileW(const wchar_t* filename, asdx::ResTexture& resTex
 //-------------------------------------------------------------------------------------------------
 //      ファイルからテクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
-bool CreateResTextureFromFileA(const char* filename, asdx::ResTexture& resTexture)
+bool CreateResTextureFromFileA(const char* filename, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
     if ( filename == nullptr )
     {
@@ -3564,9 +3902,9 @@ bool CreateResTextureFromFileA(const char* filename, asdx::ResTexture& resTextur
     if (ext == "dds")
     { return CreateResTextureFromDDSFileA( filename, resTexture ); }
     else if (ext == "tga")
-    { return CreateResTextureFromTGAFileA( filename, resTexture ); }
+    { return CreateResTextureFromTGAFileA( filename, resTexture, pPool ); }
     else if (ext == "hdr")
-    { return CreateResTextureFromHDRFileA( filename, resTexture ); }
+    { return CreateResTextureFromHDRFileA( filename, resTexture, pPool ); }
 
     return CreateResTextureFromWICFileA( filename, resTexture );
 }
@@ -3575,7 +3913,7 @@ bool CreateResTextureFromFileA(const char* filename, asdx::ResTexture& resTextur
 //-------------------------------------------------------------------------------------------------
 //      メモリストリームからテクスチャを生成します.
 //-------------------------------------------------------------------------------------------------
-bool CreateResTextureFromMemory(const uint8_t* pBinary, uint32_t bufferSize, asdx::ResTexture& resTexture)
+bool CreateResTextureFromMemory(const uint8_t* pBinary, uint32_t bufferSize, asdx::ResTexture& resTexture, ThreadPool* pPool)
 {
     if ( pBinary == nullptr || bufferSize < 4 )
     {
@@ -3595,6 +3933,18 @@ bool CreateResTextureFromMemory(const uint8_t* pBinary, uint32_t bufferSize, asd
     if ( isDDS )
     { return CreateResTextureFromDDSMemory( pBinary, bufferSize, resTexture ); }
 
+    // Radiance HDR は先頭の "#?" で判定.
+    if ( pBinary[0] == '#' && pBinary[1] == '?' )
+    { return CreateResTextureFromHDRMemory( pBinary, bufferSize, resTexture, pPool ); }
+
+    // Targa はフッターのシグネチャで判定.
+    if ( bufferSize >= sizeof(TGA_FOOTER) )
+    {
+        auto pTag = pBinary + bufferSize - sizeof(TGA_FOOTER) + offsetof(TGA_FOOTER, Tag);
+        if ( memcmp( pTag, "TRUEVISION-XFILE.", sizeof(TGA_FOOTER::Tag) ) == 0 )
+        { return CreateResTextureFromTGAMemory( pBinary, bufferSize, resTexture, pPool ); }
+    }
+
     return CreateResTextureFromWICMemory( pBinary, bufferSize, resTexture );
 }
 
@@ -3606,20 +3956,52 @@ bool CreateResTextureFromMemory(const uint8_t* pBinary, uint32_t bufferSize, asd
 //-------------------------------------------------------------------------------------------------
 //      ファイルからテクスチャリソースを生成します.
 //-------------------------------------------------------------------------------------------------
-bool ResTexture::LoadFromFileA(const char* filename)
-{ return CreateResTextureFromFileA( filename, (*this) ); }
+bool ResTexture::LoadFromFileA(const char* filename, ThreadPool* pPool)
+{ return CreateResTextureFromFileA( filename, (*this), pPool ); }
 
 //-------------------------------------------------------------------------------------------------
 //      ファイルからテクスチャリソースを生成します.
 //-------------------------------------------------------------------------------------------------
-bool ResTexture::LoadFromFileW(const wchar_t* filename)
-{ return CreateResTextureFromFileW( filename, (*this) ); }
+bool ResTexture::LoadFromFileW(const wchar_t* filename, ThreadPool* pPool)
+{ return CreateResTextureFromFileW( filename, (*this), pPool ); }
 
 //-------------------------------------------------------------------------------------------------
 //      メモリストリームからテクスチャリソースを生成します.
 //-------------------------------------------------------------------------------------------------
-bool ResTexture::LoadFromMemory(const uint8_t* pBuffer, uint32_t bufferSize)
-{ return CreateResTextureFromMemory( pBuffer, bufferSize, (*this) ); }
+bool ResTexture::LoadFromMemory(const uint8_t* pBuffer, uint32_t bufferSize, ThreadPool* pPool)
+{ return CreateResTextureFromMemory( pBuffer, bufferSize, (*this), pPool ); }
+
+//-------------------------------------------------------------------------------------------------
+//      DDSファイルに保存します.
+//-------------------------------------------------------------------------------------------------
+bool ResTexture::SaveToDDSFileA(const char* filename) const
+{
+    FILE* pFile = nullptr;
+    auto err = fopen_s(&pFile, filename, "wb");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", filename);
+        return false;
+    }
+
+    return SaveResTextureToDDSFile( pFile, (*this) );
+}
+
+//-------------------------------------------------------------------------------------------------
+//      DDSファイルに保存します.
+//-------------------------------------------------------------------------------------------------
+bool ResTexture::SaveToDDSFileW(const wchar_t* filename) const
+{
+    FILE* pFile = nullptr;
+    auto err = _wfopen_s(&pFile, filename, L"wb");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %ls", filename);
+        return false;
+    }
+
+    return SaveResTextureToDDSFile( pFile, (*this) );
+}
 
 
 } // namespace asdx
@@ -13,6 +13,11 @@
 
 namespace asdx {
 
+//-------------------------------------------------------------------------------------------------
+// Forward Declarations.
+//-------------------------------------------------------------------------------------------------
+class ThreadPool;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // SUBRESOURCE_OPTION enum
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -108,31 +113,54 @@ struct ResTexture
     //!             読み込み可能なファイルはDDS, BMP, JPG, PNG, TIFF, GIF, HDP, TGA, HDRです.
     //!
     //! @param[in]      filename        ファイル名です.
+    //! @param[in]      pPool           大きな画像を行単位で分割してデコードする場合のスレッドプール(nullptr可).
     //! @retval true    リソース生成に成功.
     //! @retval false   リソース生成に失敗.
     //---------------------------------------------------------------------------------------------
-    bool LoadFromFileA( const char* filename );
+    bool LoadFromFileA( const char* filename, ThreadPool* pPool = nullptr );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      ファイルからテクスチャリソースを生成します.
     //!             読み込み可能なファイルはDDS, BMP, JPG, PNG, TIFF, GIF, HDP, TGA, HDRです.
     //!
     //! @param[in]      filename        ファイル名です.
+    //! @param[in]      pPool           大きな画像を行単位で分割してデコードする場合のスレッドプール(nullptr可).
     //! @retval true    リソース生成に成功.
     //! @retval false   リソース生成に失敗.
     //---------------------------------------------------------------------------------------------
-    bool LoadFromFileW( const wchar_t* filename );
+    bool LoadFromFileW( const wchar_t* filename, ThreadPool* pPool = nullptr );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      メモリストリームからテクスチャリソースを生成します.
-    //!             メモリストリームの形式は DDS, BMP, JPG, PNG, TIFF, GIF, HDP, である必要があります.
+    //!             メモリストリームの形式は DDS, TGA, HDR, BMP, JPG, PNG, TIFF, GIF, HDP, である必要があります.
     //!
     //! @param[in]      pBuffer         バッファです.
     //! @param[in]      bufferSize      バッファサイズです.
+    //! @param[in]      pPool           大きな画像を行単位で分割してデコードする場合のスレッドプール(nullptr可).
     //! @retval true    リソース生成に成功.
     //! @retval false   リソース生成に失敗.
     //---------------------------------------------------------------------------------------------
-    bool LoadFromMemory( const uint8_t* pBuffer, uint32_t bufferSize );
+    bool LoadFromMemory( const uint8_t* pBuffer, uint32_t bufferSize, ThreadPool* pPool = nullptr );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      DDSファイルに保存します.
+    //!             従来のヘッダで表せないフォーマット(BC6H, BC7, sRGB, 配列など)は DX10 拡張ヘッダで保存します.
+    //!
+    //! @param[in]      filename        ファイル名です.
+    //! @retval true    保存に成功.
+    //! @retval false   保存に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool SaveToDDSFileA( const char* filename ) const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      DDSファイルに保存します.
+    //!             従来のヘッダで表せないフォーマット(BC6H, BC7, sRGB, 配列など)は DX10 拡張ヘッダで保存します.
+    //!
+    //! @param[in]      filename        ファイル名です.
+    //! @retval true    保存に成功.
+    //! @retval false   保存に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool SaveToDDSFileW( const wchar_t* filename ) const;
 };
 
 
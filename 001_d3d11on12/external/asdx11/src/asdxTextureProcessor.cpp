@@ -0,0 +1,1597 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxTextureProcessor.cpp
+// Desc : Texture Processor Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <new>
+#include <emmintrin.h>
+#include <dxgiformat.h>
+#include <asdxTextureProcessor.h>
+#include <asdxThreadPool.h>
+#include <asdxMisc.h>
+#include <asdxLogger.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   TILE_BLOCK_COUNT    = 16;           // 1タスク当たりのブロック数(縦横).
+static const uint32_t   SPLIT_ROW_PIXELS    = 64 * 1024;    // 行単位で分割する場合の1ジョブ当たりのピクセル数.
+static const float      KAISER_WIDTH        = 3.0f;         // カイザーフィルタの半径(縮小後のピクセル単位).
+static const float      KAISER_ALPHA        = 4.0f;         // カイザー窓の形状パラメータ.
+static const float      PI                  = 3.14159265358979323846f;
+static const uint32_t   BC6H_MAX_HALF       = 0x7bff;       // 符号なし半精度浮動小数の最大値.
+
+// BC7/BC6H の4bitインデックス補間の重み.
+static const uint32_t   WEIGHTS_4BIT[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PIXEL_LAYOUT enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum PIXEL_LAYOUT
+{
+    PIXEL_LAYOUT_RGBA8 = 0,
+    PIXEL_LAYOUT_BGRA8,
+    PIXEL_LAYOUT_RGBA32F,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BLOCK_FORMAT enum
+///////////////////////////////////////////////////////////////////////////////////////////////////
+enum BLOCK_FORMAT
+{
+    BLOCK_FORMAT_BC1 = 0,
+    BLOCK_FORMAT_BC3,
+    BLOCK_FORMAT_BC4,
+    BLOCK_FORMAT_BC5,
+    BLOCK_FORMAT_BC6H,
+    BLOCK_FORMAT_BC7,
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SourceFormat structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct SourceFormat
+{
+    PIXEL_LAYOUT    Layout;
+    bool            SRGB;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FilterTable structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct FilterTable
+{
+    std::vector<uint32_t>   Start;      // 出力ピクセルごとのタップ開始位置(出力数 + 1).
+    std::vector<uint32_t>   Index;      // 入力ピクセル番号.
+    std::vector<float>      Weight;     // 重み.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Block structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Block
+{
+    alignas(16) float Value[4][16];     // チャンネルごとの16ピクセル(SoA).
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BitWriter class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class BitWriter
+{
+public:
+    explicit BitWriter(uint8_t* pDst)
+    : m_pDst    (pDst)
+    , m_Pos     (0)
+    { memset(m_pDst, 0, 16); }
+
+    void Write(uint32_t value, uint32_t bits)
+    {
+        for(auto i=0u; i<bits; ++i, ++m_Pos)
+        { m_pDst[m_Pos >> 3] |= uint8_t(((value >> i) & 0x1) << (m_Pos & 0x7)); }
+    }
+
+private:
+    uint8_t*    m_pDst;
+    uint32_t    m_Pos;
+};
+
+//-------------------------------------------------------------------------------------------------
+//      配列を安全に削除します.
+//-------------------------------------------------------------------------------------------------
+template<typename T>
+void SafeDeleteArray(T*& ptr)
+{
+    if (ptr != nullptr)
+    {
+        delete[] ptr;
+        ptr = nullptr;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      範囲を分割して処理します. スレッドプールが無い場合は呼び出しスレッドで処理します.
+//-------------------------------------------------------------------------------------------------
+template<typename Func>
+void ForEachRange(asdx::ThreadPool* pPool, uint32_t count, uint32_t grainSize, Func func)
+{
+    if (grainSize == 0)
+    { grainSize = 1; }
+
+    if (pPool == nullptr || count <= grainSize)
+    {
+        func(0, count);
+        return;
+    }
+
+    pPool->ParallelFor(count, grainSize, func);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      入力フォーマットを判定します.
+//-------------------------------------------------------------------------------------------------
+bool GetSourceFormat(uint32_t format, SourceFormat& result)
+{
+    switch(format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:        result.Layout = PIXEL_LAYOUT_RGBA8;   result.SRGB = false; return true;
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:   result.Layout = PIXEL_LAYOUT_RGBA8;   result.SRGB = true;  return true;
+    case DXGI_FORMAT_B8G8R8A8_UNORM:        result.Layout = PIXEL_LAYOUT_BGRA8;   result.SRGB = false; return true;
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:   result.Layout = PIXEL_LAYOUT_BGRA8;   result.SRGB = true;  return true;
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:    result.Layout = PIXEL_LAYOUT_RGBA32F; result.SRGB = false; return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      圧縮フォーマットを判定します.
+//-------------------------------------------------------------------------------------------------
+bool GetBlockFormat(uint32_t format, BLOCK_FORMAT& result, bool& srgb)
+{
+    srgb = (format == DXGI_FORMAT_BC1_UNORM_SRGB)
+        || (format == DXGI_FORMAT_BC3_UNORM_SRGB)
+        || (format == DXGI_FORMAT_BC7_UNORM_SRGB);
+
+    switch(format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:    result = BLOCK_FORMAT_BC1;  return true;
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:    result = BLOCK_FORMAT_BC3;  return true;
+    case DXGI_FORMAT_BC4_UNORM:         result = BLOCK_FORMAT_BC4;  return true;
+    case DXGI_FORMAT_BC5_UNORM:         result = BLOCK_FORMAT_BC5;  return true;
+    case DXGI_FORMAT_BC6H_UF16:         result = BLOCK_FORMAT_BC6H; return true;
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:    result = BLOCK_FORMAT_BC7;  return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      sRGB からリニアに変換します.
+//-------------------------------------------------------------------------------------------------
+inline float SRGBToLinear(float value)
+{
+    return (value <= 0.04045f)
+        ? value / 12.92f
+        : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      8bit sRGB からリニアへの変換テーブルを取得します.
+//-------------------------------------------------------------------------------------------------
+const float* GetSRGBToLinearTable()
+{
+    static const struct Table
+    {
+        float Value[256];
+        Table()
+        {
+            for(auto i=0; i<256; ++i)
+            { Value[i] = SRGBToLinear(float(i) / 255.0f); }
+        }
+    } s_Table;
+    return s_Table.Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リニアから 8bit sRGB への変換の閾値テーブルを取得します.
+//-------------------------------------------------------------------------------------------------
+const float* GetLinearToSRGBTable()
+{
+    // Value[i] 以上のリニア値は i 以上の sRGB 値に丸められる.
+    static const struct Table
+    {
+        float Value[256];
+        Table()
+        {
+            Value[0] = -FLT_MAX;
+            for(auto i=1; i<256; ++i)
+            { Value[i] = SRGBToLinear((float(i) - 0.5f) / 255.0f); }
+        }
+    } s_Table;
+    return s_Table.Value;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リニアを 8bit sRGB に変換します.
+//-------------------------------------------------------------------------------------------------
+inline uint8_t EncodeSRGB8(float value, const float* pTable)
+{
+    // 閾値を二分探索するので丸めが正確になる.
+    uint32_t result = 0;
+    for(uint32_t step=128; step>0; step>>=1)
+    {
+        if (value >= pTable[result + step])
+        { result += step; }
+    }
+    return uint8_t(result);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      [0, 1] を 8bit に変換します.
+//-------------------------------------------------------------------------------------------------
+inline uint8_t EncodeUNorm8(float value)
+{
+    value = (value > 0.0f) ? ((value < 1.0f) ? value : 1.0f) : 0.0f;
+    return uint8_t(value * 255.0f + 0.5f);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      単精度浮動小数を半精度浮動小数に変換します.
+//-------------------------------------------------------------------------------------------------
+uint16_t ToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    auto sign = uint16_t((bits >> 16) & 0x8000);
+    bits &= 0x7fffffff;
+
+    // NaN, 無限大, オーバーフロー.
+    if (bits >= 0x47800000)
+    { return uint16_t(sign | ((bits > 0x7f800000) ? 0x7e00 : 0x7c00)); }
+
+    // 非正規化数.
+    if (bits < 0x38800000)
+    {
+        float magnitude;
+        memcpy(&magnitude, &bits, sizeof(magnitude));
+        return uint16_t(sign | uint16_t(lrintf(magnitude * 16777216.0f)));
+    }
+
+    // 最近接偶数丸め.
+    auto result = (bits - 0x38000000) >> 13;
+    auto rest   = bits & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (result & 0x1)))
+    { result++; }
+
+    return uint16_t(sign | result);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ピクセルをリニアな RGBA に変換します.
+//-------------------------------------------------------------------------------------------------
+void DecodeRow(const asdx::SubResource& src, const SourceFormat& format, uint32_t y, float* pDst)
+{
+    auto pRow = src.pPixels + size_t(y) * src.Pitch;
+    if (format.Layout == PIXEL_LAYOUT_RGBA32F)
+    {
+        memcpy(pDst, pRow, sizeof(float) * 4 * src.Width);
+        return;
+    }
+
+    auto pTable = GetSRGBToLinearTable();
+    auto swap   = (format.Layout == PIXEL_LAYOUT_BGRA8);
+    for(auto x=0u; x<src.Width; ++x)
+    {
+        auto p = pRow + x * 4;
+        auto r = p[swap ? 2 : 0];
+        auto b = p[swap ? 0 : 2];
+        if (format.SRGB)
+        {
+            pDst[x * 4 + 0] = pTable[r];
+            pDst[x * 4 + 1] = pTable[p[1]];
+            pDst[x * 4 + 2] = pTable[b];
+        }
+        else
+        {
+            pDst[x * 4 + 0] = float(r)    / 255.0f;
+            pDst[x * 4 + 1] = float(p[1]) / 255.0f;
+            pDst[x * 4 + 2] = float(b)    / 255.0f;
+        }
+        pDst[x * 4 + 3] = float(p[3]) / 255.0f;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      リニアな RGBA をピクセルに変換します.
+//-------------------------------------------------------------------------------------------------
+void EncodeRow(asdx::SubResource& dst, const SourceFormat& format, uint32_t y, const float* pSrc)
+{
+    auto pRow = dst.pPixels + size_t(y) * dst.Pitch;
+    if (format.Layout == PIXEL_LAYOUT_RGBA32F)
+    {
+        memcpy(pRow, pSrc, sizeof(float) * 4 * dst.Width);
+        return;
+    }
+
+    auto pTable = GetLinearToSRGBTable();
+    auto swap   = (format.Layout == PIXEL_LAYOUT_BGRA8);
+    for(auto x=0u; x<dst.Width; ++x)
+    {
+        auto p = pRow + x * 4;
+        auto s = pSrc + x * 4;
+        if (format.SRGB)
+        {
+            p[swap ? 2 : 0] = EncodeSRGB8(s[0], pTable);
+            p[1]            = EncodeSRGB8(s[1], pTable);
+            p[swap ? 0 : 2] = EncodeSRGB8(s[2], pTable);
+        }
+        else
+        {
+            p[swap ? 2 : 0] = EncodeUNorm8(s[0]);
+            p[1]            = EncodeUNorm8(s[1]);
+            p[swap ? 0 : 2] = EncodeUNorm8(s[2]);
+        }
+        p[3] = EncodeUNorm8(s[3]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      第1種変形ベッセル関数 I0 を求めます.
+//-------------------------------------------------------------------------------------------------
+float BesselI0(float x)
+{
+    auto sum  = 1.0f;
+    auto term = 1.0f;
+    auto half = x * 0.5f;
+    for(auto k=1; k<32; ++k)
+    {
+        term *= (half / float(k)) * (half / float(k));
+        sum  += term;
+        if (term < sum * 1e-7f)
+        { break; }
+    }
+    return sum;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      カイザー窓付き sinc 関数を求めます.
+//-------------------------------------------------------------------------------------------------
+float Kaiser(float x)
+{
+    auto t = x / KAISER_WIDTH;
+    if (t <= -1.0f || t >= 1.0f)
+    { return 0.0f; }
+
+    auto sinc   = (fabsf(x) < 1e-5f) ? 1.0f : sinf(PI * x) / (PI * x);
+    auto window = BesselI0(KAISER_ALPHA * sqrtf(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+    return sinc * window;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1次元の縮小フィルタテーブルを生成します.
+//-------------------------------------------------------------------------------------------------
+void BuildFilterTable(uint32_t srcSize, uint32_t dstSize, asdx::MIPMAP_FILTER filter, bool wrap, FilterTable& table)
+{
+    auto scale = float(srcSize) / float(dstSize);
+
+    table.Start .clear();
+    table.Index .clear();
+    table.Weight.clear();
+    table.Start.reserve(dstSize + 1);
+
+    for(auto d=0u; d<dstSize; ++d)
+    {
+        table.Start.push_back(uint32_t(table.Index.size()));
+
+        auto center = (float(d) + 0.5f) * scale;
+        auto begin  = table.Weight.size();
+        auto sum    = 0.0f;
+
+        if (filter == asdx::MIPMAP_FILTER_BOX)
+        {
+            // 出力ピクセルが覆う範囲と入力ピクセルの重なりを重みにする.
+            auto lo = float(d) * scale;
+            auto hi = lo + scale;
+            for(auto s=uint32_t(lo); s<srcSize && float(s)<hi; ++s)
+            {
+                auto l = (float(s) > lo) ? float(s) : lo;
+                auto h = (float(s + 1) < hi) ? float(s + 1) : hi;
+                if (h <= l)
+                { continue; }
+
+                table.Index .push_back(s);
+                table.Weight.push_back(h - l);
+                sum += h - l;
+            }
+        }
+        else
+        {
+            auto support = KAISER_WIDTH * scale;
+            auto first   = int32_t(floorf(center - support));
+            auto last    = int32_t(ceilf (center + support));
+            for(auto s=first; s<=last; ++s)
+            {
+                auto w = Kaiser((float(s) + 0.5f - center) / scale);
+                if (w == 0.0f)
+                { continue; }
+
+                auto n = int32_t(srcSize);
+                auto i = wrap
+                    ? ((s % n) + n) % n
+                    : ((s < 0) ? 0 : ((s >= n) ? n - 1 : s));
+
+                table.Index .push_back(uint32_t(i));
+                table.Weight.push_back(w);
+                sum += w;
+            }
+        }
+
+        for(auto i=begin; i<table.Weight.size(); ++i)
+        { table.Weight[i] /= sum; }
+    }
+
+    table.Start.push_back(uint32_t(table.Index.size()));
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1ミップレベル分を縮小します.
+//-------------------------------------------------------------------------------------------------
+void ResampleLevel
+(
+    const asdx::SubResource*    pSrcSub,        // 最上位レベルの場合の入力.
+    const float*                pSrcImage,      // 2段目以降の場合の入力(リニア RGBA).
+    const SourceFormat&         format,
+    uint32_t                    srcW,
+    uint32_t                    srcH,
+    asdx::SubResource&          dstSub,
+    float*                      pDstImage,      // 次のレベル用の出力(nullptr可).
+    asdx::MIPMAP_FILTER         filter,
+    uint32_t                    flags,
+    asdx::ThreadPool*           pPool
+)
+{
+    auto dstW     = dstSub.Width;
+    auto dstH     = dstSub.Height;
+    auto wrap     = (flags & asdx::MIPMAP_FLAG_WRAP) != 0;
+    auto weighted = (flags & asdx::MIPMAP_FLAG_ALPHA_WEIGHTED) != 0;
+
+    FilterTable tableX;
+    FilterTable tableY;
+    BuildFilterTable(srcW, dstW, filter, wrap, tableX);
+    BuildFilterTable(srcH, dstH, filter, wrap, tableY);
+
+    // 横方向の縮小結果(入力の行数 x 出力の横幅).
+    std::vector<float> temp(size_t(srcH) * dstW * 4);
+
+    ForEachRange(pPool, srcH, SPLIT_ROW_PIXELS / srcW, [&](uint32_t begin, uint32_t end)
+    {
+        std::vector<float> row(size_t(srcW) * 4);
+        for(auto y=begin; y<end; ++y)
+        {
+            const float* pRow = nullptr;
+            if (pSrcImage != nullptr && !weighted)
+            { pRow = pSrcImage + size_t(y) * srcW * 4; }
+            else
+            {
+                if (pSrcImage != nullptr)
+                { memcpy(row.data(), pSrcImage + size_t(y) * srcW * 4, sizeof(float) * 4 * srcW); }
+                else
+                { DecodeRow(*pSrcSub, format, y, row.data()); }
+
+                // 乗算済みアルファにしてから縮小する.
+                if (weighted)
+                {
+                    for(auto x=0u; x<srcW; ++x)
+                    {
+                        auto p = row.data() + x * 4;
+                        p[0] *= p[3];
+                        p[1] *= p[3];
+                        p[2] *= p[3];
+                    }
+                }
+                pRow = row.data();
+            }
+
+            auto pDst = temp.data() + size_t(y) * dstW * 4;
+            for(auto x=0u; x<dstW; ++x)
+            {
+                auto sum = _mm_setzero_ps();
+                for(auto i=tableX.Start[x]; i<tableX.Start[x + 1]; ++i)
+                {
+                    auto w = _mm_set1_ps(tableX.Weight[i]);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(w, _mm_loadu_ps(pRow + tableX.Index[i] * 4)));
+                }
+                _mm_storeu_ps(pDst + x * 4, sum);
+            }
+        }
+    });
+
+    ForEachRange(pPool, dstH, SPLIT_ROW_PIXELS / dstW, [&](uint32_t begin, uint32_t end)
+    {
+        std::vector<float> row(size_t(dstW) * 4);
+        for(auto y=begin; y<end; ++y)
+        {
+            auto pDst = (pDstImage != nullptr) ? pDstImage + size_t(y) * dstW * 4 : row.data();
+            for(auto x=0u; x<dstW; ++x)
+            {
+                auto sum = _mm_setzero_ps();
+                for(auto i=tableY.Start[y]; i<tableY.Start[y + 1]; ++i)
+                {
+                    auto w = _mm_set1_ps(tableY.Weight[i]);
+                    auto p = temp.data() + (size_t(tableY.Index[i]) * dstW + x) * 4;
+                    sum = _mm_add_ps(sum, _mm_mul_ps(w, _mm_loadu_ps(p)));
+                }
+                _mm_storeu_ps(pDst + x * 4, sum);
+
+                if (weighted)
+                {
+                    auto p = pDst + x * 4;
+                    if (p[3] > 1.0f / 4096.0f)
+                    {
+                        auto inv = 1.0f / p[3];
+                        p[0] *= inv;
+                        p[1] *= inv;
+                        p[2] *= inv;
+                    }
+                }
+            }
+
+            EncodeRow(dstSub, format, y, pDst);
+        }
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+//      16ピクセルそれぞれに最も近いパレット番号を求め, 誤差の合計を返します.
+//-------------------------------------------------------------------------------------------------
+float FindIndices
+(
+    const Block&    block,
+    const float     (*pPalette)[4],
+    uint32_t        count,
+    const float*    pChannelWeights,
+    uint16_t        mask,               // 対象ピクセルのビットマスク.
+    uint8_t*        pIndices
+)
+{
+    const __m128 wr = _mm_set1_ps(pChannelWeights[0]);
+    const __m128 wg = _mm_set1_ps(pChannelWeights[1]);
+    const __m128 wb = _mm_set1_ps(pChannelWeights[2]);
+    const __m128 wa = _mm_set1_ps(pChannelWeights[3]);
+
+    alignas(16) float   error[16];
+    alignas(16) int32_t index[16];
+
+    // 4ピクセルずつ全てのパレットとの距離を求める.
+    for(auto i=0u; i<16; i+=4)
+    {
+        auto r = _mm_load_ps(&block.Value[0][i]);
+        auto g = _mm_load_ps(&block.Value[1][i]);
+        auto b = _mm_load_ps(&block.Value[2][i]);
+        auto a = _mm_load_ps(&block.Value[3][i]);
+
+        auto bestError = _mm_set1_ps(FLT_MAX);
+        auto bestIndex = _mm_setzero_si128();
+        for(auto j=0u; j<count; ++j)
+        {
+            auto dr = _mm_sub_ps(r, _mm_set1_ps(pPalette[j][0]));
+            auto dg = _mm_sub_ps(g, _mm_set1_ps(pPalette[j][1]));
+            auto db = _mm_sub_ps(b, _mm_set1_ps(pPalette[j][2]));
+            auto da = _mm_sub_ps(a, _mm_set1_ps(pPalette[j][3]));
+
+            auto d = _mm_mul_ps(_mm_mul_ps(dr, dr), wr);
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_mul_ps(dg, dg), wg));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_mul_ps(db, db), wb));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_mul_ps(da, da), wa));
+
+            auto less = _mm_castps_si128(_mm_cmplt_ps(d, bestError));
+            bestError = _mm_min_ps(d, bestError);
+            bestIndex = _mm_or_si128(
+                _mm_and_si128(less, _mm_set1_epi32(int32_t(j))),
+                _mm_andnot_si128(less, bestIndex));
+        }
+
+        _mm_store_ps(&error[i], bestError);
+        _mm_store_si128(reinterpret_cast<__m128i*>(&index[i]), bestIndex);
+    }
+
+    auto total = 0.0f;
+    for(auto i=0u; i<16; ++i)
+    {
+        pIndices[i] = uint8_t(index[i]);
+        if (mask & (0x1 << i))
+        { total += error[i]; }
+    }
+
+    return total;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      主成分分析で端点を求めます.
+//-------------------------------------------------------------------------------------------------
+void FitEndpoints(const Block& block, uint32_t channels, uint16_t mask, float e0[4], float e1[4])
+{
+    float mean[4] = {};
+    auto  count   = 0.0f;
+    for(auto i=0u; i<16; ++i)
+    {
+        if ((mask & (0x1 << i)) == 0)
+        { continue; }
+
+        for(auto c=0u; c<channels; ++c)
+        { mean[c] += block.Value[c][i]; }
+        count += 1.0f;
+    }
+
+    for(auto c=0u; c<4; ++c)
+    {
+        mean[c] = (count > 0.0f) ? mean[c] / count : 0.0f;
+        e0[c] = e1[c] = mean[c];
+    }
+
+    if (count == 0.0f)
+    { return; }
+
+    // 共分散行列.
+    float cov[4][4] = {};
+    for(auto i=0u; i<16; ++i)
+    {
+        if ((mask & (0x1 << i)) == 0)
+        { continue; }
+
+        for(auto r=0u; r<channels; ++r)
+        {
+            auto dr = block.Value[r][i] - mean[r];
+            for(auto c=r; c<channels; ++c)
+            { cov[r][c] += dr * (block.Value[c][i] - mean[c]); }
+        }
+    }
+    for(auto r=0u; r<channels; ++r)
+    {
+        for(auto c=0u; c<r; ++c)
+        { cov[r][c] = cov[c][r]; }
+    }
+
+    // べき乗法で主軸を求める. 初期値は分散が最大のチャンネル.
+    float axis[4] = {};
+    auto maxVar = 0u;
+    for(auto c=1u; c<channels; ++c)
+    {
+        if (cov[c][c] > cov[maxVar][maxVar])
+        { maxVar = c; }
+    }
+    axis[maxVar] = 1.0f;
+
+    for(auto iter=0; iter<8; ++iter)
+    {
+        float next[4] = {};
+        auto  length  = 0.0f;
+        for(auto r=0u; r<channels; ++r)
+        {
+            for(auto c=0u; c<channels; ++c)
+            { next[r] += cov[r][c] * axis[c]; }
+            length = (fabsf(next[r]) > length) ? fabsf(next[r]) : length;
+        }
+
+        if (length < 1e-12f)
+        { return; }
+
+        for(auto c=0u; c<channels; ++c)
+        { axis[c] = next[c] / length; }
+    }
+
+    auto norm = 0.0f;
+    for(auto c=0u; c<channels; ++c)
+    { norm += axis[c] * axis[c]; }
+    norm = 1.0f / sqrtf(norm);
+    for(auto c=0u; c<channels; ++c)
+    { axis[c] *= norm; }
+
+    // 主軸に投影した範囲を端点にする.
+    auto minT =  FLT_MAX;
+    auto maxT = -FLT_MAX;
+    for(auto i=0u; i<16; ++i)
+    {
+        if ((mask & (0x1 << i)) == 0)
+        { continue; }
+
+        auto t = 0.0f;
+        for(auto c=0u; c<channels; ++c)
+        { t += (block.Value[c][i] - mean[c]) * axis[c]; }
+
+        minT = (t < minT) ? t : minT;
+        maxT = (t > maxT) ? t : maxT;
+    }
+
+    for(auto c=0u; c<channels; ++c)
+    {
+        e0[c] = mean[c] + axis[c] * minT;
+        e1[c] = mean[c] + axis[c] * maxT;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      インデックスを固定して最小二乗法で端点を求め直します.
+//-------------------------------------------------------------------------------------------------
+bool RefineEndpoints
+(
+    const Block&    block,
+    uint32_t        channels,
+    uint16_t        mask,
+    const uint8_t*  pIndices,
+    const float*    pIndexWeights,      // インデックスごとの端点1の重み.
+    float           e0[4],
+    float           e1[4]
+)
+{
+    auto aa = 0.0f;
+    auto ab = 0.0f;
+    auto bb = 0.0f;
+    float ax[4] = {};
+    float bx[4] = {};
+
+    for(auto i=0u; i<16; ++i)
+    {
+        if ((mask & (0x1 << i)) == 0)
+        { continue; }
+
+        auto b = pIndexWeights[pIndices[i]];
+        auto a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for(auto c=0u; c<channels; ++c)
+        {
+            ax[c] += a * block.Value[c][i];
+            bx[c] += b * block.Value[c][i];
+        }
+    }
+
+    auto det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f)
+    { return false; }
+
+    auto inv = 1.0f / det;
+    for(auto c=0u; c<channels; ++c)
+    {
+        e0[c] = (ax[c] * bb - bx[c] * ab) * inv;
+        e1[c] = (bx[c] * aa - ax[c] * ab) * inv;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      値を範囲内に制限して丸めます.
+//-------------------------------------------------------------------------------------------------
+inline int32_t Quantize(float value, float scale, int32_t maxValue)
+{
+    auto result = int32_t(value * scale + 0.5f);
+    return (result < 0) ? 0 : ((result > maxValue) ? maxValue : result);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      RGB を 565 に変換します.
+//-------------------------------------------------------------------------------------------------
+inline uint16_t ToRGB565(const float value[4])
+{
+    auto r = Quantize(value[0], 31.0f / 255.0f, 31);
+    auto g = Quantize(value[1], 63.0f / 255.0f, 63);
+    auto b = Quantize(value[2], 31.0f / 255.0f, 31);
+    return uint16_t((r << 11) | (g << 5) | b);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      565 を RGB に変換します.
+//-------------------------------------------------------------------------------------------------
+inline void FromRGB565(uint16_t value, float result[4])
+{
+    auto r = (value >> 11) & 0x1f;
+    auto g = (value >> 5)  & 0x3f;
+    auto b = value & 0x1f;
+    result[0] = float((r << 3) | (r >> 2));
+    result[1] = float((g << 2) | (g >> 4));
+    result[2] = float((b << 3) | (b >> 2));
+    result[3] = 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC1 のカラーブロックを圧縮します.
+//-------------------------------------------------------------------------------------------------
+void EncodeBC1Color(const Block& block, bool punchThrough, uint8_t* pDst)
+{
+    static const float kWeights[]   = { 1.0f, 1.0f, 1.0f, 0.0f };
+    static const float kIndex4[]    = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    static const float kIndex3[]    = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+    // 抜きのピクセルがある場合は3色モードにする.
+    uint16_t mask = 0xffff;
+    if (punchThrough)
+    {
+        for(auto i=0u; i<16; ++i)
+        {
+            if (block.Value[3][i] < 128.0f)
+            { mask &= ~uint16_t(0x1 << i); }
+        }
+    }
+    auto threeColor = (mask != 0xffff);
+    auto count      = threeColor ? 3u : 4u;
+    auto pWeights   = threeColor ? kIndex3 : kIndex4;
+
+    uint16_t c0 = 0;
+    uint16_t c1 = 0;
+    uint8_t  indices[16] = {};
+
+    if (mask != 0)
+    {
+        float e0[4], e1[4];
+        FitEndpoints(block, 3, mask, e0, e1);
+
+        auto bestError = FLT_MAX;
+        for(auto iter=0; iter<3; ++iter)
+        {
+            auto q0 = ToRGB565(e0);
+            auto q1 = ToRGB565(e1);
+
+            float palette[4][4];
+            FromRGB565(q0, palette[0]);
+            FromRGB565(q1, palette[1]);
+            for(auto c=0; c<3; ++c)
+            {
+                if (threeColor)
+                { palette[2][c] = (palette[0][c] + palette[1][c]) * 0.5f; }
+                else
+                {
+                    palette[2][c] = (palette[0][c] * 2.0f + palette[1][c]) / 3.0f;
+                    palette[3][c] = (palette[0][c] + palette[1][c] * 2.0f) / 3.0f;
+                }
+            }
+
+            uint8_t temp[16];
+            auto error = FindIndices(block, palette, count, kWeights, mask, temp);
+            if (error < bestError)
+            {
+                bestError = error;
+                c0 = q0;
+                c1 = q1;
+                memcpy(indices, temp, sizeof(indices));
+            }
+
+            if (error == 0.0f || !RefineEndpoints(block, 3, mask, temp, pWeights, e0, e1))
+            { break; }
+        }
+    }
+
+    // モードに合わせて端点の大小を揃える.
+    if (threeColor)
+    {
+        if (c0 > c1)
+        {
+            auto t = c0; c0 = c1; c1 = t;
+            for(auto i=0u; i<16; ++i)
+            { indices[i] = (indices[i] == 2) ? 2 : (indices[i] ^ 0x1); }
+        }
+
+        for(auto i=0u; i<16; ++i)
+        {
+            if ((mask & (0x1 << i)) == 0)
+            { indices[i] = 3; }
+        }
+    }
+    else if (c0 < c1)
+    {
+        auto t = c0; c0 = c1; c1 = t;
+        for(auto i=0u; i<16; ++i)
+        { indices[i] ^= 0x1; }
+    }
+    else if (c0 == c1)
+    { memset(indices, 0, sizeof(indices)); }
+
+    uint32_t bits = 0;
+    for(auto i=0u; i<16; ++i)
+    { bits |= uint32_t(indices[i]) << (i * 2); }
+
+    memcpy(pDst + 0, &c0,   sizeof(c0));
+    memcpy(pDst + 2, &c1,   sizeof(c1));
+    memcpy(pDst + 4, &bits, sizeof(bits));
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC4 のパレットを求めます.
+//-------------------------------------------------------------------------------------------------
+void GetBC4Palette(int32_t a0, int32_t a1, float palette[8])
+{
+    palette[0] = float(a0);
+    palette[1] = float(a1);
+    if (a0 > a1)
+    {
+        for(auto i=1; i<7; ++i)
+        { palette[i + 1] = float((7 - i) * a0 + i * a1) / 7.0f; }
+    }
+    else
+    {
+        for(auto i=1; i<5; ++i)
+        { palette[i + 1] = float((5 - i) * a0 + i * a1) / 5.0f; }
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC4 の最も近いインデックスを求めます.
+//-------------------------------------------------------------------------------------------------
+float FindBC4Indices(const float* pValues, const float palette[8], uint8_t* pIndices)
+{
+    auto total = 0.0f;
+    for(auto i=0u; i<16; ++i)
+    {
+        auto best  = FLT_MAX;
+        auto index = 0u;
+        for(auto j=0u; j<8; ++j)
+        {
+            auto d = pValues[i] - palette[j];
+            d *= d;
+            if (d < best)
+            {
+                best  = d;
+                index = j;
+            }
+        }
+        pIndices[i] = uint8_t(index);
+        total += best;
+    }
+    return total;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC4 ブロックを圧縮します.
+//-------------------------------------------------------------------------------------------------
+void EncodeBC4(const float* pValues, uint8_t* pDst)
+{
+    static const float kWeights[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+
+    auto minValue  = 255.0f;
+    auto maxValue  = 0.0f;
+    auto minInner  = 255.0f;
+    auto maxInner  = 0.0f;
+    for(auto i=0u; i<16; ++i)
+    {
+        auto v = pValues[i];
+        minValue = (v < minValue) ? v : minValue;
+        maxValue = (v > maxValue) ? v : maxValue;
+        if (v > 0.0f && v < 255.0f)
+        {
+            minInner = (v < minInner) ? v : minInner;
+            maxInner = (v > maxInner) ? v : maxInner;
+        }
+    }
+
+    float   palette[8];
+    uint8_t indices[16];
+    uint8_t temp[16];
+
+    // 8値補間モード.
+    auto a0 = Quantize(maxValue, 1.0f, 255);
+    auto a1 = Quantize(minValue, 1.0f, 255);
+    GetBC4Palette(a0, a1, palette);
+    auto bestError = FindBC4Indices(pValues, palette, indices);
+
+    if (bestError > 0.0f && a0 > a1)
+    {
+        // 最小二乗法で端点を調整する.
+        Block block;
+        memcpy(block.Value[0], pValues, sizeof(float) * 16);
+        float e0[4] = {}, e1[4] = {};
+        if (RefineEndpoints(block, 1, 0xffff, indices, kWeights, e0, e1))
+        {
+            auto r0 = Quantize(e0[0], 1.0f, 255);
+            auto r1 = Quantize(e1[0], 1.0f, 255);
+            if (r0 > r1)
+            {
+                GetBC4Palette(r0, r1, palette);
+                auto error = FindBC4Indices(pValues, palette, temp);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    a0 = r0;
+                    a1 = r1;
+                    memcpy(indices, temp, sizeof(indices));
+                }
+            }
+        }
+    }
+
+    // 0 と 255 を含む場合は6値補間モードも試す.
+    if (bestError > 0.0f && minInner <= maxInner)
+    {
+        auto b0 = Quantize(minInner, 1.0f, 255);
+        auto b1 = Quantize(maxInner, 1.0f, 255);
+        GetBC4Palette(b0, b1, palette);
+        auto error = FindBC4Indices(pValues, palette, temp);
+        if (error < bestError)
+        {
+            a0 = b0;
+            a1 = b1;
+            memcpy(indices, temp, sizeof(indices));
+        }
+    }
+
+    uint64_t bits = 0;
+    for(auto i=0u; i<16; ++i)
+    { bits |= uint64_t(indices[i]) << (i * 3); }
+
+    pDst[0] = uint8_t(a0);
+    pDst[1] = uint8_t(a1);
+    for(auto i=0u; i<6; ++i)
+    { pDst[2 + i] = uint8_t(bits >> (i * 8)); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC7 の端点を 7bit + Pビットに量子化します.
+//-------------------------------------------------------------------------------------------------
+void QuantizeBC7Endpoint(const float value[4], int32_t q[4], int32_t& pbit)
+{
+    auto bestError = FLT_MAX;
+    for(auto p=0; p<2; ++p)
+    {
+        int32_t temp[4];
+        auto error = 0.0f;
+        for(auto c=0; c<4; ++c)
+        {
+            temp[c] = Quantize(value[c] - float(p), 0.5f, 127);
+            auto d = float(temp[c] * 2 + p) - value[c];
+            error += d * d;
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            pbit      = p;
+            memcpy(q, temp, sizeof(temp));
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC7 ブロックを圧縮します(モード6).
+//-------------------------------------------------------------------------------------------------
+void EncodeBC7(const Block& block, uint8_t* pDst)
+{
+    static const float kWeights[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const struct IndexWeights
+    {
+        float Value[16];
+        IndexWeights()
+        {
+            for(auto i=0; i<16; ++i)
+            { Value[i] = float(WEIGHTS_4BIT[i]) / 64.0f; }
+        }
+    } s_IndexWeights;
+
+    float e0[4], e1[4];
+    FitEndpoints(block, 4, 0xffff, e0, e1);
+
+    int32_t best0[4] = {}, best1[4] = {};
+    int32_t bestP0 = 0, bestP1 = 0;
+    uint8_t indices[16] = {};
+    auto bestError = FLT_MAX;
+
+    for(auto iter=0; iter<3; ++iter)
+    {
+        int32_t q0[4], q1[4], p0, p1;
+        QuantizeBC7Endpoint(e0, q0, p0);
+        QuantizeBC7Endpoint(e1, q1, p1);
+
+        float palette[16][4];
+        for(auto c=0; c<4; ++c)
+        {
+            auto v0 = uint32_t(q0[c] * 2 + p0);
+            auto v1 = uint32_t(q1[c] * 2 + p1);
+            for(auto i=0; i<16; ++i)
+            { palette[i][c] = float(((64 - WEIGHTS_4BIT[i]) * v0 + WEIGHTS_4BIT[i] * v1 + 32) >> 6); }
+        }
+
+        uint8_t temp[16];
+        auto error = FindIndices(block, palette, 16, kWeights, 0xffff, temp);
+        if (error < bestError)
+        {
+            bestError = error;
+            memcpy(best0, q0, sizeof(q0));
+            memcpy(best1, q1, sizeof(q1));
+            bestP0 = p0;
+            bestP1 = p1;
+            memcpy(indices, temp, sizeof(indices));
+        }
+
+        if (error == 0.0f || !RefineEndpoints(block, 4, 0xffff, temp, s_IndexWeights.Value, e0, e1))
+        { break; }
+    }
+
+    // 先頭ピクセルのインデックスの最上位ビットは 0 でなければならない.
+    if (indices[0] & 0x8)
+    {
+        for(auto c=0; c<4; ++c)
+        {
+            auto t = best0[c]; best0[c] = best1[c]; best1[c] = t;
+        }
+        auto t = bestP0; bestP0 = bestP1; bestP1 = t;
+        for(auto i=0; i<16; ++i)
+        { indices[i] = uint8_t(15 - indices[i]); }
+    }
+
+    BitWriter writer(pDst);
+    writer.Write(0x1 << 6, 7);
+    for(auto c=0; c<4; ++c)
+    {
+        writer.Write(uint32_t(best0[c]), 7);
+        writer.Write(uint32_t(best1[c]), 7);
+    }
+    writer.Write(uint32_t(bestP0), 1);
+    writer.Write(uint32_t(bestP1), 1);
+    writer.Write(indices[0], 3);
+    for(auto i=1; i<16; ++i)
+    { writer.Write(indices[i], 4); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC6H の10bit端点を逆量子化します.
+//-------------------------------------------------------------------------------------------------
+inline uint32_t UnquantizeBC6H(int32_t value)
+{
+    if (value == 0)
+    { return 0; }
+    if (value == 1023)
+    { return 0xffff; }
+    return ((uint32_t(value) << 16) + 0x8000) >> 10;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      BC6H ブロックを圧縮します(モード11, 符号なし).
+//-------------------------------------------------------------------------------------------------
+void EncodeBC6H(const Block& block, uint8_t* pDst)
+{
+    static const float kWeights[] = { 1.0f, 1.0f, 1.0f, 0.0f };
+    static const struct IndexWeights
+    {
+        float Value[16];
+        IndexWeights()
+        {
+            for(auto i=0; i<16; ++i)
+            { Value[i] = float(WEIGHTS_4BIT[i]) / 64.0f; }
+        }
+    } s_IndexWeights;
+
+    // 半精度浮動小数のビット列を値として扱うので誤差は対数的になる.
+    float e0[4], e1[4];
+    FitEndpoints(block, 3, 0xffff, e0, e1);
+
+    int32_t best0[3] = {}, best1[3] = {};
+    uint8_t indices[16] = {};
+    auto bestError = FLT_MAX;
+
+    for(auto iter=0; iter<3; ++iter)
+    {
+        // 復元値はおおよそ (e * 64 + 32) * 31 / 64 なので逆算する.
+        int32_t q0[3], q1[3];
+        for(auto c=0; c<3; ++c)
+        {
+            q0[c] = Quantize(e0[c] / 31.0f - 0.5f, 1.0f, 1023);
+            q1[c] = Quantize(e1[c] / 31.0f - 0.5f, 1.0f, 1023);
+        }
+
+        float palette[16][4] = {};
+        for(auto c=0; c<3; ++c)
+        {
+            auto u0 = UnquantizeBC6H(q0[c]);
+            auto u1 = UnquantizeBC6H(q1[c]);
+            for(auto i=0; i<16; ++i)
+            {
+                auto v = ((64 - WEIGHTS_4BIT[i]) * u0 + WEIGHTS_4BIT[i] * u1 + 32) >> 6;
+                palette[i][c] = float((v * 31) >> 6);
+            }
+        }
+
+        uint8_t temp[16];
+        auto error = FindIndices(block, palette, 16, kWeights, 0xffff, temp);
+        if (error < bestError)
+        {
+            bestError = error;
+            memcpy(best0, q0, sizeof(q0));
+            memcpy(best1, q1, sizeof(q1));
+            memcpy(indices, temp, sizeof(indices));
+        }
+
+        if (error == 0.0f || !RefineEndpoints(block, 3, 0xffff, temp, s_IndexWeights.Value, e0, e1))
+        { break; }
+    }
+
+    // 先頭ピクセルのインデックスの最上位ビットは 0 でなければならない.
+    if (indices[0] & 0x8)
+    {
+        for(auto c=0; c<3; ++c)
+        {
+            auto t = best0[c]; best0[c] = best1[c]; best1[c] = t;
+        }
+        for(auto i=0; i<16; ++i)
+        { indices[i] = uint8_t(15 - indices[i]); }
+    }
+
+    BitWriter writer(pDst);
+    writer.Write(0x03, 5);
+    for(auto c=0; c<3; ++c)
+    { writer.Write(uint32_t(best0[c]), 10); }
+    for(auto c=0; c<3; ++c)
+    { writer.Write(uint32_t(best1[c]), 10); }
+    writer.Write(indices[0], 3);
+    for(auto i=1; i<16; ++i)
+    { writer.Write(indices[i], 4); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックのピクセルを取得します. 端のブロックは最後のピクセルを繰り返します.
+//-------------------------------------------------------------------------------------------------
+void FetchBlock
+(
+    const asdx::SubResource&    src,
+    const SourceFormat&         format,
+    uint32_t                    blockX,
+    uint32_t                    blockY,
+    bool                        hdr,            // 半精度浮動小数のビット列として取得します.
+    bool                        encodeSRGB,     // 浮動小数の入力を sRGB に変換します.
+    Block&                      block
+)
+{
+    auto pToLinear = GetSRGBToLinearTable();
+    auto pToSRGB   = GetLinearToSRGBTable();
+
+    for(auto i=0u; i<16; ++i)
+    {
+        auto x = blockX * 4 + (i & 0x3);
+        auto y = blockY * 4 + (i >> 2);
+        x = (x < src.Width)  ? x : src.Width  - 1;
+        y = (y < src.Height) ? y : src.Height - 1;
+
+        auto p = src.pPixels + size_t(y) * src.Pitch;
+        float rgba[4];
+        if (format.Layout == PIXEL_LAYOUT_RGBA32F)
+        {
+            memcpy(rgba, p + size_t(x) * 16, sizeof(rgba));
+            if (!hdr)
+            {
+                for(auto c=0; c<3; ++c)
+                { rgba[c] = float(encodeSRGB ? EncodeSRGB8(rgba[c], pToSRGB) : EncodeUNorm8(rgba[c])); }
+                rgba[3] = float(EncodeUNorm8(rgba[3]));
+            }
+        }
+        else
+        {
+            auto swap = (format.Layout == PIXEL_LAYOUT_BGRA8);
+            auto q    = p + size_t(x) * 4;
+            uint8_t value[4] = { q[swap ? 2 : 0], q[1], q[swap ? 0 : 2], q[3] };
+            for(auto c=0; c<4; ++c)
+            {
+                rgba[c] = float(value[c]);
+                if (hdr)
+                { rgba[c] = (format.SRGB && c < 3) ? pToLinear[value[c]] : rgba[c] / 255.0f; }
+            }
+        }
+
+        if (hdr)
+        {
+            // 負の値と NaN は 0 にする.
+            for(auto c=0; c<3; ++c)
+            {
+                auto h = (rgba[c] > 0.0f) ? ToHalf(rgba[c]) : uint16_t(0);
+                rgba[c] = float((h < BC6H_MAX_HALF) ? h : BC6H_MAX_HALF);
+            }
+        }
+
+        for(auto c=0; c<4; ++c)
+        { block.Value[c][i] = rgba[c]; }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロックを圧縮します.
+//-------------------------------------------------------------------------------------------------
+void EncodeBlock(BLOCK_FORMAT format, const Block& block, uint8_t* pDst)
+{
+    switch(format)
+    {
+    case BLOCK_FORMAT_BC1:
+        EncodeBC1Color(block, true, pDst);
+        break;
+
+    case BLOCK_FORMAT_BC3:
+        EncodeBC4(block.Value[3], pDst);
+        EncodeBC1Color(block, false, pDst + 8);
+        break;
+
+    case BLOCK_FORMAT_BC4:
+        EncodeBC4(block.Value[0], pDst);
+        break;
+
+    case BLOCK_FORMAT_BC5:
+        EncodeBC4(block.Value[0], pDst);
+        EncodeBC4(block.Value[1], pDst + 8);
+        break;
+
+    case BLOCK_FORMAT_BC6H:
+        EncodeBC6H(block, pDst);
+        break;
+
+    case BLOCK_FORMAT_BC7:
+        EncodeBC7(block, pDst);
+        break;
+    }
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+//-------------------------------------------------------------------------------------------------
+//      ミップマップを生成します.
+//-------------------------------------------------------------------------------------------------
+bool GenerateMipMaps
+(
+    ResTexture&     resource,
+    MIPMAP_FILTER   filter,
+    uint32_t        flags,
+    uint32_t        mipLevels,
+    ThreadPool*     pPool
+)
+{
+    SourceFormat format;
+    if (!GetSourceFormat(resource.Format, format))
+    {
+        ELOG("Error : Unsupported Format. format = %u", resource.Format);
+        return false;
+    }
+
+    if ((resource.Option & SUBRESOURCE_OPTION_VOLUME) || resource.pResources == nullptr
+      || resource.Width == 0 || resource.Height == 0)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto surfaceCount = (resource.SurfaceCount > 0) ? resource.SurfaceCount : 1;
+    auto oldMipCount  = (resource.MipMapCount  > 0) ? resource.MipMapCount  : 1;
+
+    auto fullCount = 1u;
+    for(auto size = (resource.Width > resource.Height) ? resource.Width : resource.Height; size > 1; size >>= 1)
+    { fullCount++; }
+
+    auto mipCount = (mipLevels == 0 || mipLevels > fullCount) ? fullCount : mipLevels;
+
+    auto pResources = new (std::nothrow) SubResource[surfaceCount * mipCount];
+    if (pResources == nullptr)
+    {
+        ELOG("Error : Out of Memory.");
+        return false;
+    }
+
+    auto bytesPerPixel = (format.Layout == PIXEL_LAYOUT_RGBA32F) ? 16u : 4u;
+
+    // 出力先を確保する. 最上位レベルは既存のピクセルを引き継ぐ.
+    for(auto s=0u; s<surfaceCount; ++s)
+    {
+        auto w = resource.Width;
+        auto h = resource.Height;
+        for(auto m=1u; m<mipCount; ++m)
+        {
+            w = (w > 1) ? w >> 1 : 1;
+            h = (h > 1) ? h >> 1 : 1;
+
+            auto& dst = pResources[s * mipCount + m];
+            dst.Width      = w;
+            dst.Height     = h;
+            dst.Pitch      = w * bytesPerPixel;
+            dst.SlicePitch = dst.Pitch * h;
+            dst.pPixels    = new (std::nothrow) uint8_t[dst.SlicePitch];
+            if (dst.pPixels == nullptr)
+            {
+                ELOG("Error : Out of Memory.");
+                for(auto i=0u; i<surfaceCount * mipCount; ++i)
+                { pResources[i].Release(); }
+                SafeDeleteArray(pResources);
+                return false;
+            }
+        }
+    }
+
+    for(auto s=0u; s<surfaceCount; ++s)
+    {
+        pResources[s * mipCount] = resource.pResources[s * oldMipCount];
+        resource.pResources[s * oldMipCount].pPixels = nullptr;
+    }
+
+    resource.Release();
+    resource.pResources   = pResources;
+    resource.MipMapCount  = mipCount;
+    resource.SurfaceCount = surfaceCount;
+
+    // 1つ上のレベルのリニアな値から順に縮小する.
+    std::vector<float> prev;
+    std::vector<float> next;
+    for(auto s=0u; s<surfaceCount; ++s)
+    {
+        for(auto m=1u; m<mipCount; ++m)
+        {
+            auto& src = pResources[s * mipCount + m - 1];
+            auto& dst = pResources[s * mipCount + m];
+
+            auto last = (m + 1 == mipCount);
+            next.resize(last ? 0 : size_t(dst.Width) * dst.Height * 4);
+
+            ResampleLevel(
+                (m == 1) ? &src : nullptr,
+                (m == 1) ? nullptr : prev.data(),
+                format,
+                src.Width,
+                src.Height,
+                dst,
+                last ? nullptr : next.data(),
+                filter,
+                flags,
+                pPool);
+
+            prev.swap(next);
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ブロック圧縮します.
+//-------------------------------------------------------------------------------------------------
+bool CompressTexture(ResTexture& resource, uint32_t format, ThreadPool* pPool)
+{
+    SourceFormat source;
+    if (!GetSourceFormat(resource.Format, source))
+    {
+        ELOG("Error : Unsupported Source Format. format = %u", resource.Format);
+        return false;
+    }
+
+    BLOCK_FORMAT blockFormat;
+    bool srgb;
+    if (!GetBlockFormat(format, blockFormat, srgb))
+    {
+        ELOG("Error : Unsupported Block Format. format = %u", format);
+        return false;
+    }
+
+    if ((resource.Option & SUBRESOURCE_OPTION_VOLUME) || resource.pResources == nullptr)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    // sRGB の入力は sRGB のまま圧縮する.
+    auto dstFormat  = uint32_t(source.SRGB ? MakeSRGB(int(format)) : int(format));
+    auto blockBytes = uint32_t(GetBitsPerPixel(int(dstFormat)) * 2);
+    auto hdr        = (blockFormat == BLOCK_FORMAT_BC6H);
+    auto encodeSRGB = srgb && (source.Layout == PIXEL_LAYOUT_RGBA32F);
+
+    auto surfaceCount = (resource.SurfaceCount > 0) ? resource.SurfaceCount : 1;
+    auto mipCount     = (resource.MipMapCount  > 0) ? resource.MipMapCount  : 1;
+    auto count        = surfaceCount * mipCount;
+
+    auto pResources = new (std::nothrow) SubResource[count];
+    if (pResources == nullptr)
+    {
+        ELOG("Error : Out of Memory.");
+        return false;
+    }
+
+    // タイル単位のタスクを列挙する.
+    struct Task
+    {
+        uint32_t    Index;
+        uint32_t    BlockX;
+        uint32_t    BlockY;
+    };
+    std::vector<Task> tasks;
+
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& src = resource.pResources[i];
+        auto& dst = pResources[i];
+
+        auto blockW = (src.Width  + 3) / 4;
+        auto blockH = (src.Height + 3) / 4;
+
+        dst.Width      = src.Width;
+        dst.Height     = src.Height;
+        dst.Pitch      = blockW * blockBytes;
+        dst.SlicePitch = dst.Pitch * blockH;
+        dst.pPixels    = new (std::nothrow) uint8_t[dst.SlicePitch];
+        if (dst.pPixels == nullptr)
+        {
+            ELOG("Error : Out of Memory.");
+            for(auto j=0u; j<count; ++j)
+            { pResources[j].Release(); }
+            SafeDeleteArray(pResources);
+            return false;
+        }
+
+        for(auto y=0u; y<blockH; y+=TILE_BLOCK_COUNT)
+        {
+            for(auto x=0u; x<blockW; x+=TILE_BLOCK_COUNT)
+            { tasks.push_back({ i, x, y }); }
+        }
+    }
+
+    ForEachRange(pPool, uint32_t(tasks.size()), 1, [&](uint32_t begin, uint32_t end)
+    {
+        Block block;
+        for(auto t=begin; t<end; ++t)
+        {
+            auto& task = tasks[t];
+            auto& src  = resource.pResources[task.Index];
+            auto& dst  = pResources[task.Index];
+
+            auto blockW = (src.Width  + 3) / 4;
+            auto blockH = (src.Height + 3) / 4;
+            auto endX   = (task.BlockX + TILE_BLOCK_COUNT < blockW) ? task.BlockX + TILE_BLOCK_COUNT : blockW;
+            auto endY   = (task.BlockY + TILE_BLOCK_COUNT < blockH) ? task.BlockY + TILE_BLOCK_COUNT : blockH;
+
+            for(auto y=task.BlockY; y<endY; ++y)
+            {
+                for(auto x=task.BlockX; x<endX; ++x)
+                {
+                    FetchBlock(src, source, x, y, hdr, encodeSRGB, block);
+                    EncodeBlock(blockFormat, block, dst.pPixels + size_t(y) * dst.Pitch + size_t(x) * blockBytes);
+                }
+            }
+        }
+    });
+
+    resource.Release();
+    resource.pResources = pResources;
+    resource.Format     = dstFormat;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ミップマップ生成とブロック圧縮を順に行います.
+//-------------------------------------------------------------------------------------------------
+bool ProcessTexture(ResTexture& resource, const TextureProcessDesc& desc, ThreadPool* pPool)
+{
+    if (desc.GenerateMipMaps && !GenerateMipMaps(resource, desc.Filter, desc.MipFlags, desc.MipLevels, pPool))
+    {
+        ELOG("Error : GenerateMipMaps() Failed.");
+        return false;
+    }
+
+    if (desc.Format != DXGI_FORMAT_UNKNOWN && !CompressTexture(resource, desc.Format, pPool))
+    {
+        ELOG("Error : CompressTexture() Failed.");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace asdx
@@ -0,0 +1,362 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxThreadPool.cpp
+// Desc : Work Stealing Thread Pool.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <Windows.h>
+#include <memory>
+#include <asdxThreadPool.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t INVALID_WORKER_INDEX = UINT32_MAX;
+
+//-----------------------------------------------------------------------------
+// Thread Local Variables
+//-----------------------------------------------------------------------------
+thread_local const asdx::ThreadPool*    t_pOwner       = nullptr;               // 所属するスレッドプール.
+thread_local uint32_t                   t_WorkerIndex  = INVALID_WORKER_INDEX;  // ワーカー番号.
+
+} // namespace
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool ThreadPool::Init(uint32_t threadCount)
+{
+    if (!m_Threads.empty())
+    { return false; }
+
+    if (threadCount == 0)
+    { threadCount = std::thread::hardware_concurrency(); }
+
+    if (threadCount == 0)
+    { threadCount = 1; }
+
+    m_pQueues = new (std::nothrow) Queue[threadCount];
+    if (m_pQueues == nullptr)
+    { return false; }
+
+    m_Finish = false;
+
+    m_Threads.reserve(threadCount);
+    for(auto i=0u; i<threadCount; ++i)
+    { m_Threads.emplace_back(&ThreadPool::Worker, this, i); }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void ThreadPool::Term()
+{
+    if (m_Threads.empty())
+    { return; }
+
+    WaitIdle();
+
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        m_Finish = true;
+    }
+    m_WorkerCond.notify_all();
+
+    for(auto& thread : m_Threads)
+    { thread.join(); }
+
+    m_Threads.clear();
+
+    delete[] m_pQueues;
+    m_pQueues = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      ジョブを投入します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Push(const Job& job, JOB_PRIORITY priority)
+{
+    if (!job)
+    { return; }
+
+    // ワーカーが無い場合はその場で実行.
+    if (m_Threads.empty())
+    {
+        job();
+        return;
+    }
+
+    auto count = uint32_t(m_Threads.size());
+    auto index = (t_pOwner == this)
+        ? t_WorkerIndex
+        : m_NextQueue.fetch_add(1, std::memory_order_relaxed) % count;
+
+    m_ActiveCount++;
+
+    {
+        // 起床判定と競合しないようにロックしてから増やす.
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        m_QueuedCount++;
+    }
+
+    {
+        auto& queue = m_pQueues[index];
+        ScopedLock locker(&queue.Lock);
+        queue.Jobs[priority].push_back(job);
+    }
+    m_WorkerCond.notify_one();
+    m_WaitCond.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+//      呼び出しスレッドでジョブを1つ実行します.
+//-----------------------------------------------------------------------------
+bool ThreadPool::TryExecute()
+{
+    if (m_Threads.empty())
+    { return false; }
+
+    auto index = (t_pOwner == this) ? t_WorkerIndex : INVALID_WORKER_INDEX;
+
+    Job job;
+    if (!Pop(index, job))
+    { return false; }
+
+    Execute(job);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      条件が満たされるまでジョブを実行しながら待機します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Wait(const std::function<bool(void)>& isDone)
+{
+    while(!isDone())
+    {
+        if (TryExecute())
+        { continue; }
+
+        std::unique_lock<std::mutex> locker(m_Mutex);
+        m_WaitCond.wait(locker, [&]() { return isDone() || m_QueuedCount > 0; });
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      条件が満たされるまで，ジョブを実行せずに待機します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Block(const std::function<bool(void)>& isDone)
+{
+    std::unique_lock<std::mutex> locker(m_Mutex);
+    m_WaitCond.wait(locker, [&]() { return isDone(); });
+}
+
+//-----------------------------------------------------------------------------
+//      待機中のスレッドに条件の再評価を促します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Notify()
+{
+    // 条件の評価と通知の間に割り込まないようにロックを経由する.
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+    }
+    m_WaitCond.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+//      全てのジョブが完了するまで待機します.
+//-----------------------------------------------------------------------------
+void ThreadPool::WaitIdle()
+{ Wait([this]() { return m_ActiveCount == 0; }); }
+
+//-----------------------------------------------------------------------------
+//      範囲を分割して並列に処理します.
+//-----------------------------------------------------------------------------
+void ThreadPool::ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunc& func)
+{
+    if (count == 0)
+    { return; }
+
+    if (grainSize == 0)
+    { grainSize = 1; }
+
+    auto chunkCount = (count + grainSize - 1) / grainSize;
+    if (m_Threads.empty() || chunkCount == 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    // 遅れて開始したジョブが参照しても問題ないように共有状態で管理.
+    struct State
+    {
+        std::atomic<uint32_t>   Next;
+        std::atomic<uint32_t>   Done;
+        uint32_t                Count;
+        uint32_t                GrainSize;
+        uint32_t                ChunkCount;
+        RangeFunc               Func;
+    };
+
+    auto state = std::make_shared<State>();
+    state->Next         = 0;
+    state->Done         = 0;
+    state->Count        = count;
+    state->GrainSize    = grainSize;
+    state->ChunkCount   = chunkCount;
+    state->Func         = func;
+
+    auto run = [state]()
+    {
+        for(;;)
+        {
+            auto chunk = state->Next.fetch_add(1);
+            if (chunk >= state->ChunkCount)
+            { break; }
+
+            auto begin = chunk * state->GrainSize;
+            auto end   = begin + state->GrainSize;
+            if (end > state->Count)
+            { end = state->Count; }
+            state->Func(begin, end);
+            state->Done.fetch_add(1);
+        }
+    };
+
+    auto jobCount = chunkCount - 1;
+    if (jobCount > uint32_t(m_Threads.size()))
+    { jobCount = uint32_t(m_Threads.size()); }
+    for(auto i=0u; i<jobCount; ++i)
+    { Push(run, JOB_PRIORITY_HIGH); }
+
+    run();
+
+    // run() が戻った時点で全ての範囲は割り当て済みなので，残りは他のスレッドで実行中の範囲のみ.
+    // 無関係なジョブを実行すると完了が遅れるため，ジョブは実行せずに待つ.
+    Block([&state]() { return state->Done == state->ChunkCount; });
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッド数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t ThreadPool::GetThreadCount() const
+{ return uint32_t(m_Threads.size()); }
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッドの処理です.
+//-----------------------------------------------------------------------------
+void ThreadPool::Worker(uint32_t index)
+{
+    t_pOwner      = this;
+    t_WorkerIndex = index;
+
+    // WIC などの COM を利用するジョブのため.
+    auto hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+    for(;;)
+    {
+        Job job;
+        if (Pop(index, job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> locker(m_Mutex);
+        m_WorkerCond.wait(locker, [this]() { return m_Finish || m_QueuedCount > 0; });
+
+        if (m_Finish && m_QueuedCount == 0)
+        { break; }
+    }
+
+    if (SUCCEEDED(hr))
+    { CoUninitialize(); }
+
+    t_pOwner      = nullptr;
+    t_WorkerIndex = INVALID_WORKER_INDEX;
+}
+
+//-----------------------------------------------------------------------------
+//      ジョブを取り出します.
+//-----------------------------------------------------------------------------
+bool ThreadPool::Pop(uint32_t index, Job& job)
+{
+    if (m_QueuedCount == 0)
+    { return false; }
+
+    auto count = uint32_t(m_Threads.size());
+    auto start = (index != INVALID_WORKER_INDEX) ? index : 0;
+
+    for(auto p=0; p<JOB_PRIORITY_COUNT; ++p)
+    {
+        // 自身のキューは後ろから(LIFO), 他のキューは前から(FIFO)奪う.
+        for(auto i=0u; i<count; ++i)
+        {
+            auto  target = (start + i) % count;
+            auto& queue  = m_pQueues[target];
+            ScopedLock locker(&queue.Lock);
+
+            auto& jobs = queue.Jobs[p];
+            if (jobs.empty())
+            { continue; }
+
+            if (target == index)
+            {
+                job = std::move(jobs.back());
+                jobs.pop_back();
+            }
+            else
+            {
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            m_QueuedCount--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      ジョブを実行します.
+//-----------------------------------------------------------------------------
+void ThreadPool::Execute(Job& job)
+{
+    job();
+    job = nullptr;
+
+    m_ActiveCount--;
+
+    // 待機中のスレッドに条件の再評価を促す.
+    Notify();
+}
+
+} // namespace asdx
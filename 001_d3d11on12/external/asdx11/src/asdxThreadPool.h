@@ -0,0 +1,178 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxThreadPool.h
+// Desc : Work Stealing Thread Pool.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <asdxSpinLock.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// JOB_PRIORITY enum
+///////////////////////////////////////////////////////////////////////////////
+enum JOB_PRIORITY
+{
+    JOB_PRIORITY_HIGH = 0,      //!< 高優先度.
+    JOB_PRIORITY_NORMAL,        //!< 通常.
+    JOB_PRIORITY_LOW,           //!< 低優先度.
+    JOB_PRIORITY_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ThreadPool class
+///////////////////////////////////////////////////////////////////////////////
+class ThreadPool
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    using Job       = std::function<void(void)>;
+    using RangeFunc = std::function<void(uint32_t begin, uint32_t end)>;
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    ThreadPool();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~ThreadPool();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      threadCount     ワーカースレッド数(0の場合は論理コア数).
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //-------------------------------------------------------------------------
+    bool Init(uint32_t threadCount = 0);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //!             投入済みのジョブは全て実行してから終了します.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ジョブを投入します.
+    //!             ワーカースレッドから呼ばれた場合は自身のキューに積まれます.
+    //!
+    //! @param[in]      job         ジョブ.
+    //! @param[in]      priority    優先度.
+    //-------------------------------------------------------------------------
+    void Push(const Job& job, JOB_PRIORITY priority = JOB_PRIORITY_NORMAL);
+
+    //-------------------------------------------------------------------------
+    //! @brief      呼び出しスレッドでジョブを1つ実行します.
+    //!
+    //! @retval true    ジョブを実行しました.
+    //! @retval false   実行可能なジョブがありません.
+    //-------------------------------------------------------------------------
+    bool TryExecute();
+
+    //-------------------------------------------------------------------------
+    //! @brief      条件が満たされるまでジョブを実行しながら待機します.
+    //!             条件はジョブの完了時と Notify() の呼び出し時に再評価されます.
+    //!             待ち対象と無関係なジョブも呼び出しスレッドで実行されるため，
+    //!             ジョブ内から呼び出すと待機時間やスタックの深さが他のジョブに引きずられます.
+    //!             ジョブ内で特定の処理を待つ場合は Block() を使用してください.
+    //!
+    //! @param[in]      isDone      待機を終了する場合に true を返す関数.
+    //-------------------------------------------------------------------------
+    void Wait(const std::function<bool(void)>& isDone);
+
+    //-------------------------------------------------------------------------
+    //! @brief      条件が満たされるまで，ジョブを実行せずに待機します.
+    //!             条件はジョブの完了時と Notify() の呼び出し時に再評価されます.
+    //!             待ち対象が他のスレッドで実行中であることが保証される場合にのみ使用してください.
+    //!
+    //! @param[in]      isDone      待機を終了する場合に true を返す関数.
+    //-------------------------------------------------------------------------
+    void Block(const std::function<bool(void)>& isDone);
+
+    //-------------------------------------------------------------------------
+    //! @brief      Wait() / Block() で待機中のスレッドに条件の再評価を促します.
+    //!             ジョブの完了以外で待機条件が変化した場合に呼び出します.
+    //-------------------------------------------------------------------------
+    void Notify();
+
+    //-------------------------------------------------------------------------
+    //! @brief      全てのジョブが完了するまで待機します.
+    //-------------------------------------------------------------------------
+    void WaitIdle();
+
+    //-------------------------------------------------------------------------
+    //! @brief      範囲を分割して並列に処理します.
+    //!             呼び出しスレッドも処理に参加し，全ての範囲が完了するまで戻りません.
+    //!
+    //! @param[in]      count       要素数.
+    //! @param[in]      grainSize   1ジョブ当たりの要素数.
+    //! @param[in]      func        [begin, end) を処理する関数.
+    //-------------------------------------------------------------------------
+    void ParallelFor(uint32_t count, uint32_t grainSize, const RangeFunc& func);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ワーカースレッド数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetThreadCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Queue structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Queue
+    {
+        SpinLock            Lock;                           //!< スピンロック.
+        std::deque<Job>     Jobs[JOB_PRIORITY_COUNT];       //!< 優先度別のジョブ.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<std::thread>    m_Threads;                  //!< ワーカースレッド.
+    Queue*                      m_pQueues       = nullptr;  //!< ワーカー毎のキュー.
+    std::atomic<uint32_t>       m_QueuedCount   = {};       //!< キューに積まれているジョブ数.
+    std::atomic<uint32_t>       m_ActiveCount   = {};       //!< 未完了のジョブ数.
+    std::atomic<uint32_t>       m_NextQueue     = {};       //!< 外部から投入する際のキュー番号.
+    std::atomic<bool>           m_Finish        = {};       //!< 終了フラグ.
+    std::mutex                  m_Mutex;                    //!< ミューテックス.
+    std::condition_variable     m_WorkerCond;               //!< ワーカー起床用.
+    std::condition_variable     m_WaitCond;                 //!< 待機スレッド起床用.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void Worker(uint32_t index);
+    bool Pop(uint32_t index, Job& job);
+    void Execute(Job& job);
+
+    ThreadPool              (const ThreadPool&) = delete;
+    ThreadPool& operator =  (const ThreadPool&) = delete;
+};
+
+} // namespace asdx
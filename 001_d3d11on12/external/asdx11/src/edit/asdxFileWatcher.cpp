@@ -9,52 +9,244 @@
 //-----------------------------------------------------------------------------
 #include <vector>
 #include <string>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#if defined(_WIN32)
 #include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+#include <poll.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
 #include <asdxLogger.h>
 #include <edit/asdxFileWatcher.h>
 
 
 namespace {
 
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const size_t     DEFAULT_BUFFER_SIZE     = 64 * 1024;    // ネットワークドライブの上限に合わせる.
+static const uint32_t   DEFAULT_WAIT_TIME_MSEC  = 100;
+
+#if defined(_WIN32)
+// フィルタ.
+static const DWORD NOTIFY_FILTER =
+    FILE_NOTIFY_CHANGE_FILE_NAME  |   // ファイル名の変更.
+    FILE_NOTIFY_CHANGE_DIR_NAME   |   // ディレクトリ名の変更.
+    FILE_NOTIFY_CHANGE_ATTRIBUTES |   // 属性の変更.
+    FILE_NOTIFY_CHANGE_SIZE       |   // サイズの変更.
+    FILE_NOTIFY_CHANGE_LAST_WRITE;    // 最終書き込み日時の変更.
+
+// 起床用イベントの分を除いた監視可能なディレクトリ数.
+static const size_t MAX_DIRECTORY_COUNT = MAXIMUM_WAIT_OBJECTS - 1;
+
 //-----------------------------------------------------------------------------
 //      マルチバイト文字列に変換します.
 //-----------------------------------------------------------------------------
-std::string ToStringA(const std::wstring& value)
+std::string ToStringA(const wchar_t* value, int count)
 {
-    auto length = WideCharToMultiByte(CP_ACP, 0, value.c_str(), int(value.size() + 1), nullptr, 0, nullptr, nullptr);
-    auto buffer = new char[length];
-
-    WideCharToMultiByte(CP_ACP, 0, value.c_str(), int(value.size() + 1), buffer, length, nullptr, nullptr);
+    // FILE_NOTIFY_INFORMATION::FileName はヌル終端されていないので文字数を指定して変換する.
+    auto length = WideCharToMultiByte(CP_ACP, 0, value, count, nullptr, 0, nullptr, nullptr);
+    if (length <= 0)
+    { return std::string(); }
 
-    std::string result(buffer);
-    delete[] buffer;
+    std::string result(size_t(length), '\0');
+    WideCharToMultiByte(CP_ACP, 0, value, count, &result[0], length, nullptr, nullptr);
 
     return result;
 }
+#else
+// フィルタ.
+static const uint32_t WATCH_MASK =
+    IN_CREATE       |   // ファイル・ディレクトリの作成.
+    IN_DELETE       |   // ファイル・ディレクトリの削除.
+    IN_MOVED_FROM   |   // 名前変更(変更前).
+    IN_MOVED_TO     |   // 名前変更(変更後).
+    IN_ATTRIB       |   // 属性の変更.
+    IN_MODIFY       |   // 書き込み.
+    IN_CLOSE_WRITE  |   // 書き込みモードで開いたファイルのクローズ.
+    IN_ONLYDIR;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Directory structure
+///////////////////////////////////////////////////////////////////////////////
+struct Directory
+{
+    std::string                 Path        = {};           //!< 監視対象ディレクトリ.
+    asdx::IFileUpdateListener*  pListener   = nullptr;      //!< 変更通知先.
+#if defined(_WIN32)
+    HANDLE                      hDir        = nullptr;      //!< ディレクトリハンドル.
+    HANDLE                      hEvent      = nullptr;      //!< 非同期I/Oの完了イベント.
+    OVERLAPPED                  Overlapped  = {};           //!< 非同期I/O.
+    bool                        Reading     = false;        //!< 非同期I/Oの発行中は true.
+    std::vector<uint8_t>        Buffer      = {};           //!< 変更通知バッファ.
+#endif
+};
 
+#if !defined(_WIN32)
 ///////////////////////////////////////////////////////////////////////////////
-// Worker structure
+// Watch structure
 ///////////////////////////////////////////////////////////////////////////////
-struct Worker
+struct Watch
 {
-    HANDLE                      hEvent          = nullptr;
-    HANDLE                      hDir            = nullptr;
-    uint32_t                    WaitTimeMsec    = 0;
-    std::vector<uint8_t>        Buffer          = {};
-    std::string                 DirectoryPath   = {};
-    asdx::IFileUpdateListener*  pListener       = nullptr;
-    std::atomic<bool>*          pFinish         = nullptr;
+    Directory*      pDir    = nullptr;      //!< 監視対象ディレクトリ.
+    std::string     Prefix  = {};           //!< 監視対象ディレクトリからの相対パス(末尾は '/').
+};
+#endif
 
-    Worker()
-    { /* DO_NOTHING */ }
+} // namespace
 
-    ~Worker()
-    { /* DO_NOTHING */ }
 
-    bool Prepare(const asdx::FileWatcher::Desc& desc, std::atomic<bool>* pFlags)
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////
+// FileWatcher::Context structure
+///////////////////////////////////////////////////////////////////////////////
+struct FileWatcher::Context
+{
+    std::mutex                          Mutex;                  //!< 追加要求用のミューテックス.
+    std::vector<Directory*>             Requests;               //!< 追加要求.
+    std::vector<Directory*>             Directories;            //!< 監視中ディレクトリ(監視スレッド専用).
+    std::vector<IFileUpdateListener*>   Listeners;              //!< OnIdle() の通知先(監視スレッド専用).
+    size_t                              BufferSize   = 0;       //!< ディレクトリごとのバッファサイズ.
+    uint32_t                            WaitTimeMsec = 0;       //!< 1ループの待機時間.
+    std::atomic<bool>*                  pFinish      = nullptr; //!< 終了フラグ.
+#if defined(_WIN32)
+    HANDLE                              hWake        = nullptr; //!< 起床用イベント.
+    size_t                              Count        = 0;       //!< 追加要求を含むディレクトリ数(Mutexで保護).
+#else
+    int                                 Fd           = -1;      //!< inotify のファイルディスクリプタ.
+    int                                 WakeFd       = -1;      //!< 起床用の eventfd.
+    std::unordered_map<int, Watch>      Watches;                //!< ウォッチディスクリプタとディレクトリの対応.
+    std::vector<uint8_t>                Buffer;                 //!< 変更通知バッファ.
+#endif
+
+    //-------------------------------------------------------------------------
+    //      初期化処理を行います.
+    //-------------------------------------------------------------------------
+    bool Open(const FileWatcher::Desc& desc, std::atomic<bool>* pFlags)
     {
-        hDir = CreateFileA(
-            desc.DirectoryPath,
+        pFinish      = pFlags;
+        BufferSize   = (desc.BufferSize   > 0) ? desc.BufferSize   : DEFAULT_BUFFER_SIZE;
+        WaitTimeMsec = (desc.WaitTimeMsec > 0) ? desc.WaitTimeMsec : DEFAULT_WAIT_TIME_MSEC;
+
+    #if defined(_WIN32)
+        hWake = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        if (hWake == nullptr)
+        {
+            ELOGA("Error : CreateEventA() Failed.");
+            return false;
+        }
+    #else
+        Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (Fd < 0)
+        {
+            ELOGA("Error : inotify_init1() Failed. errno = %d", errno);
+            return false;
+        }
+
+        WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (WakeFd < 0)
+        {
+            ELOGA("Error : eventfd() Failed. errno = %d", errno);
+            return false;
+        }
+
+        // 最低でも1イベント分は読み込めるようにする.
+        auto minSize = sizeof(inotify_event) + NAME_MAX + 1;
+        Buffer.resize((BufferSize > minSize) ? BufferSize : minSize);
+    #endif
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //      終了処理を行います. 監視スレッドの終了後に呼び出します.
+    //-------------------------------------------------------------------------
+    void Close()
+    {
+        for (auto pDir : Requests)
+        { Release(pDir); }
+
+        for (auto pDir : Directories)
+        { Release(pDir); }
+
+        Requests   .clear();
+        Directories.clear();
+        Listeners  .clear();
+
+    #if defined(_WIN32)
+        if (hWake != nullptr)
+        {
+            CloseHandle(hWake);
+            hWake = nullptr;
+        }
+    #else
+        if (Fd >= 0)
+        {
+            close(Fd);
+            Fd = -1;
+        }
+
+        if (WakeFd >= 0)
+        {
+            close(WakeFd);
+            WakeFd = -1;
+        }
+
+        Watches.clear();
+        Buffer.clear();
+        Buffer.shrink_to_fit();
+    #endif
+    }
+
+    //-------------------------------------------------------------------------
+    //      監視スレッドを起こします.
+    //-------------------------------------------------------------------------
+    void Wake()
+    {
+    #if defined(_WIN32)
+        SetEvent(hWake);
+    #else
+        uint64_t value = 1;
+        auto ret = write(WakeFd, &value, sizeof(value));
+        (void)ret;
+    #endif
+    }
+
+    //-------------------------------------------------------------------------
+    //      監視対象ディレクトリの追加を要求します.
+    //-------------------------------------------------------------------------
+    bool Add(const char* directoryPath, IFileUpdateListener* pListener)
+    {
+        std::string path = directoryPath;
+
+        // 末尾の区切り文字を取り除く.
+        while (path.size() > 1 && (path.back() == '/' || path.back() == '\\'))
+        { path.pop_back(); }
+
+    #if defined(_WIN32)
+        {
+            std::lock_guard<std::mutex> locker(Mutex);
+            if (Count >= MAX_DIRECTORY_COUNT)
+            {
+                ELOGA("Error : Too many directories. path = %s, limit = %zu", directoryPath, MAX_DIRECTORY_COUNT);
+                return false;
+            }
+        }
+
+        auto hDir = CreateFileA(
+            path.c_str(),
             FILE_LIST_DIRECTORY,
             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
             nullptr,
@@ -64,147 +256,411 @@ struct Worker
         );
         if (hDir == INVALID_HANDLE_VALUE)
         {
-            ELOGA("Error : CreateFileA() Failed. path = %s, errcode = 0x%x", desc.DirectoryPath, GetLastError());
-            hDir = nullptr;
+            ELOGA("Error : CreateFileA() Failed. path = %s, errcode = 0x%x", directoryPath, GetLastError());
             return false;
         }
 
-        hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        auto hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
         if (hEvent == nullptr)
         {
             ELOGA("Error : CreateEventA() Failed.");
             CloseHandle(hDir);
-            hDir = nullptr;
+            return false;
+        }
+    #else
+        struct stat st = {};
+        if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+        {
+            ELOGA("Error : Directory Not Found. path = %s", directoryPath);
+            return false;
+        }
+    #endif
+
+        auto pDir = new (std::nothrow) Directory();
+        if (pDir == nullptr)
+        {
+            ELOGA("Error : Out of Memory.");
+        #if defined(_WIN32)
+            CloseHandle(hEvent);
+            CloseHandle(hDir);
+        #endif
             return false;
         }
 
-        pFinish         = pFlags;
-        DirectoryPath   = desc.DirectoryPath;
-        pListener       = desc.pListener;
-        WaitTimeMsec    = desc.WaitTimeMsec;
-        Buffer.resize(desc.BufferSize);
+        pDir->Path      = path;
+        pDir->pListener = pListener;
+    #if defined(_WIN32)
+        pDir->hDir      = hDir;
+        pDir->hEvent    = hEvent;
+        pDir->Buffer.resize(BufferSize);
+    #endif
+
+        {
+            std::lock_guard<std::mutex> locker(Mutex);
+            Requests.push_back(pDir);
+        #if defined(_WIN32)
+            Count++;
+        #endif
+        }
 
+        // 監視の開始は監視スレッドで行う.
+        Wake();
         return true;
     }
 
-    void operator()()
+    //-------------------------------------------------------------------------
+    //      ディレクトリを解放します.
+    //-------------------------------------------------------------------------
+    void Release(Directory* pDir)
     {
-        void* pBuf = Buffer.data();
-        auto bufSize = uint32_t(Buffer.size());
+    #if defined(_WIN32)
+        if (pDir->Reading)
+        {
+            // Overlapped構造体をシステムが使わなくなるまで待機する.
+            DWORD size = 0;
+            CancelIoEx(pDir->hDir, &pDir->Overlapped);
+            GetOverlappedResult(pDir->hDir, &pDir->Overlapped, &size, TRUE);
+            pDir->Reading = false;
+        }
 
-        // フィルタ.
-        uint32_t filter =
-            FILE_NOTIFY_CHANGE_FILE_NAME  |   // ファイル名の変更.
-            FILE_NOTIFY_CHANGE_DIR_NAME   |   // ディレクトリ名の変更.
-            FILE_NOTIFY_CHANGE_ATTRIBUTES |   // 属性の変更.
-            FILE_NOTIFY_CHANGE_SIZE       |   // サイズの変更.
-            FILE_NOTIFY_CHANGE_LAST_WRITE;    // 最終書き込み日時の変更.
+        CloseHandle(pDir->hEvent);
+        CloseHandle(pDir->hDir);
 
-        // 終了フラグが立つまでループ.
-        for (;;)
         {
-            ResetEvent(hEvent);
-
-            OVERLAPPED olp = {};
-            olp.hEvent = hEvent;
-
-            // 変更を監視.
-            if (!ReadDirectoryChangesW(
-                hDir,
-                pBuf,
-                bufSize,
-                TRUE,
-                filter,
-                nullptr,
-                &olp,
-                nullptr))
+            std::lock_guard<std::mutex> locker(Mutex);
+            Count--;
+        }
+    #endif
+
+        delete pDir;
+    }
+
+    //-------------------------------------------------------------------------
+    //      追加要求されたディレクトリの監視を開始します.
+    //-------------------------------------------------------------------------
+    void Accept()
+    {
+        std::vector<Directory*> requests;
+        {
+            std::lock_guard<std::mutex> locker(Mutex);
+            requests.swap(Requests);
+        }
+
+        for (auto pDir : requests)
+        {
+            if (!Begin(pDir))
             {
-                ELOG("Error : ReadDirectoryChangesW() Failed.");
-                break;
+                Release(pDir);
+                continue;
             }
 
-            while (!pFinish->load())
+            Directories.push_back(pDir);
+
+            if (std::find(Listeners.begin(), Listeners.end(), pDir->pListener) == Listeners.end())
+            { Listeners.push_back(pDir->pListener); }
+        }
+    }
+
+#if defined(_WIN32)
+    //-------------------------------------------------------------------------
+    //      変更の監視を開始します.
+    //-------------------------------------------------------------------------
+    bool Begin(Directory* pDir)
+    {
+        ResetEvent(pDir->hEvent);
+
+        pDir->Overlapped        = {};
+        pDir->Overlapped.hEvent = pDir->hEvent;
+
+        if (!ReadDirectoryChangesW(
+            pDir->hDir,
+            pDir->Buffer.data(),
+            DWORD(pDir->Buffer.size()),
+            TRUE,
+            NOTIFY_FILTER,
+            nullptr,
+            &pDir->Overlapped,
+            nullptr))
+        {
+            ELOGA("Error : ReadDirectoryChangesW() Failed. path = %s, errcode = 0x%x", pDir->Path.c_str(), GetLastError());
+            return false;
+        }
+
+        pDir->Reading = true;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //      変更を待機して通知します.
+    //-------------------------------------------------------------------------
+    void Wait()
+    {
+        HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+        DWORD  count = 0;
+
+        handles[count++] = hWake;
+        for (auto pDir : Directories)
+        { handles[count++] = pDir->hEvent; }
+
+        auto ret = WaitForMultipleObjects(count, handles, FALSE, WaitTimeMsec);
+        if (ret == WAIT_TIMEOUT || ret == WAIT_OBJECT_0 || pFinish->load())
+        { return; }
+
+        if (ret == WAIT_FAILED)
+        {
+            ELOGA("Error : WaitForMultipleObjects() Failed. errcode = 0x%x", GetLastError());
+            return;
+        }
+
+        // 複数のディレクトリが同時に完了していることがあるので全て確認する.
+        for (auto itr = Directories.begin(); itr != Directories.end();)
+        {
+            auto pDir = *itr;
+            if (!HasOverlappedIoCompleted(&pDir->Overlapped))
             {
-                auto ret = WaitForSingleObject(hEvent, WaitTimeMsec);
-                if (ret != WAIT_TIMEOUT)
-                {
-                    break;
-                }
+                itr++;
+                continue;
             }
 
-            // 終了フラグが立っていたら終了.
-            if (pFinish->load())
+            // 非同期I/Oの結果を取得.
+            DWORD retSize = 0;
+            auto  result  = GetOverlappedResult(pDir->hDir, &pDir->Overlapped, &retSize, FALSE);
+            pDir->Reading = false;
+
+            if (!result)
             {
-                // 非同期I/Oをキャンセル.
-                CancelIo(hDir);
+                // 監視対象ディレクトリが削除された場合など.
+                ELOGA("Error : GetOverlappedResult() Failed. path = %s, errcode = 0x%x", pDir->Path.c_str(), GetLastError());
+                Release(pDir);
+                itr = Directories.erase(itr);
+                continue;
+            }
 
-                // Overlapped構造体をシステムが使わなくなるまで待機する.
-                WaitForSingleObject(hEvent, INFINITE);
+            // バッファオーバーフローの場合は通知が失われている.
+            if (retSize == 0)
+            { WLOGA("Warning : Notify buffer overflow. Some changes were lost. path = %s", pDir->Path.c_str()); }
+            else
+            { Dispatch(pDir); }
 
-                // おしまい.
-                break;
+            // 次の変更を監視.
+            if (!Begin(pDir))
+            {
+                Release(pDir);
+                itr = Directories.erase(itr);
+                continue;
             }
 
-            // 非同期I/Oの結果を取得.
-            DWORD retSize = 0;
-            if (!GetOverlappedResult(hDir, &olp, &retSize, FALSE))
+            itr++;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      変更を通知します.
+    //-------------------------------------------------------------------------
+    void Dispatch(Directory* pDir)
+    {
+        auto pInfo = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(pDir->Buffer.data());
+
+        for (;;)
+        {
+            // ファイル名取得.
+            auto path = ToStringA(pInfo->FileName, int(pInfo->FileNameLength / sizeof(WCHAR)));
+
+            // 通知.
+            pDir->pListener->OnUpdate(pInfo->Action, pDir->Path.c_str(), path.c_str());
+
+            // 次のエントリがなければ終了.
+            if (pInfo->NextEntryOffset == 0)
+            { break; }
+
+            // 次のエントリまで移動.
+            pInfo = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<uint8_t*>(pInfo) + pInfo->NextEntryOffset);
+        }
+    }
+#else
+    //-------------------------------------------------------------------------
+    //      変更の監視を開始します.
+    //-------------------------------------------------------------------------
+    bool Begin(Directory* pDir)
+    { return AddWatch(pDir, std::string(), false); }
+
+    //-------------------------------------------------------------------------
+    //      ディレクトリとそのサブディレクトリを監視対象に追加します.
+    //      inotify は再帰的な監視ができないので, ディレクトリごとにウォッチを追加する.
+    //-------------------------------------------------------------------------
+    bool AddWatch(Directory* pDir, const std::string& prefix, bool notify)
+    {
+        auto path = pDir->Path + "/" + prefix;
+
+        auto wd = inotify_add_watch(Fd, path.c_str(), WATCH_MASK);
+        if (wd < 0)
+        {
+            ELOGA("Error : inotify_add_watch() Failed. path = %s, errno = %d", path.c_str(), errno);
+            return false;
+        }
+
+        auto& watch  = Watches[wd];
+        watch.pDir   = pDir;
+        watch.Prefix = prefix;
+
+        auto pHandle = opendir(path.c_str());
+        if (pHandle == nullptr)
+        { return true; }
+
+        while (auto pEntry = readdir(pHandle))
+        {
+            if (strcmp(pEntry->d_name, ".") == 0 || strcmp(pEntry->d_name, "..") == 0)
+            { continue; }
+
+            auto relative = prefix + pEntry->d_name;
+
+            // 作成直後のディレクトリは, ウォッチ追加前に作られたファイルを通知する.
+            if (notify)
+            { pDir->pListener->OnUpdate(FILE_UPDATE_ACTION_ADDED, pDir->Path.c_str(), relative.c_str()); }
+
+            // シンボリックリンクは循環する可能性があるので辿らない.
+            struct stat st = {};
+            if (lstat((pDir->Path + "/" + relative).c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+            { AddWatch(pDir, relative + "/", notify); }
+        }
+
+        closedir(pHandle);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //      ディレクトリとそのサブディレクトリを監視対象から外します.
+    //-------------------------------------------------------------------------
+    void RemoveWatch(Directory* pDir, const std::string& prefix)
+    {
+        for (auto itr = Watches.begin(); itr != Watches.end();)
+        {
+            auto& watch = itr->second;
+            if (watch.pDir == pDir && watch.Prefix.compare(0, prefix.size(), prefix) == 0)
             {
-                ELOG("Error : GetOverlappedResult() Failed.");
-                break;
+                inotify_rm_watch(Fd, itr->first);
+                itr = Watches.erase(itr);
+                continue;
             }
 
-            // バッファオーバーフローでない場合.
-            if (retSize != 0)
+            itr++;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //      変更を待機して通知します.
+    //-------------------------------------------------------------------------
+    void Wait()
+    {
+        pollfd fds[2] = {};
+        fds[0].fd     = WakeFd;
+        fds[0].events = POLLIN;
+        fds[1].fd     = Fd;
+        fds[1].events = POLLIN;
+
+        auto ret = poll(fds, 2, int(WaitTimeMsec));
+        if (ret <= 0)
+        { return; }
+
+        if (fds[0].revents & POLLIN)
+        {
+            uint64_t value = 0;
+            auto size = read(WakeFd, &value, sizeof(value));
+            (void)size;
+        }
+
+        if (pFinish->load() || (fds[1].revents & POLLIN) == 0)
+        { return; }
+
+        // 溜まっているイベントを全て読み込む.
+        for (;;)
+        {
+            auto size = read(Fd, Buffer.data(), Buffer.size());
+            if (size <= 0)
+            { break; }
+
+            ssize_t offset = 0;
+            while (offset < size)
             {
-                auto pInfos = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(pBuf);
-                size_t offset = 0;
-
-                for (;;)
-                {
-                    // ファイル名取得.
-                    auto path = ToStringA(pInfos->FileName);
-
-                    // 末尾にカンマが来ることがあるので，それを取り除く.
-                    auto pos = path.find_last_of(',');
-                    if (pos != std::string::npos && pos == path.size() - 1)
-                    { path = path.substr(0, pos); }
-
-                    // 強制的に開いて閉じる.
-                    // これでたま～にファイルがオープンできない問題を解決できる.
-                    {
-                        auto handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
-                        if (handle != INVALID_HANDLE_VALUE)
-                        { CloseHandle(handle); }
-                    }
-
-                    // 通知.
-                    pListener->OnUpdate(pInfos->Action, DirectoryPath.c_str(), path.c_str());
-
-                    // 次のエントリがなければ終了.
-                    if (pInfos->NextEntryOffset == 0)
-                    { break; }
-
-                    // 次のエントリまで移動.
-                    pInfos = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<uint8_t*>(pInfos) + pInfos->NextEntryOffset);
-                }
+                auto pEvent = reinterpret_cast<const inotify_event*>(Buffer.data() + offset);
+                offset += sizeof(inotify_event) + pEvent->len;
+                Dispatch(*pEvent);
             }
         }
+    }
 
-        CloseHandle(hEvent);
-        CloseHandle(hDir);
+    //-------------------------------------------------------------------------
+    //      変更を通知します.
+    //-------------------------------------------------------------------------
+    void Dispatch(const inotify_event& event)
+    {
+        if (event.mask & IN_Q_OVERFLOW)
+        {
+            WLOGA("Warning : inotify queue overflow. Some changes were lost.");
+            return;
+        }
 
-        hEvent      = nullptr;
-        hDir        = nullptr;
-        pFinish     = nullptr;
-        pListener   = nullptr;
-        Buffer.clear();
-        Buffer.shrink_to_fit();
+        auto itr = Watches.find(event.wd);
+        if (itr == Watches.end())
+        { return; }
+
+        // ウォッチが削除された.
+        if (event.mask & IN_IGNORED)
+        {
+            Watches.erase(itr);
+            return;
+        }
+
+        // ディレクトリ自身に対するイベントは通知しない.
+        if (event.len == 0)
+        { return; }
+
+        auto pDir     = itr->second.pDir;
+        auto relative = itr->second.Prefix + event.name;
+
+        // ReadDirectoryChangesW() と同じ値に変換.
+        uint32_t action = FILE_UPDATE_ACTION_MODIFIED;
+        if (event.mask & IN_CREATE)
+        { action = FILE_UPDATE_ACTION_ADDED; }
+        else if (event.mask & IN_DELETE)
+        { action = FILE_UPDATE_ACTION_REMOVED; }
+        else if (event.mask & IN_MOVED_FROM)
+        { action = FILE_UPDATE_ACTION_RENAMED_OLD; }
+        else if (event.mask & IN_MOVED_TO)
+        { action = FILE_UPDATE_ACTION_RENAMED_NEW; }
+
+        pDir->pListener->OnUpdate(action, pDir->Path.c_str(), relative.c_str());
+
+        // サブディレクトリの追加・移動に追従する.
+        if (event.mask & IN_ISDIR)
+        {
+            if (event.mask & IN_MOVED_FROM)
+            { RemoveWatch(pDir, relative + "/"); }
+            else if (event.mask & (IN_CREATE | IN_MOVED_TO))
+            { AddWatch(pDir, relative + "/", true); }
+        }
     }
-};
+#endif
 
-} // namespace
+    //-------------------------------------------------------------------------
+    //      監視スレッドの処理です.
+    //-------------------------------------------------------------------------
+    void Run()
+    {
+        // 終了フラグが立つまでループ.
+        while (!pFinish->load())
+        {
+            Accept();
+            Wait();
 
-namespace asdx {
+            if (pFinish->load())
+            { break; }
+
+            for (auto pListener : Listeners)
+            { pListener->OnIdle(); }
+        }
+    }
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 // FileWatcher class
@@ -233,15 +689,34 @@ bool FileWatcher::Init(const Desc& desc)
     // 終了フラグを下す.
     m_Finish = false;
 
-    // ワーカーを初期化.
-    Worker worker;
-    if (!worker.Prepare(desc, &m_Finish))
-    { return false; }
+    // コンテキストを初期化.
+    m_pContext = new (std::nothrow) Context();
+    if (m_pContext == nullptr)
+    {
+        ELOGA("Error : Out of Memory.");
+        return false;
+    }
+
+    if (!m_pContext->Open(desc, &m_Finish))
+    {
+        Term();
+        return false;
+    }
+
+    // 監視対象ディレクトリを追加.
+    if (desc.DirectoryPath != nullptr && !AddDirectory(desc.DirectoryPath, desc.pListener))
+    {
+        Term();
+        return false;
+    }
 
     // 監視スレッド起動.
-    m_pThread = new std::thread(worker);
+    m_pThread = new (std::nothrow) std::thread(&Context::Run, m_pContext);
     if (m_pThread == nullptr)
-    { return false; }
+    {
+        Term();
+        return false;
+    }
 
     // 正常終了.
     return true;
@@ -252,23 +727,41 @@ bool FileWatcher::Init(const Desc& desc)
 //-----------------------------------------------------------------------------
 void FileWatcher::Term()
 {
-    if (m_pThread == nullptr)
-    { return; }
+    if (m_pThread != nullptr)
+    {
+        // 終了フラグを立てて監視スレッドを起こす.
+        m_Finish = true;
+        m_pContext->Wake();
 
-    // 終了フラグを立てる.
-    m_Finish = true;
+        // joinする
+        if (m_pThread->joinable())
+        { m_pThread->join(); }
 
-    // join可能になるまで待つ.
-    while (!m_pThread->joinable())
-    { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+        // スレッド破棄.
+        delete m_pThread;
+        m_pThread = nullptr;
+    }
 
-    // joinする
-    if (m_pThread->joinable())
-    { m_pThread->join(); }
+    if (m_pContext != nullptr)
+    {
+        m_pContext->Close();
+        delete m_pContext;
+        m_pContext = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      監視対象ディレクトリを追加します.
+//-----------------------------------------------------------------------------
+bool FileWatcher::AddDirectory(const char* directoryPath, IFileUpdateListener* pListener)
+{
+    if (m_pContext == nullptr || directoryPath == nullptr || pListener == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
 
-    // スレッド破棄.
-    delete m_pThread;
-    m_pThread = nullptr;
+    return m_pContext->Add(directoryPath, pListener);
 }
 
 } // namespace asdx
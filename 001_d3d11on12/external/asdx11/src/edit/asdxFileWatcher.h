@@ -8,12 +8,25 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <cstdint>
 #include <atomic>
 #include <thread>
 
 
 namespace asdx {
 
+///////////////////////////////////////////////////////////////////////////////
+// FILE_UPDATE_ACTION enum
+///////////////////////////////////////////////////////////////////////////////
+enum FILE_UPDATE_ACTION
+{
+    FILE_UPDATE_ACTION_ADDED        = 1,    //!< t@Cǉ܂.
+    FILE_UPDATE_ACTION_REMOVED      = 2,    //!< t@C폜܂.
+    FILE_UPDATE_ACTION_MODIFIED     = 3,    //!< t@CύX܂.
+    FILE_UPDATE_ACTION_RENAMED_OLD  = 4,    //!< OύXÕt@Cł.
+    FILE_UPDATE_ACTION_RENAMED_NEW  = 5,    //!< OύX̃t@Cł.
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // IFileUpdateListener interface
 ///////////////////////////////////////////////////////////////////////////////
@@ -27,11 +40,23 @@ struct IFileUpdateListener
 
     //-------------------------------------------------------------------------
     //! @brief      t@CXV̏ł.
+    //!             ĎXbhĂяo܂.
+    //!
+    //! @param[in]      actionType      FILE_UPDATE_ACTION ł.
+    //! @param[in]      directoryPath   ĎΏۃfBNgł.
+    //! @param[in]      relativePath    ĎΏۃfBNg̑΃pXł.
     //-------------------------------------------------------------------------
     virtual void OnUpdate(
         uint32_t    actionType,
         const char* directoryPath,
         const char* relativePath) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ĎXbhҋ@߂邽тɌĂяo܂.
+    //!             ő Desc::WaitTimeMsec ԊuŌĂяo܂.
+    //-------------------------------------------------------------------------
+    virtual void OnIdle()
+    { /* DO_NOTHING */ }
 };
 
 
@@ -51,9 +76,9 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     struct Desc
     {
-        const char*             DirectoryPath;      //!< ĎΏۃfBNg.
-        size_t                  BufferSize;         //!< obt@TCY.
-        uint32_t                WaitTimeMsec;       //!< 1[v̑ҋ@(~bP)
+        const char*             DirectoryPath;      //!< ĎΏۃfBNg(nullptȑꍇ AddDirectory() Œǉ).
+        size_t                  BufferSize;         //!< fBNgƂ̃obt@TCY(0̏ꍇ64KB).
+        uint32_t                WaitTimeMsec;       //!< 1[v̑ҋ@(~bP, 0̏ꍇ100~b)
         IFileUpdateListener*    pListener;          //!< ύXʒm.
     };
 
@@ -78,6 +103,7 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      ł.
+    //!             ĎXbh1, AddDirectory() ŒǉfBNgXbhŊĎ܂.
     //!
     //! @param[in]      desc        ݒł.
     //! @retval true    ɐ.
@@ -90,12 +116,29 @@ public:
     //-------------------------------------------------------------------------
     void Term();
 
+    //-------------------------------------------------------------------------
+    //! @brief      ĎΏۃfBNgǉ܂.
+    //!             TufBNgĎΏۂɂȂ܂.
+    //!
+    //! @param[in]      directoryPath   ĎΏۃfBNgł.
+    //! @param[in]      pListener       ύXʒmł.
+    //! @retval true    ǉɐ.
+    //! @retval false   ǉɎs.
+    //-------------------------------------------------------------------------
+    bool AddDirectory(const char* directoryPath, IFileUpdateListener* pListener);
+
 private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Context structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Context;
+
     //=========================================================================
     // private variables.
     //=========================================================================
-    std::atomic<bool> m_Finish  = {};       //!< ItO.
-    std::thread*      m_pThread = nullptr;  //!< ĎXbh.
+    std::atomic<bool> m_Finish   = {};          //!< ItO.
+    std::thread*      m_pThread  = nullptr;     //!< ĎXbh.
+    Context*          m_pContext = nullptr;     //!< ĎReLXg.
 
     //=========================================================================
     // private methods.
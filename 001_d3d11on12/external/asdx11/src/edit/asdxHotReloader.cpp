@@ -0,0 +1,447 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxHotReloader.cpp
+// Desc : Hot Reload Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cerrno>
+#include <cstdio>
+#include <algorithm>
+#include <sys/stat.h>
+#include <asdxHash.h>
+#include <asdxLogger.h>
+#include <edit/asdxHotReloader.h>
+
+
+namespace /* anonymous */ {
+
+//-------------------------------------------------------------------------------------------------
+// Constant Values
+//-------------------------------------------------------------------------------------------------
+static const uint32_t   DEFAULT_DEBOUNCE_MSEC   = 50;
+static const uint32_t   DEFAULT_QUEUE_CAPACITY  = 64;
+static const size_t     READ_CHUNK_SIZE         = 64 * 1024;
+
+//-------------------------------------------------------------------------------------------------
+//      区切り文字を '/' に揃えたファイルパスを生成します.
+//-------------------------------------------------------------------------------------------------
+std::string MakePath(const char* directoryPath, const char* relativePath)
+{
+    std::string path = directoryPath;
+    if (relativePath != nullptr)
+    {
+        path += '/';
+        path += relativePath;
+    }
+
+    std::replace(path.begin(), path.end(), '\\', '/');
+    return path;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      通常ファイルかどうかチェックします.
+//-------------------------------------------------------------------------------------------------
+bool IsRegularFile(const char* path)
+{
+#if defined(_WIN32)
+    struct _stat64 st = {};
+    return _stat64(path, &st) == 0 && (st.st_mode & _S_IFREG) != 0;
+#else
+    struct stat st = {};
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを読み込みます.
+//
+//      ファイルが存在しない(ディレクトリや削除済みを含む)場合は missing に true を設定します.
+//-------------------------------------------------------------------------------------------------
+bool ReadFile(const char* path, std::vector<uint8_t>& buffer, size_t& size, bool& missing)
+{
+    size    = 0;
+    missing = false;
+
+    if (!IsRegularFile(path))
+    {
+        missing = true;
+        return false;
+    }
+
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    auto err = fopen_s(&pFile, path, "rb");
+#else
+    pFile = fopen(path, "rb");
+    auto err = (pFile == nullptr) ? errno : 0;
+#endif
+    if (pFile == nullptr)
+    {
+        // 書き込み中で共有違反になった場合などは missing = false のまま.
+        missing = (err == ENOENT);
+        return false;
+    }
+
+    // 書き込み途中でサイズが変わることがあるので, 終端まで分割して読み込む.
+    for (;;)
+    {
+        if (buffer.size() < size + READ_CHUNK_SIZE)
+        {
+            auto capacity = buffer.size() * 2;
+            buffer.resize((capacity > size + READ_CHUNK_SIZE) ? capacity : size + READ_CHUNK_SIZE);
+        }
+
+        auto count = fread(buffer.data() + size, 1, buffer.size() - size, pFile);
+        size += count;
+
+        if (count == 0)
+        { break; }
+    }
+
+    auto error = ferror(pFile) != 0;
+    fclose(pFile);
+
+    return !error;
+}
+
+} // namespace /* anonymous */
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HotReloader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-------------------------------------------------------------------------------------------------
+//      コンストラクタです.
+//-------------------------------------------------------------------------------------------------
+HotReloader::HotReloader()
+: m_pHandler        (nullptr)
+, m_Debounce        (DEFAULT_DEBOUNCE_MSEC)
+, m_RetryCount      (0)
+, m_QueueHead       (0)
+, m_QueueCount      (0)
+, m_Stop            (false)
+, m_Stats           ()
+{ /* DO_NOTHING */ }
+
+//-------------------------------------------------------------------------------------------------
+//      デストラクタです.
+//-------------------------------------------------------------------------------------------------
+HotReloader::~HotReloader()
+{ Term(); }
+
+//-------------------------------------------------------------------------------------------------
+//      初期化処理を行います.
+//-------------------------------------------------------------------------------------------------
+bool HotReloader::Init(const Desc& desc)
+{
+    Term();
+
+    if (desc.pHandler == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto debounce    = (desc.DebounceMsec  > 0) ? desc.DebounceMsec  : DEFAULT_DEBOUNCE_MSEC;
+    auto tick        = (desc.TickMsec      > 0) ? desc.TickMsec      : (debounce + 3) / 4;
+    auto workerCount = (desc.WorkerCount   > 0) ? desc.WorkerCount   : 1u;
+    auto capacity    = (desc.QueueCapacity > 0) ? desc.QueueCapacity : DEFAULT_QUEUE_CAPACITY;
+
+    m_pHandler   = desc.pHandler;
+    m_Debounce   = std::chrono::milliseconds(debounce);
+    m_RetryCount = desc.RetryCount;
+    m_QueueHead  = 0;
+    m_QueueCount = 0;
+    m_Stop       = false;
+    m_Stats      = {};
+    m_Queue.resize(capacity);
+
+    // 再読み込みが監視スレッドを止めないようにワーカースレッドで行う.
+    for (auto i=0u; i<workerCount; ++i)
+    { m_Workers.emplace_back(&HotReloader::Run, this); }
+
+    // 通知の集約は監視スレッドの OnIdle() で行うので, 起床間隔が集約の時間分解能になる.
+    FileWatcher::Desc watcherDesc = {};
+    watcherDesc.DirectoryPath = nullptr;
+    watcherDesc.WaitTimeMsec  = tick;
+    watcherDesc.pListener     = this;
+
+    if (!m_Watcher.Init(watcherDesc))
+    {
+        Term();
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      終了処理を行います.
+//-------------------------------------------------------------------------------------------------
+void HotReloader::Term()
+{
+    // 先に監視を止めて, 新しい通知が来ないようにする.
+    m_Watcher.Term();
+
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        m_Stop = true;
+    }
+    m_Cond.notify_all();
+
+    for (auto& worker : m_Workers)
+    {
+        if (worker.joinable())
+        { worker.join(); }
+    }
+    m_Workers.clear();
+
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    m_Entries.clear();
+    m_Hashes .clear();
+    m_Queue  .clear();
+    m_QueueHead  = 0;
+    m_QueueCount = 0;
+    m_pHandler   = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      監視対象ディレクトリを追加します.
+//-------------------------------------------------------------------------------------------------
+bool HotReloader::AddDirectory(const char* directoryPath)
+{ return m_Watcher.AddDirectory(directoryPath, this); }
+
+//-------------------------------------------------------------------------------------------------
+//      現在のファイル内容のハッシュを登録します.
+//-------------------------------------------------------------------------------------------------
+bool HotReloader::Track(const char* path)
+{
+    if (path == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto key = MakePath(path, nullptr);
+
+    std::vector<uint8_t> buffer;
+    size_t size    = 0;
+    bool   missing = false;
+    if (!ReadFile(key.c_str(), buffer, size, missing))
+    {
+        ELOGA("Error : File Read Failed. path = %s", path);
+        return false;
+    }
+
+    auto hash = CalcHash64(buffer.data(), size);
+
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    m_Hashes[key] = hash;
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      統計情報を取得します.
+//-------------------------------------------------------------------------------------------------
+HotReloader::Stats HotReloader::GetStats() const
+{
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    return m_Stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイル更新時の処理です.
+//-------------------------------------------------------------------------------------------------
+void HotReloader::OnUpdate(uint32_t actionType, const char* directoryPath, const char* relativePath)
+{
+    auto path = MakePath(directoryPath, relativePath);
+    auto now  = Clock::now();
+
+    std::lock_guard<std::mutex> locker(m_Mutex);
+    m_Stats.EventCount++;
+
+    auto itr = m_Entries.find(path);
+
+    // 削除されたファイルは再読み込みしない.
+    // ハッシュは読み込み済みの内容を表しているので, 同じ内容で作り直された場合に備えて残しておく.
+    if (actionType == FILE_UPDATE_ACTION_REMOVED || actionType == FILE_UPDATE_ACTION_RENAMED_OLD)
+    {
+        if (itr != m_Entries.end() && itr->second.State == STATE_WAIT)
+        {
+            m_Entries.erase(itr);
+            m_Stats.CoalescedCount++;
+        }
+        return;
+    }
+
+    if (itr == m_Entries.end())
+    {
+        Entry entry = {};
+        entry.State     = STATE_WAIT;
+        entry.Dirty     = false;
+        entry.Retry     = 0;
+        entry.LastEvent = now;
+        entry.Deadline  = now + m_Debounce;
+        m_Entries.emplace(path, entry);
+        return;
+    }
+
+    // 変更が続いている間は待ち時間を延長して1回にまとめる.
+    auto& entry = itr->second;
+    entry.LastEvent = now;
+    entry.Deadline  = now + m_Debounce;
+    m_Stats.CoalescedCount++;
+
+    // キューに積んだ後の変更は, 書き込み途中の内容を読んでいる可能性があるので読み直す.
+    if (entry.State != STATE_WAIT)
+    { entry.Dirty = true; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      監視スレッドの待機明けの処理です.
+//-------------------------------------------------------------------------------------------------
+void HotReloader::OnIdle()
+{
+    auto now    = Clock::now();
+    auto pushed = false;
+
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+
+        for (auto& itr : m_Entries)
+        {
+            auto& entry = itr.second;
+            if (entry.State != STATE_WAIT || entry.Deadline > now)
+            { continue; }
+
+            // キューが一杯の場合は待たずに次回に回す.
+            if (m_QueueCount == m_Queue.size())
+            {
+                m_Stats.QueueFullCount++;
+                break;
+            }
+
+            m_Queue[(m_QueueHead + m_QueueCount) % m_Queue.size()] = itr.first;
+            m_QueueCount++;
+
+            entry.State = STATE_QUEUED;
+            pushed = true;
+        }
+    }
+
+    if (pushed)
+    { m_Cond.notify_all(); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ワーカースレッドの処理です.
+//-------------------------------------------------------------------------------------------------
+void HotReloader::Run()
+{
+    std::vector<uint8_t> buffer;
+
+    for (;;)
+    {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> locker(m_Mutex);
+            m_Cond.wait(locker, [this] { return m_Stop || m_QueueCount > 0; });
+
+            if (m_Stop)
+            { return; }
+
+            path.swap(m_Queue[m_QueueHead]);
+            m_QueueHead = (m_QueueHead + 1) % m_Queue.size();
+            m_QueueCount--;
+
+            auto itr = m_Entries.find(path);
+            if (itr == m_Entries.end())
+            { continue; }
+
+            itr->second.State = STATE_RUNNING;
+        }
+
+        Reload(path, buffer);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ファイルを再読み込みします.
+//-------------------------------------------------------------------------------------------------
+void HotReloader::Reload(const std::string& path, std::vector<uint8_t>& buffer)
+{
+    size_t size    = 0;
+    bool   missing = false;
+    auto   loaded  = ReadFile(path.c_str(), buffer, size, missing);
+    auto   hash    = loaded ? CalcHash64(buffer.data(), size) : 0;
+
+    // 内容が変化していなければ再読み込みしない.
+    auto changed = false;
+    if (loaded)
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        auto itr = m_Hashes.find(path);
+        changed = (itr == m_Hashes.end()) || (itr->second != hash);
+    }
+
+    auto succeeded = false;
+    if (changed)
+    { succeeded = m_pHandler->OnReload(path.c_str(), buffer.data(), size); }
+
+    std::lock_guard<std::mutex> locker(m_Mutex);
+
+    auto itr = m_Entries.find(path);
+    if (itr == m_Entries.end())
+    { return; }
+
+    auto& entry = itr->second;
+    auto  now   = Clock::now();
+
+    // 書き込み中などで開けなかった場合は時間をおいて再試行する.
+    if (!loaded && !missing && entry.Retry < m_RetryCount && !m_Stop)
+    {
+        entry.Retry++;
+        entry.State    = STATE_WAIT;
+        entry.Deadline = now + m_Debounce;
+        return;
+    }
+
+    if (loaded && !changed)
+    {
+        m_Stats.SkippedCount++;
+    }
+    else if (changed && succeeded)
+    {
+        m_Hashes[path] = hash;
+
+        auto latency = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(now - entry.LastEvent).count());
+        m_Stats.ReloadCount++;
+        m_Stats.TotalLatencyUsec += latency;
+        if (latency > m_Stats.MaxLatencyUsec)
+        { m_Stats.MaxLatencyUsec = latency; }
+    }
+    else if (!missing)
+    {
+        ELOGA("Error : Hot Reload Failed. path = %s", path.c_str());
+        m_Stats.FailedCount++;
+    }
+
+    // 再読み込み中に変更された場合は, 変更が落ち着いてからもう一度読み込む.
+    if (entry.Dirty)
+    {
+        entry.Dirty = false;
+        entry.Retry = 0;
+        entry.State = STATE_WAIT;
+        return;
+    }
+
+    m_Entries.erase(itr);
+}
+
+} // namespace asdx
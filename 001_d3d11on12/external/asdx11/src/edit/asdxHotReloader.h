@@ -0,0 +1,210 @@
+﻿//-------------------------------------------------------------------------------------------------
+// File : asdxHotReloader.h
+// Desc : Hot Reload Module.
+// Copyright(c) Project Asura. All right reserved.
+//-------------------------------------------------------------------------------------------------
+#pragma once
+
+//-------------------------------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <edit/asdxFileWatcher.h>
+
+
+namespace asdx {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// IHotReloadHandler interface
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct IHotReloadHandler
+{
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    virtual ~IHotReloadHandler()
+    { /* DO_NOTHING */ }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      内容が変化したファイルを再読み込みします.
+    //!             ワーカースレッドから呼び出されます. 同じファイルに対して同時に呼び出されることはありません.
+    //!
+    //! @param[in]      path        ファイルパス(監視対象ディレクトリ + '/' + 相対パス, 区切り文字は '/').
+    //! @param[in]      pData       ファイルデータ.
+    //! @param[in]      size        ファイルサイズ.
+    //! @retval true    再読み込みに成功.
+    //! @retval false   再読み込みに失敗. ハッシュは更新されないので, 同じ内容でも次の変更で再度呼び出されます.
+    //---------------------------------------------------------------------------------------------
+    virtual bool OnReload(const char* path, const uint8_t* pData, size_t size) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HotReloader class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class HotReloader : public IFileUpdateListener
+{
+    //=============================================================================================
+    // list of friend classes and methods.
+    //=============================================================================================
+    /* NOTHING */
+
+public:
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Desc structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Desc
+    {
+        uint32_t            DebounceMsec;       //!< 最後の変更から再読み込みまでの待ち時間(ミリ秒, 0の場合は50ミリ秒).
+        uint32_t            TickMsec;           //!< 監視スレッドの起床間隔(ミリ秒, 0の場合は DebounceMsec / 4).
+        uint32_t            WorkerCount;        //!< ワーカースレッド数(0の場合は1).
+        uint32_t            QueueCapacity;      //!< 再読み込み待ちキューの容量(0の場合は64).
+        uint32_t            RetryCount;         //!< ファイルを開けなかった場合の再試行回数.
+        IHotReloadHandler*  pHandler;           //!< 再読み込み処理.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Stats structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Stats
+    {
+        uint64_t    EventCount;         //!< 受け取った変更通知の数.
+        uint64_t    CoalescedCount;     //!< 他の通知とまとめた変更通知の数.
+        uint64_t    ReloadCount;        //!< 再読み込みを行った数.
+        uint64_t    SkippedCount;       //!< 内容が変化していなかったため再読み込みを省略した数.
+        uint64_t    FailedCount;        //!< 再読み込みに失敗した数.
+        uint64_t    QueueFullCount;     //!< キューが一杯で投入を見送った回数.
+        uint64_t    MaxLatencyUsec;     //!< 最後の変更通知から再読み込み完了までの最大時間(マイクロ秒).
+        uint64_t    TotalLatencyUsec;   //!< 最後の変更通知から再読み込み完了までの合計時間(マイクロ秒).
+    };
+
+    //=============================================================================================
+    // public variables.
+    //=============================================================================================
+    /* NOTHING */
+
+    //=============================================================================================
+    // public methods.
+    //=============================================================================================
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //---------------------------------------------------------------------------------------------
+    HotReloader();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //---------------------------------------------------------------------------------------------
+    ~HotReloader();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      desc        構成設定.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool Init(const Desc& desc);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      終了処理を行います. 再読み込み待ちのファイルは破棄されます.
+    //---------------------------------------------------------------------------------------------
+    void Term();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      監視対象ディレクトリを追加します.
+    //!
+    //! @param[in]      directoryPath   監視対象ディレクトリです.
+    //! @retval true    追加に成功.
+    //! @retval false   追加に失敗.
+    //---------------------------------------------------------------------------------------------
+    bool AddDirectory(const char* directoryPath);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のファイル内容のハッシュを登録します.
+    //!             初回読み込み後に呼び出しておくと, 内容の変わらない保存で再読み込みされなくなります.
+    //!
+    //! @param[in]      path        ファイルパス(IHotReloadHandler::OnReload() に渡されるものと同じ形式).
+    //! @retval true    登録に成功.
+    //! @retval false   ファイルが読み込めなかった.
+    //---------------------------------------------------------------------------------------------
+    bool Track(const char* path);
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計情報を取得します.
+    //---------------------------------------------------------------------------------------------
+    Stats GetStats() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      ファイル更新時の処理です.
+    //---------------------------------------------------------------------------------------------
+    void OnUpdate(uint32_t actionType, const char* directoryPath, const char* relativePath) override;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      監視スレッドの待機明けの処理です.
+    //---------------------------------------------------------------------------------------------
+    void OnIdle() override;
+
+private:
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // STATE enum
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    enum STATE
+    {
+        STATE_WAIT = 0,     //!< 変更が落ち着くのを待っています.
+        STATE_QUEUED,       //!< キューに積まれています.
+        STATE_RUNNING,      //!< 再読み込み中です.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        STATE       State;          //!< 状態です.
+        bool        Dirty;          //!< 再読み込み中に変更された場合は true.
+        uint32_t    Retry;          //!< 再試行した回数です.
+        TimePoint   LastEvent;      //!< 最後に変更通知を受け取った時刻です.
+        TimePoint   Deadline;       //!< キューに積む時刻です.
+    };
+
+    //=============================================================================================
+    // private variables.
+    //=============================================================================================
+    FileWatcher                                 m_Watcher;          //!< ファイル監視です.
+    IHotReloadHandler*                          m_pHandler;         //!< 再読み込み処理です.
+    std::chrono::milliseconds                   m_Debounce;         //!< 待ち時間です.
+    uint32_t                                    m_RetryCount;       //!< 再試行回数です.
+
+    mutable std::mutex                          m_Mutex;            //!< ミューテックスです.
+    std::condition_variable                     m_Cond;             //!< ワーカーを起こします.
+    std::unordered_map<std::string, Entry>      m_Entries;          //!< 変更のあったファイルです.
+    std::unordered_map<std::string, uint64_t>   m_Hashes;           //!< ファイル内容のハッシュです.
+    std::vector<std::string>                    m_Queue;            //!< 再読み込み待ちキュー(リングバッファ)です.
+    size_t                                      m_QueueHead;        //!< キューの先頭です.
+    size_t                                      m_QueueCount;       //!< キューに積まれている数です.
+    std::vector<std::thread>                    m_Workers;          //!< ワーカースレッドです.
+    bool                                        m_Stop;             //!< 終了要求フラグです.
+    Stats                                       m_Stats;            //!< 統計情報です.
+
+    //=============================================================================================
+    // private methods.
+    //=============================================================================================
+    void Run();
+    void Reload(const std::string& path, std::vector<uint8_t>& buffer);
+
+    HotReloader             (const HotReloader&) = delete;
+    HotReloader& operator = (const HotReloader&) = delete;
+};
+
+} // namespace asdx
@@ -0,0 +1,679 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestAsyncLoader.cpp
+// Desc : ThreadPool / AsyncLoader Tests and Scaling Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <asdxAsyncLoader.h>
+#include <asdxResModelBinary.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// FILE_TYPE enum
+///////////////////////////////////////////////////////////////////////////////
+enum FILE_TYPE
+{
+    FILE_TYPE_TGA = 0,      //!< 24bit Targa.
+    FILE_TYPE_HDR,          //!< Radiance HDR (非圧縮).
+    FILE_TYPE_DDS,          //!< R8G8B8A8 DDS.
+    FILE_TYPE_MODEL,        //!< ResModelBinary (width x height 頂点のグリッド).
+};
+
+//-----------------------------------------------------------------------------
+//      24bit の Targa ファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteTga(const char* path, uint32_t width, uint32_t height, uint32_t seed)
+{
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    fopen_s(&pFile, path, "wb");
+#else
+    pFile = fopen(path, "wb");
+#endif
+    if (pFile == nullptr)
+    { return false; }
+
+    const uint8_t header[18] = {
+        0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        uint8_t(width & 0xff), uint8_t(width >> 8),
+        uint8_t(height & 0xff), uint8_t(height >> 8),
+        24, 0
+    };
+    fwrite(header, sizeof(header), 1, pFile);
+
+    std::vector<uint8_t> line(width * 3);
+    for(auto y=0u; y<height; ++y)
+    {
+        for(auto x=0u; x<width * 3; ++x)
+        { line[x] = uint8_t(x * 7 + y * 13 + seed); }
+        fwrite(line.data(), line.size(), 1, pFile);
+    }
+
+    const uint8_t footer[26] = {
+        0, 0, 0, 0, 0, 0, 0, 0,
+        'T','R','U','E','V','I','S','I','O','N','-','X','F','I','L','E','.', 0
+    };
+    fwrite(footer, sizeof(footer), 1, pFile);
+    fclose(pFile);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      非圧縮の Radiance HDR ファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteHdr(const char* path, uint32_t width, uint32_t height, uint32_t seed)
+{
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    fopen_s(&pFile, path, "wb");
+#else
+    pFile = fopen(path, "wb");
+#endif
+    if (pFile == nullptr)
+    { return false; }
+
+    auto header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string(height) + " +X " + std::to_string(width) + "\n";
+    fwrite(header.data(), header.size(), 1, pFile);
+
+    // 先頭が (2, 2) だと新形式 RLE と誤認されるので, 仮数は 128 以上にする.
+    std::vector<uint8_t> line(width * 4);
+    for(auto y=0u; y<height; ++y)
+    {
+        for(auto x=0u; x<width; ++x)
+        {
+            line[x * 4 + 0] = uint8_t(128 | (x * 7 + seed));
+            line[x * 4 + 1] = uint8_t(128 | (y * 13 + seed));
+            line[x * 4 + 2] = uint8_t(128 | (x + y));
+            line[x * 4 + 3] = uint8_t(120 + (x + y + seed) % 16);
+        }
+        fwrite(line.data(), line.size(), 1, pFile);
+    }
+
+    fclose(pFile);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      R8G8B8A8 の DDS ファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteDds(const char* path, uint32_t width, uint32_t height, uint32_t seed)
+{
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    fopen_s(&pFile, path, "wb");
+#else
+    pFile = fopen(path, "wb");
+#endif
+    if (pFile == nullptr)
+    { return false; }
+
+    // DDS_HEADER (124 bytes) をそのまま並べる.
+    uint32_t header[32] = {};
+    header[ 0] = 0x20534444;                // "DDS "
+    header[ 1] = 124;                       // dwSize
+    header[ 2] = 0x1 | 0x2 | 0x4 | 0x8 | 0x1000 | 0x20000; // CAPS | HEIGHT | WIDTH | PITCH | PIXELFORMAT | MIPMAPCOUNT
+    header[ 3] = height;
+    header[ 4] = width;
+    header[ 5] = width * 4;                 // dwPitchOrLinearSize
+    header[ 7] = 1;                         // dwMipMapCount
+    header[19] = 32;                        // ddspf.dwSize
+    header[20] = 0x1 | 0x40;                // DDPF_ALPHAPIXELS | DDPF_RGB
+    header[22] = 32;                        // ddspf.dwRGBBitCount
+    header[23] = 0x000000ff;                // ddspf.dwRBitMask
+    header[24] = 0x0000ff00;                // ddspf.dwGBitMask
+    header[25] = 0x00ff0000;                // ddspf.dwBBitMask
+    header[26] = 0xff000000;                // ddspf.dwABitMask
+    header[27] = 0x1000;                    // dwCaps = DDSCAPS_TEXTURE
+    fwrite(header, sizeof(header), 1, pFile);
+
+    std::vector<uint8_t> line(width * 4);
+    for(auto y=0u; y<height; ++y)
+    {
+        for(auto x=0u; x<width * 4; ++x)
+        { line[x] = uint8_t(x * 5 + y * 3 + seed); }
+        fwrite(line.data(), line.size(), 1, pFile);
+    }
+
+    fclose(pFile);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      グリッドメッシュを生成します.
+//-----------------------------------------------------------------------------
+void CreateGridMesh(uint32_t width, uint32_t height, uint32_t seed, asdx::ResMesh& mesh)
+{
+    mesh.MeshName     = "grid" + std::to_string(seed);
+    mesh.MaterialName = "material";
+
+    for(auto y=0u; y<height; ++y)
+    {
+        for(auto x=0u; x<width; ++x)
+        {
+            mesh.Positions.push_back(asdx::Vector3(float(x), float((x * 7 + y * 3 + seed) % 5), float(y)));
+            mesh.Normals  .push_back(asdx::Vector3(0.0f, 1.0f, 0.0f));
+            mesh.TexCoords[0].push_back(asdx::Vector2(float(x) / float(width), float(y) / float(height)));
+        }
+    }
+
+    for(auto y=0u; y + 1<height; ++y)
+    {
+        for(auto x=0u; x + 1<width; ++x)
+        {
+            auto i = y * width + x;
+            mesh.Indices.insert(mesh.Indices.end(), { i, i + width, i + 1, i + 1, i + width, i + width + 1 });
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      グリッドメッシュを2つ持つモデルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteModel(const char* path, uint32_t width, uint32_t height, uint32_t seed)
+{
+    asdx::ResModel model;
+    model.Meshes.resize(2);
+    CreateGridMesh(width, height, seed, model.Meshes[0]);
+    CreateGridMesh(height, width, seed + 1, model.Meshes[1]);
+
+    return asdx::SaveResModelBinaryA(path, model, asdx::RES_MODEL_BINARY_FLAG_NONE);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// TempFiles class
+///////////////////////////////////////////////////////////////////////////////
+class TempFiles
+{
+public:
+    TempFiles(const char* prefix, uint32_t count, uint32_t width, uint32_t height, FILE_TYPE type = FILE_TYPE_TGA)
+    {
+        static const char* s_Ext[] = { ".tga", ".hdr", ".dds", ".amdl" };
+
+        for(auto i=0u; i<count; ++i)
+        {
+            auto path = std::string(prefix) + std::to_string(i) + s_Ext[type];
+
+            auto ret = false;
+            switch(type)
+            {
+            case FILE_TYPE_TGA:     ret = WriteTga  (path.c_str(), width, height, i); break;
+            case FILE_TYPE_HDR:     ret = WriteHdr  (path.c_str(), width, height, i); break;
+            case FILE_TYPE_DDS:     ret = WriteDds  (path.c_str(), width, height, i); break;
+            case FILE_TYPE_MODEL:   ret = WriteModel(path.c_str(), width, height, i); break;
+            }
+
+            if (ret)
+            { m_Paths.push_back(path); }
+        }
+
+        for(auto& path : m_Paths)
+        { m_Pointers.push_back(path.c_str()); }
+    }
+
+    ~TempFiles()
+    {
+        for(auto& path : m_Paths)
+        { remove(path.c_str()); }
+    }
+
+    uint32_t GetCount() const
+    { return uint32_t(m_Pointers.size()); }
+
+    const char* const* GetPaths() const
+    { return m_Pointers.data(); }
+
+private:
+    std::vector<std::string>    m_Paths;
+    std::vector<const char*>    m_Pointers;
+};
+
+//-----------------------------------------------------------------------------
+//      条件が満たされるまで最大 timeoutMsec だけ待ちます.
+//-----------------------------------------------------------------------------
+template<typename Func>
+bool WaitFor(Func func, uint32_t timeoutMsec)
+{
+    asdx::test::Timer timer;
+    while(!func())
+    {
+        if (timer.GetElapsedMsec() > timeoutMsec)
+        { return false; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      ParallelFor() が全範囲を一度ずつ処理することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(ThreadPool_ParallelFor)
+{
+    asdx::ThreadPool pool;
+    ASDX_CHECK(pool.Init(4));
+
+    for(auto count : { 1u, 7u, 1000u, 100000u })
+    {
+        std::vector<std::atomic<uint32_t>> hits(count);
+        for(auto& h : hits)
+        { h = 0; }
+
+        pool.ParallelFor(count, 64, [&](uint32_t begin, uint32_t end)
+        {
+            for(auto i=begin; i<end; ++i)
+            { hits[i]++; }
+        });
+
+        auto ok = true;
+        for(auto& h : hits)
+        { ok &= (h == 1); }
+        ASDX_CHECK(ok);
+    }
+
+    // ジョブ内から入れ子で呼び出しても完了する.
+    std::atomic<uint32_t> total(0);
+    for(auto i=0; i<16; ++i)
+    {
+        pool.Push([&]()
+        {
+            pool.ParallelFor(256, 16, [&](uint32_t begin, uint32_t end)
+            { total += end - begin; });
+        });
+    }
+    pool.WaitIdle();
+    ASDX_CHECK(total == 16 * 256);
+}
+
+//-----------------------------------------------------------------------------
+//      読み込み結果の状態とコールバックの回数を確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLoader_States)
+{
+    TempFiles files("asdx_test_states_", 32, 64, 64);
+    ASDX_CHECK(files.GetCount() == 32);
+
+    for(auto split : { false, true })
+    {
+        asdx::AsyncLoader loader;
+        asdx::AsyncLoader::Desc desc = { 4, split };
+        ASDX_CHECK(loader.Init(desc));
+
+        std::atomic<uint32_t> callbacks(0);
+        auto callback = [&](asdx::AsyncRequest*) { callbacks++; };
+
+        std::vector<asdx::RefPtr<asdx::AsyncTexture>> textures;
+        loader.LoadTexturesA(files.GetPaths(), files.GetCount(), textures, asdx::JOB_PRIORITY_NORMAL, callback);
+        auto missing = loader.LoadTextureA("asdx_test_missing.tga", asdx::JOB_PRIORITY_NORMAL, callback);
+
+        uint32_t canceled = 0;
+        for(auto i=files.GetCount(); i>files.GetCount() / 2; --i)
+        {
+            if (textures[i - 1]->Cancel())
+            { canceled++; }
+        }
+
+        textures[0]->Wait();
+        ASDX_CHECK(textures[0]->IsDone());
+
+        loader.WaitAll();
+
+        uint32_t completed = 0;
+        uint32_t others    = 0;
+        for(auto& texture : textures)
+        {
+            ASDX_CHECK(texture->IsDone());
+            auto state = texture->GetState();
+            if (state == asdx::ASYNC_LOAD_STATE_COMPLETED)
+            {
+                completed++;
+                ASDX_CHECK(texture->GetResource().Width == 64);
+            }
+            else if (state != asdx::ASYNC_LOAD_STATE_CANCELED)
+            { others++; }
+        }
+
+        ASDX_CHECK(missing->GetState() == asdx::ASYNC_LOAD_STATE_FAILED);
+        ASDX_CHECK(completed + canceled == files.GetCount());
+        ASDX_CHECK(others == 0);
+        ASDX_CHECK(callbacks == files.GetCount() + 1);
+
+        textures.clear();
+        missing = nullptr;
+        loader.Term();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      キャンセルで待機中のスレッドが起床することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLoader_CancelWakesWaiter)
+{
+    TempFiles files("asdx_test_cancel_", 1, 16, 16);
+
+    asdx::AsyncLoader loader;
+    asdx::AsyncLoader::Desc desc = { 1, false };
+    ASDX_CHECK(loader.Init(desc));
+
+    // 唯一のワーカーを塞いで要求を待ち状態に留める.
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    loader.GetThreadPool().Push([&]()
+    {
+        started = true;
+        while(!release)
+        { std::this_thread::yield(); }
+    });
+    ASDX_CHECK(WaitFor([&]() { return started.load(); }, 2000));
+
+    auto request = loader.LoadTextureA(files.GetPaths()[0]);
+
+    std::atomic<bool> woke(false);
+    std::thread waiter([&]()
+    {
+        loader.GetThreadPool().Block([&]() { return request->IsDone(); });
+        woke = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASDX_CHECK(request->Cancel());
+
+    // ジョブが1つも完了していなくても起床する.
+    ASDX_CHECK(WaitFor([&]() { return woke.load(); }, 2000));
+
+    release = true;
+    waiter.join();
+    loader.WaitAll();
+    ASDX_CHECK(request->GetState() == asdx::ASYNC_LOAD_STATE_CANCELED);
+}
+
+//-----------------------------------------------------------------------------
+//      呼び出しスレッドで読み込んだ要求を待つ他のスレッドが起床することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLoader_ConcurrentWaiters)
+{
+    TempFiles files("asdx_test_waiters_", 1, 16, 16);
+
+    asdx::AsyncLoader loader;
+    asdx::AsyncLoader::Desc desc = { 1, false };
+    ASDX_CHECK(loader.Init(desc));
+
+    // 唯一のワーカーを塞いで, 要求のジョブがキューに残ったままにする.
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    loader.GetThreadPool().Push([&]()
+    {
+        started = true;
+        while(!release)
+        { std::this_thread::yield(); }
+    });
+    ASDX_CHECK(WaitFor([&]() { return started.load(); }, 2000));
+
+    // コールバック中に2つ目の待機スレッドが読み込み中の要求を待ち始める.
+    std::atomic<bool> inCallback(false);
+    auto callback = [&](asdx::AsyncRequest*)
+    {
+        inCallback = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    };
+    auto request = loader.LoadTextureA(files.GetPaths()[0], asdx::JOB_PRIORITY_NORMAL, callback);
+
+    std::atomic<bool> done0(false);
+    std::atomic<bool> done1(false);
+    std::thread waiter0([&]() { request->Wait(); done0 = true; });
+    ASDX_CHECK(WaitFor([&]() { return inCallback.load(); }, 2000));
+    std::thread waiter1([&]() { request->Wait(); done1 = true; });
+
+    // キューのジョブが1つも完了していなくても両方起床する.
+    ASDX_CHECK(WaitFor([&]() { return done0 && done1; }, 2000));
+
+    release = true;
+    waiter0.join();
+    waiter1.join();
+    loader.WaitAll();
+    ASDX_CHECK(request->GetState() == asdx::ASYNC_LOAD_STATE_COMPLETED);
+}
+
+//-----------------------------------------------------------------------------
+//      HDR / DDS ファイルを分割デコードの有無に関わらず読み込めることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLoader_Formats)
+{
+    TempFiles hdrFiles("asdx_test_formats_", 8, 96, 40, FILE_TYPE_HDR);
+    TempFiles ddsFiles("asdx_test_formats_", 8, 48, 80, FILE_TYPE_DDS);
+    ASDX_CHECK(hdrFiles.GetCount() == 8);
+    ASDX_CHECK(ddsFiles.GetCount() == 8);
+
+    for(auto split : { false, true })
+    {
+        asdx::AsyncLoader loader;
+        asdx::AsyncLoader::Desc desc = { 4, split };
+        ASDX_CHECK(loader.Init(desc));
+
+        std::vector<asdx::RefPtr<asdx::AsyncTexture>> hdrs;
+        std::vector<asdx::RefPtr<asdx::AsyncTexture>> ddss;
+        loader.LoadTexturesA(hdrFiles.GetPaths(), hdrFiles.GetCount(), hdrs);
+        loader.LoadTexturesA(ddsFiles.GetPaths(), ddsFiles.GetCount(), ddss);
+        loader.WaitAll();
+
+        for(auto& texture : hdrs)
+        {
+            auto& res = texture->GetResource();
+            ASDX_CHECK(texture->GetState() == asdx::ASYNC_LOAD_STATE_COMPLETED);
+            ASDX_CHECK(res.Width == 96 && res.Height == 40);
+        }
+
+        for(auto& texture : ddss)
+        {
+            auto& res = texture->GetResource();
+            ASDX_CHECK(texture->GetState() == asdx::ASYNC_LOAD_STATE_COMPLETED);
+            ASDX_CHECK(res.Width == 48 && res.Height == 80);
+        }
+
+        // 分割デコードしても結果は変わらない.
+        if (split)
+        {
+            asdx::ResTexture expected;
+            ASDX_CHECK(expected.LoadFromFileA(hdrFiles.GetPaths()[3]));
+
+            auto& actual = hdrs[3]->GetResource();
+            ASDX_CHECK(actual.pResources[0].SlicePitch == expected.pResources[0].SlicePitch);
+            ASDX_CHECK(memcmp(actual.pResources[0].pPixels, expected.pResources[0].pPixels, expected.pResources[0].SlicePitch) == 0);
+            expected.Release();
+        }
+
+        hdrs.clear();
+        ddss.clear();
+        loader.Term();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ResModelBinary で保存したモデルを非同期に読み込めることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLoader_Models)
+{
+    TempFiles files("asdx_test_models_", 6, 17, 9, FILE_TYPE_MODEL);
+    ASDX_CHECK(files.GetCount() == 6);
+
+    for(auto split : { false, true })
+    {
+        asdx::AsyncLoader loader;
+        asdx::AsyncLoader::Desc desc = { 2, split };
+        ASDX_CHECK(loader.Init(desc));
+
+        std::atomic<uint32_t> callbacks(0);
+        auto callback = [&](asdx::AsyncRequest*) { callbacks++; };
+
+        std::vector<asdx::RefPtr<asdx::AsyncModel>> models;
+        loader.LoadModelsA(files.GetPaths(), files.GetCount(), models, asdx::JOB_PRIORITY_HIGH, callback);
+        auto missing = loader.LoadModelA("asdx_test_missing.amdl", asdx::JOB_PRIORITY_NORMAL, callback);
+
+        models[0]->Wait();
+        ASDX_CHECK(models[0]->IsDone());
+        loader.WaitAll();
+
+        for(auto i=0u; i<files.GetCount(); ++i)
+        {
+            ASDX_CHECK(models[i]->GetState() == asdx::ASYNC_LOAD_STATE_COMPLETED);
+
+            asdx::ResModel expected;
+            expected.Meshes.resize(2);
+            CreateGridMesh(17, 9, i, expected.Meshes[0]);
+            CreateGridMesh(9, 17, i + 1, expected.Meshes[1]);
+
+            auto& actual = models[i]->GetResource();
+            ASDX_CHECK(actual.Meshes.size() == 2);
+            if (actual.Meshes.size() != 2)
+            { continue; }
+
+            for(auto j=0u; j<2; ++j)
+            {
+                auto& a = actual.Meshes[j];
+                auto& e = expected.Meshes[j];
+                ASDX_CHECK(a.MeshName == e.MeshName);
+                ASDX_CHECK(a.MaterialName == e.MaterialName);
+                ASDX_CHECK(a.Indices == e.Indices);
+                ASDX_CHECK(a.Positions.size() == e.Positions.size());
+                ASDX_CHECK(a.TexCoords[0].size() == e.TexCoords[0].size());
+                ASDX_CHECK(a.Positions.size() == e.Positions.size()
+                    && memcmp(a.Positions.data(), e.Positions.data(), sizeof(asdx::Vector3) * e.Positions.size()) == 0);
+            }
+        }
+
+        ASDX_CHECK(missing->GetState() == asdx::ASYNC_LOAD_STATE_FAILED);
+        ASDX_CHECK(callbacks == files.GetCount() + 1);
+
+        models.clear();
+        missing = nullptr;
+        loader.Term();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ジョブ内からの Wait() が無関係なジョブを実行しないことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLoader_NestedWaitRunsOnlyOwnRequest)
+{
+    TempFiles files("asdx_test_nested_", 1, 16, 16);
+
+    asdx::AsyncLoader loader;
+    asdx::AsyncLoader::Desc desc = { 1, false };
+    ASDX_CHECK(loader.Init(desc));
+
+    auto& pool = loader.GetThreadPool();
+
+    // ワーカーを塞いでいる間にジョブを積む.
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    pool.Push([&]()
+    {
+        started = true;
+        while(!release)
+        { std::this_thread::yield(); }
+    });
+    ASDX_CHECK(WaitFor([&]() { return started.load(); }, 2000));
+
+    auto request = loader.LoadTextureA(files.GetPaths()[0]);
+
+    std::atomic<bool> unrelated(false);
+    pool.Push([&]() { unrelated = true; });
+
+    // 自身のキューは LIFO なので, ワーカーはこのジョブを最初に取り出す.
+    std::atomic<bool> unrelatedDuringWait(true);
+    std::atomic<bool> finished(false);
+    std::atomic<uint32_t> state(asdx::ASYNC_LOAD_STATE_PENDING);
+    pool.Push([&]()
+    {
+        request->Wait();
+        unrelatedDuringWait = unrelated.load();
+        state = request->GetState();
+        finished = true;
+    });
+
+    // 呼び出しスレッドがジョブを奪わないように, 完了までは WaitAll() を呼ばない.
+    release = true;
+    ASDX_CHECK(WaitFor([&]() { return finished.load(); }, 2000));
+    loader.WaitAll();
+
+    ASDX_CHECK(!unrelatedDuringWait);
+    ASDX_CHECK(unrelated);
+    ASDX_CHECK(state == asdx::ASYNC_LOAD_STATE_COMPLETED);
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッド数に対する読み込み時間の変化を計測します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_AsyncLoader_Scaling)
+{
+    auto quick = asdx::test::IsQuick();
+    TempFiles smallFiles("asdx_bench_small_", quick ? 32 : 128, 512, 512);
+    TempFiles largeFiles("asdx_bench_large_", 4, quick ? 1024 : 4096, quick ? 1024 : 4096);
+    TempFiles hdrFiles  ("asdx_bench_hdr_",   quick ? 16 : 64, 512, 512, FILE_TYPE_HDR);
+    TempFiles ddsFiles  ("asdx_bench_dds_",   quick ? 16 : 64, 512, 512, FILE_TYPE_DDS);
+    TempFiles modelFiles("asdx_bench_model_", quick ? 16 : 64, 128, 128, FILE_TYPE_MODEL);
+
+    auto maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+    { maxThreads = 1; }
+
+    struct Item { const char* Name; const TempFiles* pFiles; bool Split; bool Model; };
+    const Item items[] = {
+        { "tga x N",            &smallFiles, false, false },
+        { "hdr x N",            &hdrFiles,   false, false },
+        { "dds x N",            &ddsFiles,   false, false },
+        { "model x N",          &modelFiles, false, true  },
+        { "large x 4",          &largeFiles, false, false },
+        { "large x 4 (split)",  &largeFiles, true,  false },
+    };
+
+    for(auto& item : items)
+    {
+        auto baseMsec = 0.0;
+        for(auto threads = 1u; threads <= maxThreads * 2; threads *= 2)
+        {
+            asdx::AsyncLoader loader;
+            asdx::AsyncLoader::Desc desc = { threads, item.Split };
+            loader.Init(desc);
+
+            std::vector<asdx::RefPtr<asdx::AsyncTexture>> textures;
+            std::vector<asdx::RefPtr<asdx::AsyncModel>>   models;
+
+            asdx::test::Timer timer;
+            if (item.Model)
+            { loader.LoadModelsA(item.pFiles->GetPaths(), item.pFiles->GetCount(), models); }
+            else
+            { loader.LoadTexturesA(item.pFiles->GetPaths(), item.pFiles->GetCount(), textures); }
+            loader.WaitAll();
+            auto msec = timer.GetElapsedMsec();
+
+            for(auto& texture : textures)
+            { ASDX_CHECK(texture->GetState() == asdx::ASYNC_LOAD_STATE_COMPLETED); }
+            for(auto& model : models)
+            { ASDX_CHECK(model->GetState() == asdx::ASYNC_LOAD_STATE_COMPLETED); }
+
+            if (threads == 1)
+            { baseMsec = msec; }
+
+            printf("    %-18s files = %3u, threads = %2u, %8.2f ms, speedup = %.2fx\n",
+                item.Name, item.pFiles->GetCount(), threads, msec, baseMsec / msec);
+
+            textures.clear();
+            models.clear();
+            loader.Term();
+        }
+    }
+}
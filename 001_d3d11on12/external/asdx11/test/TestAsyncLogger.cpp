@@ -0,0 +1,473 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestAsyncLogger.cpp
+// Desc : AsyncLogger Tests and Latency Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <asdxAsyncLogger.h>
+#include <asdxLogger.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      テキストファイルを行単位で読み込みます.
+//-----------------------------------------------------------------------------
+std::vector<std::string> ReadLines(const char* path)
+{
+    std::vector<std::string> result;
+    std::ifstream stream(path);
+    std::string line;
+    while(std::getline(stream, line))
+    { result.push_back(line); }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズを取得します. 存在しない場合は -1 を返します.
+//-----------------------------------------------------------------------------
+long GetFileSize(const std::string& path)
+{
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    fopen_s(&pFile, path.c_str(), "rb");
+#else
+    pFile = fopen(path.c_str(), "rb");
+#endif
+    if (pFile == nullptr)
+    { return -1; }
+
+    fseek(pFile, 0, SEEK_END);
+    auto size = ftell(pFile);
+    fclose(pFile);
+    return size;
+}
+
+//-----------------------------------------------------------------------------
+//      ローテーションされたファイルを古い順に列挙します.
+//-----------------------------------------------------------------------------
+std::vector<std::string> GetRotatedFiles(const std::string& path, uint32_t maxCount)
+{
+    std::vector<std::string> result;
+    for(auto i=maxCount; i>=1; --i)
+    {
+        auto name = path + "." + std::to_string(i);
+        if (GetFileSize(name) >= 0)
+        { result.push_back(name); }
+    }
+    result.push_back(path);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ローテーションされたファイルを削除します.
+//-----------------------------------------------------------------------------
+void RemoveRotatedFiles(const std::string& path, uint32_t maxCount)
+{
+    remove(path.c_str());
+    for(auto i=1u; i<=maxCount + 1; ++i)
+    { remove((path + "." + std::to_string(i)).c_str()); }
+}
+
+//-----------------------------------------------------------------------------
+//      条件が満たされるまで最大 timeoutMsec だけ待ちます.
+//-----------------------------------------------------------------------------
+template<typename Func>
+bool WaitFor(Func func, uint32_t timeoutMsec)
+{
+    asdx::test::Timer timer;
+    while(!func())
+    {
+        if (timer.GetElapsedMsec() > timeoutMsec)
+        { return false; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      テキストファイルに出力する構成設定を取得します.
+//-----------------------------------------------------------------------------
+asdx::AsyncLogger::Desc GetTextDesc(const char* path, asdx::LogOverflow overflow, uint32_t flushInterval)
+{
+    asdx::AsyncLogger::Desc desc = {};
+    desc.BufferSize     = asdx::AsyncLogger::MinBufferSize;
+    desc.Overflow       = overflow;
+    desc.Sinks          = asdx::LOG_SINK_TEXT_FILE;
+    desc.TextFilePath   = path;
+    desc.FlushInterval  = flushInterval;
+    return desc;
+}
+
+//-----------------------------------------------------------------------------
+//      パーセンタイル値を取得します.
+//-----------------------------------------------------------------------------
+uint32_t Percentile(const std::vector<uint32_t>& sorted, double p)
+{ return sorted[size_t(p * double(sorted.size() - 1))]; }
+
+//-----------------------------------------------------------------------------
+//      複数スレッドからのログ呼び出しの遅延を計測します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void MeasureLatency(const char* name, uint32_t threadCount, uint32_t logCount, Func func)
+{
+    std::vector<std::vector<uint32_t>> latency(threadCount, std::vector<uint32_t>(logCount));
+    std::atomic<uint32_t> ready(0);
+
+    asdx::test::Timer timer;
+    std::vector<std::thread> threads;
+    for(auto t=0u; t<threadCount; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            // 全スレッドが揃ってから開始する.
+            ready++;
+            while(ready < threadCount)
+            { std::this_thread::yield(); }
+
+            for(auto i=0u; i<logCount; ++i)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                func(t, i);
+                auto end = std::chrono::steady_clock::now();
+                latency[t][i] = uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            }
+        });
+    }
+
+    for(auto& thread : threads)
+    { thread.join(); }
+    auto msec = timer.GetElapsedMsec();
+
+    std::vector<uint32_t> all;
+    for(auto& values : latency)
+    { all.insert(all.end(), values.begin(), values.end()); }
+    std::sort(all.begin(), all.end());
+
+    fprintf(stderr, "    %-28s p50 = %6u, p90 = %6u, p99 = %7u, p99.9 = %8u, max = %9u ns, total = %8.2f ms\n",
+        name,
+        Percentile(all, 0.5),
+        Percentile(all, 0.9),
+        Percentile(all, 0.99),
+        Percentile(all, 0.999),
+        all.back(),
+        msec);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      テキスト出力とバイナリログの変換結果が一致することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLogger_TextAndBinary)
+{
+    const char* textPath    = "asdx_test_logger.txt";
+    const char* binaryPath  = "asdx_test_logger.bin";
+    const char* decodePath  = "asdx_test_logger_decoded.txt";
+
+    asdx::AsyncLogger::Desc desc = {};
+    desc.Sinks          = asdx::LOG_SINK_TEXT_FILE | asdx::LOG_SINK_BINARY_FILE;
+    desc.TextFilePath   = textPath;
+    desc.BinaryFilePath = binaryPath;
+
+    asdx::AsyncLogger logger;
+    ASDX_CHECK(logger.Init(desc));
+
+    for(auto i=0; i<100; ++i)
+    { logger.LogA(asdx::LogLevel::Info, "value %d %5.2f %s", i, i * 0.5, "text"); }
+    logger.LogW(asdx::LogLevel::Warning, L"wide %ls %d", L"string", 7);
+
+    logger.SetFilter(asdx::LogLevel::Error);
+    logger.LogA(asdx::LogLevel::Info, "filtered");
+    logger.SetFilter(asdx::LogLevel::Verbose);
+
+    logger.Flush();
+    ASDX_CHECK(logger.GetStats().WrittenCount == 101);
+    logger.Term();
+
+    // 終了後のログは無視される.
+    logger.LogA(asdx::LogLevel::Info, "after term");
+
+    ASDX_CHECK(asdx::DecodeBinaryLog(binaryPath, decodePath));
+
+    auto text    = ReadLines(textPath);
+    auto decoded = ReadLines(decodePath);
+    ASDX_CHECK(text.size() == 101);
+    ASDX_CHECK(text == decoded);
+    if (text.size() == 101)
+    {
+        ASDX_CHECK(text[3].find("value 3  1.50 text") != std::string::npos);
+        ASDX_CHECK(text[100].find("wide string 7") != std::string::npos);
+    }
+
+    remove(textPath);
+    remove(binaryPath);
+    remove(decodePath);
+}
+
+//-----------------------------------------------------------------------------
+//      バッファが半分を超えると起床間隔を待たずに書き出されることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLogger_WakeOnHalfFull)
+{
+    const char* path = "asdx_test_logger_wake.txt";
+
+    asdx::AsyncLogger logger;
+    ASDX_CHECK(logger.Init(GetTextDesc(path, asdx::LogOverflow::Drop, 60 * 1000)));
+
+    // 起動直後の待機に入るのを待つ.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::string text(200, 'x');
+    auto count = 0u;
+    while(logger.GetStats().HighWaterMark < asdx::AsyncLogger::MinBufferSize / 2)
+    {
+        logger.LogA(asdx::LogLevel::Info, "%s", text.c_str());
+        count++;
+    }
+
+    ASDX_CHECK(WaitFor([&]() { return logger.GetStats().WrittenCount > 0; }, 2000));
+    ASDX_CHECK(logger.GetStats().DroppedCount == 0);
+
+    logger.Term();
+    ASDX_CHECK(ReadLines(path).size() == count);
+    remove(path);
+}
+
+//-----------------------------------------------------------------------------
+//      待機モードでバッファが一杯になっても起床間隔を待たずに進むことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLogger_BlockWakesWriter)
+{
+    const char* path = "asdx_test_logger_block.txt";
+
+    asdx::AsyncLogger logger;
+    ASDX_CHECK(logger.Init(GetTextDesc(path, asdx::LogOverflow::Block, 5 * 1000)));
+
+    // バッファの数倍のログを書き込む.
+    std::string text(500, 'y');
+    auto count = uint32_t(asdx::AsyncLogger::MinBufferSize * 4 / text.size());
+
+    asdx::test::Timer timer;
+    for(auto i=0u; i<count; ++i)
+    { logger.LogA(asdx::LogLevel::Info, "%u %s", i, text.c_str()); }
+    auto msec = timer.GetElapsedMsec();
+
+    auto stats = logger.GetStats();
+    ASDX_CHECK(stats.BlockedCount > 0);
+    ASDX_CHECK(stats.DroppedCount == 0);
+    ASDX_CHECK(msec < 2000.0);
+
+    logger.Term();
+    ASDX_CHECK(ReadLines(path).size() == count);
+    remove(path);
+}
+
+//-----------------------------------------------------------------------------
+//      ログ出力中のスレッドがあっても安全に終了できることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLogger_TermWithConcurrentProducers)
+{
+    const char* path = "asdx_test_logger_term.txt";
+
+    for(auto overflow : { asdx::LogOverflow::Drop, asdx::LogOverflow::Block })
+    {
+        asdx::AsyncLogger logger;
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> calls(0);
+
+        std::vector<std::thread> threads;
+        for(auto t=0; t<4; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                // Init() / Term() の前後を問わず呼び出し続ける.
+                while(!stop)
+                {
+                    logger.LogA(asdx::LogLevel::Info, "thread %d call %llu", t, (unsigned long long)calls.load());
+                    calls++;
+                }
+            });
+        }
+
+        for(auto i=0; i<10; ++i)
+        {
+            ASDX_CHECK(logger.Init(GetTextDesc(path, overflow, 1)));
+
+            auto begin = calls.load();
+            ASDX_CHECK(WaitFor([&]() { return calls.load() > begin + 100; }, 2000));
+
+            logger.Term();
+        }
+
+        stop = true;
+        for(auto& thread : threads)
+        { thread.join(); }
+    }
+
+    remove(path);
+}
+
+//-----------------------------------------------------------------------------
+//      ローテーションの前後でレコードが分割も欠落もしないことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(AsyncLogger_Rotation)
+{
+    const std::string textPath   = "asdx_test_logger_rotate.txt";
+    const std::string binaryPath = "asdx_test_logger_rotate.bin";
+    const char*       decodePath = "asdx_test_logger_rotate_decoded.txt";
+    const uint32_t    logCount   = 600;
+    const uint64_t    maxSize    = 4096;
+
+    // 全て残す場合と古いファイルを削除する場合.
+    for(auto maxCount : { 64u, 2u })
+    {
+        RemoveRotatedFiles(textPath,   maxCount);
+        RemoveRotatedFiles(binaryPath, maxCount);
+
+        asdx::AsyncLogger::Desc desc = {};
+        desc.Sinks          = asdx::LOG_SINK_TEXT_FILE | asdx::LOG_SINK_BINARY_FILE;
+        desc.TextFilePath   = textPath.c_str();
+        desc.BinaryFilePath = binaryPath.c_str();
+        desc.MaxFileSize    = maxSize;
+        desc.MaxFileCount   = maxCount;
+
+        asdx::AsyncLogger logger;
+        ASDX_CHECK(logger.Init(desc));
+
+        // 長さの異なるレコードで境界の位置をずらす. 行末の "|end" で分割を検出する.
+        // 長いフォーマットはファイルの途中で初出となり, 定義の分だけサイズが増える.
+        auto longFormat = "seq %05u long " + std::string(1000, '-') + "|end";
+        for(auto i=0u; i<logCount; ++i)
+        {
+            std::string text(i % 37, char('a' + i % 26));
+            if (i % 67 == 66)
+            { logger.LogA(asdx::LogLevel::Info, longFormat.c_str(), i); }
+            else if (i % 5 == 0)
+            { logger.LogW(asdx::LogLevel::Info, L"seq %05u wide %*d|end", i, int(text.size()), int(i % 7)); }
+            else
+            { logger.LogA(asdx::LogLevel::Info, "seq %05u %d %s|end", i, int(i % 7), text.c_str()); }
+        }
+        logger.Term();
+
+        auto textFiles   = GetRotatedFiles(textPath,   maxCount);
+        auto binaryFiles = GetRotatedFiles(binaryPath, maxCount);
+        ASDX_CHECK(textFiles.size() > 2);
+        ASDX_CHECK(binaryFiles.size() > 2);
+        ASDX_CHECK(textFiles.size()   <= maxCount + 1);
+        ASDX_CHECK(binaryFiles.size() <= maxCount + 1);
+        ASDX_CHECK(GetFileSize(textPath   + "." + std::to_string(maxCount + 1)) < 0);
+        ASDX_CHECK(GetFileSize(binaryPath + "." + std::to_string(maxCount + 1)) < 0);
+
+        // 古い順に繋げる.
+        std::vector<std::string> text;
+        auto withinSize = true;
+        for(auto& path : textFiles)
+        {
+            withinSize &= (GetFileSize(path) <= long(maxSize));
+            auto lines = ReadLines(path.c_str());
+            text.insert(text.end(), lines.begin(), lines.end());
+        }
+        ASDX_CHECK(withinSize);
+
+        std::vector<std::string> decoded;
+        auto decodeSucceeded = true;
+        withinSize = true;
+        for(auto& path : binaryFiles)
+        {
+            withinSize      &= (GetFileSize(path) <= long(maxSize));
+            decodeSucceeded &= asdx::DecodeBinaryLog(path.c_str(), decodePath);
+            auto lines = ReadLines(decodePath);
+            decoded.insert(decoded.end(), lines.begin(), lines.end());
+        }
+        ASDX_CHECK(withinSize);
+        ASDX_CHECK(decodeSucceeded);
+
+        // 残っているレコードは最新まで連続している.
+        auto complete = !text.empty();
+        auto first    = logCount - uint32_t(text.size());
+        for(size_t i=0; i<text.size(); ++i)
+        {
+            char expected[32];
+            snprintf(expected, sizeof(expected), "seq %05u ", first + uint32_t(i));
+            complete &= (text[i].find(expected) != std::string::npos);
+            complete &= (text[i].size() >= 4 && text[i].compare(text[i].size() - 4, 4, "|end") == 0);
+        }
+        ASDX_CHECK(complete);
+
+        // 古いファイルが削除されるまでは全て残っている.
+        if (textFiles.size() <= maxCount)
+        { ASDX_CHECK(text.size() == logCount); }
+        else
+        { ASDX_CHECK(text.size() < logCount); }
+
+        // バイナリは境界の位置が異なるので, 共通する末尾を比較する.
+        auto common = std::min(text.size(), decoded.size());
+        ASDX_CHECK(common > 0);
+        ASDX_CHECK(std::equal(text.end() - common, text.end(), decoded.end() - common));
+        if (binaryFiles.size() <= maxCount)
+        { ASDX_CHECK(decoded.size() == logCount); }
+
+        RemoveRotatedFiles(textPath,   maxCount);
+        RemoveRotatedFiles(binaryPath, maxCount);
+    }
+
+    remove(decodePath);
+}
+
+//-----------------------------------------------------------------------------
+//      8スレッドからのログ呼び出しの遅延を同期ロガーと比較します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_AsyncLogger_Latency)
+{
+    const char* path = "asdx_bench_logger.txt";
+
+    auto quick       = asdx::test::IsQuick();
+    auto threadCount = 8u;
+    auto syncCount   = quick ? 200u : 2000u;
+    auto asyncCount  = quick ? 5000u : 50000u;
+
+    auto& system = asdx::SystemLogger::GetInstance();
+
+    MeasureLatency("SystemLogger (sync)", threadCount, syncCount, [](uint32_t t, uint32_t i)
+    { ILOGA("thread %u iter %u value %f name %s", t, i, i * 0.5, "bench"); });
+
+    for(auto overflow : { asdx::LogOverflow::Drop, asdx::LogOverflow::Block })
+    {
+        auto desc = GetTextDesc(path, overflow, 0);
+        desc.BufferSize = 8 * 1024 * 1024;
+
+        asdx::AsyncLogger logger;
+        logger.Init(desc);
+        system.SetAsyncLogger(&logger);
+
+        auto name = (overflow == asdx::LogOverflow::Drop) ? "AsyncLogger (Drop, 8MB)" : "AsyncLogger (Block, 8MB)";
+        MeasureLatency(name, threadCount, asyncCount, [](uint32_t t, uint32_t i)
+        { ILOGA("thread %u iter %u value %f name %s", t, i, i * 0.5, "bench"); });
+
+        logger.Flush();
+        auto stats = logger.GetStats();
+        logger.Term();
+
+        fprintf(stderr, "    %-28s written = %llu, dropped = %llu, blocked = %llu, high water mark = %zu\n",
+            "",
+            (unsigned long long)stats.WrittenCount,
+            (unsigned long long)stats.DroppedCount,
+            (unsigned long long)stats.BlockedCount,
+            stats.HighWaterMark);
+    }
+
+    remove(path);
+}
@@ -0,0 +1,307 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestFrameHeap.cpp
+// Desc : FrameHeap Tests and Allocation Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <asdxFrameHeap.h>
+#include <asdxThreadPool.h>
+#include <asdxTest.h>
+
+#if (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || (__cplusplus >= 201703L)
+#define ASDX_TEST_PMR   1
+#include <memory_resource>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      別スレッドで処理を実行して終了を待ちます.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void RunOnThread(Func func)
+{
+    std::thread thread(func);
+    thread.join();
+}
+
+//-----------------------------------------------------------------------------
+//      マーカーでの巻き戻しが有効かどうかを確認します.
+//-----------------------------------------------------------------------------
+bool IsRollbackEnabled(asdx::FrameHeap& heap)
+{
+    auto marker = heap.GetMarker();
+    auto ptr0 = heap.Alloc(32);
+    heap.Rollback(marker);
+    auto ptr1 = heap.Alloc(32);
+    heap.Rollback(marker);
+    return ptr0 != nullptr && ptr0 == ptr1;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      アライメントとフレームの切り替えを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(FrameHeap_AlignAndReset)
+{
+    asdx::FrameHeap::Desc desc = {};
+    desc.SizePerFrame = 64 * 1024;
+    desc.FrameCount   = 2;
+    desc.ArenaSize    = 4 * 1024;
+
+    asdx::FrameHeap heap;
+    ASDX_CHECK(heap.Init(desc));
+
+    for(auto alignment : { 1u, 16u, 64u, 256u, 4096u })
+    {
+        auto ptr = heap.Alloc(24, alignment);
+        ASDX_CHECK(ptr != nullptr);
+        ASDX_CHECK((reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0);
+    }
+    ASDX_CHECK(heap.Alloc(16, 3) == nullptr);
+
+    struct alignas(64) Aligned { float Value[4]; };
+    auto pArray = heap.AllocArray<Aligned>(8);
+    ASDX_CHECK(pArray != nullptr);
+    ASDX_CHECK((reinterpret_cast<uintptr_t>(pArray) & 63) == 0);
+
+    // 共有領域を使い切ると失敗として数える.
+    ASDX_CHECK(heap.Alloc(128 * 1024) == nullptr);
+    ASDX_CHECK(heap.GetStats().FailedCount == 1);
+
+    // フレーム 1 が完了するまで領域 1 は再利用しない.
+    ASDX_CHECK(heap.Reset(0));
+    ASDX_CHECK(heap.Reset(0));
+    ASDX_CHECK(!heap.Reset(0));
+    ASDX_CHECK(heap.Reset(1));
+    ASDX_CHECK(heap.GetFrameIndex() == 3);
+    ASDX_CHECK(heap.GetStats().UsedBytes == 0);
+    ASDX_CHECK(heap.GetStats().HighWaterMark > 0);
+}
+
+//-----------------------------------------------------------------------------
+//      スコープ付きマーカーで一時確保が巻き戻されることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(FrameHeap_ScopedMarker)
+{
+    asdx::FrameHeap heap;
+    ASDX_CHECK(heap.Init(1024 * 1024));
+
+    auto pKeep = heap.Alloc<uint32_t>(1u);
+    ASDX_CHECK(pKeep != nullptr);
+
+    void* pFirst = nullptr;
+    for(auto i=0; i<4; ++i)
+    {
+        asdx::FrameHeap::ScopedMarker scope(heap);
+
+        auto ptr = heap.AllocArray<uint8_t>(1024);
+        for(auto j=0; j<32; ++j)
+        { ASDX_CHECK(heap.AllocArray<uint8_t>(1024) != nullptr); }
+
+        if (i == 0)
+        { pFirst = ptr; }
+        ASDX_CHECK(ptr == pFirst);
+    }
+
+    ASDX_CHECK(*pKeep == 1);
+}
+
+//-----------------------------------------------------------------------------
+//      終了したスレッドのスロットが再利用されることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(FrameHeap_SlotsRecycledAfterThreadExit)
+{
+    asdx::FrameHeap heap;
+    ASDX_CHECK(heap.Init(16 * 1024 * 1024));
+
+    // MaxThreadCount を超える数のスレッドを順番に生成しても，全てアリーナを持てる.
+    auto enabled = 0u;
+    auto count   = asdx::FrameHeap::MaxThreadCount * 3;
+    for(auto i=0u; i<count; ++i)
+    {
+        RunOnThread([&]()
+        {
+            if (IsRollbackEnabled(heap))
+            { enabled++; }
+        });
+    }
+    ASDX_CHECK(enabled == count);
+}
+
+//-----------------------------------------------------------------------------
+//      同時に MaxThreadCount を超えた場合の動作を確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(FrameHeap_SlotOverflow)
+{
+    asdx::FrameHeap heap;
+    ASDX_CHECK(heap.Init(16 * 1024 * 1024));
+
+    auto count = asdx::FrameHeap::MaxThreadCount + 8;
+
+    std::mutex              mutex;
+    std::condition_variable cond;
+    uint32_t                arrived = 0;
+    bool                    release = false;
+    std::atomic<uint32_t>   allocated(0);
+    std::atomic<uint32_t>   enabled(0);
+
+    std::vector<std::thread> threads;
+    for(auto i=0u; i<count; ++i)
+    {
+        threads.emplace_back([&]()
+        {
+            // 全スレッドがスロットを要求した状態で待つ.
+            if (heap.Alloc(64) != nullptr)
+            { allocated++; }
+
+            if (IsRollbackEnabled(heap))
+            { enabled++; }
+
+            std::unique_lock<std::mutex> locker(mutex);
+            arrived++;
+            cond.notify_all();
+            cond.wait(locker, [&]() { return release; });
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        cond.wait(locker, [&]() { return arrived == count; });
+        release = true;
+    }
+    cond.notify_all();
+
+    for(auto& thread : threads)
+    { thread.join(); }
+
+    // 溢れたスレッドも共有領域から確保できる.
+    // 呼び出しスレッドが1つスロットを持っているので，アリーナを持てるのは残りのスロット数.
+    ASDX_CHECK(allocated == count);
+    ASDX_CHECK(enabled + 1 >= asdx::FrameHeap::MaxThreadCount);
+    ASDX_CHECK(enabled < count);
+
+    // 溢れたスレッドの終了後は再びアリーナを持てる.
+    bool recovered = false;
+    RunOnThread([&]() { recovered = IsRollbackEnabled(heap); });
+    ASDX_CHECK(recovered);
+}
+
+//-----------------------------------------------------------------------------
+//      フレーム毎の確保と解放の速度を new/delete, pmr と比較します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_FrameHeap)
+{
+    auto quick      = asdx::test::IsQuick();
+    auto frameCount = quick ? 20u : 200u;
+    auto allocCount = 20000u;
+    auto taskCount  = 16u;
+
+    auto sizeOf = [](uint32_t task, uint32_t i)
+    { return size_t(16 + ((i * 2654435761u + task * 40503u) >> 20) % 241); };
+
+    asdx::FrameHeap::Desc desc = {};
+    desc.SizePerFrame = size_t(taskCount) * allocCount * 272;
+    desc.FrameCount   = 2;
+    desc.ArenaSize    = 0;
+
+    asdx::FrameHeap heap;
+    heap.Init(desc);
+
+    auto maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+    { maxThreads = 1; }
+
+    for(auto threads = 1u; threads <= maxThreads; threads *= 2)
+    {
+        asdx::ThreadPool pool;
+        pool.Init(threads);
+
+        std::atomic<uint64_t> sink(0);
+
+        // new / delete.
+        asdx::test::Timer timer;
+        for(auto f=0u; f<frameCount; ++f)
+        {
+            pool.ParallelFor(taskCount, 1, [&](uint32_t begin, uint32_t end)
+            {
+                std::vector<uint8_t*> ptrs(allocCount);
+                for(auto t=begin; t<end; ++t)
+                {
+                    for(auto i=0u; i<allocCount; ++i)
+                    {
+                        ptrs[i] = new uint8_t[sizeOf(t, i)];
+                        ptrs[i][0] = uint8_t(i);
+                    }
+                    sink += ptrs[allocCount - 1][0];
+                    for(auto i=0u; i<allocCount; ++i)
+                    { delete[] ptrs[i]; }
+                }
+            });
+        }
+        auto newMsec = timer.GetElapsedMsec();
+
+    #if ASDX_TEST_PMR
+        // std::pmr::monotonic_buffer_resource.
+        timer.Reset();
+        for(auto f=0u; f<frameCount; ++f)
+        {
+            pool.ParallelFor(taskCount, 1, [&](uint32_t begin, uint32_t end)
+            {
+                for(auto t=begin; t<end; ++t)
+                {
+                    std::pmr::monotonic_buffer_resource resource;
+                    uint8_t* ptr = nullptr;
+                    for(auto i=0u; i<allocCount; ++i)
+                    {
+                        ptr = static_cast<uint8_t*>(resource.allocate(sizeOf(t, i), 16));
+                        ptr[0] = uint8_t(i);
+                    }
+                    sink += ptr[0];
+                }
+            });
+        }
+        auto pmrMsec = timer.GetElapsedMsec();
+    #else
+        auto pmrMsec = 0.0;
+    #endif
+
+        // FrameHeap.
+        timer.Reset();
+        for(auto f=0u; f<frameCount; ++f)
+        {
+            pool.ParallelFor(taskCount, 1, [&](uint32_t begin, uint32_t end)
+            {
+                for(auto t=begin; t<end; ++t)
+                {
+                    uint8_t* ptr = nullptr;
+                    for(auto i=0u; i<allocCount; ++i)
+                    {
+                        ptr = static_cast<uint8_t*>(heap.Alloc(sizeOf(t, i)));
+                        ptr[0] = uint8_t(i);
+                    }
+                    sink += ptr[0];
+                }
+            });
+            heap.Reset();
+        }
+        auto heapMsec = timer.GetElapsedMsec();
+
+        ASDX_CHECK(heap.GetStats().FailedCount == 0);
+
+        printf("    threads = %2u, new/delete = %8.2f ms, pmr = %8.2f ms, FrameHeap = %8.2f ms (%.2fx / %.2fx)\n",
+            threads, newMsec, pmrMsec, heapMsec, newMsec / heapMsec, pmrMsec / heapMsec);
+    }
+}
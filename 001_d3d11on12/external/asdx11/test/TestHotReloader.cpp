@@ -0,0 +1,666 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestHotReloader.cpp
+// Desc : FileWatcher / HotReloader Event Storm Tests and Latency Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <edit/asdxFileWatcher.h>
+#include <edit/asdxHotReloader.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Using Statements
+//-----------------------------------------------------------------------------
+using Clock     = std::chrono::steady_clock;
+using TimePoint = Clock::time_point;
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t   WAIT_TIMEOUT_MSEC   = 10000;
+static const uint32_t   PROBE_INTERVAL_MSEC = 500;
+static const char*      PROBE_FILE_NAME     = "probe.txt";
+
+//-----------------------------------------------------------------------------
+//      ファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteText(const std::string& path, const std::string& text)
+{
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    fopen_s(&pFile, path.c_str(), "wb");
+#else
+    pFile = fopen(path.c_str(), "wb");
+#endif
+    if (pFile == nullptr)
+    { return false; }
+
+    auto count = fwrite(text.data(), 1, text.size(), pFile);
+    fclose(pFile);
+    return count == text.size();
+}
+
+//-----------------------------------------------------------------------------
+//      ファイル名を変更します.
+//
+//      Windows では読み込み中のファイルを上書きできないので少し待って再試行します.
+//-----------------------------------------------------------------------------
+bool RenameFile(const std::string& from, const std::string& to)
+{
+    for(auto i=0; i<100; ++i)
+    {
+        std::error_code ec;
+        std::filesystem::rename(from, to, ec);
+        if (!ec)
+        { return true; }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      条件が満たされるまで最大 timeoutMsec だけ待ちます.
+//-----------------------------------------------------------------------------
+template<typename Func>
+bool WaitFor(Func func, uint32_t timeoutMsec)
+{
+    asdx::test::Timer timer;
+    while(!func())
+    {
+        if (timer.GetElapsedMsec() > timeoutMsec)
+        { return false; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      監視が始まるまで待ちます.
+//
+//      AddDirectory() は監視スレッドで監視を開始するので, 戻った時点では変更を取りこぼすことがある.
+//      通知が届くまで同じ内容で書き直す. 書き直すたびに待ち時間が延長されるので間隔は十分に空ける.
+//-----------------------------------------------------------------------------
+template<typename Func>
+bool WaitWatching(const std::string& path, Func func)
+{
+    for(auto i=0u; i<WAIT_TIMEOUT_MSEC / PROBE_INTERVAL_MSEC; ++i)
+    {
+        WriteText(path, "probe");
+        if (WaitFor(func, PROBE_INTERVAL_MSEC))
+        { return true; }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      経過時間をミリ秒単位で取得します.
+//-----------------------------------------------------------------------------
+double ToMsec(TimePoint begin, TimePoint end)
+{ return std::chrono::duration<double, std::milli>(end - begin).count(); }
+
+///////////////////////////////////////////////////////////////////////////////
+// TempDirectory class
+///////////////////////////////////////////////////////////////////////////////
+class TempDirectory
+{
+public:
+    TempDirectory()
+    {
+        static std::atomic<uint32_t> s_Counter(0);
+
+        auto name = std::string("asdx_test_") + std::to_string(Clock::now().time_since_epoch().count()) + "_" + std::to_string(s_Counter++);
+        m_Path = std::filesystem::temp_directory_path() / name;
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_Path, ec);
+    }
+
+    ~TempDirectory()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(m_Path, ec);
+    }
+
+    // AddDirectory() に渡すパス.
+    std::string GetPath() const
+    { return m_Path.string(); }
+
+    // ディレクトリ内のファイルパス.
+    std::string GetFile(const char* name) const
+    { return (m_Path / name).string(); }
+
+    // IHotReloadHandler::OnReload() に渡されるパス.
+    std::string GetKey(const char* name) const
+    { return m_Path.generic_string() + "/" + name; }
+
+    void CreateSubDirectory(const char* name) const
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(m_Path / name, ec);
+    }
+
+private:
+    std::filesystem::path   m_Path;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ReloadRecorder class
+///////////////////////////////////////////////////////////////////////////////
+class ReloadRecorder : public asdx::IHotReloadHandler
+{
+public:
+    struct Record
+    {
+        uint32_t    Count = 0;      //!< 再読み込みされた回数.
+        std::string Data;           //!< 最後に読み込んだ内容.
+        TimePoint   Time;           //!< 最後に読み込んだ時刻.
+    };
+
+    explicit ReloadRecorder(uint32_t delayMsec = 0)
+    : m_DelayMsec   (delayMsec)
+    , m_Entered     (0)
+    { /* DO_NOTHING */ }
+
+    bool OnReload(const char* path, const uint8_t* pData, size_t size) override
+    {
+        m_Entered++;
+
+        if (m_DelayMsec > 0)
+        { std::this_thread::sleep_for(std::chrono::milliseconds(m_DelayMsec.load())); }
+
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        auto& record = m_Records[path];
+        record.Count++;
+        record.Data.assign(reinterpret_cast<const char*>(pData), size);
+        record.Time = Clock::now();
+        return true;
+    }
+
+    Record Get(const std::string& path) const
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        auto itr = m_Records.find(path);
+        return (itr != m_Records.end()) ? itr->second : Record();
+    }
+
+    uint32_t GetCount(const std::string& path) const
+    { return Get(path).Count; }
+
+    uint32_t GetEntered() const
+    { return m_Entered; }
+
+    void SetDelay(uint32_t delayMsec)
+    { m_DelayMsec = delayMsec; }
+
+private:
+    mutable std::mutex              m_Mutex;
+    std::map<std::string, Record>   m_Records;
+    std::atomic<uint32_t>           m_DelayMsec;
+    std::atomic<uint32_t>           m_Entered;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// EventRecorder class
+///////////////////////////////////////////////////////////////////////////////
+class EventRecorder : public asdx::IFileUpdateListener
+{
+public:
+    struct Event
+    {
+        uint32_t            Action;
+        std::string         Path;
+        std::thread::id     ThreadId;
+    };
+
+    EventRecorder()
+    : m_IdleCount(0)
+    { /* DO_NOTHING */ }
+
+    void OnUpdate(uint32_t actionType, const char*, const char* relativePath) override
+    {
+        std::string path = relativePath;
+        std::replace(path.begin(), path.end(), '\\', '/');
+
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        m_Events.push_back({ actionType, path, std::this_thread::get_id() });
+    }
+
+    void OnIdle() override
+    { m_IdleCount++; }
+
+    bool Contains(uint32_t action, const char* path) const
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        for(auto& event : m_Events)
+        {
+            if ((action == 0 || event.Action == action) && event.Path == path)
+            { return true; }
+        }
+        return false;
+    }
+
+    std::vector<Event> GetEvents() const
+    {
+        std::lock_guard<std::mutex> locker(m_Mutex);
+        return m_Events;
+    }
+
+    uint32_t GetIdleCount() const
+    { return m_IdleCount; }
+
+private:
+    mutable std::mutex      m_Mutex;
+    std::vector<Event>      m_Events;
+    std::atomic<uint32_t>   m_IdleCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// StormResult structure
+///////////////////////////////////////////////////////////////////////////////
+struct StormResult
+{
+    uint64_t            EventCount  = 0;    //!< 受け取った変更通知の数.
+    uint64_t            ReloadCount = 0;    //!< 再読み込みの数.
+    std::vector<double> LatencyMsec;        //!< 最後の書き込みから再読み込みまでの時間.
+    bool                Succeeded   = false;//!< 全ファイルが最終内容で1回ずつ再読み込みされた場合は true.
+};
+
+//-----------------------------------------------------------------------------
+//      fileCount 個のファイルに writeCount 回ずつ交互に書き込み, 再読み込みを計測します.
+//-----------------------------------------------------------------------------
+StormResult RunStorm(uint32_t fileCount, uint32_t writeCount, uint32_t debounceMsec)
+{
+    StormResult result;
+
+    TempDirectory   dir;
+    ReloadRecorder  recorder;
+
+    asdx::HotReloader::Desc desc = {};
+    desc.DebounceMsec   = debounceMsec;
+    desc.WorkerCount    = 2;
+    desc.QueueCapacity  = fileCount;
+    desc.pHandler       = &recorder;
+
+    asdx::HotReloader reloader;
+    if (!reloader.Init(desc) || !reloader.AddDirectory(dir.GetPath().c_str()))
+    { return result; }
+
+    if (!WaitWatching(dir.GetFile(PROBE_FILE_NAME), [&]() { return recorder.GetCount(dir.GetKey(PROBE_FILE_NAME)) > 0; }))
+    { return result; }
+
+    auto before = reloader.GetStats();
+
+    std::vector<std::string> names;
+    std::vector<TimePoint>   lastWrite(fileCount);
+    for(auto i=0u; i<fileCount; ++i)
+    { names.push_back("file" + std::to_string(i) + ".txt"); }
+
+    // エディタの連続保存を模して, 全ファイルを交互に書き換える.
+    for(auto j=0u; j<writeCount; ++j)
+    {
+        for(auto i=0u; i<fileCount; ++i)
+        {
+            WriteText(dir.GetFile(names[i].c_str()), names[i] + " rev " + std::to_string(j));
+            lastWrite[i] = Clock::now();
+        }
+    }
+
+    auto done = WaitFor([&]()
+    {
+        for(auto& name : names)
+        {
+            if (recorder.GetCount(dir.GetKey(name.c_str())) == 0)
+            { return false; }
+        }
+        return true;
+    }, WAIT_TIMEOUT_MSEC);
+
+    // 遅れて再読み込みされないことも確認する.
+    std::this_thread::sleep_for(std::chrono::milliseconds(debounceMsec * 3));
+
+    auto after = reloader.GetStats();
+    reloader.Term();
+
+    result.EventCount  = after.EventCount  - before.EventCount;
+    result.ReloadCount = after.ReloadCount - before.ReloadCount;
+    result.Succeeded   = done;
+
+    for(auto i=0u; i<fileCount; ++i)
+    {
+        auto record = recorder.Get(dir.GetKey(names[i].c_str()));
+        auto expect = names[i] + " rev " + std::to_string(writeCount - 1);
+
+        result.Succeeded &= (record.Count == 1);
+        result.Succeeded &= (record.Data == expect);
+
+        if (record.Count > 0)
+        { result.LatencyMsec.push_back(ToMsec(lastWrite[i], record.Time)); }
+    }
+
+    std::sort(result.LatencyMsec.begin(), result.LatencyMsec.end());
+    return result;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      FileWatcher が追加・変更・名前変更・削除を通知することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(FileWatcher_RawEvents)
+{
+    TempDirectory dir0;
+    TempDirectory dir1;
+    dir1.CreateSubDirectory("sub");
+
+    EventRecorder listener0;
+    EventRecorder listener1;
+
+    auto path = dir0.GetPath();
+
+    asdx::FileWatcher::Desc desc = {};
+    desc.DirectoryPath  = path.c_str();
+    desc.WaitTimeMsec   = 10;
+    desc.pListener      = &listener0;
+
+    asdx::FileWatcher watcher;
+    ASDX_CHECK(watcher.Init(desc));
+    ASDX_CHECK(watcher.AddDirectory(dir1.GetPath().c_str(), &listener1));
+    ASDX_CHECK(!watcher.AddDirectory((dir0.GetPath() + "/not_found").c_str(), &listener0));
+
+    // 監視開始前に作られていることがあるので, 通知の種類は問わない.
+    ASDX_CHECK(WaitWatching(dir0.GetFile(PROBE_FILE_NAME), [&]() { return listener0.Contains(0, PROBE_FILE_NAME); }));
+    ASDX_CHECK(WaitWatching(dir1.GetFile(PROBE_FILE_NAME), [&]() { return listener1.Contains(0, PROBE_FILE_NAME); }));
+
+    // 追加・変更・名前変更・削除.
+    ASDX_CHECK(WriteText(dir0.GetFile("a.txt"), "a"));
+    ASDX_CHECK(WriteText(dir0.GetFile("a.txt"), "aa"));
+    ASDX_CHECK(RenameFile(dir0.GetFile("a.txt"), dir0.GetFile("b.txt")));
+    ASDX_CHECK(remove(dir0.GetFile("b.txt").c_str()) == 0);
+
+    // サブディレクトリも監視される.
+    ASDX_CHECK(WriteText(dir1.GetFile("sub/c.txt"), "c"));
+
+    ASDX_CHECK(WaitFor([&]() { return listener0.Contains(asdx::FILE_UPDATE_ACTION_REMOVED, "b.txt"); }, WAIT_TIMEOUT_MSEC));
+    ASDX_CHECK(WaitFor([&]() { return listener1.Contains(asdx::FILE_UPDATE_ACTION_ADDED, "sub/c.txt"); }, WAIT_TIMEOUT_MSEC));
+
+    ASDX_CHECK(listener0.Contains(asdx::FILE_UPDATE_ACTION_ADDED,       "a.txt"));
+    ASDX_CHECK(listener0.Contains(asdx::FILE_UPDATE_ACTION_MODIFIED,    "a.txt"));
+    ASDX_CHECK(listener0.Contains(asdx::FILE_UPDATE_ACTION_RENAMED_OLD, "a.txt"));
+    ASDX_CHECK(listener0.Contains(asdx::FILE_UPDATE_ACTION_RENAMED_NEW, "b.txt"));
+
+    // 通知先ごとに分かれていて, 全て同じ監視スレッドから届く.
+    auto events0 = listener0.GetEvents();
+    auto events1 = listener1.GetEvents();
+    ASDX_CHECK(!events0.empty() && !events1.empty());
+
+    auto sameThread = true;
+    auto separated  = true;
+    for(auto& event : events0)
+    {
+        sameThread &= (event.ThreadId == events0.front().ThreadId);
+        separated  &= (event.Path != "sub/c.txt");
+    }
+    for(auto& event : events1)
+    {
+        sameThread &= (event.ThreadId == events0.front().ThreadId);
+        separated  &= (event.Path != "a.txt" && event.Path != "b.txt");
+    }
+    ASDX_CHECK(sameThread);
+    ASDX_CHECK(separated);
+
+    // OnIdle() は通知がなくても呼び出される.
+    auto idle = listener0.GetIdleCount();
+    ASDX_CHECK(WaitFor([&]() { return listener0.GetIdleCount() > idle + 2; }, WAIT_TIMEOUT_MSEC));
+    ASDX_CHECK(listener1.GetIdleCount() > 0);
+
+    watcher.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      連続した書き込みが1ファイルにつき1回の再読み込みにまとめられることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HotReloader_EventStorm)
+{
+    const uint32_t FileCount    = 8;
+    const uint32_t WriteCount   = 50;
+    const uint32_t DebounceMsec = 100;
+
+    auto result = RunStorm(FileCount, WriteCount, DebounceMsec);
+    ASDX_CHECK(result.Succeeded);
+    ASDX_CHECK(result.ReloadCount == FileCount);
+    ASDX_CHECK(result.EventCount > result.ReloadCount);
+    ASDX_CHECK(result.LatencyMsec.size() == FileCount);
+
+    // 最後の書き込みから待ち時間が経過する前には再読み込みしない.
+    if (!result.LatencyMsec.empty())
+    {
+        ASDX_CHECK(result.LatencyMsec.front() >= DebounceMsec * 0.9);
+        printf("    %u files x %u writes : events = %llu, reloads = %llu, latency min = %.1f ms, max = %.1f ms\n",
+            FileCount, WriteCount,
+            static_cast<unsigned long long>(result.EventCount),
+            static_cast<unsigned long long>(result.ReloadCount),
+            result.LatencyMsec.front(), result.LatencyMsec.back());
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      内容の変わらない保存では再読み込みしないことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HotReloader_SkipUnchanged)
+{
+    TempDirectory   dir;
+    ReloadRecorder  recorder;
+
+    auto path = dir.GetFile("shader.hlsl");
+    auto key  = dir.GetKey("shader.hlsl");
+    ASDX_CHECK(WriteText(path, "float4 main() : SV_Target { return 0; }"));
+
+    asdx::HotReloader::Desc desc = {};
+    desc.DebounceMsec   = 30;
+    desc.pHandler       = &recorder;
+
+    asdx::HotReloader reloader;
+    ASDX_CHECK(reloader.Init(desc));
+    ASDX_CHECK(reloader.AddDirectory(dir.GetPath().c_str()));
+    ASDX_CHECK(reloader.Track(key.c_str()));
+    ASDX_CHECK(!reloader.Track(dir.GetKey("not_found.hlsl").c_str()));
+    ASDX_CHECK(WaitWatching(dir.GetFile(PROBE_FILE_NAME), [&]() { return recorder.GetCount(dir.GetKey(PROBE_FILE_NAME)) > 0; }));
+
+    // 同じ内容で上書きしても呼び出されない.
+    auto before = reloader.GetStats();
+    for(auto i=0; i<5; ++i)
+    { ASDX_CHECK(WriteText(path, "float4 main() : SV_Target { return 0; }")); }
+
+    ASDX_CHECK(WaitFor([&]() { return reloader.GetStats().SkippedCount > before.SkippedCount; }, WAIT_TIMEOUT_MSEC));
+    ASDX_CHECK(recorder.GetCount(key) == 0);
+
+    // 内容が変われば呼び出される.
+    ASDX_CHECK(WriteText(path, "float4 main() : SV_Target { return 1; }"));
+    ASDX_CHECK(WaitFor([&]() { return recorder.GetCount(key) == 1; }, WAIT_TIMEOUT_MSEC));
+
+    // 再読み込みした内容に戻すだけの保存も省略される.
+    before = reloader.GetStats();
+    ASDX_CHECK(WriteText(path, "float4 main() : SV_Target { return 1; }"));
+    ASDX_CHECK(WaitFor([&]() { return reloader.GetStats().SkippedCount > before.SkippedCount; }, WAIT_TIMEOUT_MSEC));
+    ASDX_CHECK(recorder.GetCount(key) == 1);
+    ASDX_CHECK(recorder.Get(key).Data == "float4 main() : SV_Target { return 1; }");
+
+    reloader.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      一時ファイルに書いてから名前を変更する保存で, 一時ファイルを読み込まないことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HotReloader_AtomicSave)
+{
+    TempDirectory   dir;
+    ReloadRecorder  recorder;
+
+    asdx::HotReloader::Desc desc = {};
+    desc.DebounceMsec   = 50;
+    desc.RetryCount     = 3;
+    desc.pHandler       = &recorder;
+
+    asdx::HotReloader reloader;
+    ASDX_CHECK(reloader.Init(desc));
+    ASDX_CHECK(reloader.AddDirectory(dir.GetPath().c_str()));
+    ASDX_CHECK(WaitWatching(dir.GetFile(PROBE_FILE_NAME), [&]() { return recorder.GetCount(dir.GetKey(PROBE_FILE_NAME)) > 0; }));
+
+    auto path = dir.GetFile("scene.xml");
+    auto temp = dir.GetFile("scene.xml.tmp");
+
+    for(auto i=0; i<10; ++i)
+    {
+        ASDX_CHECK(WriteText(temp, "<scene rev=\"" + std::to_string(i) + "\"/>"));
+        ASDX_CHECK(RenameFile(temp, path));
+    }
+
+    ASDX_CHECK(WaitFor([&]() { return recorder.GetCount(dir.GetKey("scene.xml")) > 0; }, WAIT_TIMEOUT_MSEC));
+    std::this_thread::sleep_for(std::chrono::milliseconds(desc.DebounceMsec * 3));
+
+    ASDX_CHECK(recorder.GetCount(dir.GetKey("scene.xml")) == 1);
+    ASDX_CHECK(recorder.Get(dir.GetKey("scene.xml")).Data == "<scene rev=\"9\"/>");
+    ASDX_CHECK(recorder.GetCount(dir.GetKey("scene.xml.tmp")) == 0);
+    ASDX_CHECK(reloader.GetStats().FailedCount == 0);
+
+    reloader.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      キューが一杯になっても変更を取りこぼさないことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HotReloader_QueueFull)
+{
+    const uint32_t FileCount = 10;
+
+    TempDirectory   dir;
+    ReloadRecorder  recorder;
+
+    asdx::HotReloader::Desc desc = {};
+    desc.DebounceMsec   = 20;
+    desc.WorkerCount    = 1;
+    desc.QueueCapacity  = 2;
+    desc.pHandler       = &recorder;
+
+    asdx::HotReloader reloader;
+    ASDX_CHECK(reloader.Init(desc));
+    ASDX_CHECK(reloader.AddDirectory(dir.GetPath().c_str()));
+    ASDX_CHECK(WaitWatching(dir.GetFile(PROBE_FILE_NAME), [&]() { return recorder.GetCount(dir.GetKey(PROBE_FILE_NAME)) > 0; }));
+
+    // 再読み込みを遅くして, キューを溢れさせる.
+    recorder.SetDelay(20);
+
+    std::vector<std::string> names;
+    for(auto i=0u; i<FileCount; ++i)
+    {
+        names.push_back("mesh" + std::to_string(i) + ".bin");
+        ASDX_CHECK(WriteText(dir.GetFile(names.back().c_str()), names.back()));
+    }
+
+    auto done = WaitFor([&]()
+    {
+        for(auto& name : names)
+        {
+            if (recorder.GetCount(dir.GetKey(name.c_str())) == 0)
+            { return false; }
+        }
+        return true;
+    }, WAIT_TIMEOUT_MSEC);
+    ASDX_CHECK(done);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(desc.DebounceMsec * 3));
+
+    for(auto& name : names)
+    {
+        auto record = recorder.Get(dir.GetKey(name.c_str()));
+        ASDX_CHECK(record.Count == 1);
+        ASDX_CHECK(record.Data == name);
+    }
+    ASDX_CHECK(reloader.GetStats().QueueFullCount > 0);
+
+    reloader.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      再読み込み中の変更が, 最新の内容でもう一度読み込まれることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HotReloader_ModifiedDuringReload)
+{
+    TempDirectory   dir;
+    ReloadRecorder  recorder;
+
+    asdx::HotReloader::Desc desc = {};
+    desc.DebounceMsec   = 20;
+    desc.pHandler       = &recorder;
+
+    asdx::HotReloader reloader;
+    ASDX_CHECK(reloader.Init(desc));
+    ASDX_CHECK(reloader.AddDirectory(dir.GetPath().c_str()));
+    ASDX_CHECK(WaitWatching(dir.GetFile(PROBE_FILE_NAME), [&]() { return recorder.GetCount(dir.GetKey(PROBE_FILE_NAME)) > 0; }));
+
+    auto path = dir.GetFile("material.json");
+    auto key  = dir.GetKey("material.json");
+
+    recorder.SetDelay(200);
+    auto entered = recorder.GetEntered();
+
+    ASDX_CHECK(WriteText(path, "{ \"rev\" : 0 }"));
+    ASDX_CHECK(WaitFor([&]() { return recorder.GetEntered() > entered; }, WAIT_TIMEOUT_MSEC));
+
+    // OnReload() の実行中に書き換える.
+    ASDX_CHECK(WriteText(path, "{ \"rev\" : 1 }"));
+    recorder.SetDelay(0);
+
+    ASDX_CHECK(WaitFor([&]() { return recorder.GetCount(key) == 2; }, WAIT_TIMEOUT_MSEC));
+    std::this_thread::sleep_for(std::chrono::milliseconds(desc.DebounceMsec * 3));
+
+    ASDX_CHECK(recorder.GetCount(key) == 2);
+    ASDX_CHECK(recorder.Get(key).Data == "{ \"rev\" : 1 }");
+
+    reloader.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      書き込みの嵐に対する再読み込み回数と遅延を計測します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_HotReloader_Storm)
+{
+    const uint32_t DebounceMsec = 50;
+    const uint32_t WriteCount   = asdx::test::IsQuick() ? 20 : 100;
+
+    printf("    debounce = %u ms, writes per file = %u\n", DebounceMsec, WriteCount);
+    printf("    %6s %10s %10s %8s %12s %12s\n", "files", "writes", "events", "reloads", "p50 (ms)", "max (ms)");
+
+    for(auto fileCount : { 1u, 8u, 32u })
+    {
+        auto result = RunStorm(fileCount, WriteCount, DebounceMsec);
+        ASDX_CHECK(result.Succeeded);
+
+        auto p50 = result.LatencyMsec.empty() ? 0.0 : result.LatencyMsec[result.LatencyMsec.size() / 2];
+        auto p100 = result.LatencyMsec.empty() ? 0.0 : result.LatencyMsec.back();
+
+        printf("    %6u %10u %10llu %8llu %12.2f %12.2f\n",
+            fileCount, fileCount * WriteCount,
+            static_cast<unsigned long long>(result.EventCount),
+            static_cast<unsigned long long>(result.ReloadCount),
+            p50, p100);
+    }
+}
@@ -0,0 +1,420 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestMathBatch.cpp
+// Desc : Batched SIMD Math Tests and Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <asdxMathBatch.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const size_t     kCounts[]   = { 0, 1, 3, 4, 7, 8, 9, 15, 31, 33, 1000, 1027 };
+static const float      kTolerance  = 1e-5f;
+static const char*      kLevelNames[] = { "Scalar", "SSE2", "AVX2" };
+
+//-----------------------------------------------------------------------------
+//      サポートされている全てのSIMDレベルで処理を実行します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void ForEachLevel(Func func)
+{
+    auto prev = asdx::GetSimdLevel();
+    for(auto level = 0; level <= int(asdx::GetSupportedSimdLevel()); ++level)
+    {
+        asdx::SetSimdLevel(asdx::SIMD_LEVEL(level));
+        ASDX_CHECK(asdx::GetSimdLevel() == asdx::SIMD_LEVEL(level));
+        func(asdx::SIMD_LEVEL(level));
+    }
+    asdx::SetSimdLevel(prev);
+}
+
+//-----------------------------------------------------------------------------
+//      相対誤差を考慮して比較します.
+//-----------------------------------------------------------------------------
+inline bool IsNear(float a, float b)
+{
+    auto scale = fabsf(a) > fabsf(b) ? fabsf(a) : fabsf(b);
+    if (scale < 1.0f)
+    { scale = 1.0f; }
+    return fabsf(a - b) <= kTolerance * scale;
+}
+
+inline bool IsNear(const asdx::Vector3& a, const asdx::Vector3& b)
+{ return IsNear(a.x, b.x) && IsNear(a.y, b.y) && IsNear(a.z, b.z); }
+
+inline bool IsNear(const asdx::Vector4& a, const asdx::Vector4& b)
+{ return IsNear(a.x, b.x) && IsNear(a.y, b.y) && IsNear(a.z, b.z) && IsNear(a.w, b.w); }
+
+//-----------------------------------------------------------------------------
+//      可視判定のビットを取得します.
+//-----------------------------------------------------------------------------
+inline bool IsVisible(const std::vector<uint32_t>& bits, size_t index)
+{ return (bits[index / 32] & (1u << (index % 32))) != 0; }
+
+///////////////////////////////////////////////////////////////////////////////
+// Scene structure
+///////////////////////////////////////////////////////////////////////////////
+struct Scene
+{
+    asdx::Matrix    World;
+    asdx::Matrix    Proj;
+    asdx::Vector4   Planes[6];
+
+    Scene()
+    {
+        World = asdx::Matrix::CreateRotationFromYawPitchRoll(0.3f, -0.7f, 1.1f)
+              * asdx::Matrix::CreateTranslation(1.5f, -2.0f, 3.25f);
+
+        auto view = asdx::Matrix::CreateLookAt(
+            asdx::Vector3(0.0f, 2.0f, -10.0f),
+            asdx::Vector3(0.0f, 0.0f, 0.0f),
+            asdx::Vector3(0.0f, 1.0f, 0.0f));
+        Proj = asdx::Matrix::CreatePerspectiveFieldOfView(1.0f, 16.0f / 9.0f, 0.1f, 50.0f);
+
+        asdx::CalcFrustumPlanes(view, Proj, Planes);
+    }
+
+    // 平面からの符号付き距離(精度差で判定が揺れる境界付近の要素は比較から除外する).
+    double Distance(uint32_t plane, double x, double y, double z) const
+    {
+        auto& p = Planes[plane];
+        return x * p.x + y * p.y + z * p.z + p.w;
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      乱数でベクトルを生成します.
+//-----------------------------------------------------------------------------
+std::vector<asdx::Vector3> RandomVector3(std::mt19937& rng, size_t count, float range)
+{
+    std::uniform_real_distribution<float> dist(-range, range);
+    std::vector<asdx::Vector3> result(count);
+    for(auto& v : result)
+    { v = asdx::Vector3(dist(rng), dist(rng), dist(rng)); }
+    return result;
+}
+
+std::vector<asdx::Vector4> RandomVector4(std::mt19937& rng, size_t count, float range)
+{
+    std::uniform_real_distribution<float> dist(-range, range);
+    std::vector<asdx::Vector4> result(count);
+    for(auto& v : result)
+    { v = asdx::Vector4(dist(rng), dist(rng), dist(rng), dist(rng)); }
+    return result;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      Vector3 の変換結果をスカラー関数と比較します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MathBatch_TransformVector3)
+{
+    Scene scene;
+    std::mt19937 rng(1);
+
+    ForEachLevel([&](asdx::SIMD_LEVEL)
+    {
+        for(auto count : kCounts)
+        {
+            auto src = RandomVector3(rng, count, 100.0f);
+            std::vector<asdx::Vector3> pos(count), coord(count), nrm(count);
+
+            asdx::TransformBatch      (src.data(), count, scene.World, pos.data());
+            asdx::TransformCoordBatch (src.data(), count, scene.Proj,  coord.data());
+            asdx::TransformNormalBatch(src.data(), count, scene.World, nrm.data());
+
+            auto ok = true;
+            for(size_t i=0; i<count; ++i)
+            {
+                ok &= IsNear(pos[i],   asdx::Vector3::Transform      (src[i], scene.World));
+                ok &= IsNear(coord[i], asdx::Vector3::TransformCoord (src[i], scene.Proj));
+                ok &= IsNear(nrm[i],   asdx::Vector3::TransformNormal(src[i], scene.World));
+            }
+            ASDX_CHECK(ok);
+
+            // 入力と出力が同じ配列でも良い.
+            auto inplace = src;
+            asdx::TransformBatch(inplace.data(), count, scene.World, inplace.data());
+            for(size_t i=0; i<count; ++i)
+            { ok &= IsNear(inplace[i], pos[i]); }
+            ASDX_CHECK(ok);
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      Vector4 の変換結果をスカラー関数と比較します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MathBatch_TransformVector4)
+{
+    Scene scene;
+    std::mt19937 rng(2);
+
+    ForEachLevel([&](asdx::SIMD_LEVEL)
+    {
+        for(auto count : kCounts)
+        {
+            auto src = RandomVector4(rng, count, 100.0f);
+            std::vector<asdx::Vector4> dst(count);
+            asdx::TransformBatch(src.data(), count, scene.World, dst.data());
+
+            auto ok = true;
+            for(size_t i=0; i<count; ++i)
+            { ok &= IsNear(dst[i], asdx::Vector4::Transform(src[i], scene.World)); }
+            ASDX_CHECK(ok);
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      正規化の結果をスカラー関数と比較します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MathBatch_Normalize)
+{
+    std::mt19937 rng(3);
+
+    ForEachLevel([&](asdx::SIMD_LEVEL)
+    {
+        for(auto count : kCounts)
+        {
+            auto src = RandomVector3(rng, count, 10.0f);
+
+            // 長さ0のベクトルは零ベクトルになる.
+            if (count > 2)
+            { src[count / 2] = asdx::Vector3(0.0f, 0.0f, 0.0f); }
+
+            std::vector<asdx::Vector3> dst(count);
+            asdx::NormalizeBatch(src.data(), count, dst.data());
+
+            auto ok = true;
+            for(size_t i=0; i<count; ++i)
+            {
+                if (src[i].x == 0.0f && src[i].y == 0.0f && src[i].z == 0.0f)
+                { ok &= (dst[i].x == 0.0f && dst[i].y == 0.0f && dst[i].z == 0.0f); }
+                else
+                { ok &= IsNear(dst[i], asdx::Vector3::Normalize(src[i])); }
+            }
+            ASDX_CHECK(ok);
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      球とAABBの可視判定を平面との距離から求めた結果と比較します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MathBatch_Culling)
+{
+    Scene scene;
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> radius(0.0f, 3.0f);
+
+    ForEachLevel([&](asdx::SIMD_LEVEL)
+    {
+        for(auto count : kCounts)
+        {
+            auto centers = RandomVector3(rng, count, 40.0f);
+
+            std::vector<asdx::Vector4> spheres(count);
+            std::vector<asdx::Vector3> mins(count), maxs(count);
+            for(size_t i=0; i<count; ++i)
+            {
+                auto r = radius(rng);
+                spheres[i] = asdx::Vector4(centers[i].x, centers[i].y, centers[i].z, r);
+                mins[i]    = asdx::Vector3(centers[i].x - r, centers[i].y - r * 0.5f, centers[i].z - r * 2.0f);
+                maxs[i]    = asdx::Vector3(centers[i].x + r, centers[i].y + r * 0.5f, centers[i].z + r * 2.0f);
+            }
+
+            // 末尾のワードの余りビットを検出するために埋めておく.
+            auto words = (count + 31) / 32;
+            std::vector<uint32_t> sphereBits(words, 0xcdcdcdcd), boxBits(words, 0xcdcdcdcd);
+            asdx::CullSpheres(scene.Planes, spheres.data(), count, sphereBits.data());
+            asdx::CullBoxes  (scene.Planes, mins.data(), maxs.data(), count, boxBits.data());
+
+            auto ok      = true;
+            auto visible = 0u;
+            for(size_t i=0; i<count; ++i)
+            {
+                auto sphere    = true;
+                auto box       = true;
+                auto ambiguous = false;
+                for(auto j=0u; j<6; ++j)
+                {
+                    auto& p = scene.Planes[j];
+                    auto ds = scene.Distance(j, spheres[i].x, spheres[i].y, spheres[i].z) + spheres[i].w;
+                    auto db = scene.Distance(j,
+                        (p.x >= 0.0f) ? maxs[i].x : mins[i].x,
+                        (p.y >= 0.0f) ? maxs[i].y : mins[i].y,
+                        (p.z >= 0.0f) ? maxs[i].z : mins[i].z);
+                    sphere    &= (ds >= 0.0);
+                    box       &= (db >= 0.0);
+                    ambiguous |= (fabs(ds) < 1e-3) || (fabs(db) < 1e-3);
+                }
+
+                if (ambiguous)
+                { continue; }
+
+                ok &= (IsVisible(sphereBits, i) == sphere);
+                ok &= (IsVisible(boxBits,    i) == box);
+                visible += sphere ? 1 : 0;
+            }
+            ASDX_CHECK(ok);
+
+            for(auto i=count; i<words * 32; ++i)
+            {
+                ok &= !IsVisible(sphereBits, i);
+                ok &= !IsVisible(boxBits,    i);
+            }
+            ASDX_CHECK(ok);
+
+            // 全て可視, 全て不可視の偏ったデータになっていないこと.
+            if (count >= 1000)
+            { ASDX_CHECK(visible > 0 && visible < count); }
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      スキニングの結果をブレンドした行列による変換と比較します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MathBatch_Skinning)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> angle(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    const uint16_t boneCount = 64;
+    std::vector<asdx::Matrix> bones(boneCount);
+    for(auto& bone : bones)
+    {
+        bone = asdx::Matrix::CreateRotationFromYawPitchRoll(angle(rng), angle(rng), angle(rng))
+             * asdx::Matrix::CreateTranslation(angle(rng), angle(rng), angle(rng));
+    }
+
+    ForEachLevel([&](asdx::SIMD_LEVEL)
+    {
+        for(auto count : kCounts)
+        {
+            auto positions = RandomVector3(rng, count, 5.0f);
+            auto normals   = RandomVector3(rng, count, 1.0f);
+
+            std::vector<asdx::ResBoneIndex> indices(count);
+            std::vector<asdx::Vector4>      weights(count);
+            for(size_t i=0; i<count; ++i)
+            {
+                indices[i] = asdx::ResBoneIndex(
+                    uint16_t(rng() % boneCount), uint16_t(rng() % boneCount),
+                    uint16_t(rng() % boneCount), uint16_t(rng() % boneCount));
+
+                asdx::Vector4 w(unit(rng), unit(rng), unit(rng), unit(rng));
+                auto sum = w.x + w.y + w.z + w.w;
+                weights[i] = asdx::Vector4(w.x / sum, w.y / sum, w.z / sum, w.w / sum);
+            }
+
+            std::vector<asdx::Vector3> outPositions(count), outNormals(count), outOnly(count);
+            asdx::SkinningBatch(positions.data(), normals.data(), indices.data(), weights.data(),
+                count, bones.data(), outPositions.data(), outNormals.data());
+
+            // 法線無しでも位置座標は同じ結果になる.
+            asdx::SkinningBatch(positions.data(), nullptr, indices.data(), weights.data(),
+                count, bones.data(), outOnly.data(), nullptr);
+
+            auto ok = true;
+            for(size_t i=0; i<count; ++i)
+            {
+                auto& idx = indices[i];
+                auto& w   = weights[i];
+                auto  m   = bones[idx.x] * w.x + bones[idx.y] * w.y + bones[idx.z] * w.z + bones[idx.w] * w.w;
+
+                ok &= IsNear(outPositions[i], asdx::Vector3::Transform(positions[i], m));
+                ok &= IsNear(outNormals[i],   asdx::Vector3::TransformNormal(normals[i], m));
+                ok &= IsNear(outOnly[i],      outPositions[i]);
+            }
+            ASDX_CHECK(ok);
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      要素数毎の処理時間をSIMDレベル別に計測します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_MathBatch)
+{
+    Scene scene;
+    std::mt19937 rng(6);
+
+    const size_t counts[] = { 10000, 100000, 1000000 };
+    auto repeat = asdx::test::IsQuick() ? 3 : 20;
+
+    for(auto count : counts)
+    {
+        auto src     = RandomVector3(rng, count, 40.0f);
+        auto spheres = RandomVector4(rng, count, 40.0f);
+        for(auto& s : spheres)
+        { s.w = fabsf(s.w) * 0.1f; }
+
+        std::vector<asdx::ResBoneIndex> indices(count);
+        std::vector<asdx::Vector4>      weights(count, asdx::Vector4(0.4f, 0.3f, 0.2f, 0.1f));
+        for(auto& idx : indices)
+        { idx = asdx::ResBoneIndex(uint16_t(rng() % 64), uint16_t(rng() % 64), uint16_t(rng() % 64), uint16_t(rng() % 64)); }
+        std::vector<asdx::Matrix> bones(64, scene.World);
+
+        std::vector<asdx::Vector3> dst(count), dstNormals(count);
+        std::vector<uint32_t>      bits((count + 31) / 32);
+
+        double scalar[4] = {};
+        ForEachLevel([&](asdx::SIMD_LEVEL level)
+        {
+            double msec[4] = {};
+
+            asdx::test::Timer timer;
+            for(auto r=0; r<repeat; ++r)
+            { asdx::TransformBatch(src.data(), count, scene.World, dst.data()); }
+            msec[0] = timer.GetElapsedMsec() / repeat;
+
+            timer.Reset();
+            for(auto r=0; r<repeat; ++r)
+            { asdx::NormalizeBatch(src.data(), count, dst.data()); }
+            msec[1] = timer.GetElapsedMsec() / repeat;
+
+            timer.Reset();
+            for(auto r=0; r<repeat; ++r)
+            { asdx::CullSpheres(scene.Planes, spheres.data(), count, bits.data()); }
+            msec[2] = timer.GetElapsedMsec() / repeat;
+
+            timer.Reset();
+            for(auto r=0; r<repeat; ++r)
+            {
+                asdx::SkinningBatch(src.data(), src.data(), indices.data(), weights.data(),
+                    count, bones.data(), dst.data(), dstNormals.data());
+            }
+            msec[3] = timer.GetElapsedMsec() / repeat;
+
+            if (level == asdx::SIMD_LEVEL_SCALAR)
+            {
+                for(auto i=0; i<4; ++i)
+                { scalar[i] = msec[i]; }
+            }
+
+            printf("    count = %7zu, %-6s : transform = %7.3f ms (%.2fx), normalize = %7.3f ms (%.2fx), cull = %7.3f ms (%.2fx), skinning = %7.3f ms (%.2fx)\n",
+                count, kLevelNames[level],
+                msec[0], scalar[0] / msec[0],
+                msec[1], scalar[1] / msec[1],
+                msec[2], scalar[2] / msec[2],
+                msec[3], scalar[3] / msec[3]);
+        });
+    }
+}
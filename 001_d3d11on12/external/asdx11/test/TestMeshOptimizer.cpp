@@ -0,0 +1,416 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestMeshOptimizer.cpp
+// Desc : Mesh Optimizer Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <random>
+#include <vector>
+#include <asdxMeshOptimizer.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+//-----------------------------------------------------------------------------
+//      格子状のメッシュを生成します.
+//-----------------------------------------------------------------------------
+asdx::ResMesh CreateGrid(uint32_t size)
+{
+    asdx::ResMesh mesh;
+    for(auto y=0u; y<=size; ++y)
+    {
+        for(auto x=0u; x<=size; ++x)
+        { mesh.Positions.push_back(asdx::Vector3(float(x), float(y), 0.0f)); }
+    }
+
+    for(auto y=0u; y<size; ++y)
+    {
+        for(auto x=0u; x<size; ++x)
+        {
+            auto i0 = y * (size + 1) + x;
+            auto i1 = i0 + 1;
+            auto i2 = i0 + size + 1;
+            auto i3 = i2 + 1;
+            mesh.Indices.insert(mesh.Indices.end(), { i0, i1, i2, i2, i1, i3 });
+        }
+    }
+
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+//      起伏のある格子状のメッシュを生成します.
+//-----------------------------------------------------------------------------
+asdx::ResMesh CreateBumpyGrid(uint32_t size)
+{
+    auto mesh = CreateGrid(size);
+    for(auto& p : mesh.Positions)
+    { p.z = 2.0f * sinf(p.x * 0.4f) * cosf(p.y * 0.3f); }
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+//      頂点を共有しないランダムな三角形群を生成します.
+//-----------------------------------------------------------------------------
+asdx::ResMesh CreateTriangleSoup(uint32_t triCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    asdx::ResMesh mesh;
+    for(auto i=0u; i<triCount * 3; ++i)
+    {
+        mesh.Positions.push_back(asdx::Vector3(dist(rng), dist(rng), dist(rng)));
+        mesh.Indices.push_back(i);
+    }
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+//      FIFO 頂点キャッシュのミス数を素朴に数えます.
+//-----------------------------------------------------------------------------
+uint32_t CountFifoMisses(const std::vector<uint32_t>& indices, uint32_t cacheSize)
+{
+    std::deque<uint32_t> cache;
+    uint32_t misses = 0;
+    for(auto index : indices)
+    {
+        if (std::find(cache.begin(), cache.end(), index) != cache.end())
+        { continue; }
+
+        misses++;
+        cache.push_back(index);
+        if (cache.size() > cacheSize)
+        { cache.pop_front(); }
+    }
+    return misses;
+}
+
+//-----------------------------------------------------------------------------
+//      三角形の一覧を並び順に依存しない形で取得します.
+//-----------------------------------------------------------------------------
+std::vector<Triangle> GetSortedTriangles(const std::vector<uint32_t>& indices)
+{
+    std::vector<Triangle> result;
+    for(size_t i=0; i + 2 < indices.size(); i += 3)
+    { result.push_back({ indices[i + 0], indices[i + 1], indices[i + 2] }); }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      縮退三角形を含むメッシュでも三角形の並び替えのみが行われることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MeshOptimizer_VertexCacheWithDegenerateTriangles)
+{
+    auto mesh = CreateGrid(32);
+
+    // 頂点の重複位置が異なる縮退三角形を混ぜてシャッフルする.
+    std::mt19937 rng(7);
+    auto triCount = uint32_t(mesh.Indices.size() / 3);
+    for(auto i=0u; i<triCount; i += 5)
+    {
+        auto a = mesh.Indices[i * 3 + 0];
+        auto b = mesh.Indices[i * 3 + 1];
+        switch(rng() % 4)
+        {
+        case 0: { mesh.Indices.insert(mesh.Indices.end(), { a, a, b }); } break;
+        case 1: { mesh.Indices.insert(mesh.Indices.end(), { a, b, b }); } break;
+        case 2: { mesh.Indices.insert(mesh.Indices.end(), { a, b, a }); } break;
+        case 3: { mesh.Indices.insert(mesh.Indices.end(), { a, a, a }); } break;
+        }
+    }
+
+    std::vector<Triangle> tris;
+    for(size_t i=0; i<mesh.Indices.size(); i += 3)
+    { tris.push_back({ mesh.Indices[i + 0], mesh.Indices[i + 1], mesh.Indices[i + 2] }); }
+    std::shuffle(tris.begin(), tris.end(), rng);
+
+    mesh.Indices.clear();
+    for(auto& tri : tris)
+    { mesh.Indices.insert(mesh.Indices.end(), tri.begin(), tri.end()); }
+
+    auto before   = asdx::CalcMeshStats(mesh);
+    auto expected = GetSortedTriangles(mesh.Indices);
+
+    ASDX_CHECK(asdx::OptimizeVertexCache(mesh));
+
+    auto after = asdx::CalcMeshStats(mesh);
+    ASDX_CHECK(GetSortedTriangles(mesh.Indices) == expected);
+    ASDX_CHECK(after.ACMR < before.ACMR);
+
+    // 同じ入力からは同じ結果になる.
+    auto again = mesh;
+    again.Indices.clear();
+    for(auto& tri : tris)
+    { again.Indices.insert(again.Indices.end(), tri.begin(), tri.end()); }
+    ASDX_CHECK(asdx::OptimizeVertexCache(again));
+    ASDX_CHECK(again.Indices == mesh.Indices);
+
+    printf("    ACMR : %.3f -> %.3f\n", before.ACMR, after.ACMR);
+}
+
+//-----------------------------------------------------------------------------
+//      小さな例で FIFO キャッシュのミス数を確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MeshOptimizer_CalcMeshStats)
+{
+    // キャッシュサイズ 3 で手計算したミス数.
+    //   (0, 1, 2) : 0, 1, 2 がミス                     -> [0, 1, 2]  3
+    //   (1, 2, 3) : 3 がミス                           -> [1, 2, 3]  4
+    //   (2, 3, 4) : 4 がミス                           -> [2, 3, 4]  5
+    //   (0, 1, 5) : 全てミス                           -> [0, 1, 5]  8
+    //   (0, 5, 4) : 4 がミス(ヒットでは順番は変わらない)  -> [1, 5, 4]  9
+    asdx::ResMesh mesh;
+    for(auto i=0; i<7; ++i)
+    { mesh.Positions.push_back(asdx::Vector3(float(i), 0.0f, 0.0f)); }
+    mesh.Indices = { 0, 1, 2,  1, 2, 3,  2, 3, 4,  0, 1, 5,  0, 5, 4 };
+
+    auto stats = asdx::CalcMeshStats(mesh, 3);
+    ASDX_CHECK(stats.VertexCount    == 7);
+    ASDX_CHECK(stats.TriangleCount  == 5);
+    ASDX_CHECK(stats.CacheMissCount == 9);
+    ASDX_CHECK(stats.ACMR == 9.0f / 5.0f);
+    ASDX_CHECK(stats.ATVR == 9.0f / 6.0f);     // 参照されない頂点 6 は含めない.
+    ASDX_CHECK(stats.VertexBytes == 7 * sizeof(asdx::Vector3));
+    ASDX_CHECK(stats.IndexBytes  == 15 * sizeof(uint32_t));
+
+    // 大きなメッシュでも素朴な FIFO と一致する.
+    auto grid = CreateGrid(24);
+    std::mt19937 rng(3);
+    std::shuffle(grid.Indices.begin(), grid.Indices.end(), rng);
+    for(auto cacheSize : { 3u, 8u, 16u, 32u })
+    { ASDX_CHECK(asdx::CalcMeshStats(grid, cacheSize).CacheMissCount == CountFifoMisses(grid.Indices, cacheSize)); }
+}
+
+//-----------------------------------------------------------------------------
+//      全属性が一致する頂点のみが結合されることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MeshOptimizer_WeldVertices)
+{
+    asdx::ResMesh mesh;
+    auto add = [&](float x, float y, float u)
+    {
+        mesh.Positions   .push_back(asdx::Vector3(x, y, 0.0f));
+        mesh.Normals     .push_back(asdx::Vector3(0.0f, 0.0f, 1.0f));
+        mesh.TexCoords[0].push_back(asdx::Vector2(u, 0.5f));
+    };
+
+    add(0.0f, 0.0f, 0.0f);              // 0
+    add(1.0f, 0.0f, 0.1f);              // 1
+    add(0.0f, 1.0f, 0.2f);              // 2
+    add(1.0f, 0.0f, 0.1f);              // 3 : 1 と完全に一致.
+    add(1.0f, 1.0f, 0.3f);              // 4
+    add(0.0f, 1.0f, 0.2f);              // 5 : 2 と完全に一致.
+    add(nextafterf(1.0f, 2.0f), 1.0f, 0.3f);    // 6 : 4 と位置が 1ulp 異なる.
+    add(1.0f, 1.0f, 0.30001f);          // 7 : 4 とテクスチャ座標のみ異なる.
+    mesh.Indices = { 0, 1, 2,  3, 4, 5,  5, 4, 6,  2, 3, 7 };
+
+    auto before = mesh;
+    ASDX_CHECK(asdx::WeldVertices(mesh) == 2);
+    ASDX_CHECK(mesh.Positions.size()    == 6);
+    ASDX_CHECK(mesh.Normals.size()      == 6);
+    ASDX_CHECK(mesh.TexCoords[0].size() == 6);
+    ASDX_CHECK(mesh.Indices.size()      == before.Indices.size());
+
+    // 最初に現れた頂点が残り, 参照先の属性は変わらない.
+    ASDX_CHECK((mesh.Indices == std::vector<uint32_t>{ 0, 1, 2,  1, 3, 2,  2, 3, 4,  2, 1, 5 }));
+
+    auto same = true;
+    for(size_t i=0; i<mesh.Indices.size(); ++i)
+    {
+        auto a = mesh.Indices[i];
+        auto b = before.Indices[i];
+        same &= memcmp(&mesh.Positions[a],    &before.Positions[b],    sizeof(asdx::Vector3)) == 0;
+        same &= memcmp(&mesh.TexCoords[0][a], &before.TexCoords[0][b], sizeof(asdx::Vector2)) == 0;
+    }
+    ASDX_CHECK(same);
+
+    // 重複がなければ何もしない.
+    auto again = mesh;
+    ASDX_CHECK(asdx::WeldVertices(again) == 0);
+    ASDX_CHECK(again.Indices == mesh.Indices);
+}
+
+//-----------------------------------------------------------------------------
+//      参照順に頂点が並び, 参照されない頂点が削除されることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MeshOptimizer_OptimizeVertexFetch)
+{
+    auto mesh = CreateBumpyGrid(16);
+
+    // 頂点の並びをシャッフルし, 参照されない頂点を混ぜる.
+    std::mt19937 rng(11);
+    auto vertexCount = uint32_t(mesh.Positions.size());
+    std::vector<uint32_t> order(vertexCount);
+    for(auto i=0u; i<vertexCount; ++i)
+    { order[i] = i; }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    std::vector<asdx::Vector3> positions;
+    std::vector<uint32_t>      remap(vertexCount);
+    for(auto i=0u; i<vertexCount; ++i)
+    {
+        if (i % 7 == 0)
+        { positions.push_back(asdx::Vector3(-1.0f, -1.0f, float(i))); }
+
+        remap[order[i]] = uint32_t(positions.size());
+        positions.push_back(mesh.Positions[order[i]]);
+    }
+    for(auto& index : mesh.Indices)
+    { index = remap[index]; }
+    mesh.Positions = positions;
+
+    auto before = mesh;
+    ASDX_CHECK(asdx::OptimizeVertexFetch(mesh));
+    ASDX_CHECK(mesh.Positions.size() == vertexCount);
+    ASDX_CHECK(mesh.Indices.size() == before.Indices.size());
+
+    // 初めて参照される頂点番号は 0, 1, 2, ... と単調に増える.
+    uint32_t next = 0;
+    auto monotonic = true;
+    for(auto index : mesh.Indices)
+    {
+        if (index == next)
+        { next++; }
+        else
+        { monotonic &= (index < next); }
+    }
+    ASDX_CHECK(monotonic);
+    ASDX_CHECK(next == vertexCount);
+
+    // 三角形の形は変わらない.
+    auto same = true;
+    for(size_t i=0; i<mesh.Indices.size(); ++i)
+    { same &= memcmp(&mesh.Positions[mesh.Indices[i]], &before.Positions[before.Indices[i]], sizeof(asdx::Vector3)) == 0; }
+    ASDX_CHECK(same);
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットの上限, 網羅性, 境界球, 法線コーンを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(MeshOptimizer_BuildMeshlets)
+{
+    auto grid = CreateBumpyGrid(48);
+    ASDX_CHECK(asdx::OptimizeVertexCache(grid));
+
+    // 縮退三角形を含めても網羅されること.
+    grid.Indices.insert(grid.Indices.end(), { 5, 5, 6,  7, 7, 7 });
+
+    auto soup = CreateTriangleSoup(1000, 5);
+
+    struct Case { const asdx::ResMesh* pMesh; uint32_t MaxVertices; uint32_t MaxPrimitives; };
+    const Case cases[] = {
+        { &grid, asdx::DEFAULT_MESHLET_VERTEX_COUNT, asdx::DEFAULT_MESHLET_PRIM_COUNT },
+        { &grid, 3,   1   },
+        { &grid, 256, 512 },
+        { &soup, 256, 512 },    // 頂点数で分割される.
+        { &soup, 64,  8   },    // プリミティブ数で分割される.
+    };
+
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> eyeDist(-60.0f, 60.0f);
+
+    for(auto& c : cases)
+    {
+        auto& mesh = *c.pMesh;
+
+        asdx::ResMeshlets result;
+        ASDX_CHECK(asdx::BuildMeshlets(mesh, c.MaxVertices, c.MaxPrimitives, result));
+        ASDX_CHECK(result.Meshlets.size() == result.Bounds.size());
+
+        std::vector<uint32_t> indices;
+        auto withinLimits = true;
+        auto validLocal   = true;
+        auto enclosed     = true;
+        auto conservative = true;
+        uint32_t culled   = 0;
+        uint32_t tested   = 0;
+
+        for(size_t m=0; m<result.Meshlets.size(); ++m)
+        {
+            auto& meshlet = result.Meshlets[m];
+            auto& bounds  = result.Bounds[m];
+            auto  pVerts  = result.UniqueVertexIndices.data() + meshlet.VertexOffset;
+            auto  pPrims  = result.PrimitiveIndices.data() + size_t(meshlet.PrimitiveOffset) * 3;
+
+            withinLimits &= (meshlet.VertexCount    <= c.MaxVertices);
+            withinLimits &= (meshlet.VertexCount    <= asdx::MAX_MESHLET_VERTEX_COUNT);
+            withinLimits &= (meshlet.PrimitiveCount <= c.MaxPrimitives);
+            withinLimits &= (meshlet.PrimitiveCount > 0);
+
+            for(auto i=0u; i<meshlet.PrimitiveCount * 3; ++i)
+            {
+                validLocal &= (pPrims[i] < meshlet.VertexCount);
+                indices.push_back(pVerts[pPrims[i]]);
+            }
+
+            for(auto i=0u; i<meshlet.VertexCount; ++i)
+            {
+                auto dist = asdx::Vector3::Distance(bounds.Center, mesh.Positions[pVerts[i]]);
+                enclosed &= (dist <= bounds.Radius * 1.0001f + 1e-5f);
+            }
+
+            // カリングされる視点からは全ての三角形が裏向きであること.
+            for(auto e=0; e<64; ++e)
+            {
+                asdx::Vector3 eye(eyeDist(rng), eyeDist(rng), eyeDist(rng));
+                auto dir = bounds.ConeApex - eye;
+                auto len = dir.Length();
+                if (len <= 0.0f)
+                { continue; }
+
+                tested++;
+                if (asdx::Vector3::Dot(dir * (1.0f / len), bounds.ConeAxis) < bounds.ConeCutoff)
+                { continue; }
+
+                culled++;
+                for(auto i=0u; i<meshlet.PrimitiveCount; ++i)
+                {
+                    auto& p0 = mesh.Positions[pVerts[pPrims[i * 3 + 0]]];
+                    auto& p1 = mesh.Positions[pVerts[pPrims[i * 3 + 1]]];
+                    auto& p2 = mesh.Positions[pVerts[pPrims[i * 3 + 2]]];
+                    auto n = asdx::Vector3::Cross(p1 - p0, p2 - p0);
+                    conservative &= (asdx::Vector3::Dot(n, eye - p0) <= 1e-3f * n.Length());
+                }
+            }
+        }
+
+        // 三角形が入力順に1回ずつ含まれる.
+        ASDX_CHECK(indices == mesh.Indices);
+        ASDX_CHECK(withinLimits);
+        ASDX_CHECK(validLocal);
+        ASDX_CHECK(enclosed);
+        ASDX_CHECK(conservative);
+
+        printf("    max = (%3u, %3u) : meshlets = %5zu, culled = %u / %u\n",
+            c.MaxVertices, c.MaxPrimitives, result.Meshlets.size(), culled, tested);
+    }
+
+    // 平面ではコーンが閉じてカリングが効く.
+    auto flat = CreateGrid(16);
+    asdx::ResMeshlets flatResult;
+    ASDX_CHECK(asdx::BuildMeshlets(flat, 64, 126, flatResult));
+    ASDX_CHECK(!flatResult.Bounds.empty() && flatResult.Bounds[0].ConeCutoff < 0.01f);
+
+    // ローカル番号は uint8_t なので 256 頂点を超える指定はできない.
+    asdx::ResMeshlets invalid;
+    ASDX_CHECK(!asdx::BuildMeshlets(grid, asdx::MAX_MESHLET_VERTEX_COUNT + 1, 126, invalid));
+    ASDX_CHECK(!asdx::BuildMeshlets(grid, 2, 126, invalid));
+    ASDX_CHECK(!asdx::BuildMeshlets(grid, 64, 0, invalid));
+}
@@ -0,0 +1,397 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestResModel.cpp
+// Desc : CalcNormals() / CalcTangents() / ResModelBinary Tests and Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <asdxResModel.h>
+#include <asdxResModelBinary.h>
+#include <asdxMathBatch.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      逐次版の法線計算です (並列化前の実装から最終三角形の欠落のみ修正).
+//-----------------------------------------------------------------------------
+void CalcNormalsScalar(asdx::ResMesh& resource)
+{
+    auto vertexCount = resource.Positions.size();
+    std::vector<asdx::Vector3> normals(vertexCount, asdx::Vector3(0.0f, 0.0f, 0.0f));
+
+    auto indexCount = resource.Indices.size();
+    for(size_t i=0; i + 3 <= indexCount; i+=3)
+    {
+        auto i0 = resource.Indices[i + 0];
+        auto i1 = resource.Indices[i + 1];
+        auto i2 = resource.Indices[i + 2];
+
+        auto e0 = resource.Positions[i1] - resource.Positions[i0];
+        auto e1 = resource.Positions[i2] - resource.Positions[i0];
+
+        auto fn = asdx::Vector3::Cross(e0, e1);
+        fn = asdx::Vector3::SafeNormalize(fn, fn);
+
+        normals[i0] += fn;
+        normals[i1] += fn;
+        normals[i2] += fn;
+    }
+
+    for(size_t i=0; i<vertexCount; ++i)
+    { normals[i] = asdx::Vector3::SafeNormalize(normals[i], normals[i]); }
+
+    const auto SMOOTHING_ANGLE = 59.7f;
+    auto cosSmooth = cosf(asdx::ToDegree(SMOOTHING_ANGLE));
+
+    resource.Normals.resize(vertexCount);
+
+    for(size_t i=0; i + 3 <= indexCount; i+=3)
+    {
+        auto i0 = resource.Indices[i + 0];
+        auto i1 = resource.Indices[i + 1];
+        auto i2 = resource.Indices[i + 2];
+
+        auto e0 = resource.Positions[i1] - resource.Positions[i0];
+        auto e1 = resource.Positions[i2] - resource.Positions[i0];
+
+        auto fn = asdx::Vector3::Cross(e0, e1);
+        fn = asdx::Vector3::SafeNormalize(fn, fn);
+
+        auto c0 = asdx::Vector3::Dot(normals[i0], fn);
+        auto c1 = asdx::Vector3::Dot(normals[i1], fn);
+        auto c2 = asdx::Vector3::Dot(normals[i2], fn);
+
+        resource.Normals[i0] = (c0 >= cosSmooth) ? normals[i0] : fn;
+        resource.Normals[i1] = (c1 >= cosSmooth) ? normals[i1] : fn;
+        resource.Normals[i2] = (c2 >= cosSmooth) ? normals[i2] : fn;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      逐次版の接線計算です (並列化前の実装から最終三角形の欠落のみ修正).
+//-----------------------------------------------------------------------------
+void CalcTangentsScalar(asdx::ResMesh& resource)
+{
+    auto vertexCount = resource.Positions.size();
+    resource.Tangents.resize(vertexCount);
+
+    if (resource.TexCoords[0].empty())
+    {
+        for(size_t i=0; i<vertexCount; ++i)
+        {
+            asdx::Vector3 T, B;
+            asdx::CalcONB(resource.Normals[i], T, B);
+            resource.Tangents[i] = T;
+        }
+        return;
+    }
+
+    for(size_t i=0; i<vertexCount; ++i)
+    { resource.Tangents[i] = asdx::Vector3(0.0f, 0.0f, 0.0f); }
+
+    auto indexCount = resource.Indices.size();
+    for(size_t i=0; i + 3 <= indexCount; i+=3)
+    {
+        auto i0 = resource.Indices[i + 0];
+        auto i1 = resource.Indices[i + 1];
+        auto i2 = resource.Indices[i + 2];
+
+        const auto& t0 = resource.TexCoords[0][i0];
+        const auto& t1 = resource.TexCoords[0][i1];
+        const auto& t2 = resource.TexCoords[0][i2];
+
+        auto e1 = resource.Positions[i1] - resource.Positions[i0];
+        auto e2 = resource.Positions[i2] - resource.Positions[i0];
+
+        float x1 = t1.x - t0.x;
+        float x2 = t2.x - t0.x;
+
+        float y1 = t1.y - t0.y;
+        float y2 = t2.y - t0.y;
+
+        float r = 1.0f / (x1 * y2 - x2 * y1);
+
+        asdx::Vector3 T = (e1 * y2 - e2 * y1) * r;
+
+        resource.Tangents[i0] += T;
+        resource.Tangents[i1] += T;
+        resource.Tangents[i2] += T;
+    }
+
+    for(size_t i=0; i<vertexCount; ++i)
+    {
+        auto a = resource.Tangents[i];
+        auto b = resource.Normals[i];
+        auto T = a - b * asdx::Vector3::Dot(a, b);
+        resource.Tangents[i] = asdx::Vector3::SafeNormalize(T, T);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      起伏のあるグリッドメッシュを生成します ((size - 1)^2 * 2 三角形).
+//-----------------------------------------------------------------------------
+asdx::ResMesh CreateGrid(uint32_t size, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+
+    asdx::ResMesh mesh;
+    mesh.Positions   .reserve(size * size);
+    mesh.TexCoords[0].reserve(size * size);
+    for(auto y=0u; y<size; ++y)
+    {
+        for(auto x=0u; x<size; ++x)
+        {
+            auto u = float(x) / float(size - 1);
+            auto v = float(y) / float(size - 1);
+            mesh.Positions   .push_back(asdx::Vector3(u + jitter(rng), v + jitter(rng), sinf(u * 20.0f) * cosf(v * 13.0f) * 0.1f));
+            mesh.TexCoords[0].push_back(asdx::Vector2(u, v));
+        }
+    }
+
+    mesh.Indices.reserve((size - 1) * (size - 1) * 6);
+    for(auto y=0u; y<size - 1; ++y)
+    {
+        for(auto x=0u; x<size - 1; ++x)
+        {
+            auto i0 = y * size + x;
+            auto i1 = i0 + 1;
+            auto i2 = i0 + size;
+            auto i3 = i2 + 1;
+
+            mesh.Indices.push_back(i0); mesh.Indices.push_back(i1); mesh.Indices.push_back(i2);
+            mesh.Indices.push_back(i1); mesh.Indices.push_back(i3); mesh.Indices.push_back(i2);
+        }
+    }
+
+    return mesh;
+}
+
+//-----------------------------------------------------------------------------
+//      ベクトル配列がビット単位で一致するかどうか.
+//-----------------------------------------------------------------------------
+bool IsSame(const std::vector<asdx::Vector3>& a, const std::vector<asdx::Vector3>& b)
+{
+    return a.size() == b.size()
+        && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(asdx::Vector3)) == 0);
+}
+
+//-----------------------------------------------------------------------------
+//      バイナリ形式に変換して読み戻します.
+//-----------------------------------------------------------------------------
+bool RoundTrip(const asdx::ResModel& model, uint32_t flags, std::vector<uint8_t>& binary, asdx::ResModel& result)
+{
+    if (!asdx::WriteResModelBinary(model, flags, binary))
+    { return false; }
+
+    asdx::ResModelBinary reader;
+    if (!reader.LoadFromMemory(binary.data(), binary.size()))
+    { return false; }
+
+    result.Meshes.resize(reader.GetMeshCount());
+    for(auto i=0u; i<reader.GetMeshCount(); ++i)
+    { asdx::Expand(reader.GetMesh(i), result.Meshes[i]); }
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      並列版が逐次版とビット単位で一致することを確認します.
+//      三角形数が並列化の閾値を超えるのでメッシュ内並列の経路を通ります.
+//-----------------------------------------------------------------------------
+ASDX_TEST(CalcNormalsTangents_MatchScalar)
+{
+    // AVX 版は実行時に選択されるので, 対応している全ての SIMD レベルで確認する.
+    auto prev = asdx::GetSimdLevel();
+    for(auto level = 0; level <= int(asdx::GetSupportedSimdLevel()); ++level)
+    {
+        asdx::SetSimdLevel(asdx::SIMD_LEVEL(level));
+
+        for(auto size : { 2u, 3u, 7u, 400u })
+        {
+            auto expected = CreateGrid(size, size);
+            auto actual   = expected;
+
+            CalcNormalsScalar (expected);
+            CalcTangentsScalar(expected);
+
+            asdx::CalcNormals (actual);
+            asdx::CalcTangents(actual);
+
+            ASDX_CHECK(IsSame(expected.Normals,  actual.Normals));
+            ASDX_CHECK(IsSame(expected.Tangents, actual.Tangents));
+        }
+    }
+    asdx::SetSimdLevel(prev);
+}
+
+//-----------------------------------------------------------------------------
+//      モデル単位の処理 (メッシュ間並列 + メッシュ内並列) を確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(CalcNormalsTangents_ModelMatchScalar)
+{
+    asdx::ResModel expected;
+    for(auto i=0u; i<32; ++i)
+    { expected.Meshes.push_back(CreateGrid(16 + i, i)); }
+    expected.Meshes.push_back(CreateGrid(300, 100));
+
+    // テクスチャ座標の無いメッシュは簡易計算になる.
+    expected.Meshes.push_back(CreateGrid(20, 200));
+    expected.Meshes.back().TexCoords[0].clear();
+
+    auto actual = expected;
+
+    for(auto& mesh : expected.Meshes)
+    {
+        CalcNormalsScalar (mesh);
+        CalcTangentsScalar(mesh);
+    }
+
+    asdx::CalcNormals (actual);
+    asdx::CalcTangents(actual);
+
+    for(size_t i=0; i<expected.Meshes.size(); ++i)
+    {
+        ASDX_CHECK(IsSame(expected.Meshes[i].Normals,  actual.Meshes[i].Normals));
+        ASDX_CHECK(IsSame(expected.Meshes[i].Tangents, actual.Meshes[i].Tangents));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      どの三角形からも参照されない頂点の扱いを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(CalcNormals_UnreferencedVertex)
+{
+    auto mesh = CreateGrid(4, 1);
+    mesh.Positions   .push_back(asdx::Vector3(5.0f, 5.0f, 5.0f));
+    mesh.TexCoords[0].push_back(asdx::Vector2(0.0f, 0.0f));
+    auto last = mesh.Positions.size() - 1;
+
+    // 新たに確保される法線はゼロになる.
+    asdx::CalcNormals(mesh);
+    ASDX_CHECK(mesh.Normals[last].x == 0.0f && mesh.Normals[last].y == 0.0f && mesh.Normals[last].z == 0.0f);
+
+    // 既存の法線は逐次版と同様に保持される.
+    mesh.Normals[last] = asdx::Vector3(0.0f, 1.0f, 0.0f);
+    asdx::CalcNormals(mesh);
+    ASDX_CHECK(mesh.Normals[last].y == 1.0f);
+
+    // 空のインデックスバッファでも落ちない.
+    asdx::ResMesh empty;
+    empty.Positions.push_back(asdx::Vector3(0.0f, 0.0f, 0.0f));
+    asdx::CalcNormals (empty);
+    asdx::CalcTangents(empty);
+    ASDX_CHECK(empty.Normals.size() == 1 && empty.Tangents.size() == 1);
+}
+
+//-----------------------------------------------------------------------------
+//      法線の無いメッシュでも圧縮形式で接線が失われないことを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(ResModelBinary_QuantizedTangentsWithoutNormals)
+{
+    auto full = CreateGrid(8, 3);
+    asdx::CalcNormals (full);
+    asdx::CalcTangents(full);
+
+    // 接線と従接線のみを持つメッシュ.
+    auto tangentOnly = full;
+    tangentOnly.MeshName = "tangent_only";
+    tangentOnly.Normals.clear();
+    tangentOnly.Bitangents.resize(tangentOnly.Tangents.size());
+    for(size_t i=0; i<tangentOnly.Tangents.size(); ++i)
+    { tangentOnly.Bitangents[i] = asdx::Vector3::Cross(full.Normals[i], full.Tangents[i]); }
+
+    asdx::ResModel model;
+    model.Meshes.push_back(full);
+    model.Meshes.push_back(tangentOnly);
+
+    std::vector<uint8_t> binary;
+    asdx::ResModel       result;
+
+    // 非圧縮では全てそのまま戻る.
+    ASDX_CHECK(RoundTrip(model, asdx::RES_MODEL_BINARY_FLAG_NONE, binary, result));
+    ASDX_CHECK(result.Meshes.size() == 2);
+    if (result.Meshes.size() == 2)
+    {
+        ASDX_CHECK(result.Meshes[1].Normals.empty());
+        ASDX_CHECK(IsSame(result.Meshes[1].Tangents,   tangentOnly.Tangents));
+        ASDX_CHECK(IsSame(result.Meshes[1].Bitangents, tangentOnly.Bitangents));
+    }
+
+    // 圧縮では法線の無いメッシュの接線は非圧縮で格納される.
+    ASDX_CHECK(RoundTrip(model, asdx::RES_MODEL_BINARY_FLAG_QUANTIZED, binary, result));
+    ASDX_CHECK(result.Meshes.size() == 2);
+    if (result.Meshes.size() == 2)
+    {
+        ASDX_CHECK(result.Meshes[1].MeshName == "tangent_only");
+        ASDX_CHECK(result.Meshes[1].Normals.empty());
+        ASDX_CHECK(IsSame(result.Meshes[1].Tangents,   tangentOnly.Tangents));
+        ASDX_CHECK(IsSame(result.Meshes[1].Bitangents, tangentOnly.Bitangents));
+        ASDX_CHECK(IsSame(result.Meshes[1].Positions,  tangentOnly.Positions));
+
+        // 法線のあるメッシュは従来どおり TBN に圧縮される.
+        auto& mesh  = result.Meshes[0];
+        auto  close = mesh.Normals.size() == full.Normals.size() && mesh.Tangents.size() == full.Tangents.size();
+        for(size_t i=0; close && i<mesh.Normals.size(); ++i)
+        {
+            close &= asdx::Vector3::Dot(mesh.Normals [i], full.Normals [i]) > 0.999f;
+            close &= asdx::Vector3::Dot(mesh.Tangents[i], full.Tangents[i]) > 0.999f;
+        }
+        ASDX_CHECK(close);
+    }
+
+    asdx::ResModelBinary reader;
+    ASDX_CHECK(reader.LoadFromMemory(binary.data(), binary.size()));
+    auto view = reader.GetMesh(1);
+    ASDX_CHECK(view.Quantized && view.EncodedTBNs == nullptr && view.Tangents != nullptr && view.Bitangents != nullptr);
+    view = reader.GetMesh(0);
+    ASDX_CHECK(view.EncodedTBNs != nullptr && view.Tangents == nullptr);
+}
+
+//-----------------------------------------------------------------------------
+//      数百万三角形のメッシュで逐次版と並列版の処理時間を比較します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_CalcNormalsTangents)
+{
+    auto sizes = asdx::test::IsQuick()
+        ? std::vector<uint32_t>{ 256, 512 }
+        : std::vector<uint32_t>{ 1024, 2048 };
+
+    for(auto size : sizes)
+    {
+        auto expected = CreateGrid(size, 1);
+        auto actual   = expected;
+
+        asdx::test::Timer timer;
+        CalcNormalsScalar (expected);
+        CalcTangentsScalar(expected);
+        auto scalarMsec = timer.GetElapsedMsec();
+
+        // スレッドプールの起動を計測から除く.
+        if (size == sizes.front())
+        {
+            auto warmup = CreateGrid(64, 2);
+            asdx::CalcNormals(warmup);
+        }
+
+        timer.Reset();
+        asdx::CalcNormals (actual);
+        asdx::CalcTangents(actual);
+        auto parallelMsec = timer.GetElapsedMsec();
+
+        ASDX_CHECK(IsSame(expected.Normals,  actual.Normals));
+        ASDX_CHECK(IsSame(expected.Tangents, actual.Tangents));
+
+        printf("    triangles = %8zu, scalar = %8.2f ms, parallel = %8.2f ms, speedup = %.2fx\n",
+            actual.Indices.size() / 3, scalarMsec, parallelMsec, scalarMsec / parallelMsec);
+    }
+}
@@ -0,0 +1,686 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestResTexture.cpp
+// Desc : TGA / HDR / DDS Decoder Tests and Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <asdxResTexture.h>
+#include <asdxThreadPool.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t FORMAT_R8_UNORM               = 61;   // DXGI_FORMAT_R8_UNORM
+static const uint32_t FORMAT_R8G8B8A8_UNORM         = 28;   // DXGI_FORMAT_R8G8B8A8_UNORM
+static const uint32_t FORMAT_R8G8B8A8_UNORM_SRGB    = 29;   // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+static const uint32_t FORMAT_B8G8R8A8_UNORM         = 87;   // DXGI_FORMAT_B8G8R8A8_UNORM
+static const uint32_t FORMAT_R16G16B16A16_FLOAT     = 10;   // DXGI_FORMAT_R16G16B16A16_FLOAT
+static const uint32_t FORMAT_R32G32B32A32_FLOAT     = 2;    // DXGI_FORMAT_R32G32B32A32_FLOAT
+static const uint32_t FORMAT_BC1_UNORM              = 71;   // DXGI_FORMAT_BC1_UNORM
+static const uint32_t FORMAT_BC1_UNORM_SRGB         = 72;   // DXGI_FORMAT_BC1_UNORM_SRGB
+static const uint32_t FORMAT_BC4_UNORM              = 80;   // DXGI_FORMAT_BC4_UNORM
+static const uint32_t FORMAT_BC6H_UF16              = 95;   // DXGI_FORMAT_BC6H_UF16
+static const uint32_t FORMAT_BC7_UNORM_SRGB         = 99;   // DXGI_FORMAT_BC7_UNORM_SRGB
+static const uint32_t OPTION_CUBEMAP                = 0x1;  // SUBRESOURCE_OPTION_CUBEMAP
+static const char*    DDS_TEMP_PATH                 = "asdx_test_dds.dds";
+
+///////////////////////////////////////////////////////////////////////////////
+// TgaImage structure
+///////////////////////////////////////////////////////////////////////////////
+struct TgaImage
+{
+    std::vector<uint8_t>    File;       //!< ファイルイメージ.
+    std::vector<uint8_t>    Expected;   //!< 期待されるデコード結果.
+};
+
+//-----------------------------------------------------------------------------
+//      リトルエンディアンで書き込みます.
+//-----------------------------------------------------------------------------
+void Write16(std::vector<uint8_t>& buffer, uint32_t value)
+{
+    buffer.push_back(uint8_t(value & 0xff));
+    buffer.push_back(uint8_t(value >> 8));
+}
+
+//-----------------------------------------------------------------------------
+//      同じ値が続く区間を含むランダムなピクセル列を生成します.
+//-----------------------------------------------------------------------------
+std::vector<uint8_t> CreatePixels(std::mt19937& rng, size_t count, uint32_t bytes, uint32_t valueCount)
+{
+    std::vector<uint8_t> result(count * bytes);
+    for(size_t i=0; i<count;)
+    {
+        auto run    = 1 + rng() % 24;
+        auto repeat = (rng() % 2) == 0;
+
+        uint8_t pixel[4];
+        for(auto k=0u; k<bytes; ++k)
+        { pixel[k] = uint8_t(rng() % valueCount); }
+
+        for(auto r=0u; r<run && i<count; ++r, ++i)
+        {
+            for(auto k=0u; k<bytes; ++k)
+            { result[i * bytes + k] = repeat ? pixel[k] : uint8_t(rng() % valueCount); }
+        }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      Targa の RLE 圧縮を行います.
+//-----------------------------------------------------------------------------
+void EncodeTgaRLE(const std::vector<uint8_t>& pixels, uint32_t bytes, std::vector<uint8_t>& result)
+{
+    auto count = pixels.size() / bytes;
+    auto same  = [&](size_t a, size_t b) { return memcmp(&pixels[a * bytes], &pixels[b * bytes], bytes) == 0; };
+
+    size_t i = 0;
+    while(i < count)
+    {
+        auto j = i + 1;
+        while(j < count && j - i < 128 && same(i, j))
+        { ++j; }
+
+        if (j - i >= 2)
+        {
+            result.push_back(uint8_t(0x80 | (j - i - 1)));
+            result.insert(result.end(), &pixels[i * bytes], &pixels[i * bytes] + bytes);
+            i = j;
+            continue;
+        }
+
+        j = i + 1;
+        while(j < count && j - i < 128 && !(j + 1 < count && same(j, j + 1)))
+        { ++j; }
+
+        result.push_back(uint8_t(j - i - 1));
+        result.insert(result.end(), &pixels[i * bytes], &pixels[j * bytes]);
+        i = j;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      Targa イメージを生成します.
+//      format は 1(インデックス), 2(フルカラー), 3(グレースケール), +8 で RLE です.
+//-----------------------------------------------------------------------------
+TgaImage CreateTga(std::mt19937& rng, uint32_t format, uint32_t bpp, uint32_t width, uint32_t height)
+{
+    auto bytes   = bpp / 8;
+    auto count   = size_t(width) * height;
+    auto indexed = (format & 0x7) == 1;
+    auto gray    = (format & 0x7) == 3;
+
+    // パレットは 24bit BGR.
+    std::vector<uint8_t> palette;
+    if (indexed)
+    {
+        palette.resize(256 * 3);
+        for(auto& c : palette)
+        { c = uint8_t(rng()); }
+    }
+
+    auto pixels = CreatePixels(rng, count, bytes, 256);
+
+    TgaImage image;
+    auto& file = image.File;
+    file.push_back(0);                                  // IdFieldLength
+    file.push_back(indexed ? 1 : 0);                    // HasColorMap
+    file.push_back(uint8_t(format));                    // Format
+    Write16(file, 0);                                   // ColorMapEntry
+    Write16(file, indexed ? 256 : 0);                   // ColorMapLength
+    file.push_back(indexed ? 24 : 0);                   // ColorMapEntrySize
+    Write16(file, 0);                                   // OffsetX
+    Write16(file, 0);                                   // OffsetY
+    Write16(file, width);                               // Width
+    Write16(file, height);                              // Height
+    file.push_back(uint8_t(bpp));                       // BitPerPixel
+    file.push_back(0);                                  // ImageDescriptor
+
+    file.insert(file.end(), palette.begin(), palette.end());
+
+    if (format & 0x8)
+    { EncodeTgaRLE(pixels, bytes, file); }
+    else
+    { file.insert(file.end(), pixels.begin(), pixels.end()); }
+
+    // フッター.
+    for(auto i=0; i<8; ++i)
+    { file.push_back(0); }
+    const char tag[18] = "TRUEVISION-XFILE.";
+    file.insert(file.end(), tag, tag + sizeof(tag));
+
+    // 期待値.
+    if (gray)
+    {
+        image.Expected = pixels;
+        return image;
+    }
+
+    image.Expected.resize(count * 4);
+    for(size_t i=0; i<count; ++i)
+    {
+        auto pSrc = indexed ? &palette[pixels[i] * 3] : &pixels[i * bytes];
+        auto pDst = &image.Expected[i * 4];
+        pDst[0] = pSrc[2];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[0];
+        pDst[3] = (bytes == 4) ? pSrc[3] : 255;
+    }
+
+    return image;
+}
+
+//-----------------------------------------------------------------------------
+//      Radiance HDR イメージを生成します.
+//-----------------------------------------------------------------------------
+std::vector<uint8_t> CreateHdr(std::mt19937& rng, uint32_t width, uint32_t height, bool rle, std::vector<float>& expected)
+{
+    std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string(height) + " +X " + std::to_string(width) + "\n";
+    std::vector<uint8_t> file(header.begin(), header.end());
+
+    auto count = size_t(width) * height;
+    auto rgbe  = CreatePixels(rng, count, 4, 256);
+    expected.resize(count * 4);
+
+    for(size_t i=0; i<count; ++i)
+    {
+        auto p = &rgbe[i * 4];
+
+        // 指数は 0(黒), 非正規化数になる小さい値, 通常の値を混ぜる.
+        auto sel = p[3] % 4;
+        p[3] = (sel == 0) ? 0 : (sel == 1) ? uint8_t(1 + p[3] % 12) : uint8_t(100 + p[3] % 60);
+
+        // 旧形式のランレングスと誤認されないようにする.
+        if (p[0] == 1 && p[1] == 1 && p[2] == 1)
+        { p[0] = 2; }
+
+        auto f = (p[3] != 0) ? ldexp(1.0, int(p[3]) - (128 + 8)) : 0.0;
+        expected[i * 4 + 0] = float(p[0] * f);
+        expected[i * 4 + 1] = float(p[1] * f);
+        expected[i * 4 + 2] = float(p[2] * f);
+        expected[i * 4 + 3] = 1.0f;
+    }
+
+    for(auto y=0u; y<height; ++y)
+    {
+        auto pLine = &rgbe[size_t(y) * width * 4];
+        if (!rle)
+        {
+            file.insert(file.end(), pLine, pLine + width * 4);
+            continue;
+        }
+
+        // 新形式 RLE (チャンネルごとに圧縮).
+        file.push_back(2);
+        file.push_back(2);
+        file.push_back(uint8_t(width >> 8));
+        file.push_back(uint8_t(width & 0xff));
+        for(auto c=0u; c<4; ++c)
+        {
+            auto x = 0u;
+            while(x < width)
+            {
+                auto j = x + 1;
+                while(j < width && j - x < 127 && pLine[j * 4 + c] == pLine[x * 4 + c])
+                { ++j; }
+
+                if (j - x >= 3)
+                {
+                    file.push_back(uint8_t(128 + (j - x)));
+                    file.push_back(pLine[x * 4 + c]);
+                    x = j;
+                    continue;
+                }
+
+                auto end = x + 1;
+                while(end < width && end - x < 128 && !(end + 2 < width && pLine[end * 4 + c] == pLine[(end + 1) * 4 + c] && pLine[end * 4 + c] == pLine[(end + 2) * 4 + c]))
+                { ++end; }
+
+                file.push_back(uint8_t(end - x));
+                for(auto k=x; k<end; ++k)
+                { file.push_back(pLine[k * 4 + c]); }
+                x = end;
+            }
+        }
+    }
+
+    return file;
+}
+
+//-----------------------------------------------------------------------------
+//      デコード結果が期待値と一致するかどうか.
+//-----------------------------------------------------------------------------
+bool IsSame(const asdx::ResTexture& texture, const void* pExpected, size_t size)
+{
+    return texture.pResources != nullptr
+        && texture.pResources[0].SlicePitch == size
+        && memcmp(texture.pResources[0].pPixels, pExpected, size) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//      ランダムな内容の配列 / キューブマップテクスチャを生成します.
+//      サブリソースはサーフェイスごとに全ミップレベルを並べます.
+//-----------------------------------------------------------------------------
+void CreateLayeredTexture
+(
+    std::mt19937&       rng,
+    uint32_t            format,
+    uint32_t            blockSize,      // ブロック圧縮の場合は 4, それ以外は 1.
+    uint32_t            blockBytes,     // 1ブロック(1ピクセル)当たりのバイト数.
+    uint32_t            width,
+    uint32_t            height,
+    uint32_t            surfaceCount,
+    uint32_t            mipCount,
+    uint32_t            option,
+    asdx::ResTexture&   texture
+)
+{
+    texture.Width        = width;
+    texture.Height       = height;
+    texture.Depth        = 0;
+    texture.Format       = format;
+    texture.MipMapCount  = mipCount;
+    texture.SurfaceCount = surfaceCount;
+    texture.Option       = option;
+    texture.pResources   = new asdx::SubResource[surfaceCount * mipCount];
+
+    for(auto i=0u; i<surfaceCount; ++i)
+    {
+        auto w = width;
+        auto h = height;
+        for(auto j=0u; j<mipCount; ++j)
+        {
+            auto  rows = (h + blockSize - 1) / blockSize;
+            auto& res  = texture.pResources[i * mipCount + j];
+            res.Width      = w;
+            res.Height     = h;
+            res.Pitch      = ((w + blockSize - 1) / blockSize) * blockBytes;
+            res.SlicePitch = res.Pitch * rows;
+            res.pPixels    = new uint8_t[res.SlicePitch];
+            for(auto k=0u; k<res.SlicePitch; ++k)
+            { res.pPixels[k] = uint8_t(rng()); }
+
+            w = (w > 1) ? w >> 1 : 1;
+            h = (h > 1) ? h >> 1 : 1;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルを読み込みます.
+//-----------------------------------------------------------------------------
+std::vector<uint8_t> ReadFile(const char* path)
+{
+    std::vector<uint8_t> result;
+
+    FILE* pFile = nullptr;
+#if defined(_WIN32)
+    fopen_s(&pFile, path, "rb");
+#else
+    pFile = fopen(path, "rb");
+#endif
+    if (pFile == nullptr)
+    { return result; }
+
+    fseek(pFile, 0, SEEK_END);
+    result.resize(size_t(ftell(pFile)));
+    fseek(pFile, 0, SEEK_SET);
+    if (fread(result.data(), 1, result.size(), pFile) != result.size())
+    { result.clear(); }
+    fclose(pFile);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャの構成と全サブリソースが一致するかどうか.
+//-----------------------------------------------------------------------------
+bool IsSameTexture(const asdx::ResTexture& a, const asdx::ResTexture& b)
+{
+    if (a.Width        != b.Width
+     || a.Height       != b.Height
+     || a.Format       != b.Format
+     || a.MipMapCount  != b.MipMapCount
+     || a.SurfaceCount != b.SurfaceCount
+     || a.Option       != b.Option
+     || a.pResources   == nullptr
+     || b.pResources   == nullptr)
+    { return false; }
+
+    for(auto i=0u; i<a.SurfaceCount * a.MipMapCount; ++i)
+    {
+        auto& x = a.pResources[i];
+        auto& y = b.pResources[i];
+        if (x.Width      != y.Width
+         || x.Height     != y.Height
+         || x.Pitch      != y.Pitch
+         || x.SlicePitch != y.SlicePitch
+         || memcmp(x.pPixels, y.pPixels, x.SlicePitch) != 0)
+        { return false; }
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      Targa のデコード結果を確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TGA_DecodeMatchesReference)
+{
+    struct Case { uint32_t Format; uint32_t Bpp; uint32_t DxgiFormat; };
+    const Case cases[] = {
+        {  2, 24, FORMAT_R8G8B8A8_UNORM },
+        {  2, 32, FORMAT_R8G8B8A8_UNORM },
+        { 10, 24, FORMAT_R8G8B8A8_UNORM },
+        { 10, 32, FORMAT_R8G8B8A8_UNORM },
+        {  3,  8, FORMAT_R8_UNORM },
+        { 11,  8, FORMAT_R8_UNORM },
+        {  1,  8, FORMAT_R8G8B8A8_UNORM },
+        {  9,  8, FORMAT_R8G8B8A8_UNORM },
+    };
+    const uint32_t sizes[][2] = { { 1, 1 }, { 37, 13 }, { 300, 200 }, { 1024, 1100 } };
+
+    std::mt19937 rng(1234);
+    asdx::ThreadPool pool;
+    pool.Init(4);
+
+    for(auto& c : cases)
+    {
+        for(auto& s : sizes)
+        {
+            auto image = CreateTga(rng, c.Format, c.Bpp, s[0], s[1]);
+            for(auto pPool : { (asdx::ThreadPool*)nullptr, &pool })
+            {
+                asdx::ResTexture texture;
+                ASDX_CHECK(texture.LoadFromMemory(image.File.data(), uint32_t(image.File.size()), pPool));
+                ASDX_CHECK(texture.Format == c.DxgiFormat);
+                ASDX_CHECK(texture.Width == s[0] && texture.Height == s[1]);
+                ASDX_CHECK(IsSame(texture, image.Expected.data(), image.Expected.size()));
+                texture.Release();
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      壊れた Targa データでも範囲外アクセスせずに失敗することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TGA_RejectsTruncatedData)
+{
+    std::mt19937 rng(5678);
+    for(auto format : { 2u, 10u })
+    {
+        auto image = CreateTga(rng, format, 32, 64, 64);
+        auto body  = image.File.size() - 26;
+
+        // フッターを残したままピクセルデータを切り詰める.
+        auto truncated = image.File;
+        truncated.erase(truncated.begin() + body / 2, truncated.begin() + body);
+
+        asdx::ResTexture texture;
+        ASDX_CHECK(!texture.LoadFromMemory(truncated.data(), uint32_t(truncated.size())));
+
+        // ランダムに壊したデータは成功しても失敗してもよいが, 落ちてはいけない.
+        for(auto i=0; i<32; ++i)
+        {
+            auto broken = image.File;
+            for(auto k=0; k<8; ++k)
+            { broken[rng() % body] = uint8_t(rng()); }
+
+            asdx::ResTexture result;
+            if (result.LoadFromMemory(broken.data(), uint32_t(broken.size())))
+            { result.Release(); }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      HDR のデコード結果が ldexp() による変換とビット単位で一致することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HDR_DecodeMatchesLdexp)
+{
+    std::mt19937 rng(4321);
+    asdx::ThreadPool pool;
+    pool.Init(4);
+
+    const uint32_t sizes[][2] = { { 1, 1 }, { 7, 3 }, { 300, 20 }, { 2048, 600 } };
+    for(auto& s : sizes)
+    {
+        for(auto rle : { false, true })
+        {
+            // 新形式 RLE は幅 8 以上 32767 以下のみ.
+            if (rle && s[0] < 8)
+            { continue; }
+
+            std::vector<float> expected;
+            auto file = CreateHdr(rng, s[0], s[1], rle, expected);
+
+            for(auto pPool : { (asdx::ThreadPool*)nullptr, &pool })
+            {
+                asdx::ResTexture texture;
+                ASDX_CHECK(texture.LoadFromMemory(file.data(), uint32_t(file.size()), pPool));
+                ASDX_CHECK(texture.Format == FORMAT_R32G32B32A32_FLOAT);
+                ASDX_CHECK(IsSame(texture, expected.data(), expected.size() * sizeof(float)));
+                texture.Release();
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      データに見合わない画像サイズの HDR を確保前に拒否することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(HDR_RejectsInvalidSize)
+{
+    auto makeHdr = [](uint32_t width, uint32_t height, const std::vector<uint8_t>& data)
+    {
+        std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string(height) + " +X " + std::to_string(width) + "\n";
+        std::vector<uint8_t> file(header.begin(), header.end());
+        file.insert(file.end(), data.begin(), data.end());
+        return file;
+    };
+
+    std::vector<uint8_t> pixel = { 128, 64, 32, 129 };
+
+    // 上限を超える, またはスキャンライン数に対してデータが足りない.
+    const uint32_t sizes[][2] = { { 100000, 1 }, { 1, 100000 }, { 16385, 16385 }, { 16384, 16384 }, { 4, 2 } };
+    for(auto& size : sizes)
+    {
+        auto file = makeHdr(size[0], size[1], pixel);
+
+        asdx::ResTexture texture;
+        ASDX_CHECK(!texture.LoadFromMemory(file.data(), uint32_t(file.size())));
+    }
+
+    // 旧形式の繰り返しだけで圧縮されたスキャンラインは読み込める.
+    // 1行目 : 1ピクセル + 231 + (3 << 8) = 1000, 以降の行 : 232 + (3 << 8) = 1000.
+    auto data = pixel;
+    data.insert(data.end(), { 1, 1, 1, 231,  1, 1, 1, 3 });
+    for(auto y=1; y<4; ++y)
+    { data.insert(data.end(), { 1, 1, 1, 232,  1, 1, 1, 3 }); }
+
+    auto file = makeHdr(1000, 4, data);
+    asdx::ResTexture texture;
+    ASDX_CHECK(texture.LoadFromMemory(file.data(), uint32_t(file.size())));
+    if (texture.pResources != nullptr)
+    {
+        auto pLast = reinterpret_cast<const float*>(texture.pResources[0].pPixels) + (size_t(1000) * 4 - 1) * 4;
+        auto value = float(ldexp(128.0, 129 - (128 + 8)));
+        ASDX_CHECK(texture.Width == 1000 && texture.Height == 4);
+        ASDX_CHECK(pLast[0] == value && pLast[3] == 1.0f);
+        texture.Release();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      TGA / HDR のデコード性能を計測します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_TGA_HDR)
+{
+    auto size   = asdx::test::IsQuick() ? 1024u : 4096u;
+    auto repeat = asdx::test::IsQuick() ? 3 : 5;
+
+    std::mt19937 rng(1);
+    asdx::ThreadPool pool;
+    pool.Init();
+
+    struct Item { const char* Name; std::vector<uint8_t> File; };
+    std::vector<Item> items;
+    items.push_back({ "TGA 24bit",     CreateTga(rng,  2, 24, size, size).File });
+    items.push_back({ "TGA 32bit",     CreateTga(rng,  2, 32, size, size).File });
+    items.push_back({ "TGA 32bit RLE", CreateTga(rng, 10, 32, size, size).File });
+    items.push_back({ "TGA 8bit Index",CreateTga(rng,  1,  8, size, size).File });
+
+    std::vector<float> expected;
+    items.push_back({ "HDR",     CreateHdr(rng, size / 2, size / 2, false, expected) });
+    items.push_back({ "HDR RLE", CreateHdr(rng, size / 2, size / 2, true,  expected) });
+
+    for(auto& item : items)
+    {
+        for(auto pPool : { (asdx::ThreadPool*)nullptr, &pool })
+        {
+            auto best   = 1e30;
+            auto pixels = 0.0;
+            for(auto i=0; i<repeat; ++i)
+            {
+                asdx::ResTexture texture;
+                asdx::test::Timer timer;
+                auto ret = texture.LoadFromMemory(item.File.data(), uint32_t(item.File.size()), pPool);
+                auto msec = timer.GetElapsedMsec();
+                ASDX_CHECK(ret);
+                if (!ret)
+                { break; }
+
+                pixels = double(texture.Width) * texture.Height;
+                best   = (msec < best) ? msec : best;
+                texture.Release();
+            }
+
+            printf("    %-16s %-8s %8.2f ms, %8.1f MB/s, %8.1f Mpixel/s\n",
+                item.Name,
+                (pPool != nullptr) ? "pool" : "single",
+                best,
+                double(item.File.size()) / (1024.0 * 1024.0) / (best / 1000.0),
+                pixels / 1e6 / (best / 1000.0));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      DDS の保存と読み込みで配列 / キューブマップ / フォーマットが保たれることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(DDS_SaveLoadRoundTrip)
+{
+    struct Case { uint32_t Format; uint32_t BlockSize; uint32_t BlockBytes; uint32_t SurfaceCount; uint32_t Option; };
+    const Case cases[] = {
+        // 従来のヘッダで保存されるもの.
+        { FORMAT_R8G8B8A8_UNORM_SRGB,   1,  4,  1, 0 },
+        { FORMAT_BC1_UNORM_SRGB,        4,  8,  6, OPTION_CUBEMAP },
+        { FORMAT_BC4_UNORM,             4,  8,  1, 0 },
+        { FORMAT_R32G32B32A32_FLOAT,    1, 16,  1, 0 },
+
+        // DX10 拡張ヘッダで保存されるもの.
+        { FORMAT_R8G8B8A8_UNORM,        1,  4,  1, 0 },
+        { FORMAT_B8G8R8A8_UNORM,        1,  4,  3, 0 },
+        { FORMAT_R16G16B16A16_FLOAT,    1,  8,  2, 0 },
+        { FORMAT_BC1_UNORM,             4,  8,  4, 0 },
+        { FORMAT_BC6H_UF16,             4, 16,  6, OPTION_CUBEMAP },
+        { FORMAT_BC7_UNORM_SRGB,        4, 16, 12, OPTION_CUBEMAP },
+    };
+
+    std::mt19937 rng(2468);
+    for(auto& c : cases)
+    {
+        for(auto mipCount : { 1u, 6u })
+        {
+            asdx::ResTexture source;
+            CreateLayeredTexture(rng, c.Format, c.BlockSize, c.BlockBytes, 37, 20, c.SurfaceCount, mipCount, c.Option, source);
+            ASDX_CHECK(source.SaveToDDSFileA(DDS_TEMP_PATH));
+
+            asdx::ResTexture fromFile;
+            ASDX_CHECK(fromFile.LoadFromFileA(DDS_TEMP_PATH));
+            ASDX_CHECK(IsSameTexture(source, fromFile));
+            fromFile.Release();
+
+            auto file = ReadFile(DDS_TEMP_PATH);
+            asdx::ResTexture fromMemory;
+            ASDX_CHECK(fromMemory.LoadFromMemory(file.data(), uint32_t(file.size())));
+            ASDX_CHECK(IsSameTexture(source, fromMemory));
+            fromMemory.Release();
+
+            source.Release();
+        }
+    }
+
+    remove(DDS_TEMP_PATH);
+}
+
+//-----------------------------------------------------------------------------
+//      壊れた DX10 拡張ヘッダ付き DDS データでも範囲外アクセスせずに失敗することを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(DDS_RejectsBrokenDX10Header)
+{
+    std::mt19937 rng(1357);
+
+    asdx::ResTexture source;
+    CreateLayeredTexture(rng, FORMAT_BC7_UNORM_SRGB, 4, 16, 64, 64, 6, 7, OPTION_CUBEMAP, source);
+    ASDX_CHECK(source.SaveToDDSFileA(DDS_TEMP_PATH));
+    source.Release();
+
+    auto file = ReadFile(DDS_TEMP_PATH);
+    remove(DDS_TEMP_PATH);
+    ASDX_CHECK(file.size() > 148);
+    if (file.size() <= 148)
+    { return; }
+
+    // magic(4) + DDS_HEADER(124) の直後が DX10 拡張ヘッダ.
+    const size_t dx10 = 128;
+
+    // 拡張ヘッダの途中で切れている.
+    {
+        asdx::ResTexture texture;
+        ASDX_CHECK(!texture.LoadFromMemory(file.data(), uint32_t(dx10 + 8)));
+    }
+
+    // ピクセルデータが足りない.
+    {
+        asdx::ResTexture texture;
+        ASDX_CHECK(!texture.LoadFromMemory(file.data(), uint32_t(file.size() - 1)));
+        texture.Release();
+    }
+
+    // 配列数を水増ししてもピクセルデータの外は読まない.
+    {
+        auto broken = file;
+        broken[dx10 + 12] = 200;
+        asdx::ResTexture texture;
+        ASDX_CHECK(!texture.LoadFromMemory(broken.data(), uint32_t(broken.size())));
+        texture.Release();
+    }
+
+    // 未対応の DXGI フォーマット, 配列数 0, 不正な次元.
+    for(auto offset : { size_t(0), size_t(12), size_t(4) })
+    {
+        auto broken = file;
+        broken[dx10 + offset + 0] = (offset == 4) ? 9 : 0;
+        broken[dx10 + offset + 1] = 0;
+        asdx::ResTexture texture;
+        ASDX_CHECK(!texture.LoadFromMemory(broken.data(), uint32_t(broken.size())));
+    }
+}
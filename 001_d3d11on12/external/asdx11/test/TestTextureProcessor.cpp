@@ -0,0 +1,799 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestTextureProcessor.cpp
+// Desc : MipMap Generation / Block Compression Tests and Benchmark.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <asdxTextureProcessor.h>
+#include <asdxThreadPool.h>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+static const uint32_t FORMAT_R8G8B8A8_UNORM         = 28;   // DXGI_FORMAT_R8G8B8A8_UNORM
+static const uint32_t FORMAT_R8G8B8A8_UNORM_SRGB    = 29;   // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+static const uint32_t FORMAT_R32G32B32A32_FLOAT     = 2;    // DXGI_FORMAT_R32G32B32A32_FLOAT
+static const uint32_t FORMAT_BC1_UNORM              = 71;   // DXGI_FORMAT_BC1_UNORM
+static const uint32_t FORMAT_BC3_UNORM              = 77;   // DXGI_FORMAT_BC3_UNORM
+static const uint32_t FORMAT_BC4_UNORM              = 80;   // DXGI_FORMAT_BC4_UNORM
+static const uint32_t FORMAT_BC5_UNORM              = 83;   // DXGI_FORMAT_BC5_UNORM
+static const uint32_t FORMAT_BC6H_UF16              = 95;   // DXGI_FORMAT_BC6H_UF16
+static const uint32_t FORMAT_BC7_UNORM              = 98;   // DXGI_FORMAT_BC7_UNORM
+static const uint32_t FORMAT_BC7_UNORM_SRGB         = 99;   // DXGI_FORMAT_BC7_UNORM_SRGB
+
+// BC6H / BC7 の 4bit インデックスの補間ウェイト.
+static const int BC_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+///////////////////////////////////////////////////////////////////////////////
+// BitReader structure
+///////////////////////////////////////////////////////////////////////////////
+struct BitReader
+{
+    const uint8_t*  pData;
+    uint32_t        Pos;
+
+    uint32_t Read(uint32_t count)
+    {
+        uint32_t result = 0;
+        for(auto i=0u; i<count; ++i, ++Pos)
+        { result |= ((pData[Pos >> 3] >> (Pos & 7)) & 1u) << i; }
+        return result;
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      RGB565 を 8bit に展開します.
+//-----------------------------------------------------------------------------
+void Expand565(uint16_t color, int result[3])
+{
+    int r = color >> 11;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    result[0] = (r << 3) | (r >> 2);
+    result[1] = (g << 2) | (g >> 4);
+    result[2] = (b << 3) | (b >> 2);
+}
+
+//-----------------------------------------------------------------------------
+//      BC1 ブロックをデコードします(BC3 のカラー部分は forceFour = true).
+//-----------------------------------------------------------------------------
+void DecodeBC1(const uint8_t* pBlock, uint8_t result[16][4], bool forceFour)
+{
+    uint16_t c0, c1;
+    uint32_t bits;
+    memcpy(&c0,   pBlock + 0, 2);
+    memcpy(&c1,   pBlock + 2, 2);
+    memcpy(&bits, pBlock + 4, 4);
+
+    int palette[4][4];
+    Expand565(c0, palette[0]);
+    Expand565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+
+    if (c0 > c1 || forceFour)
+    {
+        for(auto c=0; c<3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        palette[2][3] = palette[3][3] = 255;
+    }
+    else
+    {
+        for(auto c=0; c<3; ++c)
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 0;
+    }
+
+    for(auto i=0; i<16; ++i)
+    {
+        auto index = (bits >> (2 * i)) & 3;
+        for(auto c=0; c<4; ++c)
+        { result[i][c] = uint8_t(palette[index][c]); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      BC4 ブロックをデコードします.
+//-----------------------------------------------------------------------------
+void DecodeBC4(const uint8_t* pBlock, uint8_t result[16])
+{
+    int a0 = pBlock[0];
+    int a1 = pBlock[1];
+
+    int palette[8];
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for(auto i=1; i<7; ++i)
+        { palette[i + 1] = ((7 - i) * a0 + i * a1) / 7; }
+    }
+    else
+    {
+        for(auto i=1; i<5; ++i)
+        { palette[i + 1] = ((5 - i) * a0 + i * a1) / 5; }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for(auto i=0; i<6; ++i)
+    { bits |= uint64_t(pBlock[2 + i]) << (8 * i); }
+
+    for(auto i=0; i<16; ++i)
+    { result[i] = uint8_t(palette[(bits >> (3 * i)) & 7]); }
+}
+
+//-----------------------------------------------------------------------------
+//      BC7 ブロックをデコードします(エンコーダが出力するモード6のみ).
+//-----------------------------------------------------------------------------
+bool DecodeBC7(const uint8_t* pBlock, uint8_t result[16][4])
+{
+    BitReader reader = { pBlock, 0 };
+
+    auto mode = 0;
+    while(mode < 8 && reader.Read(1) == 0)
+    { mode++; }
+
+    if (mode != 6)
+    { return false; }
+
+    int endpoint[2][4];
+    for(auto c=0; c<4; ++c)
+    {
+        endpoint[0][c] = reader.Read(7);
+        endpoint[1][c] = reader.Read(7);
+    }
+
+    auto p0 = int(reader.Read(1));
+    auto p1 = int(reader.Read(1));
+    for(auto c=0; c<4; ++c)
+    {
+        endpoint[0][c] = (endpoint[0][c] << 1) | p0;
+        endpoint[1][c] = (endpoint[1][c] << 1) | p1;
+    }
+
+    for(auto i=0; i<16; ++i)
+    {
+        auto w = BC_WEIGHTS4[reader.Read((i == 0) ? 3 : 4)];
+        for(auto c=0; c<4; ++c)
+        { result[i][c] = uint8_t(((64 - w) * endpoint[0][c] + w * endpoint[1][c] + 32) >> 6); }
+    }
+
+    return reader.Pos == 128;
+}
+
+//-----------------------------------------------------------------------------
+//      半精度浮動小数を単精度に変換します.
+//-----------------------------------------------------------------------------
+float HalfToFloat(uint16_t value)
+{
+    auto e = (value >> 10) & 31;
+    auto m = value & 1023;
+
+    float result;
+    if (e == 0)
+    { result = ldexpf(float(m), -24); }
+    else if (e == 31)
+    { result = INFINITY; }
+    else
+    { result = ldexpf(float(m | 1024), int(e) - 25); }
+
+    return (value & 0x8000) ? -result : result;
+}
+
+//-----------------------------------------------------------------------------
+//      BC6H_UF16 ブロックをデコードします(エンコーダが出力するモード11のみ).
+//-----------------------------------------------------------------------------
+bool DecodeBC6H(const uint8_t* pBlock, float result[16][3])
+{
+    BitReader reader = { pBlock, 0 };
+
+    auto mode = reader.Read(2);
+    if (mode < 2)
+    { return false; }
+
+    mode |= reader.Read(3) << 2;
+    if (mode != 3)
+    { return false; }
+
+    int endpoint[2][3];
+    for(auto c=0; c<3; ++c)
+    { endpoint[0][c] = reader.Read(10); }
+    for(auto c=0; c<3; ++c)
+    { endpoint[1][c] = reader.Read(10); }
+
+    auto unquantize = [](int v)
+    { return (v == 0) ? 0 : (v == 1023) ? 0xFFFF : ((v << 16) + 0x8000) >> 10; };
+
+    for(auto i=0; i<16; ++i)
+    {
+        auto w = BC_WEIGHTS4[reader.Read((i == 0) ? 3 : 4)];
+        for(auto c=0; c<3; ++c)
+        {
+            auto a = unquantize(endpoint[0][c]);
+            auto b = unquantize(endpoint[1][c]);
+            auto v = ((64 - w) * a + w * b + 32) >> 6;
+            result[i][c] = HalfToFloat(uint16_t((v * 31) >> 6));
+        }
+    }
+
+    return reader.Pos == 128;
+}
+
+//-----------------------------------------------------------------------------
+//      グラデーション, 硬いエッジ, ノイズを含む画像を生成します.
+//-----------------------------------------------------------------------------
+std::vector<uint8_t> CreateImage(uint32_t width, uint32_t height, uint32_t seed, bool alpha)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> result(size_t(width) * height * 4);
+
+    for(auto y=0u; y<height; ++y)
+    {
+        for(auto x=0u; x<width; ++x)
+        {
+            auto fx = float(x) / width;
+            auto fy = float(y) / height;
+            auto r  = 0.5f + 0.5f * sinf(fx * 12.0f + fy * 3.0f);
+            auto g  = fx * fy;
+            auto b  = 0.5f + 0.5f * cosf(fy * 9.0f - fx * 2.0f);
+
+            if (((x / 37) + (y / 53)) % 5 == 0)
+            {
+                r = 1.0f - r;
+                g = 0.2f;
+            }
+
+            if (x > width / 2 && y > height / 2)
+            {
+                auto n = (rng() % 1000) / 1000.0f;
+                r = r * 0.7f + n * 0.3f;
+                g = g * 0.8f + n * 0.2f;
+            }
+
+            auto p = &result[(size_t(y) * width + x) * 4];
+            p[0] = uint8_t(r * 255.0f + 0.5f);
+            p[1] = uint8_t(g * 255.0f + 0.5f);
+            p[2] = uint8_t(b * 255.0f + 0.5f);
+            p[3] = alpha ? uint8_t((((x / 8) + (y / 8)) & 1) ? 255 : (x * 255 / width)) : 255;
+        }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      1枚のサブリソースを持つテクスチャを生成します.
+//-----------------------------------------------------------------------------
+void CreateTexture(uint32_t width, uint32_t height, uint32_t format, uint32_t pixelBytes, const void* pPixels, asdx::ResTexture& texture)
+{
+    texture.Width        = width;
+    texture.Height       = height;
+    texture.Depth        = 0;
+    texture.Format       = format;
+    texture.MipMapCount  = 1;
+    texture.SurfaceCount = 1;
+    texture.Option       = 0;
+    texture.pResources   = new asdx::SubResource[1];
+
+    auto& res = texture.pResources[0];
+    res.Width      = width;
+    res.Height     = height;
+    res.Pitch      = width * pixelBytes;
+    res.SlicePitch = res.Pitch * height;
+    res.pPixels    = new uint8_t[res.SlicePitch];
+    memcpy(res.pPixels, pPixels, res.SlicePitch);
+}
+
+//-----------------------------------------------------------------------------
+//      平均二乗誤差から PSNR を求めます.
+//-----------------------------------------------------------------------------
+double CalcPSNR(double mse)
+{ return (mse <= 0.0) ? 99.0 : 10.0 * log10(255.0 * 255.0 / mse); }
+
+//-----------------------------------------------------------------------------
+//      圧縮結果をデコードして元画像との平均二乗誤差を求めます.
+//-----------------------------------------------------------------------------
+double CalcMSE(const asdx::ResTexture& texture, const std::vector<uint8_t>& expected, uint32_t channels)
+{
+    auto& res   = texture.pResources[0];
+    auto blockW = (res.Width  + 3) / 4;
+    auto blockH = (res.Height + 3) / 4;
+
+    double error = 0.0;
+    size_t count = 0;
+
+    for(auto by=0u; by<blockH; ++by)
+    {
+        for(auto bx=0u; bx<blockW; ++bx)
+        {
+            auto    pRow = res.pPixels + by * res.Pitch;
+            uint8_t decoded[16][4] = {};
+            uint8_t a[16], b[16];
+
+            switch(texture.Format)
+            {
+            case FORMAT_BC1_UNORM:
+                DecodeBC1(pRow + bx * 8, decoded, false);
+                break;
+
+            case FORMAT_BC3_UNORM:
+                DecodeBC4(pRow + bx * 16, a);
+                DecodeBC1(pRow + bx * 16 + 8, decoded, true);
+                for(auto i=0; i<16; ++i)
+                { decoded[i][3] = a[i]; }
+                break;
+
+            case FORMAT_BC4_UNORM:
+                DecodeBC4(pRow + bx * 8, a);
+                for(auto i=0; i<16; ++i)
+                { decoded[i][0] = a[i]; }
+                break;
+
+            case FORMAT_BC5_UNORM:
+                DecodeBC4(pRow + bx * 16, a);
+                DecodeBC4(pRow + bx * 16 + 8, b);
+                for(auto i=0; i<16; ++i)
+                {
+                    decoded[i][0] = a[i];
+                    decoded[i][1] = b[i];
+                }
+                break;
+
+            case FORMAT_BC7_UNORM:
+            case FORMAT_BC7_UNORM_SRGB:
+                if (!DecodeBC7(pRow + bx * 16, decoded))
+                { return 1e30; }
+                break;
+
+            default:
+                return 1e30;
+            }
+
+            for(auto i=0u; i<16; ++i)
+            {
+                auto x = bx * 4 + (i & 3);
+                auto y = by * 4 + (i >> 2);
+                if (x >= res.Width || y >= res.Height)
+                { continue; }
+
+                for(auto c=0u; c<channels; ++c)
+                {
+                    auto d = double(decoded[i][c]) - expected[(size_t(y) * res.Width + x) * 4 + c];
+                    error += d * d;
+                    count++;
+                }
+            }
+        }
+    }
+
+    return error / double(count);
+}
+
+//-----------------------------------------------------------------------------
+//      HDR 画像を生成します.
+//-----------------------------------------------------------------------------
+std::vector<float> CreateHdrImage(uint32_t width, uint32_t height)
+{
+    std::mt19937 rng(5);
+    std::vector<float> result(size_t(width) * height * 4);
+
+    for(auto y=0u; y<height; ++y)
+    {
+        for(auto x=0u; x<width; ++x)
+        {
+            auto p = &result[(size_t(y) * width + x) * 4];
+            auto e = powf(2.0f, 8.0f * x / width - 4.0f);
+            p[0] = e * (0.5f + 0.5f * sinf(y * 0.05f));
+            p[1] = e * 0.3f;
+            p[2] = e * (float(y) / height);
+            p[3] = 1.0f;
+
+            if (((x / 16) + (y / 16)) % 7 == 0)
+            { p[0] *= (rng() % 100) / 25.0f; }
+        }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      BC6H の圧縮結果をトーンマップした値で比較した PSNR を求めます.
+//-----------------------------------------------------------------------------
+double CalcPSNR_BC6H(const asdx::ResTexture& texture, const std::vector<float>& expected)
+{
+    auto& res     = texture.pResources[0];
+    auto tonemap  = [](float v) { return 255.0 * pow(v / (1.0 + v), 1.0 / 2.2); };
+
+    double error = 0.0;
+    size_t count = 0;
+
+    for(auto by=0u; by<res.Height / 4; ++by)
+    {
+        for(auto bx=0u; bx<res.Width / 4; ++bx)
+        {
+            float decoded[16][3];
+            if (!DecodeBC6H(res.pPixels + by * res.Pitch + bx * 16, decoded))
+            { return 0.0; }
+
+            for(auto i=0u; i<16; ++i)
+            {
+                auto x = bx * 4 + (i & 3);
+                auto y = by * 4 + (i >> 2);
+                for(auto c=0; c<3; ++c)
+                {
+                    auto d = tonemap(decoded[i][c]) - tonemap(expected[(size_t(y) * res.Width + x) * 4 + c]);
+                    error += d * d;
+                    count++;
+                }
+            }
+        }
+    }
+
+    return CalcPSNR(error / double(count));
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      sRGB はリニア空間で縮小されることを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TextureProcessor_MipMapSRGB)
+{
+    std::vector<uint8_t> checker(64 * 64 * 4);
+    for(auto y=0; y<64; ++y)
+    {
+        for(auto x=0; x<64; ++x)
+        {
+            auto p = &checker[(y * 64 + x) * 4];
+            p[0] = p[1] = p[2] = ((x + y) & 1) ? 255 : 0;
+            p[3] = 255;
+        }
+    }
+
+    // 0 と 1 のリニア平均 0.5 は sRGB で 188.
+    asdx::ResTexture texture;
+    CreateTexture(64, 64, FORMAT_R8G8B8A8_UNORM_SRGB, 4, checker.data(), texture);
+    ASDX_CHECK(asdx::GenerateMipMaps(texture, asdx::MIPMAP_FILTER_BOX));
+    ASDX_CHECK(texture.MipMapCount == 7);
+    ASDX_CHECK(texture.pResources[1].pPixels[0] == 188);
+    ASDX_CHECK(texture.pResources[6].pPixels[0] == 188);
+    ASDX_CHECK(texture.pResources[6].Width == 1 && texture.pResources[6].Height == 1);
+    texture.Release();
+
+    // UNORM はそのまま平均.
+    CreateTexture(64, 64, FORMAT_R8G8B8A8_UNORM, 4, checker.data(), texture);
+    ASDX_CHECK(asdx::GenerateMipMaps(texture, asdx::MIPMAP_FILTER_BOX));
+    ASDX_CHECK(texture.pResources[1].pPixels[0] == 128);
+    texture.Release();
+}
+
+//-----------------------------------------------------------------------------
+//      2のべき乗でないサイズ, アルファ重み付け, 浮動小数のミップマップを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TextureProcessor_MipMapFilters)
+{
+    asdx::ThreadPool pool;
+    pool.Init(4);
+
+    // 一定値の画像はカイザーフィルタでも値が変わらない.
+    {
+        std::vector<uint8_t> flat(37 * 23 * 4, 77);
+        asdx::ResTexture texture;
+        CreateTexture(37, 23, FORMAT_R8G8B8A8_UNORM, 4, flat.data(), texture);
+        ASDX_CHECK(asdx::GenerateMipMaps(texture, asdx::MIPMAP_FILTER_KAISER, asdx::MIPMAP_FLAG_WRAP, 0, &pool));
+        ASDX_CHECK(texture.MipMapCount == 6);
+
+        auto same = true;
+        for(auto m=0u; m<texture.MipMapCount; ++m)
+        {
+            auto& res = texture.pResources[m];
+            for(auto i=0u; i<res.SlicePitch; ++i)
+            { same &= (res.pPixels[i] == 77); }
+        }
+        ASDX_CHECK(same);
+        ASDX_CHECK(texture.pResources[5].Width == 1 && texture.pResources[5].Height == 1);
+        texture.Release();
+    }
+
+    // 透明な赤が不透明な緑に滲まない.
+    {
+        uint8_t pixels[2 * 2 * 4] = {
+              0, 255, 0, 255,
+            255,   0, 0,   0,
+            255,   0, 0,   0,
+            255,   0, 0,   0,
+        };
+        asdx::ResTexture texture;
+        CreateTexture(2, 2, FORMAT_R8G8B8A8_UNORM, 4, pixels, texture);
+        ASDX_CHECK(asdx::GenerateMipMaps(texture, asdx::MIPMAP_FILTER_BOX, asdx::MIPMAP_FLAG_ALPHA_WEIGHTED));
+        auto p = texture.pResources[1].pPixels;
+        ASDX_CHECK(p[0] == 0 && p[1] == 255 && p[3] == 64);
+        texture.Release();
+    }
+
+    // 浮動小数.
+    {
+        std::vector<float> flat(16 * 16 * 4, 2.5f);
+        asdx::ResTexture texture;
+        CreateTexture(16, 16, FORMAT_R32G32B32A32_FLOAT, 16, flat.data(), texture);
+        ASDX_CHECK(asdx::GenerateMipMaps(texture, asdx::MIPMAP_FILTER_KAISER));
+
+        float value;
+        memcpy(&value, texture.pResources[4].pPixels, sizeof(value));
+        ASDX_CHECK(fabsf(value - 2.5f) < 1e-4f);
+        texture.Release();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ブロック圧縮の画質をリファレンスデコーダで確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TextureProcessor_CompressPSNR)
+{
+    const uint32_t size = 512;
+    auto opaque = CreateImage(size, size, 1, false);
+    auto alpha  = CreateImage(size, size, 2, true);
+
+    struct Case { uint32_t Format; bool Alpha; uint32_t Channels; double MinPSNR; };
+    const Case cases[] = {
+        { FORMAT_BC1_UNORM, false, 3, 36.0 },
+        { FORMAT_BC3_UNORM, true,  4, 37.0 },
+        { FORMAT_BC4_UNORM, false, 1, 42.0 },
+        { FORMAT_BC5_UNORM, false, 2, 43.0 },
+        { FORMAT_BC7_UNORM, false, 3, 41.0 },
+        { FORMAT_BC7_UNORM, true,  4, 42.0 },
+    };
+
+    asdx::ThreadPool pool;
+    pool.Init(4);
+
+    for(auto& c : cases)
+    {
+        auto& image = c.Alpha ? alpha : opaque;
+
+        // 並列でも逐次でも同じ結果になる.
+        asdx::ResTexture single;
+        asdx::ResTexture parallel;
+        CreateTexture(size, size, FORMAT_R8G8B8A8_UNORM, 4, image.data(), single);
+        CreateTexture(size, size, FORMAT_R8G8B8A8_UNORM, 4, image.data(), parallel);
+        ASDX_CHECK(asdx::CompressTexture(single, c.Format));
+        ASDX_CHECK(asdx::CompressTexture(parallel, c.Format, &pool));
+        ASDX_CHECK(single.Format == c.Format);
+        ASDX_CHECK(single.pResources[0].SlicePitch == parallel.pResources[0].SlicePitch);
+        ASDX_CHECK(memcmp(single.pResources[0].pPixels, parallel.pResources[0].pPixels, single.pResources[0].SlicePitch) == 0);
+
+        auto psnr = CalcPSNR(CalcMSE(single, image, c.Channels));
+        ASDX_CHECK(psnr >= c.MinPSNR);
+        if (psnr < c.MinPSNR)
+        { printf("    format %u : PSNR %.2f dB < %.2f dB\n", c.Format, psnr, c.MinPSNR); }
+
+        single.Release();
+        parallel.Release();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      BC1 のパンチスルーアルファを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TextureProcessor_BC1PunchThrough)
+{
+    const uint32_t size = 256;
+    auto image = CreateImage(size, size, 2, true);
+
+    asdx::ResTexture texture;
+    CreateTexture(size, size, FORMAT_R8G8B8A8_UNORM, 4, image.data(), texture);
+    ASDX_CHECK(asdx::CompressTexture(texture, FORMAT_BC1_UNORM));
+
+    // アルファ 128 未満は透明, それ以外は不透明にデコードされる.
+    size_t mismatch = 0;
+    auto&  res      = texture.pResources[0];
+    for(auto by=0u; by<size / 4; ++by)
+    {
+        for(auto bx=0u; bx<size / 4; ++bx)
+        {
+            uint8_t decoded[16][4];
+            DecodeBC1(res.pPixels + by * res.Pitch + bx * 8, decoded, false);
+            for(auto i=0u; i<16; ++i)
+            {
+                auto a = image[((by * 4 + (i >> 2)) * size + bx * 4 + (i & 3)) * 4 + 3];
+                if ((a < 128) != (decoded[i][3] == 0))
+                { mismatch++; }
+            }
+        }
+    }
+    ASDX_CHECK(mismatch == 0);
+    texture.Release();
+}
+
+//-----------------------------------------------------------------------------
+//      ミップマップ生成と圧縮を続けて行った場合のレイアウトを確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TextureProcessor_ProcessTexture)
+{
+    asdx::ThreadPool pool;
+    pool.Init(4);
+
+    // sRGB の入力は sRGB の圧縮フォーマットになる.
+    {
+        auto image = CreateImage(256, 256, 3, false);
+        asdx::ResTexture texture;
+        CreateTexture(256, 256, FORMAT_R8G8B8A8_UNORM_SRGB, 4, image.data(), texture);
+
+        asdx::TextureProcessDesc desc = {};
+        desc.GenerateMipMaps = true;
+        desc.Filter          = asdx::MIPMAP_FILTER_KAISER;
+        desc.Format          = FORMAT_BC7_UNORM;
+        ASDX_CHECK(asdx::ProcessTexture(texture, desc, &pool));
+        ASDX_CHECK(texture.Format == FORMAT_BC7_UNORM_SRGB);
+        ASDX_CHECK(texture.MipMapCount == 9);
+        ASDX_CHECK(texture.pResources[8].Pitch == 16 && texture.pResources[8].SlicePitch == 16);
+        ASDX_CHECK(texture.pResources[7].Pitch == 16 && texture.pResources[6].Pitch == 16);
+        ASDX_CHECK(texture.pResources[5].Pitch == 32);
+        texture.Release();
+    }
+
+    // 4の倍数でないサイズはブロック単位に切り上げる.
+    {
+        std::vector<uint8_t> flat(13 * 7 * 4, 200);
+        asdx::ResTexture texture;
+        CreateTexture(13, 7, FORMAT_R8G8B8A8_UNORM, 4, flat.data(), texture);
+        ASDX_CHECK(asdx::CompressTexture(texture, FORMAT_BC1_UNORM));
+        ASDX_CHECK(texture.pResources[0].Pitch == 4 * 8);
+        ASDX_CHECK(texture.pResources[0].SlicePitch == 4 * 8 * 2);
+        texture.Release();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      BC6H の画質をリファレンスデコーダで確認します.
+//-----------------------------------------------------------------------------
+ASDX_TEST(TextureProcessor_CompressBC6H)
+{
+    const uint32_t size = 256;
+    auto image = CreateHdrImage(size, size);
+
+    asdx::ResTexture texture;
+    CreateTexture(size, size, FORMAT_R32G32B32A32_FLOAT, 16, image.data(), texture);
+    ASDX_CHECK(asdx::CompressTexture(texture, FORMAT_BC6H_UF16));
+    ASDX_CHECK(texture.Format == FORMAT_BC6H_UF16);
+
+    auto psnr = CalcPSNR_BC6H(texture, image);
+    ASDX_CHECK(psnr > 42.0);
+    if (psnr <= 42.0)
+    { printf("    BC6H : PSNR %.2f dB\n", psnr); }
+
+    texture.Release();
+}
+
+//-----------------------------------------------------------------------------
+//      ミップマップ生成とブロック圧縮の性能を計測します.
+//-----------------------------------------------------------------------------
+ASDX_BENCH(Bench_TextureProcessor)
+{
+    auto size   = asdx::test::IsQuick() ? 512u : 2048u;
+    auto repeat = asdx::test::IsQuick() ? 2 : 3;
+    auto pixels = double(size) * size;
+
+    asdx::ThreadPool pool;
+    pool.Init();
+
+    auto opaque = CreateImage(size, size, 1, false);
+    auto alpha  = CreateImage(size, size, 2, true);
+
+    // ミップマップ生成.
+    struct Filter { const char* Name; asdx::MIPMAP_FILTER Filter; };
+    const Filter filters[] = {
+        { "MipMap Box",    asdx::MIPMAP_FILTER_BOX },
+        { "MipMap Kaiser", asdx::MIPMAP_FILTER_KAISER },
+    };
+
+    for(auto& f : filters)
+    {
+        for(auto pPool : { (asdx::ThreadPool*)nullptr, &pool })
+        {
+            auto best = 1e30;
+            for(auto i=0; i<repeat; ++i)
+            {
+                asdx::ResTexture texture;
+                CreateTexture(size, size, FORMAT_R8G8B8A8_UNORM_SRGB, 4, opaque.data(), texture);
+
+                asdx::test::Timer timer;
+                ASDX_CHECK(asdx::GenerateMipMaps(texture, f.Filter, 0, 0, pPool));
+                auto msec = timer.GetElapsedMsec();
+                best = (msec < best) ? msec : best;
+                texture.Release();
+            }
+
+            printf("    %-16s %-8s %8.2f ms, %8.1f Mpixel/s\n",
+                f.Name,
+                (pPool != nullptr) ? "pool" : "single",
+                best,
+                pixels / 1e6 / (best / 1000.0));
+        }
+    }
+
+    // ブロック圧縮.
+    struct Format { const char* Name; uint32_t Format; bool Alpha; uint32_t Channels; };
+    const Format formats[] = {
+        { "BC1",         FORMAT_BC1_UNORM, false, 3 },
+        { "BC3",         FORMAT_BC3_UNORM, true,  4 },
+        { "BC4",         FORMAT_BC4_UNORM, false, 1 },
+        { "BC5",         FORMAT_BC5_UNORM, false, 2 },
+        { "BC7",         FORMAT_BC7_UNORM, false, 3 },
+        { "BC7 (alpha)", FORMAT_BC7_UNORM, true,  4 },
+    };
+
+    for(auto& f : formats)
+    {
+        auto& image = f.Alpha ? alpha : opaque;
+        for(auto pPool : { (asdx::ThreadPool*)nullptr, &pool })
+        {
+            auto best = 1e30;
+            auto psnr = 0.0;
+            for(auto i=0; i<repeat; ++i)
+            {
+                asdx::ResTexture texture;
+                CreateTexture(size, size, FORMAT_R8G8B8A8_UNORM, 4, image.data(), texture);
+
+                asdx::test::Timer timer;
+                ASDX_CHECK(asdx::CompressTexture(texture, f.Format, pPool));
+                auto msec = timer.GetElapsedMsec();
+                best = (msec < best) ? msec : best;
+
+                if (i == 0)
+                { psnr = CalcPSNR(CalcMSE(texture, image, f.Channels)); }
+                texture.Release();
+            }
+
+            printf("    %-16s %-8s %8.2f ms, %8.1f Mpixel/s, PSNR %6.2f dB\n",
+                f.Name,
+                (pPool != nullptr) ? "pool" : "single",
+                best,
+                pixels / 1e6 / (best / 1000.0),
+                psnr);
+        }
+    }
+
+    // BC6H.
+    {
+        auto hdrSize = size / 2;
+        auto hdr     = CreateHdrImage(hdrSize, hdrSize);
+        for(auto pPool : { (asdx::ThreadPool*)nullptr, &pool })
+        {
+            asdx::ResTexture texture;
+            CreateTexture(hdrSize, hdrSize, FORMAT_R32G32B32A32_FLOAT, 16, hdr.data(), texture);
+
+            asdx::test::Timer timer;
+            ASDX_CHECK(asdx::CompressTexture(texture, FORMAT_BC6H_UF16, pPool));
+            auto msec = timer.GetElapsedMsec();
+
+            printf("    %-16s %-8s %8.2f ms, %8.1f Mpixel/s, PSNR %6.2f dB (tonemapped)\n",
+                "BC6H",
+                (pPool != nullptr) ? "pool" : "single",
+                msec,
+                double(hdrSize) * hdrSize / 1e6 / (msec / 1000.0),
+                CalcPSNR_BC6H(texture, hdr));
+            texture.Release();
+        }
+    }
+}
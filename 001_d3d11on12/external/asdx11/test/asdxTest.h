@@ -0,0 +1,87 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxTest.h
+// Desc : Minimal Test / Benchmark Harness.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+
+
+namespace asdx {
+namespace test {
+
+///////////////////////////////////////////////////////////////////////////////
+// TestCase structure
+///////////////////////////////////////////////////////////////////////////////
+struct TestCase
+{
+    const char*     Name;       //!< テスト名.
+    bool            IsBench;    //!< ベンチマークの場合は true.
+    void            (*pFunc)(); //!< テスト関数.
+    TestCase*       pNext;      //!< 次のテスト.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// TestRegistrar structure
+///////////////////////////////////////////////////////////////////////////////
+struct TestRegistrar
+{
+    explicit TestRegistrar(TestCase* pCase);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Timer class
+///////////////////////////////////////////////////////////////////////////////
+class Timer
+{
+public:
+    Timer()
+    : m_Start(std::chrono::steady_clock::now())
+    { /* DO_NOTHING */ }
+
+    void Reset()
+    { m_Start = std::chrono::steady_clock::now(); }
+
+    double GetElapsedMsec() const
+    { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count(); }
+
+private:
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      失敗を記録します.
+//-----------------------------------------------------------------------------
+void ReportFailure(const char* file, int line, const char* expr);
+
+//-----------------------------------------------------------------------------
+//! @brief      ベンチマークの規模を縮小するかどうか (-quick 指定時).
+//-----------------------------------------------------------------------------
+bool IsQuick();
+
+} // namespace test
+} // namespace asdx
+
+//-----------------------------------------------------------------------------
+// Macros
+//-----------------------------------------------------------------------------
+#define ASDX_TEST_REGISTER(name, isBench) \
+    static void name(); \
+    static asdx::test::TestCase     s_Case_##name = { #name, isBench, name, nullptr }; \
+    static asdx::test::TestRegistrar s_Registrar_##name(&s_Case_##name); \
+    static void name()
+
+// 既定で実行されるテスト.
+#define ASDX_TEST(name)     ASDX_TEST_REGISTER(name, false)
+
+// -bench 指定時のみ実行されるベンチマーク.
+#define ASDX_BENCH(name)    ASDX_TEST_REGISTER(name, true)
+
+#define ASDX_CHECK(expr) \
+    do { if (!(expr)) { asdx::test::ReportFailure(__FILE__, __LINE__, #expr); } } while(0)
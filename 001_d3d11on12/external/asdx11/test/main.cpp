@@ -0,0 +1,115 @@
+﻿//-----------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Test / Benchmark Entry Point.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstring>
+#include <asdxTest.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Global Variables.
+//-----------------------------------------------------------------------------
+asdx::test::TestCase*   g_pHead         = nullptr;  // 登録されたテスト.
+uint32_t                g_FailureCount  = 0;        // 失敗数.
+bool                    g_Quick         = false;    // 規模縮小フラグ.
+
+} // namespace
+
+
+namespace asdx {
+namespace test {
+
+//-----------------------------------------------------------------------------
+//      テストを登録します.
+//-----------------------------------------------------------------------------
+TestRegistrar::TestRegistrar(TestCase* pCase)
+{
+    pCase->pNext = g_pHead;
+    g_pHead = pCase;
+}
+
+//-----------------------------------------------------------------------------
+//      失敗を記録します.
+//-----------------------------------------------------------------------------
+void ReportFailure(const char* file, int line, const char* expr)
+{
+    fprintf(stderr, "[File: %s, Line: %d] Check Failed : %s\n", file, line, expr);
+    g_FailureCount++;
+}
+
+//-----------------------------------------------------------------------------
+//      ベンチマークの規模を縮小するかどうか.
+//-----------------------------------------------------------------------------
+bool IsQuick()
+{ return g_Quick; }
+
+} // namespace test
+} // namespace asdx
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//
+//      asdx_test [-bench] [-quick] [filter]
+//          -bench  ベンチマークも実行します.
+//          -quick  ベンチマークの規模を縮小します.
+//          filter  名前にこの文字列を含むものだけを実行します.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    auto bench  = false;
+    auto filter = "";
+
+    for(auto i=1; i<argc; ++i)
+    {
+        if (strcmp(argv[i], "-bench") == 0)
+        { bench = true; }
+        else if (strcmp(argv[i], "-quick") == 0)
+        { g_Quick = true; }
+        else
+        { filter = argv[i]; }
+    }
+
+    // 登録順に並べ直す.
+    asdx::test::TestCase* pList = nullptr;
+    for(auto pCase = g_pHead; pCase != nullptr;)
+    {
+        auto pNext = pCase->pNext;
+        pCase->pNext = pList;
+        pList = pCase;
+        pCase = pNext;
+    }
+
+    uint32_t runCount = 0;
+    for(auto pCase = pList; pCase != nullptr; pCase = pCase->pNext)
+    {
+        if (pCase->IsBench && !bench)
+        { continue; }
+
+        if (strstr(pCase->Name, filter) == nullptr)
+        { continue; }
+
+        auto prevFailure = g_FailureCount;
+        printf("[ RUN  ] %s\n", pCase->Name);
+        fflush(stdout);
+
+        asdx::test::Timer timer;
+        pCase->pFunc();
+
+        printf("[ %s ] %s (%.1f ms)\n",
+            (g_FailureCount == prevFailure) ? " OK " : "FAIL",
+            pCase->Name,
+            timer.GetElapsedMsec());
+        fflush(stdout);
+        runCount++;
+    }
+
+    printf("%u test(s) run, %u failure(s).\n", runCount, g_FailureCount);
+    return (g_FailureCount == 0) ? 0 : 1;
+}